@@ -122,7 +122,7 @@ OptionsParser::OptionsParser() : _desc("Options")
     ("codegen,k", opt::value<std::string>()->default_value(defComp.has_codegen_directory() ? defComp.codegen_directory() : def_workdir), "Codegen Directory")
     ("mode,m", opt::value<std::string>()->default_value("Debug"), "Game Mode (Run, Compile, Debug, Design)")
     ("graphics,g", opt::value<std::string>()->default_value(defAPI.has_target_graphics() ? defAPI.target_graphics() : "OpenGL3"), "Graphics System (Direct3D9, Direct3D11, OpenGL1, OpenGL3, OpenGLES2, OpenGLES3, None)")
-    ("audio,a", opt::value<std::string>()->default_value(defAPI.has_target_audio() ? defAPI.target_audio() : "None"), "Audio System (DirectSound, OpenAL, XAudio2, None)")
+    ("audio,a", opt::value<std::string>()->default_value(defAPI.has_target_audio() ? defAPI.target_audio() : "None"), "Audio System (DirectSound, OpenAL, XAudio2, SDL, Mixer, None)")
     ("widgets,w", opt::value<std::string>()->default_value(defAPI.has_target_widgets() ? defAPI.target_widgets() : "None"), "Widget System (Win32, xlib, Cocoa, GTK+, None)")
     ("network,n", opt::value<std::string>()->default_value(defAPI.has_target_network() ? defAPI.target_network() : "None"), "Networking System (DirectPlay, Asynchronous, BerkeleySockets, None)")
     ("collision,c", opt::value<std::string>()->default_value(defAPI.has_target_collision() ? defAPI.target_collision() : "None"), "Collision System (Precise, BBox, None)")
@@ -295,6 +295,12 @@ std::string OptionsParser::APIyaml(const buffers::resources::Settings* currentCo
   yaml += "inherit-increment-from: " + std::to_string(inherit_increment) + "\n";
   yaml += "inherit-objects: " + std::string(inherit_objects ? "true" : "false") + "\n";
   yaml += "automatic-semicolons: " + std::string(automatic_semicolons ? "true" : "false") + "\n";
+  if (compilerSettings.has_sprite_codec())
+    yaml += "sprite-codec: " + std::to_string(compilerSettings.sprite_codec()) + "\n";
+  if (compilerSettings.has_background_codec())
+    yaml += "background-codec: " + std::to_string(compilerSettings.background_codec()) + "\n";
+  if (compilerSettings.has_font_codec())
+    yaml += "font-codec: " + std::to_string(compilerSettings.font_codec()) + "\n";
   yaml += " \n";
   yaml += "target-audio: " + audio + "\n";
   yaml += "target-windowing: " + platform + "\n";
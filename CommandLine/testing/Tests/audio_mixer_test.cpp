@@ -0,0 +1,11 @@
+#include "TestHarness.hpp"
+#include <gtest/gtest.h>
+
+TEST(Game, audio_mixer_test) {
+  if (!TestHarness::windowing_supported()) return;
+  TestConfig tc;
+  tc.extensions = "GTest";
+  tc.audio = "Mixer";
+  EXPECT_EQ(TestHarness::run_to_completion("CommandLine/testing/Tests/audio_mixer_test.sog", tc), 0)
+      << "Mixer test game failed; check the log for gTest failures.";
+}
@@ -145,13 +145,12 @@ inline void write_exe_info(const std::filesystem::path& codegen_directory, const
 
 #define irrr() if (res) { idpr("Error occurred; see scrollback for details.",-1); return res; }
 
-static int write_res_helper(FILE* gameModule, int& resourceblock_start, const GameData &game) {
-  // Start by setting off our location with a DWord of NULLs
-  fwrite("\0\0\0",1,4,gameModule);
+static int write_res_helper(FILE* gameModule, const GameData &game) {
+  ResourceModuleWriter module(gameModule);
 
   idpr("Adding Sprites",90);
 
-  int res = current_language->module_write_sprites(game, gameModule);
+  int res = current_language->module_write_sprites(game, module);
   if (res) { 
     idpr("Error occurred; see scrollback for details.",-1); 
     return res;
@@ -160,17 +159,20 @@ static int write_res_helper(FILE* gameModule, int& resourceblock_start, const Ga
   edbg << "Finalized sprites." << flushl;
   idpr("Adding Sounds",93);
 
-  current_language->module_write_sounds(game, gameModule);
+  current_language->module_write_sounds(game, module);
 
-  current_language->module_write_backgrounds(game, gameModule);
+  current_language->module_write_backgrounds(game, module);
 
-  current_language->module_write_fonts(game, gameModule);
+  current_language->module_write_fonts(game, module);
 
-  current_language->module_write_paths(game, gameModule);
+  current_language->module_write_paths(game, module);
 
-  // Tell where the resources start
-  fwrite("\0\0\0\0res0",8,1,gameModule);
-  fwrite(&resourceblock_start,4,1,gameModule);
+  // Write the table of contents and tell where the resources start
+  res = module.finish();
+  if (res) {
+    user << "Failed to write the resource table of contents." << flushl;
+    idpr("Error occurred; see scrollback for details.",-1);
+  }
 
   // Close the game module; we're done adding resources
   idpr("Closing game module and running if requested.",99);
@@ -680,7 +682,6 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
   }
 
   FILE *gameModule;
-  int resourceblock_start = 0;
   std::filesystem::path resfile = compilerInfo.exe_vars["RESOURCES"];
   cout << "`" << resfile.u8string() << "` == '$exe': " << (resfile == "$exe"?"true":"FALSE") << endl;
 
@@ -700,7 +701,7 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
       idpr("Failed to write resources.",-1); return 12;
     }
 
-    write_res_helper(gameModule, resourceblock_start, game);
+    if (int res = write_res_helper(gameModule, game)) return res;
   }
 
   /**  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
@@ -786,21 +787,21 @@ int lang_CPP::compile(const GameData &game, const char* exe_filename, int mode)
 
   if (resfile == "$exe")
   {
-    gameModule = fopen(gameFname.u8string().c_str(),"ab");
+    // Opened for update rather than append so the module header can be
+    // patched once the table of contents is written
+    gameModule = fopen(gameFname.u8string().c_str(),"r+b");
     if (!gameModule) {
       user << "Failed to append resources to the game. Did compile actually succeed?" << flushl;
       idpr("Failed to add resources.",-1); return 12;
     }
 
-    fseek(gameModule,0,SEEK_END); //necessary on Windows for no reason.
-    resourceblock_start = ftell(gameModule);
-
-    if (resourceblock_start < 128) {
+    fseek(gameModule,0,SEEK_END);
+    if (ftell(gameModule) < 128) {
       user << "Compiled game is clearly not a working module; cannot continue" << flushl;
       idpr("Failed to add resources.",-1); return 13;
     }
 
-    write_res_helper(gameModule, resourceblock_start, game);
+    if (int res = write_res_helper(gameModule, game)) return res;
   }
 
 
@@ -40,48 +40,38 @@ using namespace std;
 #include "backend/ideprint.h"
 #include "languages/lang_CPP.h"
 
-inline void writei(int x, FILE *f) {
-  fwrite(&x,4,1,f);
-}
+#include "module_writer.h"
+#include "settings.h"
+
+using namespace enigma::resource_module;
 
-int lang_CPP::module_write_backgrounds(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_backgrounds(const GameData &game, ResourceModuleWriter &module)
 {
   // Now we're going to add backgrounds
   edbg << game.backgrounds.size() << " Adding Backgrounds to Game Module: " << flushl;
 
-  //Magic Number
-  fwrite("BKG ",4,1,gameModule);
-
-  //Indicate how many
-  int back_count = game.backgrounds.size();
-  fwrite(&back_count,4,1,gameModule);
-
-  int back_maxid = 0;
-  for (int i = 0; i < back_count; i++)
-    if (game.backgrounds[i].id() > back_maxid)
-      back_maxid = game.backgrounds[i].id();
-  fwrite(&back_maxid,4,1,gameModule);
-
-  for (int i = 0; i < back_count; i++)
+  for (const auto &background : game.backgrounds)
   {
-    writei(game.backgrounds[i].id(), gameModule);  // id
-    writei(game.backgrounds[i].image_data.width,  gameModule);  // width
-    writei(game.backgrounds[i].image_data.height, gameModule);  // height
-
-    writei(game.backgrounds[i].legacy_transparency,   gameModule);
-    writei(game.backgrounds[i]->smooth_edges(),       gameModule);
-    writei(game.backgrounds[i]->preload(),            gameModule);
-    writei(game.backgrounds[i]->use_as_tileset(),     gameModule);
-    writei(game.backgrounds[i]->tile_width(),         gameModule);
-    writei(game.backgrounds[i]->tile_height(),        gameModule);
-    writei(game.backgrounds[i]->horizontal_offset(),  gameModule);
-    writei(game.backgrounds[i]->vertical_offset(),    gameModule);
-    writei(game.backgrounds[i]->horizontal_spacing(), gameModule);
-    writei(game.backgrounds[i]->vertical_spacing(),   gameModule);
+    BackgroundInfo info;
+    info.width = background.image_data.width;
+    info.height = background.image_data.height;
+    info.transparent = background.legacy_transparency;
+    info.smooth_edges = background->smooth_edges();
+    info.preload = background->preload();
+    info.use_as_tileset = background->use_as_tileset();
+    info.tile_width = background->tile_width();
+    info.tile_height = background->tile_height();
+    info.h_offset = background->horizontal_offset();
+    info.v_offset = background->vertical_offset();
+    info.h_sep = background->horizontal_spacing();
+    info.v_sep = background->vertical_spacing();
+    module.add(RES_BACKGROUND, background.id(), 0, CODEC_NONE, &info, sizeof(info));
 
-    const int sz = game.backgrounds[i].image_data.pixels.size();
-    writei(sz, gameModule); // size
-    fwrite(game.backgrounds[i].image_data.pixels.data(), 1, sz, gameModule); // data
+    if (!module.add_deflated(RES_BACKGROUND_IMAGE, background.id(), 0, setting::background_codec,
+                             background.image_data.pixels, info.width * info.height * 4)) {
+      user << "Image data of background `" << background.name << "' is corrupt." << flushl;
+      return 14;
+    }
   }
 
   edbg << "Done writing backgrounds." << flushl;
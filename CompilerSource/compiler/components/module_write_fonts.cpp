@@ -36,14 +36,11 @@ using namespace std;
 #include "rectpacker/rectpack.h"
 #include "languages/lang_CPP.h"
 
-inline void writei(int x, FILE *f) {
-  fwrite(&x,4,1,f);
-}
-inline void writef(float x, FILE *f) {
-  fwrite(&x,4,1,f);
-}
+#include "module_writer.h"
+#include "settings.h"
 
 using namespace enigma::rect_packer;
+using namespace enigma::resource_module;
 
 struct GlyphTextureRect {
   float x, y, x2, y2;
@@ -82,18 +79,11 @@ static inline void populate_texture(const FontData& font, pvrect* boxes,
   fclose(sex);*/
 }
 
-int lang_CPP::module_write_fonts(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_fonts(const GameData &game, ResourceModuleWriter &module)
 {
   // Now we're going to add backgrounds
   edbg << game.fonts.size() << " Adding Fonts to Game Module: " << flushl;
 
-  //Magic Number
-  fwrite("FNT ",4,1,gameModule);
-
-  //Indicate how many
-  int font_count = game.fonts.size();
-  writei(font_count,gameModule);
-
   // For each included font
   for (const auto &font : game.fonts) {
     cout << "Iterating included fonts..." << endl;
@@ -151,36 +141,41 @@ int lang_CPP::module_write_fonts(const GameData &game, FILE *gameModule)
       cout << "Allocated a big texture. Moving font into it..." << endl;
       populate_texture(font, boxes, glyphtexc, bigtex, w, h);
 
-      writei(font.id(), gameModule);
-      writei(w,gameModule), writei(h, gameModule);
-      fwrite(bigtex, 1, w * h, gameModule);
-      fwrite("done", 1, 4, gameModule);
+      module.add_encoded(RES_FONT_IMAGE, font.id(), 0, setting::font_codec, bigtex, w * h);
 
       delete[] bigtex;
     }
 
+    FontInfo info;
+    info.texture_width = w;
+    info.texture_height = h;
+    info.range_count = font.normalized_ranges.size();
+    module.begin(RES_FONT, font.id());
+    module.write(info);
+
     size_t igt = 0;
     for (const auto &range : font.normalized_ranges) {
-      writei(range.min, gameModule);
-      unsigned rangeSize = range.max - range.min + 1;
-      writei(rangeSize, gameModule);
+      GlyphRangeInfo rinfo;
+      rinfo.start = range.min;
+      rinfo.count = range.max - range.min + 1;
+      module.write(rinfo);
       for (const auto &glyph : range.glyphs) {
-        writef(glyph.metrics.advance(),  gameModule);
-        writef(glyph.metrics.baseline(), gameModule);
-        writef(glyph.metrics.origin(),   gameModule);
-        writei(glyph.metrics.width(),    gameModule);
-        writei(glyph.metrics.height(),   gameModule);
-
-        writef(glyphtexc[igt].x,  gameModule),
-        writef(glyphtexc[igt].y,  gameModule),
-        writef(glyphtexc[igt].x2, gameModule),
-        writef(glyphtexc[igt].y2, gameModule);
+        GlyphInfo ginfo;
+        ginfo.advance  = glyph.metrics.advance();
+        ginfo.baseline = glyph.metrics.baseline();
+        ginfo.origin   = glyph.metrics.origin();
+        ginfo.width    = glyph.metrics.width();
+        ginfo.height   = glyph.metrics.height();
+        ginfo.tx  = glyphtexc[igt].x;
+        ginfo.ty  = glyphtexc[igt].y;
+        ginfo.tx2 = glyphtexc[igt].x2;
+        ginfo.ty2 = glyphtexc[igt].y2;
+        module.write(ginfo);
         igt++;
       }
     }
+    module.end();
 
-
-    fwrite("endf",1,4,gameModule);
     cout << "Wrote all data for font " << font.id() << endl;
     delete[] glyphtexc;
     delete[] boxes;
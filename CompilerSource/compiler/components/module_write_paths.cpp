@@ -44,47 +44,35 @@ using namespace std;
 
 #include "languages/lang_CPP.h"
 
-inline void writei(int x, FILE *f) {
-  fwrite(&x,4,1,f);
-}
+#include "module_writer.h"
+
+using namespace enigma::resource_module;
 
-int lang_CPP::module_write_paths(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_paths(const GameData &game, ResourceModuleWriter &module)
 {
   // Now we're going to add paths
   edbg << "Adding " << game.paths.size() << " Paths to Game Module: " << flushl;
 
-  //Magic Number
-  fwrite("PTH ",4,1,gameModule);
-
-  //Indicate how many
-  int path_count = game.paths.size();
-  fwrite(&path_count,4,1,gameModule);
-
-  int path_maxid = 0;
-  for (int i = 0; i < path_count; i++)
-    if (game.paths[i].id() > path_maxid)
-      path_maxid = game.paths[i].id();
-  fwrite(&path_maxid,4,1,gameModule);
-
-  for (int i = 0; i < path_count; i++)
+  for (const auto &path : game.paths)
   {
-    writei(game.paths[i].id(), gameModule); //id
-
-    writei(game.paths[i]->smooth(), gameModule);
-    writei(game.paths[i]->closed(), gameModule);
-    writei(game.paths[i]->precision(), gameModule);
+    PathInfo info;
+    info.smooth = path->smooth();
+    info.closed = path->closed();
+    info.precision = path->precision();
     // possibly snapX/Y?
+    info.point_count = path->points().size();
 
-    // Track how many path points we're copying
-    int pointCount = game.paths[i]->points().size();
-    writei(pointCount,gameModule);
-
-    for (int ii = 0; ii < pointCount; ii++)
+    module.begin(RES_PATH, path.id());
+    module.write(info);
+    for (const auto &point : path->points())
     {
-      writei(game.paths[i]->points(ii).x(), gameModule);
-      writei(game.paths[i]->points(ii).y(), gameModule);
-      writei(game.paths[i]->points(ii).speed(), gameModule);
+      PathPointInfo pt;
+      pt.x = point.x();
+      pt.y = point.y();
+      pt.speed = point.speed();
+      module.write(pt);
     }
+    module.end();
   }
 
   edbg << "Done writing paths." << flushl;
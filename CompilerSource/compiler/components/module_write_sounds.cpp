@@ -41,11 +41,11 @@ using namespace std;
 #include "backend/ideprint.h"
 #include "languages/lang_CPP.h"
 
-inline void writei(int x, FILE *f) {
-  fwrite(&x,4,1,f);
-}
+#include "module_writer.h"
+
+using namespace enigma::resource_module;
 
-int lang_CPP::module_write_sounds(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_sounds(const GameData &game, ResourceModuleWriter &module)
 {
   // Now we're going to add sounds
   edbg << game.sounds.size() << " Sounds:" << flushl;
@@ -54,30 +54,22 @@ int lang_CPP::module_write_sounds(const GameData &game, FILE *gameModule)
     fflush(stdout);
   }
 
-  //Magic number
-  fwrite("SND ",4,1,gameModule);
-
-  //Indicate how many
-  size_t sound_count = game.sounds.size();
-  fwrite(&sound_count,4,1,gameModule);
-
-  int sound_maxid = 0;
-  for (size_t i = 0; i < sound_count; i++)
-    if (game.sounds[i].id() > sound_maxid)
-      sound_maxid = game.sounds[i].id();
-  fwrite(&sound_maxid,4,1,gameModule);
-
-  for (size_t i = 0; i < sound_count; i++) {
-    const size_t sndsz = game.sounds[i].audio.size();
+  for (const auto &sound : game.sounds) {
+    const size_t sndsz = sound.audio.size();
     if (!sndsz) {
-      user << "Sound `" << game.sounds[i].name << "' has no size. "
+      user << "Sound `" << sound.name << "' has no size. "
               "It will be omitted from the game." << flushl;
       continue;
     }
 
-    writei(game.sounds[i].id(), gameModule); // ID
-    writei(sndsz, gameModule); // Size
-    fwrite(game.sounds[i].audio.data(), 1, sndsz, gameModule); // Data
+    // Background music is long; don't decode it all up front
+    SoundInfo info;
+    info.kind = sound->kind();
+    info.streamed = sound->streamed() or sound->kind() == buffers::resources::Sound::BACKGROUND_MUSIC;
+    module.add(RES_SOUND_INFO, sound.id(), 0, CODEC_NONE, &info, sizeof(info));
+
+    // Stored as imported so the audio system can decode it in place
+    module.add(RES_SOUND, sound.id(), 0, CODEC_NONE, sound.audio.data(), sndsz);
   }
 
   edbg << "Done writing sounds." << flushl;
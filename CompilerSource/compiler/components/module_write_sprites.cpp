@@ -41,75 +41,62 @@ using namespace std;
 
 #include "backend/ideprint.h"
 
-inline void writei(int x, FILE *f) {
-  fwrite(&x,4,1,f);
-}
+#include "module_writer.h"
+#include "settings.h"
+
+using namespace enigma::resource_module;
 
 #include "languages/lang_CPP.h"
-int lang_CPP::module_write_sprites(const GameData &game, FILE *gameModule)
+int lang_CPP::module_write_sprites(const GameData &game, ResourceModuleWriter &module)
 {
   // Now we're going to add sprites
   edbg << game.sprites.size() << " Adding Sprites to Game Module: " << flushl;
 
-  //Magic Number
-  fwrite("SPR ",4,1,gameModule);
-
-  //Indicate how many
-  int sprite_count = game.sprites.size();
-  fwrite(&sprite_count,4,1,gameModule);
-
-  int sprite_maxid = 0;
-  for (int i = 0; i < sprite_count; i++)
-    if (game.sprites[i].id() > sprite_maxid)
-      sprite_maxid = game.sprites[i].id();
-  fwrite(&sprite_maxid,4,1,gameModule);
-
-  for (int i = 0; i < sprite_count; i++)
+  for (const auto &sprite : game.sprites)
   {
-    writei(game.sprites[i].id(), gameModule); //id
-
     // Track how many subImages we're copying
-    int subCount = game.sprites[i].image_data.size();
+    int subCount = sprite.image_data.size();
 
     int swidth = 0, sheight = 0;
     for (int ii = 0; ii < subCount; ii++)
     {
       if (!swidth and !sheight) {
-        swidth =  game.sprites[i].image_data[ii].width;
-        sheight = game.sprites[i].image_data[ii].height;
+        swidth =  sprite.image_data[ii].width;
+        sheight = sprite.image_data[ii].height;
       }
-      else if (swidth != game.sprites[i].image_data[ii].width
-           || sheight != game.sprites[i].image_data[ii].height) {
-        user << "Subimages of sprite `" << game.sprites[i].name << "' vary in dimensions; do not want." << flushl;
+      else if (swidth != sprite.image_data[ii].width
+           || sheight != sprite.image_data[ii].height) {
+        user << "Subimages of sprite `" << sprite.name << "' vary in dimensions; do not want." << flushl;
         return 14;
       }
     }
     if (!(swidth and sheight and subCount)) {
-      user << "Subimages of sprite `" << game.sprites[i].name << "' have zero size." << flushl;
+      user << "Subimages of sprite `" << sprite.name << "' have zero size." << flushl;
       return 14;
     }
 
-    writei(swidth, gameModule); //width
-    writei(sheight,gameModule); //height
-    writei(game.sprites[i]->origin_x(),  gameModule); // xorig
-    writei(game.sprites[i]->origin_y(),  gameModule); // yorig
-    writei(game.sprites[i]->bbox_top(),    gameModule); // BBox Top
-    writei(game.sprites[i]->bbox_bottom(), gameModule); // BBox Bottom
-    writei(game.sprites[i]->bbox_left(),   gameModule); // BBox Left
-    writei(game.sprites[i]->bbox_right(),  gameModule); // BBox Right
-    writei(game.sprites[i]->bbox_mode(),   gameModule); // BBox Mode
-    writei(game.sprites[i]->shape(),    gameModule); // Mask shape
-
-    writei(subCount,gameModule); //subimages
-
-    for (int ii = 0;ii < subCount; ii++)
+    SpriteInfo info;
+    info.width = swidth;
+    info.height = sheight;
+    info.xorig = sprite->origin_x();
+    info.yorig = sprite->origin_y();
+    info.bbox_top = sprite->bbox_top();
+    info.bbox_bottom = sprite->bbox_bottom();
+    info.bbox_left = sprite->bbox_left();
+    info.bbox_right = sprite->bbox_right();
+    info.bbox_mode = sprite->bbox_mode();
+    info.shape = sprite->shape();
+    info.subimages = subCount;
+    module.add(RES_SPRITE, sprite.id(), 0, CODEC_NONE, &info, sizeof(info));
+
+    // Subimage pixels were already deflated when the image was imported
+    for (int ii = 0; ii < subCount; ii++)
     {
-      //strans = game.sprites[i].image_data[ii].transColor, fwrite(&idttrans,4,1,exe); //Transparent color
-      writei(swidth * sheight * 4, gameModule); // size when unpacked
-      writei(game.sprites[i].image_data[ii].pixels.size(), gameModule);  // size
-      fwrite(game.sprites[i].image_data[ii].pixels.data(), 1,
-             game.sprites[i].image_data[ii].pixels.size(), gameModule);  // data
-      writei(0,gameModule);
+      if (!module.add_deflated(RES_SPRITE_IMAGE, sprite.id(), ii, setting::sprite_codec,
+                               sprite.image_data[ii].pixels, swidth * sheight * 4)) {
+        user << "Subimage " << ii << " of sprite `" << sprite.name << "' is corrupt." << flushl;
+        return 14;
+      }
     }
   }
 
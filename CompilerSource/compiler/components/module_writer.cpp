@@ -0,0 +1,138 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "module_writer.h"
+#include "lz4/lz4block.h"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+using namespace enigma::resource_module;
+
+ResourceModuleWriter::ResourceModuleWriter(FILE *module): module_(module) {
+  fseek(module_, 0, SEEK_END);
+  start_ = ftell(module_);
+
+  // Placeholder; finish() fills in the entry count and TOC location.
+  Header header = {};
+  fwrite(&header, sizeof(header), 1, module_);
+  memset(&pending_, 0, sizeof(pending_));
+}
+
+void ResourceModuleWriter::align() {
+  static const char zeros[kPayloadAlignment] = {};
+  const long pos = ftell(module_) - start_;
+  const size_t pad = (kPayloadAlignment - pos % kPayloadAlignment) % kPayloadAlignment;
+  fwrite(zeros, 1, pad, module_);
+}
+
+void ResourceModuleWriter::add(uint32_t type, int id, uint32_t index, uint32_t codec,
+                               const void *data, size_t size, size_t unpacked_size) {
+  align();
+  TocEntry entry;
+  entry.type = type;
+  entry.id = id;
+  entry.index = index;
+  entry.codec = codec;
+  entry.offset = ftell(module_) - start_;
+  entry.size = size;
+  entry.unpacked_size = unpacked_size ? unpacked_size : size;
+  fwrite(data, 1, size, module_);
+  toc_.push_back(entry);
+}
+
+void ResourceModuleWriter::add_encoded(uint32_t type, int id, uint32_t index, uint32_t codec,
+                                       const void *data, size_t size) {
+  std::vector<unsigned char> packed;
+  switch (codec) {
+    case CODEC_ZLIB: {
+      uLongf packed_size = compressBound(size);
+      packed.resize(packed_size);
+      if (compress(packed.data(), &packed_size, (const Bytef*) data, size) == Z_OK) {
+        add(type, id, index, CODEC_ZLIB, packed.data(), packed_size, size);
+        return;
+      }
+      break;
+    }
+    case CODEC_LZ4:
+      packed.resize(enigma::lz4::compress_bound(size));
+      packed.resize(enigma::lz4::compress((const unsigned char*) data, size, packed.data()));
+      add(type, id, index, CODEC_LZ4, packed.data(), packed.size(), size);
+      return;
+  }
+  add(type, id, index, CODEC_NONE, data, size);
+}
+
+bool ResourceModuleWriter::add_deflated(uint32_t type, int id, uint32_t index, uint32_t codec,
+                                        const std::vector<uint8_t> &deflated, size_t unpacked_size) {
+  if (codec == CODEC_ZLIB) {
+    add(type, id, index, CODEC_ZLIB, deflated.data(), deflated.size(), unpacked_size);
+    return true;
+  }
+
+  std::vector<unsigned char> raw(unpacked_size);
+  uLongf raw_size = unpacked_size;
+  if (uncompress(raw.data(), &raw_size, deflated.data(), deflated.size()) != Z_OK or raw_size != unpacked_size)
+    return false;
+  add_encoded(type, id, index, codec, raw.data(), raw.size());
+  return true;
+}
+
+void ResourceModuleWriter::begin(uint32_t type, int id, uint32_t index) {
+  align();
+  pending_.type = type;
+  pending_.id = id;
+  pending_.index = index;
+  pending_.codec = CODEC_NONE;
+  pending_.offset = ftell(module_) - start_;
+}
+
+void ResourceModuleWriter::write(const void *data, size_t size) {
+  fwrite(data, 1, size, module_);
+}
+
+void ResourceModuleWriter::end() {
+  pending_.size = pending_.unpacked_size = ftell(module_) - start_ - pending_.offset;
+  toc_.push_back(pending_);
+}
+
+int ResourceModuleWriter::finish() {
+  std::sort(toc_.begin(), toc_.end());
+  for (size_t i = 1; i < toc_.size(); ++i) {
+    if (!(toc_[i - 1] < toc_[i])) return 1;  // Duplicate (type, id, index)
+  }
+
+  align();
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.version = kVersion;
+  header.entry_count = toc_.size();
+  header.reserved = 0;
+  header.toc_offset = ftell(module_) - start_;
+  if (fwrite(toc_.data(), sizeof(TocEntry), toc_.size(), module_) != toc_.size())
+    return 2;
+
+  // Tell where the resources start
+  const int block_start = start_;
+  fwrite(kTrailer, sizeof(kTrailer), 1, module_);
+  fwrite(&block_start, 4, 1, module_);
+
+  fseek(module_, start_, SEEK_SET);
+  if (fwrite(&header, sizeof(header), 1, module_) != 1) return 2;
+  fseek(module_, 0, SEEK_END);
+  return 0;
+}
@@ -0,0 +1,68 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_MODULE_WRITER_H
+#define ENIGMA_MODULE_WRITER_H
+
+#include "resource_module.h"
+
+#include <cstdio>
+#include <vector>
+
+/// Streams resource payloads into a game module and records their TOC entries.
+/// The TOC and trailer are written by finish(), once every payload is known.
+class ResourceModuleWriter {
+ public:
+  /// Begins a resource block at the current end of the given file.
+  /// The file remains owned by the caller.
+  explicit ResourceModuleWriter(FILE *module);
+
+  /// Appends one payload. `unpacked_size` is the decoded size for compressed
+  /// codecs; pass 0 to use `size`, as is appropriate for CODEC_NONE.
+  void add(uint32_t type, int id, uint32_t index, uint32_t codec,
+           const void *data, size_t size, size_t unpacked_size = 0);
+
+  /// Appends raw data, packing it with the given codec first.
+  void add_encoded(uint32_t type, int id, uint32_t index, uint32_t codec,
+                   const void *data, size_t size);
+
+  /// Appends data that was deflated on import, repacking it if the requested
+  /// codec is not zlib. Returns false if the data does not inflate to
+  /// `unpacked_size` bytes.
+  bool add_deflated(uint32_t type, int id, uint32_t index, uint32_t codec,
+                    const std::vector<uint8_t> &deflated, size_t unpacked_size);
+
+  /// Appends a payload built from several pieces, such as a fixed-size info
+  /// struct followed by a table of records.
+  void begin(uint32_t type, int id, uint32_t index = 0);
+  void write(const void *data, size_t size);
+  template<typename T> void write(const T &value) { write(&value, sizeof(T)); }
+  void end();
+
+  /// Writes the TOC and trailer and patches the header to point at the TOC.
+  /// Returns nonzero if the block could not be completed.
+  int finish();
+
+ private:
+  void align();
+
+  FILE *module_;
+  long start_;
+  enigma::resource_module::TocEntry pending_;
+  std::vector<enigma::resource_module::TocEntry> toc_;
+};
+
+#endif  // ENIGMA_MODULE_WRITER_H
@@ -177,10 +177,19 @@ int lang_CPP::compile_writeDefraggedEvents(
   /* Now for the grand finale:  the actual event sequence.
   *****************************************************************************/
   wto << "  int ENIGMA_events()" << endl << "  {" << endl;
+  string profiler_phase = "profiler_other";
   for (const EventGroupKey &event : used_events) {
     if (!event.UsesEventLoop()) continue;
 
     string base_indent =  string(4, ' ');
+
+    // Tell the profiler which part of the frame this is, when that changes
+    const string phase = event.GroupName() == "Collisions" ? "profiler_collision" :
+                         event.GroupName() == "Draw" ? "profiler_draw" : "profiler_step";
+    if (phase != profiler_phase) {
+      wto << base_indent << "enigma::profiler_phase(enigma_user::" << phase << ");" << endl;
+      profiler_phase = phase;
+    }
     bool callsubcheck =   event.HasSubCheck()   && !event.IsStacked();
     bool emitsupercheck = event.HasSuperCheck() && !event.IsStacked();
     const string fname =  event.FunctionName();
@@ -219,6 +228,7 @@ int lang_CPP::compile_writeDefraggedEvents(
         <<     base_indent << endl;
   }
   wto << "    after_events:" << endl;
+  wto << "    enigma::profiler_phase(enigma_user::profiler_other);" << endl;
   if (game.settings.shortcuts().let_escape_end_game())
     wto << "    if (keyboard_check_pressed(vk_escape)) game_end();" << endl;
   if (game.settings.shortcuts().let_f4_switch_fullscreen())
@@ -236,6 +246,7 @@ int lang_CPP::compile_writeDefraggedEvents(
   wto << "    enigma::dispose_destroyed_instances();" << endl;
   wto << "    enigma::rooms_switch();" << endl;
   wto << "    enigma::set_room_speed(room_speed);" << endl;
+  wto << "    enigma::profiler_end_frame();" << endl;
   wto << "    " << endl;
   wto << "    return 0;" << endl;
   wto << "  } // event function" << endl;
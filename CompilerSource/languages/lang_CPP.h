@@ -53,11 +53,11 @@ struct lang_CPP: language_adapter {
   int compile_writeDefraggedEvents(const GameData &game, const std::set<EventGroupKey> &used_events, const ParsedObjectVec &parsed_objects) final;
 
   // Resources added to module
-  int module_write_sprites(const GameData &game, FILE *gameModule) final;
-  int module_write_sounds(const GameData &game, FILE *gameModule) final;
-  int module_write_backgrounds(const GameData &game, FILE *gameModule) final;
-  int module_write_paths(const GameData &game, FILE *gameModule) final;
-  int module_write_fonts(const GameData &game, FILE *gameModule) final;
+  int module_write_sprites(const GameData &game, ResourceModuleWriter &module) final;
+  int module_write_sounds(const GameData &game, ResourceModuleWriter &module) final;
+  int module_write_backgrounds(const GameData &game, ResourceModuleWriter &module) final;
+  int module_write_paths(const GameData &game, ResourceModuleWriter &module) final;
+  int module_write_fonts(const GameData &game, ResourceModuleWriter &module) final;
 
   int  load_shared_locals() final;
   void load_extension_locals() final;
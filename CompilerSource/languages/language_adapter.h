@@ -31,6 +31,7 @@
 #include "backend/GameData.h"
 #include "parser/object_storage.h"
 #include "frontend.h"
+#include "compiler/components/module_writer.h"
 
 struct language_adapter {
   virtual string get_name() = 0;
@@ -50,11 +51,11 @@ struct language_adapter {
   virtual int compile_writeDefraggedEvents(const GameData &game, const std::set<EventGroupKey> &used_events, const ParsedObjectVec &parsed_objects) = 0;
 
   // Resources added to module
-  virtual int module_write_sprites(const GameData &game, FILE *gameModule) = 0;
-  virtual int module_write_sounds(const GameData &game, FILE *gameModule) = 0;
-  virtual int module_write_backgrounds(const GameData &game, FILE *gameModule) = 0;
-  virtual int module_write_paths(const GameData &game, FILE *gameModule) = 0;
-  virtual int module_write_fonts(const GameData &game, FILE *gameModule) = 0;
+  virtual int module_write_sprites(const GameData &game, ResourceModuleWriter &module) = 0;
+  virtual int module_write_sounds(const GameData &game, ResourceModuleWriter &module) = 0;
+  virtual int module_write_backgrounds(const GameData &game, ResourceModuleWriter &module) = 0;
+  virtual int module_write_paths(const GameData &game, ResourceModuleWriter &module) = 0;
+  virtual int module_write_fonts(const GameData &game, ResourceModuleWriter &module) = 0;
 
   // Globals and locals
   virtual int  load_shared_locals() = 0;
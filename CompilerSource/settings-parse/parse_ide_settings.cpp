@@ -138,6 +138,12 @@ void parse_ide_settings(const char* eyaml)
   }
   setting::automatic_semicolons   = settree.get("automatic-semicolons").toBool();
   setting::keyword_blacklist = settree.get("keyword-blacklist").toString();
+  if (settree.exists("sprite-codec"))
+    setting::sprite_codec = settree.get("sprite-codec").toInt();
+  if (settree.exists("background-codec"))
+    setting::background_codec = settree.get("background-codec").toInt();
+  if (settree.exists("font-codec"))
+    setting::font_codec = settree.get("font-codec").toInt();
 
   // Path to enigma sources
   enigma_root = settree.get("enigma-root").toString();
@@ -52,6 +52,11 @@ namespace setting
   bool automatic_semicolons = 0; // Determines whether semicolons should automatically be added or if the user wants strict syntax
   COMPLIANCE_LVL compliance_mode = COMPL_STANDARD;
   std::string keyword_blacklist = "";
+
+  //Resource options
+  unsigned sprite_codec = 1;     // How sprite subimages are packed.      0 = none, 1 = zlib, 2 = LZ4
+  unsigned background_codec = 1; // How background images are packed.     0 = none, 1 = zlib, 2 = LZ4
+  unsigned font_codec = 0;       // How font glyph textures are packed.   0 = none, 1 = zlib, 2 = LZ4
 }
 
 CompilerInfo compilerInfo;
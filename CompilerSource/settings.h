@@ -75,6 +75,11 @@ namespace setting
   extern bool automatic_semicolons; // Determines whether semicolons should automatically be added or if the user wants strict syntax
   extern COMPLIANCE_LVL compliance_mode; // How to resolve differences between GM versions.
   extern std::string keyword_blacklist; //Words to blacklist from user scripts, separated by commas.
+
+  //Resource options
+  extern unsigned sprite_codec;     // How sprite subimages are packed.      0 = none, 1 = zlib, 2 = LZ4
+  extern unsigned background_codec; // How background images are packed.     0 = none, 1 = zlib, 2 = LZ4
+  extern unsigned font_codec;       // How font glyph textures are packed.   0 = none, 1 = zlib, 2 = LZ4
 }
 
 struct CompilerInfo {
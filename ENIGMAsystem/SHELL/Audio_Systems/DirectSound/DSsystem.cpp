@@ -215,6 +215,11 @@ int sound_add_from_buffer(int id, void* buffer, size_t bufsize) {
   return 0;
 }
 
+int sound_add_from_buffer_streamed(int id, void* buffer, size_t bufsize) {
+  // DirectSound buffers hold the whole sound; there's no decoder to stream from
+  return sound_add_from_buffer(id, buffer, bufsize);
+}
+
 int sound_add_from_stream(int id, size_t (*callback)(void* userdata, void* buffer, size_t size),
                           void (*seek)(void* userdata, float position), void (*cleanup)(void* userdata),
                           void* userdata) {
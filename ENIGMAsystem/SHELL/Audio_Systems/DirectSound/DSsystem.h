@@ -37,6 +37,7 @@ int get_free_channel(double priority);
 void eos_callback(void *soundID, unsigned src);
 int audiosystem_initialize();
 int sound_add_from_buffer(int id, void *buffer, size_t bufsize);
+int sound_add_from_buffer_streamed(int id, void *buffer, size_t bufsize);
 int sound_add_from_stream(int id, size_t (*callback)(void *userdata, void *buffer, size_t size),
                           void (*seek)(void *userdata, float position), void (*cleanup)(void *userdata),
                           void *userdata);
@@ -21,6 +21,7 @@
 #ifndef ENIGMA_AS_ADVANCED_H
 #define ENIGMA_AS_ADVANCED_H
 
+#include <cstddef>
 #include <string>
 using std::string;
 
@@ -76,6 +77,12 @@ int audio_add(string fname);
 void audio_delete(int index);
 void audio_falloff_set_model(int model);
 
+// Bytes the audio system holds for a sound: its decoded samples, or for a
+// streamed sound its encoded data and stream buffers.
+size_t audio_sound_get_memory_usage(int index);
+// Logs the memory held by every sound, largest first.
+void audio_debug_memory_usage();
+
 int audio_emitter_create();
 bool audio_emitter_exists(int index);
 void audio_emitter_falloff(int emitter, as_scalar falloff_ref, as_scalar falloff_max, as_scalar falloff_factor);
@@ -0,0 +1,5 @@
+// Informative header designed to grant superior control over platform-
+// or API-dependent behavior. This file can define any number of macros
+// describing various compatibility and feature points.
+
+#define ENIGMA_AS_MIXER 1
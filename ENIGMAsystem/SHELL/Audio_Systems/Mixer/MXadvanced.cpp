@@ -0,0 +1,349 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "MXsystem.h"
+#include "MXdecode.h"
+#include "SoundEmitter.h"
+
+#include "../General/ASadvanced.h"
+#include "../General/ASbasic.h"
+#include "../General/ASutil.h"
+#include "Widget_Systems/widgets_mandatory.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+using namespace enigma::mixer;
+using enigma::AUDIO_CHANNEL_OFFSET;
+
+namespace {
+
+// The sound's own data, plus what each channel streaming it has decoded
+size_t sound_memory(int index) {
+  const Sound &snd = sounds[index];
+  size_t bytes = snd.samples.capacity() * sizeof(float) + (snd.encoded ? snd.encoded->capacity() : 0);
+  for (const SoundChannel &ch : sound_channels) {
+    if (!ch.active or ch.soundIndex != index) continue;
+    bytes += ch.block.capacity() * sizeof(float) + (ch.decoder ? ch.decoder->memory() : 0);
+  }
+  return bytes;
+}
+
+// Calls `f` on the channel behind a handle, or on every channel playing a sound.
+template<typename F> void for_each_channel(int index, F f) {
+  if (index >= AUDIO_CHANNEL_OFFSET) {
+    if (SoundChannel *ch = get_channel(index)) f(*ch, index - AUDIO_CHANNEL_OFFSET);
+    return;
+  }
+  for (size_t i = 0; i < sound_channels.size(); i++) {
+    if (sound_channels[i].active and sound_channels[i].soundIndex == index) f(sound_channels[i], i);
+  }
+}
+
+SoundEmitter *get_emitter(int emitter) {
+  if (emitter < 0 or size_t(emitter) >= sound_emitters.size() or !sound_emitters[emitter]) {
+    DEBUG_MESSAGE("Audio emitter " + std::to_string(emitter) + " does not exist", MESSAGE_TYPE::M_USER_ERROR);
+    return nullptr;
+  }
+  return sound_emitters[emitter];
+}
+
+}  // namespace
+
+namespace enigma_user {
+
+bool audio_exists(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.exists(index);
+}
+
+bool audio_is_playing(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  bool playing = false;
+  for_each_channel(index, [&](SoundChannel &ch, int) { playing |= !ch.paused; });
+  return playing;
+}
+
+bool audio_is_paused(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  bool paused = false;
+  for_each_channel(index, [&](SoundChannel &ch, int) { paused |= ch.paused; });
+  return paused;
+}
+
+int audio_play_sound(int index, double priority, bool loop) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  const int channel = start_channel(index, priority, loop);
+  return channel == -1 ? -1 : channel + AUDIO_CHANNEL_OFFSET;
+}
+
+int audio_play_sound_at(int index, as_scalar x, as_scalar y, as_scalar z, as_scalar falloff_ref, as_scalar falloff_max,
+                        as_scalar falloff_factor, bool loop, double priority) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  const int channel = start_channel(index, priority, loop);
+  if (channel == -1) return -1;
+  SoundChannel &ch = sound_channels[channel];
+  ch.positional = true;
+  ch.pos[0] = x;
+  ch.pos[1] = y;
+  ch.pos[2] = z;
+  ch.falloff[0] = falloff_ref;
+  ch.falloff[1] = falloff_max;
+  ch.falloff[2] = falloff_factor;
+  return channel + AUDIO_CHANNEL_OFFSET;
+}
+
+int audio_play_sound_on(int emitter, int sound, bool loop, double priority) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  SoundEmitter *emit = get_emitter(emitter);
+  if (!emit) return -1;
+  const int channel = start_channel(sound, priority, loop);
+  if (channel == -1) return -1;
+  // The channel follows the emitter; its own position is the fallback if the emitter is freed
+  SoundChannel &ch = sound_channels[channel];
+  ch.positional = true;
+  ch.emitter = emitter;
+  std::copy(emit->emitPos, emit->emitPos + 3, ch.pos);
+  std::copy(emit->falloff, emit->falloff + 3, ch.falloff);
+  return channel + AUDIO_CHANNEL_OFFSET;
+}
+
+void audio_pause_sound(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for_each_channel(index, [](SoundChannel &ch, int) { ch.paused = true; });
+}
+
+void audio_resume_sound(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for_each_channel(index, [](SoundChannel &ch, int) { ch.paused = false; });
+}
+
+void audio_stop_sound(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for_each_channel(index, [](SoundChannel &, int channel) { release_channel(channel); });
+}
+
+void audio_pause_all() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (SoundChannel &ch : sound_channels) ch.paused = true;
+}
+
+void audio_resume_all() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (SoundChannel &ch : sound_channels) ch.paused = false;
+}
+
+void audio_stop_all() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (size_t i = 0; i < sound_channels.size(); i++) release_channel(i);
+}
+
+void audio_sound_seek(int index, double offset) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for_each_channel(index, [&](SoundChannel &ch, int) {
+    Sound &snd = sounds[ch.soundIndex];
+    if (snd.streaming()) {
+      if (seek_stream(ch, offset)) ch.position = 0;
+    } else {
+      ch.position = std::max(offset, 0.0) * snd.rate;
+    }
+  });
+}
+
+double audio_sound_offset(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  double offset = 0;
+  for_each_channel(index, [&](SoundChannel &ch, int) {
+    offset = (ch.block_start + ch.position) / sounds[ch.soundIndex].rate;
+  });
+  return offset;
+}
+
+void audio_listener_orientation(as_scalar lookat_x, as_scalar lookat_y, as_scalar lookat_z, as_scalar up_x,
+                                as_scalar up_y, as_scalar up_z) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  listener_ori[0] = lookat_x;
+  listener_ori[1] = lookat_y;
+  listener_ori[2] = lookat_z;
+  listener_ori[3] = up_x;
+  listener_ori[4] = up_y;
+  listener_ori[5] = up_z;
+}
+
+void audio_listener_position(as_scalar x, as_scalar y, as_scalar z) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  listener_pos[0] = x;
+  listener_pos[1] = y;
+  listener_pos[2] = z;
+}
+
+void audio_listener_velocity(as_scalar vx, as_scalar vy, as_scalar vz) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  listener_vel[0] = vx;
+  listener_vel[1] = vy;
+  listener_vel[2] = vz;
+}
+
+int audio_sound_length(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (index >= AUDIO_CHANNEL_OFFSET) {
+    SoundChannel *ch = get_channel(index);
+    if (!ch) return 0;
+    index = ch->soundIndex;
+  }
+  if (!sounds.exists(index)) return 0;
+  const Sound &snd = sounds[index];
+  return snd.rate and !snd.stream ? snd.frames / snd.rate : 0;
+}
+
+void audio_sound_pitch(int index, float pitch) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (index >= AUDIO_CHANNEL_OFFSET) for_each_channel(index, [&](SoundChannel &ch, int) { ch.pitch = pitch; });
+  else sounds.get(index).pitch = pitch;
+}
+
+void audio_sound_gain(int index, float volume, double time) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (index < AUDIO_CHANNEL_OFFSET) {
+    // Sounds change at once; the mixer still smooths the step over one block
+    sounds.get(index).volume = volume;
+    return;
+  }
+  for_each_channel(index, [&](SoundChannel &ch, int) {
+    ch.gain_target = volume;
+    ch.gain_frames = time > 0 ? size_t(time / 1000 * output_rate) : 0;
+    if (!ch.gain_frames) ch.gain = volume;
+  });
+}
+
+void audio_master_gain(float volume) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  master_gain = volume;
+}
+
+void audio_channel_num(int num) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  channel_num = std::max(num, 1);
+}
+
+int audio_system() { return audio_new_system; }
+
+int audio_add(string fname) {
+  size_t flen = 0;
+  std::unique_ptr<char[]> fdata(enigma::read_all_bytes(fname, flen));
+  if (!fdata) {
+    DEBUG_MESSAGE("The sound file \"" + fname + "\" failed to open", MESSAGE_TYPE::M_ERROR);
+    return -1;
+  }
+  Sound snd;
+  if (!decode_sound(reinterpret_cast<unsigned char*>(fdata.get()), flen, snd)) {
+    DEBUG_MESSAGE("The sound file \"" + fname + "\" failed to be decoded", MESSAGE_TYPE::M_ERROR);
+    return -1;
+  }
+  snd.loaded = true;
+
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.add(std::move(snd));
+}
+
+void audio_delete(int index) { sound_delete(index); }
+
+void audio_falloff_set_model(int model) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  falloff_model = model;
+}
+
+size_t audio_sound_get_memory_usage(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.exists(index) ? sound_memory(index) : 0;
+}
+
+void audio_debug_memory_usage() {
+  std::vector<std::pair<size_t, int> > usage;
+  size_t total = 0;
+  {
+    std::lock_guard<std::mutex> guard(mixer_lock);
+    for (auto it : sounds) {
+      usage.push_back({sound_memory(it.first), it.first});
+      total += usage.back().first;
+    }
+  }
+  std::sort(usage.rbegin(), usage.rend());
+  for (const auto &u : usage) {
+    DEBUG_MESSAGE("Sound " + std::to_string(u.second) + (sounds[u.second].streaming() ? " (streamed): " : ": ")
+                  + std::to_string(u.first) + " bytes", MESSAGE_TYPE::M_INFO);
+  }
+  DEBUG_MESSAGE("All sounds: " + std::to_string(total) + " bytes", MESSAGE_TYPE::M_INFO);
+}
+
+int audio_emitter_create() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sound_emitters.push_back(new SoundEmitter());
+  return sound_emitters.size() - 1;
+}
+
+bool audio_emitter_exists(int index) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return index >= 0 and size_t(index) < sound_emitters.size() and sound_emitters[index];
+}
+
+void audio_emitter_falloff(int emitter, as_scalar falloff_ref, as_scalar falloff_max, as_scalar falloff_factor) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (SoundEmitter *emit = get_emitter(emitter)) {
+    emit->falloff[0] = falloff_ref;
+    emit->falloff[1] = falloff_max;
+    emit->falloff[2] = falloff_factor;
+  }
+}
+
+void audio_emitter_free(int emitter) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (SoundEmitter *emit = get_emitter(emitter)) {
+    delete emit;
+    sound_emitters[emitter] = nullptr;
+  }
+}
+
+void audio_emitter_gain(int emitter, double gain) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (SoundEmitter *emit = get_emitter(emitter)) emit->volume = gain;
+}
+
+void audio_emitter_pitch(int emitter, double pitch) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (SoundEmitter *emit = get_emitter(emitter)) emit->pitch = pitch;
+}
+
+void audio_emitter_position(int emitter, as_scalar x, as_scalar y, as_scalar z) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (SoundEmitter *emit = get_emitter(emitter)) {
+    emit->emitPos[0] = x;
+    emit->emitPos[1] = y;
+    emit->emitPos[2] = z;
+  }
+}
+
+void audio_emitter_velocity(int emitter, as_scalar vx, as_scalar vy, as_scalar vz) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (SoundEmitter *emit = get_emitter(emitter)) {
+    emit->emitVel[0] = vx;
+    emit->emitVel[1] = vy;
+    emit->emitVel[2] = vz;
+  }
+}
+
+}  // namespace enigma_user
@@ -0,0 +1,255 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "MXsystem.h"
+#include "MXdecode.h"
+
+#include "../General/ASbasic.h"
+#include "../General/ASadvanced.h"
+#include "../General/ASutil.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+using namespace enigma::mixer;
+
+namespace {
+
+// Sets every channel currently playing `sound` to `paused`; returns whether any changed.
+bool pause_sound_channels(int sound, bool paused) {
+  bool changed = false;
+  for (SoundChannel &ch : sound_channels) {
+    if (ch.active and ch.soundIndex == sound and ch.paused != paused) {
+      ch.paused = paused;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace
+
+namespace enigma_user {
+
+bool sound_exists(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.exists(sound);
+}
+
+bool sound_play(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return start_channel(sound, 1, false) != -1;
+}
+
+bool sound_loop(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return start_channel(sound, 1, true) != -1;
+}
+
+void sound_stop(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (size_t i = 0; i < sound_channels.size(); i++) {
+    if (sound_channels[i].active and sound_channels[i].soundIndex == sound) release_channel(i);
+  }
+}
+
+void sound_stop_all() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (size_t i = 0; i < sound_channels.size(); i++) release_channel(i);
+}
+
+void sound_delete(int sound) {
+  sound_stop(sound);
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.destroy(sound);
+}
+
+bool sound_pause(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return pause_sound_channels(sound, true);
+}
+
+void sound_pause_all() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (SoundChannel &ch : sound_channels) ch.paused = true;
+}
+
+bool sound_resume(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return pause_sound_channels(sound, false);
+}
+
+void sound_resume_all() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (SoundChannel &ch : sound_channels) ch.paused = false;
+}
+
+float sound_get_pan(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.get(sound).pan;
+}
+
+float sound_get_volume(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.get(sound).volume;
+}
+
+float sound_get_length(int sound) {  // Not for callback streams
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  const Sound &snd = sounds.get(sound);
+  return snd.rate and !snd.stream ? float(snd.frames) / snd.rate : 0;
+}
+
+float sound_get_position(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (!sounds.exists(sound)) return -1;
+  for (const SoundChannel &ch : sound_channels) {
+    if (ch.active and ch.soundIndex == sound) return (ch.block_start + ch.position) / sounds[sound].rate;
+  }
+  return -1;
+}
+
+void sound_seek(int sound, float position) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  if (!sounds.exists(sound)) return;
+  const Sound &snd = sounds[sound];
+  for (SoundChannel &ch : sound_channels) {
+    if (!ch.active or ch.soundIndex != sound) continue;
+    if (!snd.streaming()) ch.position = std::max(position, 0.0f) * snd.rate;
+    else if (seek_stream(ch, position)) ch.position = 0;
+  }
+}
+
+void sound_seek_all(float position) {
+  std::vector<int> playing;
+  {
+    std::lock_guard<std::mutex> guard(mixer_lock);
+    for (const SoundChannel &ch : sound_channels) {
+      if (ch.active) playing.push_back(ch.soundIndex);
+    }
+  }
+  for (int sound : playing) sound_seek(sound, position);
+}
+
+bool sound_isplaying(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (const SoundChannel &ch : sound_channels) {
+    if (ch.active and !ch.paused and ch.soundIndex == sound) return true;
+  }
+  return false;
+}
+
+bool sound_ispaused(int sound) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (const SoundChannel &ch : sound_channels) {
+    if (ch.active and ch.paused and ch.soundIndex == sound) return true;
+  }
+  return false;
+}
+
+int sound_add(string fname, int kind, bool preload) {  // preload makes no difference here
+  if (kind != 1) return audio_add(fname);
+  // Background music stays encoded and streams, as music resources do
+  size_t flen = 0;
+  std::unique_ptr<char[]> fdata(enigma::read_all_bytes(fname, flen));
+  if (!fdata) {
+    DEBUG_MESSAGE("The sound file \"" + fname + "\" failed to open", MESSAGE_TYPE::M_ERROR);
+    return -1;
+  }
+  const int sound = enigma::sound_allocate();
+  if (enigma::sound_add_from_buffer_streamed(sound, fdata.get(), flen)) return -1;
+  return sound;
+}
+
+bool sound_replace(int sound, string fname, int kind, bool preload) {
+  size_t flen = 0;
+  std::unique_ptr<char[]> fdata(enigma::read_all_bytes(fname, flen));
+  Sound snd;
+  if (!fdata or !decode_sound(reinterpret_cast<unsigned char*>(fdata.get()), flen, snd)) {
+    DEBUG_MESSAGE("Could not replace sound " + std::to_string(sound) + " with \"" + fname + "\"", MESSAGE_TYPE::M_USER_ERROR);
+    return false;
+  }
+  snd.loaded = true;
+
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.assign(sound, std::move(snd));
+  return true;
+}
+
+const char* sound_get_audio_error() { return ""; }
+
+void sound_pan(int sound, float value) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.get(sound).pan = value;
+}
+
+void sound_pitch(int sound, float value) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.get(sound).pitch = value;
+}
+
+void sound_volume(int sound, float value) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.get(sound).volume = value;
+}
+
+void sound_global_volume(float mastervolume) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  master_gain = mastervolume;
+}
+
+void sound_3d_set_sound_cone(int snd, float x, float y, float z, double anglein, double angleout, long voloutside) {}
+
+void sound_3d_set_sound_distance(int snd, float mindist, float maxdist) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  Sound &sound = sounds.get(snd);
+  sound.positional = true;
+  sound.falloff[0] = mindist;
+  sound.falloff[1] = maxdist;
+}
+
+void sound_3d_set_sound_position(int snd, float x, float y, float z) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  Sound &sound = sounds.get(snd);
+  sound.positional = true;
+  sound.pos[0] = x;
+  sound.pos[1] = y;
+  sound.pos[2] = z;
+}
+
+void sound_3d_set_sound_velocity(int snd, float x, float y, float z) {}
+
+void sound_effect_chorus(int snd, float wetdry, float depth, float feedback, float frequency, long wave, float delay,
+                         long phase) {}
+
+void sound_effect_compressor(int snd, float gain, float attack, float release, float threshold, float ratio,
+                             float delay) {}
+
+void sound_effect_echo(int snd, float wetdry, float feedback, float leftdelay, float rightdelay, long pandelay) {}
+
+void sound_effect_equalizer(int snd, float center, float bandwidth, float gain) {}
+
+void sound_effect_flanger(int snd, float wetdry, float depth, float feedback, float frequency, long wave, float delay,
+                          long phase) {}
+
+void sound_effect_gargle(int snd, unsigned rate, unsigned wave) {}
+
+void sound_effect_reverb(int snd, float gain, float mix, float time, float ratio) {}
+
+void sound_effect_set(int snd, int effect) {}
+
+}  // namespace enigma_user
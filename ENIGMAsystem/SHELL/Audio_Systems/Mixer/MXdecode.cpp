@@ -0,0 +1,266 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "MXdecode.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#ifdef ENIGMA_MIXER_VORBIS
+#include <vorbis/vorbisfile.h>
+#endif
+
+namespace enigma {
+namespace mixer {
+
+namespace {
+
+uint32_t read_u32(const unsigned char *p) { return p[0] | p[1] << 8 | p[2] << 16 | uint32_t(p[3]) << 24; }
+uint16_t read_u16(const unsigned char *p) { return p[0] | p[1] << 8; }
+
+float read_sample(const unsigned char *p, unsigned bits, bool is_float) {
+  switch (bits) {
+    case 8:  return (p[0] - 128) / 128.0f;
+    case 16: return int16_t(read_u16(p)) / 32768.0f;
+    case 24: return (int32_t(uint32_t(p[0]) << 8 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 24) >> 8) / 8388608.0f;
+    case 32:
+      if (is_float) {
+        const uint32_t v = read_u32(p);
+        float f;
+        memcpy(&f, &v, sizeof(f));
+        return f;
+      }
+      return int32_t(read_u32(p)) / 2147483648.0f;
+  }
+  return 0;
+}
+
+struct WavFormat {
+  unsigned channels, rate, bits;
+  bool is_float;
+  const unsigned char *pcm;
+  size_t frames;
+};
+
+bool parse_wav(const unsigned char *data, size_t size, WavFormat &wav) {
+  if (size < 12 or memcmp(data, "RIFF", 4) or memcmp(data + 8, "WAVE", 4)) return false;
+
+  unsigned format = 0, channels = 0, rate = 0, bits = 0;
+  const unsigned char *pcm = nullptr;
+  size_t pcm_size = 0;
+  for (size_t at = 12; at + 8 <= size;) {
+    const unsigned char *chunk = data + at + 8;
+    const size_t chunk_size = std::min<size_t>(read_u32(data + at + 4), size - at - 8);
+    if (!memcmp(data + at, "fmt ", 4) and chunk_size >= 16) {
+      format = read_u16(chunk);
+      channels = read_u16(chunk + 2);
+      rate = read_u32(chunk + 4);
+      bits = read_u16(chunk + 14);
+      // WAVE_FORMAT_EXTENSIBLE keeps the real format in its subformat GUID
+      if (format == 0xFFFE and chunk_size >= 26) format = read_u16(chunk + 24);
+    } else if (!memcmp(data + at, "data", 4)) {
+      pcm = chunk;
+      pcm_size = chunk_size;
+    }
+    at += 8 + chunk_size + (chunk_size & 1);
+  }
+
+  const bool is_float = format == 3;
+  if (!pcm or !channels or !rate or (format != 1 and !is_float)) return false;
+  if (is_float ? bits != 32 : (bits != 8 and bits != 16 and bits != 24 and bits != 32)) return false;
+
+  wav.channels = channels;
+  wav.rate = rate;
+  wav.bits = bits;
+  wav.is_float = is_float;
+  wav.pcm = pcm;
+  wav.frames = pcm_size / (channels * (bits / 8));
+  return true;
+}
+
+// Converts `count` frames starting at `frame`, dropping channels past the second.
+void convert_wav(const WavFormat &wav, size_t frame, size_t count, float *out) {
+  const unsigned stride = wav.channels * (wav.bits / 8), channels = wav.channels > 1 ? 2 : 1;
+  const unsigned char *in = wav.pcm + frame * stride;
+  for (size_t i = 0; i < count; ++i, in += stride) {
+    for (unsigned c = 0; c < channels; ++c) *out++ = read_sample(in + c * (wav.bits / 8), wav.bits, wav.is_float);
+  }
+}
+
+bool decode_wav(const unsigned char *data, size_t size, Sound &sound) {
+  WavFormat wav;
+  if (!parse_wav(data, size, wav)) return false;
+  sound.channels = wav.channels > 1 ? 2 : 1;
+  sound.rate = wav.rate;
+  sound.frames = wav.frames;
+  sound.samples.resize(sound.frames * sound.channels);
+  convert_wav(wav, 0, wav.frames, sound.samples.data());
+  return true;
+}
+
+class WavStream : public StreamDecoder {
+ public:
+  explicit WavStream(EncodedData data): data_(std::move(data)) {}
+
+  bool open() {
+    if (!parse_wav(data_->data(), data_->size(), wav_)) return false;
+    channels = wav_.channels > 1 ? 2 : 1;
+    rate = wav_.rate;
+    frames = wav_.frames;
+    return true;
+  }
+
+  size_t read(float *out, size_t count) override {
+    count = std::min(count, frames - position_);
+    convert_wav(wav_, position_, count, out);
+    position_ += count;
+    return count;
+  }
+
+  void seek(size_t frame) override { position_ = std::min(frame, frames); }
+  size_t memory() const override { return sizeof(*this); }
+
+ private:
+  EncodedData data_;
+  WavFormat wav_;
+  size_t position_ = 0;
+};
+
+#ifdef ENIGMA_MIXER_VORBIS
+struct MemoryFile {
+  const unsigned char *data;
+  size_t size, position;
+};
+
+size_t memory_read(void *ptr, size_t size, size_t count, void *source) {
+  MemoryFile *file = static_cast<MemoryFile*>(source);
+  const size_t bytes = std::min(size * count, file->size - file->position);
+  memcpy(ptr, file->data + file->position, bytes);
+  file->position += bytes;
+  return size ? bytes / size : 0;
+}
+
+int memory_seek(void *source, ogg_int64_t offset, int whence) {
+  MemoryFile *file = static_cast<MemoryFile*>(source);
+  const ogg_int64_t base = whence == SEEK_CUR ? file->position : whence == SEEK_END ? file->size : 0;
+  if (base + offset < 0 or size_t(base + offset) > file->size) return -1;
+  file->position = base + offset;
+  return 0;
+}
+
+long memory_tell(void *source) { return static_cast<MemoryFile*>(source)->position; }
+
+bool decode_vorbis(const unsigned char *data, size_t size, Sound &sound) {
+  if (size < 4 or memcmp(data, "OggS", 4)) return false;
+
+  MemoryFile file = {data, size, 0};
+  const ov_callbacks callbacks = {memory_read, memory_seek, nullptr, memory_tell};
+  OggVorbis_File vf;
+  if (ov_open_callbacks(&file, &vf, nullptr, 0, callbacks)) return false;
+
+  const vorbis_info *info = ov_info(&vf, -1);
+  sound.channels = info->channels > 1 ? 2 : 1;
+  sound.rate = info->rate;
+  sound.samples.clear();
+  const ogg_int64_t total = ov_pcm_total(&vf, -1);
+  if (total > 0) sound.samples.reserve(size_t(total) * sound.channels);
+
+  float **pcm;
+  int section;
+  long frames;
+  while ((frames = ov_read_float(&vf, &pcm, 4096, &section)) > 0) {
+    for (long i = 0; i < frames; ++i) {
+      for (unsigned c = 0; c < sound.channels; ++c) sound.samples.push_back(pcm[c][i]);
+    }
+  }
+  ov_clear(&vf);
+
+  sound.frames = sound.samples.size() / sound.channels;
+  return frames == 0;
+}
+
+class VorbisStream : public StreamDecoder {
+ public:
+  explicit VorbisStream(EncodedData data): data_(std::move(data)) {}
+  ~VorbisStream() { if (open_) ov_clear(&vf_); }
+
+  bool open() {
+    file_ = {data_->data(), data_->size(), 0};
+    const ov_callbacks callbacks = {memory_read, memory_seek, nullptr, memory_tell};
+    if (ov_open_callbacks(&file_, &vf_, nullptr, 0, callbacks)) return false;
+    open_ = true;
+    const vorbis_info *info = ov_info(&vf_, -1);
+    channels = info->channels > 1 ? 2 : 1;
+    rate = info->rate;
+    const ogg_int64_t total = ov_pcm_total(&vf_, -1);
+    frames = total > 0 ? total : 0;
+    return true;
+  }
+
+  size_t read(float *out, size_t count) override {
+    size_t done = 0;
+    float **pcm;
+    int section;
+    while (done < count) {
+      const long n = ov_read_float(&vf_, &pcm, count - done, &section);
+      if (n == OV_HOLE) continue;  // A gap in the data; carry on after it
+      if (n <= 0) break;
+      for (long i = 0; i < n; ++i) {
+        for (unsigned c = 0; c < channels; ++c) *out++ = pcm[c][i];
+      }
+      done += n;
+    }
+    return done;
+  }
+
+  void seek(size_t frame) override { ov_pcm_seek(&vf_, frame); }
+  size_t memory() const override { return sizeof(*this); }
+
+ private:
+  EncodedData data_;
+  MemoryFile file_;
+  OggVorbis_File vf_;
+  bool open_ = false;
+};
+#endif
+
+}  // namespace
+
+bool decode_sound(const unsigned char *data, size_t size, Sound &sound) {
+  if (decode_wav(data, size, sound)) return true;
+#ifdef ENIGMA_MIXER_VORBIS
+  if (decode_vorbis(data, size, sound)) return true;
+#endif
+  return false;
+}
+
+std::shared_ptr<StreamDecoder> open_stream(EncodedData data) {
+  if (!data) return nullptr;
+#ifdef ENIGMA_MIXER_VORBIS
+  if (data->size() >= 4 and !memcmp(data->data(), "OggS", 4)) {
+    std::shared_ptr<VorbisStream> vorbis = std::make_shared<VorbisStream>(std::move(data));
+    if (vorbis->open()) return vorbis;
+    return nullptr;
+  }
+#endif
+  std::shared_ptr<WavStream> wav = std::make_shared<WavStream>(std::move(data));
+  if (wav->open()) return wav;
+  return nullptr;
+}
+
+}  // namespace mixer
+}  // namespace enigma
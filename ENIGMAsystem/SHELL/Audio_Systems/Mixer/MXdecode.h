@@ -0,0 +1,61 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_MX_DECODE_H
+#define ENIGMA_MX_DECODE_H
+
+#include "SoundResource.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace enigma {
+namespace mixer {
+
+// Decodes a whole sound file into float PCM. Recognizes RIFF WAVE (integer
+// PCM of 8 to 32 bits, or 32-bit float) and, when built with libvorbisfile,
+// Ogg Vorbis. Channels past the second are dropped. Returns false if the
+// data is not in a supported format.
+bool decode_sound(const unsigned char *data, size_t size, Sound &sound);
+
+// Decodes a sound file incrementally, for music and other long sounds that
+// would take too much memory as PCM.
+class StreamDecoder {
+ public:
+  virtual ~StreamDecoder() {}
+
+  unsigned channels = 0;  // 1 or 2
+  unsigned rate = 0;
+  size_t frames = 0;      // Total length
+
+  // Decodes up to `count` frames of interleaved PCM into `out`. Returns the
+  // number decoded, which is 0 only at the end of the sound.
+  virtual size_t read(float *out, size_t count) = 0;
+  virtual void seek(size_t frame) = 0;
+  // Bytes held by the decoder, not counting the encoded file it shares
+  virtual size_t memory() const = 0;
+};
+
+// Opens a decoder over `data`, which it shares with any other decoders open
+// on the same file. Accepts the same formats as decode_sound. Returns NULL if
+// the data is not supported.
+std::shared_ptr<StreamDecoder> open_stream(EncodedData data);
+
+}  // namespace mixer
+}  // namespace enigma
+
+#endif
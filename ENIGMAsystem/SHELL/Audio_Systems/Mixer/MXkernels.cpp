@@ -0,0 +1,99 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "MXkernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENIGMA_MIXER_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace enigma {
+namespace mixer {
+
+void mix_mono(float *out, const float *in, size_t frames, float left, float right, float dleft, float dright) {
+  size_t i = 0;
+#ifdef ENIGMA_MIXER_SSE
+  // Gains for frames i and i + 1, as (L, R, L, R), and for frames i + 2 and i + 3
+  __m128 g01 = _mm_setr_ps(left, right, left + dleft, right + dright);
+  __m128 g23 = _mm_add_ps(g01, _mm_setr_ps(2 * dleft, 2 * dright, 2 * dleft, 2 * dright));
+  const __m128 dg = _mm_setr_ps(4 * dleft, 4 * dright, 4 * dleft, 4 * dright);
+  for (; i + 4 <= frames; i += 4) {
+    const __m128 s = _mm_loadu_ps(in + i);
+    const __m128 s01 = _mm_unpacklo_ps(s, s), s23 = _mm_unpackhi_ps(s, s);
+    _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(s01, g01)));
+    _mm_storeu_ps(out + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 4), _mm_mul_ps(s23, g23)));
+    g01 = _mm_add_ps(g01, dg);
+    g23 = _mm_add_ps(g23, dg);
+  }
+#endif
+  for (; i < frames; ++i) {
+    out[2 * i] += in[i] * (left + dleft * i);
+    out[2 * i + 1] += in[i] * (right + dright * i);
+  }
+}
+
+void mix_stereo(float *out, const float *in, size_t frames, float left, float right, float dleft, float dright) {
+  size_t i = 0;
+#ifdef ENIGMA_MIXER_SSE
+  __m128 g = _mm_setr_ps(left, right, left + dleft, right + dright);
+  const __m128 dg = _mm_setr_ps(2 * dleft, 2 * dright, 2 * dleft, 2 * dright);
+  for (; i + 2 <= frames; i += 2) {
+    _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(_mm_loadu_ps(in + 2 * i), g)));
+    g = _mm_add_ps(g, dg);
+  }
+#endif
+  for (; i < frames; ++i) {
+    out[2 * i] += in[2 * i] * (left + dleft * i);
+    out[2 * i + 1] += in[2 * i + 1] * (right + dright * i);
+  }
+}
+
+size_t resample(float *out, size_t frames, const float *in, size_t in_frames, unsigned channels,
+                double &position, double step, const float *next) {
+  size_t i = 0;
+  for (; i < frames and position < in_frames; ++i, position += step) {
+    const size_t at = size_t(position);
+    const float t = float(position - at);
+    const float *a = in + at * channels;
+    const float *b = at + 1 < in_frames ? a + channels : next ? next : a;
+    for (unsigned c = 0; c < channels; ++c) out[i * channels + c] = a[c] + (b[c] - a[c]) * t;
+  }
+  return i;
+}
+
+void to_s16(int16_t *out, const float *in, size_t samples) {
+  size_t i = 0;
+#ifdef ENIGMA_MIXER_SSE
+  const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+  for (; i + 8 <= samples; i += 8) {
+    const __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi), scale);
+    const __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi), scale);
+    _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+  }
+#endif
+  for (; i < samples; ++i) out[i] = int16_t(std::lrint(std::min(std::max(in[i], -1.0f), 1.0f) * 32767.0f));
+}
+
+void from_s16(float *out, const int16_t *in, size_t samples) {
+  for (size_t i = 0; i < samples; ++i) out[i] = in[i] * (1.0f / 32768.0f);
+}
+
+}  // namespace mixer
+}  // namespace enigma
@@ -0,0 +1,52 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_MX_KERNELS_H
+#define ENIGMA_MX_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Inner loops of the mixer. Each has an SSE path and a portable one; the
+// portable loops are written so compilers can vectorize them elsewhere.
+
+namespace enigma {
+namespace mixer {
+
+// Adds mono `in` to interleaved stereo `out`. The left and right gains start
+// at (left, right) and change by (dleft, dright) every frame.
+void mix_mono(float *out, const float *in, size_t frames, float left, float right, float dleft, float dright);
+
+// Adds interleaved stereo `in` to `out`, with gains as for mix_mono.
+void mix_stereo(float *out, const float *in, size_t frames, float left, float right, float dleft, float dright);
+
+// Fills `out` with up to `frames` frames of `in` read from `position` in
+// steps of `step`, interpolating linearly. Stops at the end of `in`; `next`
+// is the frame that follows it (the first frame when looping, else NULL).
+// Returns the number of frames written and advances `position`.
+size_t resample(float *out, size_t frames, const float *in, size_t in_frames, unsigned channels,
+                double &position, double step, const float *next);
+
+// Converts samples to signed 16-bit, clamping to [-1, 1].
+void to_s16(int16_t *out, const float *in, size_t samples);
+
+// Converts signed 16-bit samples to float.
+void from_s16(float *out, const int16_t *in, size_t samples);
+
+}  // namespace mixer
+}  // namespace enigma
+
+#endif
@@ -0,0 +1,107 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "MXoffline.h"
+#include "MXkernels.h"
+#include "MXsystem.h"
+
+#include "Platforms/General/fileio.h"
+#include "Widget_Systems/widgets_mandatory.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+FILE_t *wav_file = nullptr;
+unsigned wav_rate = 0;
+uint32_t wav_frames = 0;
+
+void put_u32(unsigned char *p, uint32_t v) {
+  p[0] = v, p[1] = v >> 8, p[2] = v >> 16, p[3] = v >> 24;
+}
+void put_u16(unsigned char *p, uint16_t v) {
+  p[0] = v, p[1] = v >> 8;
+}
+
+void write_wav_header() {
+  unsigned char header[44] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+                              'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0};
+  const uint32_t data_size = wav_frames * 4;
+  put_u32(header + 4, 36 + data_size);
+  put_u32(header + 24, wav_rate);
+  put_u32(header + 28, wav_rate * 4);
+  put_u16(header + 32, 4);
+  put_u16(header + 34, 16);
+  memcpy(header + 36, "data", 4);
+  put_u32(header + 40, data_size);
+  fseek_wrapper(wav_file, 0, SEEK_SET);
+  fwrite_wrapper(header, sizeof(header), 1, wav_file);
+  fseek_wrapper(wav_file, 0, SEEK_END);
+}
+
+}  // namespace
+
+namespace enigma_user {
+
+bool audio_render_begin(std::string fname, int sample_rate) {
+  if (wav_file) audio_render_end();
+  if (sample_rate <= 0) {
+    DEBUG_MESSAGE("Offline audio sample rate must be positive", MESSAGE_TYPE::M_USER_ERROR);
+    return false;
+  }
+  if (!(wav_file = fopen_wrapper(fname.c_str(), "wb"))) {
+    DEBUG_MESSAGE("Could not open \"" + fname + "\" to render audio", MESSAGE_TYPE::M_ERROR);
+    return false;
+  }
+  wav_rate = sample_rate;
+  wav_frames = 0;
+  write_wav_header();
+
+  std::lock_guard<std::mutex> guard(enigma::mixer::mixer_lock);
+  enigma::mixer::set_offline(true, wav_rate);
+  return true;
+}
+
+int audio_render_step(double seconds) {
+  if (!wav_file) return 0;
+  const size_t frames = seconds > 0 ? size_t(std::llround(seconds * wav_rate)) : 0;
+  std::vector<float> mixed(frames * 2);
+  std::vector<int16_t> pcm(frames * 2);
+  {
+    std::lock_guard<std::mutex> guard(enigma::mixer::mixer_lock);
+    enigma::mixer::render(mixed.data(), frames);
+  }
+  enigma::mixer::to_s16(pcm.data(), mixed.data(), pcm.size());
+  fwrite_wrapper(pcm.data(), sizeof(int16_t), pcm.size(), wav_file);
+  wav_frames += frames;
+  return frames;
+}
+
+bool audio_render_end() {
+  if (!wav_file) return false;
+  write_wav_header();
+  fclose_wrapper(wav_file);
+  wav_file = nullptr;
+
+  std::lock_guard<std::mutex> guard(enigma::mixer::mixer_lock);
+  enigma::mixer::set_offline(false, 0);
+  return true;
+}
+
+}  // namespace enigma_user
@@ -0,0 +1,35 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_MX_OFFLINE_H
+#define ENIGMA_MX_OFFLINE_H
+
+#include <string>
+
+namespace enigma_user {
+
+// Sends mixer output to a 16-bit stereo WAV file instead of the audio device.
+// Until audio_render_end, sound only advances when audio_render_step is
+// called, so the file comes out the same on every run and every machine.
+bool audio_render_begin(std::string fname, int sample_rate = 44100);
+// Mixes the next `seconds` of audio into the file; returns the frames written.
+int audio_render_step(double seconds);
+// Finishes the file and returns output to the audio device.
+bool audio_render_end();
+
+}  // namespace enigma_user
+
+#endif
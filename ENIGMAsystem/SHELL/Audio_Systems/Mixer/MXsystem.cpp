@@ -0,0 +1,428 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "MXsystem.h"
+#include "MXdecode.h"
+#include "MXkernels.h"
+#include "SoundEmitter.h"
+#include "../General/ASadvanced.h"
+
+#include "Widget_Systems/widgets_mandatory.h"
+
+#ifdef ENIGMA_MIXER_SDL
+#include <SDL.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+AssetArray<Sound> sounds;
+vector<SoundChannel> sound_channels;
+vector<SoundEmitter*> sound_emitters;
+
+namespace enigma {
+namespace mixer {
+
+std::mutex mixer_lock;
+unsigned output_rate = 44100;
+float master_gain = 1.0f;
+size_t channel_num = 128;
+int falloff_model = enigma_user::audio_falloff_inverse_distance_clamped;
+float listener_pos[3] = {0.0f, 0.0f, 0.0f};
+float listener_vel[3] = {0.0f, 0.0f, 0.0f};
+// GameMaker's default: y grows down the screen, so up is -y and +x is right
+float listener_ori[6] = {0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 0.0f};
+
+namespace {
+
+const size_t kBlockFrames = 256;  // Gains and 3D positions are updated per block
+const size_t kStreamFrames = 4096;
+
+vector<int> free_channels;    // Idle channels, reused most recent first
+vector<int> active_channels;  // Playing or paused channels, in no order
+vector<float> scratch(kBlockFrames * 2);
+bool offline = false;
+unsigned device_rate = 44100;
+
+#ifdef ENIGMA_MIXER_SDL
+SDL_AudioDeviceID device = 0;
+
+void device_callback(void*, Uint8 *stream, int len) {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  // While rendering offline, the game decides when time passes
+  if (offline) memset(stream, 0, len);
+  else render(reinterpret_cast<float*>(stream), len / (2 * sizeof(float)));
+}
+#endif
+
+// Same models as OpenAL, so games sound alike on either system.
+float falloff_gain(float distance, float ref, float max, float factor) {
+  using namespace enigma_user;
+  switch (falloff_model) {
+    case audio_falloff_inverse_distance_clamped:
+      distance = std::min(std::max(distance, ref), max);
+      // fallthrough
+    case audio_falloff_inverse_distance:
+      if (ref + factor * (distance - ref) <= 0) return 1;
+      return ref / (ref + factor * (distance - ref));
+    case audio_falloff_linear_distance_clamped:
+      distance = std::min(std::max(distance, ref), max);
+      // fallthrough
+    case audio_falloff_linear_distance:
+      if (max <= ref) return 1;
+      return std::min(std::max(1 - factor * (distance - ref) / (max - ref), 0.0f), 1.0f);
+    case audio_falloff_exponent_distance_clamped:
+      distance = std::min(std::max(distance, ref), max);
+      // fallthrough
+    case audio_falloff_exponent_distance:
+      if (distance <= 0 or ref <= 0) return 1;
+      return std::pow(distance / ref, -factor);
+    default:
+      return 1;
+  }
+}
+
+// Works out where a channel's gains and pitch should be by the end of a block.
+void channel_targets(SoundChannel &ch, const Sound &snd, size_t frames, float &left, float &right, float &pitch) {
+  if (ch.gain_frames) {
+    const size_t n = std::min(ch.gain_frames, frames);
+    ch.gain += (ch.gain_target - ch.gain) * n / ch.gain_frames;
+    ch.gain_frames -= n;
+  }
+
+  float gain = snd.volume * ch.gain * master_gain;
+  float pan = snd.pan;
+  pitch = snd.pitch * ch.pitch;
+
+  if (ch.positional or snd.positional) {
+    const float *pos = ch.positional ? ch.pos : snd.pos, *falloff = ch.positional ? ch.falloff : snd.falloff;
+    if (ch.emitter >= 0 and size_t(ch.emitter) < sound_emitters.size() and sound_emitters[ch.emitter]) {
+      const SoundEmitter *emit = sound_emitters[ch.emitter];
+      pos = emit->emitPos;
+      falloff = emit->falloff;
+      gain *= emit->volume;
+      pitch *= emit->pitch;
+    }
+    const float rel[3] = {pos[0] - listener_pos[0], pos[1] - listener_pos[1], pos[2] - listener_pos[2]};
+    const float distance = std::sqrt(rel[0] * rel[0] + rel[1] * rel[1] + rel[2] * rel[2]);
+    gain *= falloff_gain(distance, falloff[0], falloff[1], falloff[2]);
+
+    // The listener's right is look-at cross up
+    const float *at = listener_ori, *up = listener_ori + 3;
+    const float side[3] = {at[1] * up[2] - at[2] * up[1], at[2] * up[0] - at[0] * up[2], at[0] * up[1] - at[1] * up[0]};
+    const float side_len = std::sqrt(side[0] * side[0] + side[1] * side[1] + side[2] * side[2]);
+    pan = distance > 1e-6f and side_len > 1e-6f
+        ? (rel[0] * side[0] + rel[1] * side[1] + rel[2] * side[2]) / (distance * side_len) : 0;
+  }
+
+  pan = std::min(std::max(pan, -1.0f), 1.0f);
+  if (snd.channels == 1) {
+    // Constant power, so mono sounds don't get louder in the middle
+    const float angle = (pan + 1) * float(M_PI / 4);
+    left = gain * std::cos(angle);
+    right = gain * std::sin(angle);
+  } else {
+    left = gain * std::min(1.0f, 1 - pan);
+    right = gain * std::min(1.0f, 1 + pan);
+  }
+}
+
+// Decodes the block after a channel's current one. Returns false at the end of the stream.
+bool refill_stream(SoundChannel &ch, const Sound &snd) {
+  ch.block_start += ch.block_frames;
+  if (ch.decoder) {
+    ch.block.resize(kStreamFrames * snd.channels);
+    ch.block_frames = ch.decoder->read(ch.block.data(), kStreamFrames);
+    return ch.block_frames;
+  }
+  int16_t pcm[kStreamFrames * 2];
+  const size_t frames = snd.stream(snd.userdata, pcm, sizeof(pcm)) / (2 * sizeof(int16_t));
+  ch.block.resize(frames * 2);
+  from_s16(ch.block.data(), pcm, frames * 2);
+  ch.block_frames = frames;
+  return frames;
+}
+
+// Mixes one block of a channel into `out`. Returns false once it has finished.
+bool mix_channel(SoundChannel &ch, float *out, size_t frames) {
+  Sound &snd = sounds[ch.soundIndex];
+  float left, right, pitch;
+  channel_targets(ch, snd, frames, left, right, pitch);
+  if (!ch.started) {
+    ch.last_left = left;
+    ch.last_right = right;
+    ch.started = true;
+  }
+  const float dleft = (left - ch.last_left) / frames, dright = (right - ch.last_right) / frames;
+  const double step = std::max(double(pitch), 1e-3) * snd.rate / output_rate;
+  const bool streamed = snd.streaming();
+
+  for (size_t done = 0; done < frames;) {
+    // Streamed sounds play out of the channel's own block
+    const float *samples = streamed ? ch.block.data() : snd.samples.data();
+    const size_t count = streamed ? ch.block_frames : snd.frames;
+    if (ch.position >= count) {
+      if (streamed) {
+        ch.position -= count;
+        if (!refill_stream(ch, snd)) {
+          if (!ch.loop or !seek_stream(ch, 0)) return false;
+          ch.position = 0;
+          if (!refill_stream(ch, snd)) return false;
+        }
+      } else if (ch.loop and snd.frames) {
+        ch.position = std::fmod(ch.position, double(snd.frames));
+      } else {
+        return false;
+      }
+      continue;
+    }
+
+    const float *src;
+    size_t n;
+    if (step == 1.0 and ch.position == std::floor(ch.position)) {
+      // Playing at the output rate; mix straight out of the sound
+      const size_t at = size_t(ch.position);
+      n = std::min(frames - done, count - at);
+      src = samples + at * snd.channels;
+      ch.position += n;
+    } else {
+      const float *next = ch.loop and !streamed ? samples : nullptr;
+      n = resample(scratch.data(), frames - done, samples, count, snd.channels, ch.position, step, next);
+      src = scratch.data();
+    }
+
+    (snd.channels == 1 ? mix_mono : mix_stereo)(out + 2 * done, src, n, ch.last_left + dleft * done,
+                                                ch.last_right + dright * done, dleft, dright);
+    done += n;
+  }
+
+  ch.last_left = left;
+  ch.last_right = right;
+  return true;
+}
+
+}  // namespace
+
+int acquire_channel(double priority) {
+  if (active_channels.size() >= channel_num) {
+    int victim = -1;
+    for (int c : active_channels) {
+      if (sound_channels[c].priority < priority and (victim == -1 or sound_channels[c].priority < sound_channels[victim].priority))
+        victim = c;
+    }
+    if (victim == -1) return -1;
+    release_channel(victim);
+  }
+
+  int channel;
+  if (free_channels.empty()) {
+    channel = sound_channels.size();
+    sound_channels.emplace_back();
+  } else {
+    channel = free_channels.back();
+    free_channels.pop_back();
+  }
+
+  SoundChannel &ch = sound_channels[channel];
+  ch = SoundChannel();
+  ch.priority = priority;
+  ch.active = true;
+  ch.slot = active_channels.size();
+  active_channels.push_back(channel);
+  return channel;
+}
+
+void release_channel(int channel) {
+  SoundChannel &ch = sound_channels[channel];
+  if (!ch.active) return;
+  ch.active = false;
+  ch.decoder.reset();
+  const int last = active_channels.back();
+  active_channels[ch.slot] = last;
+  sound_channels[last].slot = ch.slot;
+  active_channels.pop_back();
+  free_channels.push_back(channel);
+}
+
+int start_channel(int sound, double priority, bool loop) {
+  if (!sounds.exists(sound)) return -1;
+  const int channel = acquire_channel(priority);
+  if (channel == -1) return -1;
+
+  SoundChannel &ch = sound_channels[channel];
+  ch.soundIndex = sound;
+  ch.loop = loop;
+  const Sound &snd = sounds[sound];
+  if (snd.encoded) {
+    ch.decoder = open_stream(snd.encoded);
+    if (!ch.decoder) {
+      release_channel(channel);
+      return -1;
+    }
+  } else if (snd.stream) {
+    // A callback has one read position, so only one channel can play from it
+    for (size_t i = 0; i < active_channels.size();) {
+      const int other = active_channels[i];
+      if (other != channel and sound_channels[other].soundIndex == sound) release_channel(other);
+      else ++i;
+    }
+    seek_stream(ch, 0);
+  }
+  return channel;
+}
+
+bool seek_stream(SoundChannel &ch, float position) {
+  const Sound &snd = sounds[ch.soundIndex];
+  const size_t frame = size_t(std::max(position, 0.0f) * snd.rate);
+  ch.block.clear();
+  ch.block_frames = 0;
+  if (ch.decoder) {
+    ch.decoder->seek(frame);
+  } else {
+    if (!snd.seek) return false;
+    snd.seek(snd.userdata, position);
+  }
+  ch.block_start = ch.decoder ? std::min(frame, snd.frames) : frame;
+  return true;
+}
+
+SoundChannel *get_channel(int handle) {
+  if (handle < AUDIO_CHANNEL_OFFSET) return nullptr;
+  const size_t channel = handle - AUDIO_CHANNEL_OFFSET;
+  if (channel >= sound_channels.size() or !sound_channels[channel].active) return nullptr;
+  return &sound_channels[channel];
+}
+
+void render(float *out, size_t frames) {
+  memset(out, 0, frames * 2 * sizeof(float));
+  for (size_t at = 0; at < frames; at += kBlockFrames) {
+    const size_t n = std::min(kBlockFrames, frames - at);
+    for (size_t i = 0; i < active_channels.size();) {
+      SoundChannel &ch = sound_channels[active_channels[i]];
+      if (ch.paused or mix_channel(ch, out + 2 * at, n)) ++i;
+      else release_channel(active_channels[i]);  // Moves the last channel into slot i
+    }
+  }
+}
+
+void set_offline(bool enable, unsigned rate) {
+  offline = enable;
+  output_rate = enable ? rate : device_rate;
+}
+
+}  // namespace mixer
+
+using namespace mixer;
+
+int audiosystem_initialize() {
+#ifdef ENIGMA_MIXER_SDL
+  if (SDL_InitSubSystem(SDL_INIT_AUDIO)) {
+    DEBUG_MESSAGE(std::string("Failed to initialize SDL audio: ") + SDL_GetError(), MESSAGE_TYPE::M_ERROR);
+    return 1;
+  }
+
+  SDL_AudioSpec want = {}, have;
+  want.freq = 44100;
+  want.format = AUDIO_F32SYS;
+  want.channels = 2;
+  want.samples = 1024;
+  want.callback = device_callback;
+  device = SDL_OpenAudioDevice(nullptr, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+  if (!device) {
+    DEBUG_MESSAGE(std::string("Failed to open audio device: ") + SDL_GetError(), MESSAGE_TYPE::M_ERROR);
+    return 1;
+  }
+  output_rate = device_rate = have.freq;
+  SDL_PauseAudioDevice(device, 0);
+#else
+  DEBUG_MESSAGE("Audio mixer was built without SDL; sound can only be rendered offline", MESSAGE_TYPE::M_WARNING);
+#endif
+  return 0;
+}
+
+void audiosystem_update(void) {}
+
+void audiosystem_cleanup() {
+#ifdef ENIGMA_MIXER_SDL
+  if (device) SDL_CloseAudioDevice(device);
+  device = 0;
+#endif
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  for (size_t i = 0; i < sounds.size(); ++i) {
+    if (sounds.exists(i)) sounds[i].destroy();
+  }
+  for (SoundEmitter *emit : sound_emitters) delete emit;
+  sound_emitters.clear();
+}
+
+int sound_add_from_buffer(int id, void *buffer, size_t bufsize) {
+  // Decode before locking, so playing sounds don't stall meanwhile
+  Sound snd;
+  if (!decode_sound(static_cast<const unsigned char*>(buffer), bufsize, snd)) {
+    DEBUG_MESSAGE("Could not decode sound " + std::to_string(id) + ": unsupported format", MESSAGE_TYPE::M_USER_ERROR);
+    return 1;
+  }
+  snd.loaded = true;
+
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.assign(id, std::move(snd));
+  return 0;
+}
+
+int sound_add_from_buffer_streamed(int id, void *buffer, size_t bufsize) {
+  const unsigned char *data = static_cast<const unsigned char*>(buffer);
+  Sound snd;
+  snd.encoded = std::make_shared<const std::vector<unsigned char> >(data, data + bufsize);
+  // Channels open their own decoders; this one just checks the file and reads its format
+  const std::shared_ptr<StreamDecoder> decoder = open_stream(snd.encoded);
+  if (!decoder) {
+    DEBUG_MESSAGE("Could not stream sound " + std::to_string(id) + ": unsupported format", MESSAGE_TYPE::M_USER_ERROR);
+    return 1;
+  }
+  snd.channels = decoder->channels;
+  snd.rate = decoder->rate;
+  snd.frames = decoder->frames;
+  snd.loaded = true;
+
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.assign(id, std::move(snd));
+  return 0;
+}
+
+int sound_add_from_stream(int id, size_t (*callback)(void *userdata, void *buffer, size_t size),
+                          void (*seek)(void *userdata, float position), void (*cleanup)(void *userdata),
+                          void *userdata) {
+  Sound snd;
+  snd.channels = 2;
+  snd.rate = 44100;
+  snd.stream = callback;
+  snd.seek = seek;
+  snd.cleanup = cleanup;
+  snd.userdata = userdata;
+  snd.loaded = true;
+
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  sounds.assign(id, std::move(snd));
+  return 0;
+}
+
+int sound_allocate() {
+  std::lock_guard<std::mutex> guard(mixer_lock);
+  return sounds.add(Sound());
+}
+
+}  // namespace enigma
@@ -0,0 +1,80 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_MX_SYSTEM_H
+#define ENIGMA_MX_SYSTEM_H
+
+#include "SoundChannel.h"
+#include "SoundResource.h"
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+
+namespace enigma {
+
+// Handles returned by audio_play_sound are channel indices plus this offset.
+const int AUDIO_CHANNEL_OFFSET = 200000;
+
+namespace mixer {
+
+// Guards every sound, channel and emitter against the output thread.
+extern std::mutex mixer_lock;
+
+extern unsigned output_rate;
+extern float master_gain;
+extern size_t channel_num;
+extern int falloff_model;
+extern float listener_pos[3];
+extern float listener_vel[3];
+extern float listener_ori[6];  // Look-at vector, then up vector
+
+// Takes a free channel, or the lowest-priority channel below `priority`.
+// Returns -1 if every channel is busy with something more important.
+int acquire_channel(double priority);
+void release_channel(int channel);
+
+// Starts `sound` on a fresh channel and returns the channel index, or -1.
+int start_channel(int sound, double priority, bool loop);
+
+// Discards the block a channel decoded from a streamed sound and moves its
+// decoder to `position` seconds. Returns false if the stream can't seek.
+bool seek_stream(SoundChannel &ch, float position);
+
+// Returns the channel behind a handle from audio_play_sound, or NULL.
+SoundChannel *get_channel(int handle);
+
+// Mixes every playing channel into `frames` frames of interleaved stereo.
+void render(float *out, size_t frames);
+
+// Switches output between the audio device and offline rendering.
+void set_offline(bool offline, unsigned rate);
+
+}  // namespace mixer
+
+int audiosystem_initialize();
+int sound_add_from_buffer(int id, void *buffer, size_t bufsize);
+int sound_add_from_buffer_streamed(int id, void *buffer, size_t bufsize);
+int sound_add_from_stream(int id, size_t (*callback)(void *userdata, void *buffer, size_t size),
+                          void (*seek)(void *userdata, float position), void (*cleanup)(void *userdata),
+                          void *userdata);
+int sound_allocate();
+void audiosystem_update(void);
+void audiosystem_cleanup();
+
+}  // namespace enigma
+
+#endif
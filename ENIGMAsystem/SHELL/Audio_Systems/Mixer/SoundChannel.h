@@ -0,0 +1,59 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_SOUND_CHANNEL_H
+#define ENIGMA_SOUND_CHANNEL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+using std::vector;
+
+namespace enigma { namespace mixer { class StreamDecoder; } }
+
+// A voice: one playing instance of a sound.
+struct SoundChannel {
+  int soundIndex = -1;
+  double priority = 0;
+  double position = 0;  // In frames of the sound, fractional when resampling
+  float gain = 1.0f;    // Instance gain, on top of the sound's volume
+  float gain_target = 1.0f;
+  size_t gain_frames = 0;  // Output frames left in a gain fade
+  float pitch = 1.0f;
+  bool active = false, paused = false, loop = false;
+
+  // A streamed sound is decoded a block at a time for each channel playing it,
+  // so that `position` is within `block`, and `block_start` frames precede it.
+  std::shared_ptr<enigma::mixer::StreamDecoder> decoder;  // NULL for callback streams
+  vector<float> block;
+  size_t block_frames = 0;
+  size_t block_start = 0;
+
+  // Positional voices are attenuated and panned relative to the listener
+  bool positional = false;
+  int emitter = -1;
+  float pos[3] = {0, 0, 0};
+  float falloff[3] = {100.0f, 300.0f, 1.0f};  // Reference distance, maximum distance, factor
+
+  // Gains applied at the end of the last block; the next block ramps from them
+  float last_left = 0, last_right = 0;
+  bool started = false;
+  size_t slot = 0;  // Index in active_channels
+};
+
+extern vector<SoundChannel> sound_channels;
+
+#endif
@@ -1,5 +1,4 @@
-/** Copyright (C) 2014 Harijs Grinbergs
-***
+/**
 *** This file is a part of the ENIGMA Development Environment.
 ***
 *** ENIGMA is free software: you can redistribute it and/or modify it under the
@@ -15,18 +14,20 @@
 *** with this code. If not, see <http://www.gnu.org/licenses/>
 **/
 
-#include "profiler.h"
-
-namespace enigma {
-
-GPUProfiler gpuprof;
+#ifndef ENIGMA_SOUND_EMITTER_H
+#define ENIGMA_SOUND_EMITTER_H
 
-} // namespace enigma
+#include <vector>
+using std::vector;
 
-namespace enigma_user {
+struct SoundEmitter {
+  float emitPos[3] = {0, 0, 0};
+  float emitVel[3] = {0, 0, 0};
+  float falloff[3] = {100.0f, 300.0f, 1.0f};
+  float pitch = 1.0f;
+  float volume = 1.0f;
+};
 
-int profiler_get_vertex_count() { return enigma::gpuprof.drawn_vertex_number; }
-int profiler_get_drawcall_count() { return enigma::gpuprof.drawn_drawcall_number; }
-int profiler_get_vbo_count() { return enigma::gpuprof.drawn_vbo_number; }
+extern vector<SoundEmitter*> sound_emitters;
 
-} // namespace enigma_user
+#endif
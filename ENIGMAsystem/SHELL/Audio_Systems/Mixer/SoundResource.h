@@ -0,0 +1,79 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_SOUND_RESOURCE_H
+#define ENIGMA_SOUND_RESOURCE_H
+
+#include "Universal_System/Resources/AssetArray.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using enigma::AssetArray;
+
+namespace enigma {
+namespace mixer {
+
+// A sound file kept encoded, shared by every channel streaming from it
+typedef std::shared_ptr<const std::vector<unsigned char> > EncodedData;
+
+}  // namespace mixer
+}  // namespace enigma
+
+struct Sound {
+  std::vector<float> samples;  // Interleaved PCM, `channels` samples per frame
+  unsigned channels = 0;       // 1 or 2
+  unsigned rate = 0;           // Frames per second
+  size_t frames = 0;           // Total length; unknown (0) for callback streams
+
+  // Streams pull 16-bit stereo at 44100 Hz from a callback instead
+  size_t (*stream)(void *userdata, void *buffer, size_t size) = nullptr;
+  void (*seek)(void *userdata, float position) = nullptr;
+  void (*cleanup)(void *userdata) = nullptr;
+  void *userdata = nullptr;
+
+  // Streamed sound files keep their encoded data; each channel playing one
+  // opens its own decoder over it and decodes a block at a time
+  enigma::mixer::EncodedData encoded;
+
+  float volume = 1.0f;
+  float pan = 0.0f;  // -1 is hard left, 1 hard right
+  float pitch = 1.0f;
+  bool loaded = false;
+
+  // Set by the sound_3d functions; applies to channels not placed by audio_play_sound_at/on
+  bool positional = false;
+  float pos[3] = {0, 0, 0};
+  float falloff[3] = {1.0f, 1e9f, 1.0f};
+
+  static const char* getAssetTypeName() { return "sound"; }
+
+  bool isDestroyed() const { return !loaded; }
+  bool streaming() const { return stream or encoded; }
+
+  void destroy() {
+    if (stream and cleanup) cleanup(userdata);
+    samples = std::vector<float>();
+    stream = nullptr;
+    encoded.reset();
+    loaded = false;
+  }
+};
+
+extern AssetArray<Sound> sounds;
+
+#endif
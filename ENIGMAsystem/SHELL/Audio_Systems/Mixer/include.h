@@ -0,0 +1,3 @@
+#include "../General/ASbasic.h"
+#include "../General/ASadvanced.h"
+#include "MXoffline.h"
@@ -35,7 +35,9 @@ using std::string;
 #endif
 
 #include "Universal_System/estring.h"
+#include "Widget_Systems/widgets_mandatory.h"
 
+#include <algorithm>
 #include <vector>
 using std::vector;
 #include <time.h>
@@ -110,10 +112,11 @@ int audio_play_sound(int sound, double priority, bool loop) {
     alSourcef(sound_channels[src]->source, AL_GAIN, snd->volume);
     sound_channels[src]->priority = priority;
     sound_channels[src]->soundIndex = sound;
+    if (snd->stream) alureRewindStream(snd->stream);
     snd->idle = !(snd->playing =
                       !snd->stream ? alurePlaySource(sound_channels[src]->source, enigma::eos_callback,
                                                      (void *)(ptrdiff_t)sound) != AL_FALSE
-                                   : alurePlaySourceStream(sound_channels[src]->source, snd->stream, 3, -1,
+                                   : alurePlaySourceStream(sound_channels[src]->source, snd->stream, 3, loop ? -1 : 0,
                                                            enigma::eos_callback, (void *)(ptrdiff_t)sound) != AL_FALSE);
     return src + 200000;
   } else {
@@ -136,10 +139,11 @@ int audio_play_sound_at(int sound, as_scalar x, as_scalar y, as_scalar z, as_sca
     alSourcef(sound_channels[src]->source, AL_GAIN, snd->volume);
     sound_channels[src]->priority = priority;
     sound_channels[src]->soundIndex = sound;
+    if (snd->stream) alureRewindStream(snd->stream);
     snd->idle = !(snd->playing =
                       !snd->stream ? alurePlaySource(sound_channels[src]->source, enigma::eos_callback,
                                                      (void *)(ptrdiff_t)sound) != AL_FALSE
-                                   : alurePlaySourceStream(sound_channels[src]->source, snd->stream, 3, -1,
+                                   : alurePlaySourceStream(sound_channels[src]->source, snd->stream, 3, loop ? -1 : 0,
                                                            enigma::eos_callback, (void *)(ptrdiff_t)sound) != AL_FALSE);
     return src + 200000;
   } else {
@@ -313,6 +317,27 @@ void audio_delete(int sound) {
 
 void audio_falloff_set_model(int model) { alDistanceModel(falloff_models[model]); }
 
+size_t audio_sound_get_memory_usage(int index) {
+  get_sound(snd, index, 0);
+  return snd ? snd->memory : 0;
+}
+
+void audio_debug_memory_usage() {
+  vector<std::pair<size_t, int> > usage;
+  size_t total = 0;
+  for (const auto &it : sound_resources) {
+    if (!it.second) continue;
+    usage.push_back({it.second->memory, it.first});
+    total += it.second->memory;
+  }
+  std::sort(usage.rbegin(), usage.rend());
+  for (const auto &u : usage) {
+    DEBUG_MESSAGE("Sound " + std::to_string(u.second) + (sound_resources[u.second]->stream ? " (streamed): " : ": ")
+                  + std::to_string(u.first) + " bytes", MESSAGE_TYPE::M_INFO);
+  }
+  DEBUG_MESSAGE("All sounds: " + std::to_string(total) + " bytes", MESSAGE_TYPE::M_INFO);
+}
+
 int audio_emitter_create() {
   int i = sound_emitters.size();
   sound_emitters.push_back(new SoundEmitter());
@@ -59,11 +59,12 @@ bool sound_play(int sound) {  // Returns whether sound is playing
   float sourcePosAL[] = {snd->pan, 0.0f, 0.0f};
   alSourcefv(sound_channels[src]->source, AL_POSITION, sourcePosAL);
   sound_channels[src]->soundIndex = sound;
+  if (snd->stream) alureRewindStream(snd->stream);
   return !(snd->idle =
                !(snd->playing =
                      !snd->stream ? alurePlaySource(sound_channels[src]->source, enigma::eos_callback,
                                                     (void*)(ptrdiff_t)sound) != AL_FALSE
-                                  : alurePlaySourceStream(sound_channels[src]->source, snd->stream, 3, -1,
+                                  : alurePlaySourceStream(sound_channels[src]->source, snd->stream, 3, 0,
                                                           enigma::eos_callback, (void*)(ptrdiff_t)sound) != AL_FALSE));
 }
 
@@ -82,6 +83,7 @@ bool sound_loop(int sound) {  // Returns whether sound is playing
   float sourcePosAL[] = {snd->pan, 0.0f, 0.0f};
   alSourcefv(sound_channels[src]->source, AL_POSITION, sourcePosAL);
   sound_channels[src]->soundIndex = sound;
+  if (snd->stream) alureRewindStream(snd->stream);
   return !(snd->idle =
                !(snd->playing =
                      !snd->stream ? alurePlaySource(sound_channels[src]->source, enigma::eos_callback,
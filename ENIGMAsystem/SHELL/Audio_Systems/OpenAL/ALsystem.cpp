@@ -51,6 +51,13 @@ list<ALuint> garbageBuffers;  // OpenAL buffers queued for deletion
 
 namespace {
 int next_sound_id = 0;  //ID of the next sound to allocate (GM does not actually re-use sound IDs).
+const ALsizei kStreamChunk = 16384;
+
+size_t buffer_memory(ALuint buf) {
+  ALint size = 0;
+  alGetBufferi(buf, AL_SIZE, &size);
+  return size;
+}
 }
 
 namespace enigma {
@@ -126,6 +133,26 @@ int sound_add_from_buffer(int id, void *buffer, size_t bufsize) {
     return 1;
   }
 
+  snd->memory = buffer_memory(buf);
+  snd->loaded = LOADSTATE_COMPLETE;
+  return 0;
+}
+
+int sound_add_from_buffer_streamed(int id, void *buffer, size_t bufsize) {
+  SoundResource *snd = new SoundResource();
+  sound_resources[id] = snd;
+  if (id >= next_sound_id) {
+    next_sound_id = id + 1;
+  }
+
+  // ALURE copies the encoded data and decodes kStreamChunk bytes at a time as it plays
+  snd->stream = alureCreateStreamFromMemory((const ALubyte *)buffer, bufsize, kStreamChunk, 0, NULL);
+  if (!snd->stream) {
+    DEBUG_MESSAGE(std::string("Could not stream sound ") + std::to_string(id) + " from memory buffer: " + alureGetErrorString(), MESSAGE_TYPE::M_USER_ERROR);
+    return 1;
+  }
+
+  snd->memory = bufsize + 3 * kStreamChunk;
   snd->loaded = LOADSTATE_COMPLETE;
   return 0;
 }
@@ -145,6 +172,7 @@ int sound_add_from_file(int id, string fname) {
     return 1;
   }
 
+  snd->memory = buffer_memory(buf);
   snd->loaded = LOADSTATE_COMPLETE;
   return 0;
 }
@@ -161,6 +189,7 @@ int sound_replace_from_file(int id, string fname) {
     return 1;
   }
 
+  snd->memory = buffer_memory(buf);
   snd->loaded = LOADSTATE_COMPLETE;
   return 0;
 }
@@ -183,6 +212,7 @@ int sound_add_from_stream(int id, size_t (*callback)(void *userdata, void *buffe
   snd->cleanup = cleanup;
   snd->userdata = userdata;
   snd->seek = seek;
+  snd->memory = 3 * 4096;
 
   snd->loaded = LOADSTATE_COMPLETE;
   return 0;
@@ -214,6 +244,9 @@ void audiosystem_update(void) {
       ++it;
     }
   }
+  // Streams are refilled here, on the main thread, rather than by ALURE's own
+  // update thread: eos_callback runs wherever alureUpdate does, and it touches
+  // sound_resources without a lock. Three chunks queued cover several frames.
   alureUpdate();
 }
 
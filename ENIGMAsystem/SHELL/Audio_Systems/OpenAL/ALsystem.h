@@ -79,6 +79,7 @@ void eos_callback(void *soundID, ALuint src);
 int audiosystem_initialize();
 SoundResource *sound_new_with_source();
 int sound_add_from_buffer(int id, void *buffer, size_t bufsize);
+int sound_add_from_buffer_streamed(int id, void *buffer, size_t bufsize);
 int sound_add_from_file(int id, std::string fname);
 int sound_replace_from_file(int id, std::string fname);
 int sound_add_from_stream(int id, size_t (*callback)(void *userdata, void *buffer, size_t size),
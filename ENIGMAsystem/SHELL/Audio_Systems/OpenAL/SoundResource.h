@@ -35,12 +35,13 @@ struct SoundResource {
   float volume;
   float pan;
   float pitch;
+  size_t memory;  // Bytes held for this sound, decoded or encoded
 
   load_state loaded;  // Degree to which this sound has been loaded successfully
   bool idle;          // True if this sound is not being used, false if playing or paused.
   bool playing;       // True if this sound is playing; not paused or idle.
 
-  SoundResource() : stream(0), cleanup(0), userdata(0), seek(0), kind(0), loaded(LOADSTATE_NONE), idle(1), playing(0) {
+  SoundResource() : stream(0), cleanup(0), userdata(0), seek(0), kind(0), memory(0), loaded(LOADSTATE_NONE), idle(1), playing(0) {
     buf[0] = 0;
     buf[1] = 0;
     buf[2] = 0;
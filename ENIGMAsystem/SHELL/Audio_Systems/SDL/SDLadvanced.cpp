@@ -6,11 +6,13 @@
 #include "Widget_Systems/widgets_mandatory.h"
 #include "../General/ASutil.h"
 #include <SDL_mixer.h>
+#include <algorithm>
 #include <string>
 #include <stdio.h>
 
 const int AUDIO_CHANNEL_OFFSET = 400000;
 const int AUDIO_CHANNEL_COUNT = 128;
+const int AUDIO_MUSIC_HANDLE = AUDIO_CHANNEL_OFFSET + AUDIO_CHANNEL_COUNT;  // The one music stream
 vector<SoundChannel *> sound_channels;
 
 namespace enigma_user {
@@ -39,6 +41,7 @@ int audio_add(string fname) {
 
 int audio_play_sound(int index, double priority, bool loop) {
   const Sound& snd = sounds.get(index);
+  if (snd.mm) return enigma::music_play(index, loop) ? AUDIO_MUSIC_HANDLE : -1;
   if (sound_channels.empty() || sound_channels.size() <= AUDIO_CHANNEL_COUNT - 1) {
     SoundChannel* sc = new SoundChannel();
     sc->mchunk = snd.mc;
@@ -68,11 +71,13 @@ int audio_play_sound(int index, double priority, bool loop) {
 }
   
 bool audio_is_playing(int index) {
+  if (index == AUDIO_MUSIC_HANDLE) return Mix_PlayingMusic();
   if (index >= AUDIO_CHANNEL_OFFSET) {
     return Mix_Playing(index - AUDIO_CHANNEL_OFFSET);
   }
   
   const Sound& snd = sounds.get(index);
+  if (snd.mm) return enigma::music_sound == index && Mix_PlayingMusic();
   for(size_t i = 0; i < sound_channels.size() ; i++) {
     if (sound_channels[i]->mchunk == snd.mc && Mix_Playing(i) == 1) { return true; }
   }
@@ -80,10 +85,12 @@ bool audio_is_playing(int index) {
 }
 
 bool audio_is_paused(int index) {
+  if (index == AUDIO_MUSIC_HANDLE) return Mix_PausedMusic();
   if (index >= AUDIO_CHANNEL_OFFSET) {
     return Mix_Paused(index - AUDIO_CHANNEL_OFFSET);
   }
   const Sound& snd = sounds.get(index);
+  if (snd.mm) return enigma::music_sound == index && Mix_PausedMusic();
   for(size_t i = 0; i < sound_channels.size() ; i++) {
     if (sound_channels[i]->mchunk == snd.mc && Mix_Paused(i) == 1) { return true; }
   }
@@ -91,7 +98,10 @@ bool audio_is_paused(int index) {
 }
 
 void audio_stop_sound(int index) {
-  if (index >= AUDIO_CHANNEL_OFFSET) {
+  if (index == AUDIO_MUSIC_HANDLE || (index < AUDIO_CHANNEL_OFFSET && sounds.get(index).mm)) {
+    if (index == AUDIO_MUSIC_HANDLE || enigma::music_sound == index) Mix_HaltMusic();
+  }
+  else if (index >= AUDIO_CHANNEL_OFFSET) {
     Mix_HaltChannel(index - AUDIO_CHANNEL_OFFSET);
   }
   else { 
@@ -105,7 +115,10 @@ void audio_stop_sound(int index) {
 }
 
 void audio_pause_sound(int index) {
-  if (index >= AUDIO_CHANNEL_OFFSET) {
+  if (index == AUDIO_MUSIC_HANDLE || (index < AUDIO_CHANNEL_OFFSET && sounds.get(index).mm)) {
+    if (index == AUDIO_MUSIC_HANDLE || enigma::music_sound == index) Mix_PauseMusic();
+  }
+  else if (index >= AUDIO_CHANNEL_OFFSET) {
     Mix_Pause(index - AUDIO_CHANNEL_OFFSET);
   }
   else { 
@@ -119,7 +132,10 @@ void audio_pause_sound(int index) {
 }
 
 void audio_resume_sound(int index) {
-  if (index >= AUDIO_CHANNEL_OFFSET) {
+  if (index == AUDIO_MUSIC_HANDLE || (index < AUDIO_CHANNEL_OFFSET && sounds.get(index).mm)) {
+    if (index == AUDIO_MUSIC_HANDLE || enigma::music_sound == index) Mix_ResumeMusic();
+  }
+  else if (index >= AUDIO_CHANNEL_OFFSET) {
     Mix_Resume(index - AUDIO_CHANNEL_OFFSET);
   }
   else { 
@@ -134,10 +150,31 @@ void audio_resume_sound(int index) {
 
 void audio_stop_all() {
   Mix_HaltChannel(-1);
+  Mix_HaltMusic();
 }
 
 void audio_pause_all() {
   Mix_Pause(-1);
+  Mix_PauseMusic();
+}
+
+size_t audio_sound_get_memory_usage(int index) {
+  return sounds.exists(index) ? sounds.get(index).memory() : 0;
+}
+
+void audio_debug_memory_usage() {
+  std::vector<std::pair<size_t, int> > usage;
+  size_t total = 0;
+  for (auto it : sounds) {
+    usage.push_back({it.second.memory(), it.first});
+    total += it.second.memory();
+  }
+  std::sort(usage.rbegin(), usage.rend());
+  for (const auto &u : usage) {
+    DEBUG_MESSAGE("Sound " + std::to_string(u.second) + (sounds.get(u.second).mm ? " (streamed): " : ": ")
+                  + std::to_string(u.first) + " bytes", MESSAGE_TYPE::M_INFO);
+  }
+  DEBUG_MESSAGE("All sounds: " + std::to_string(total) + " bytes", MESSAGE_TYPE::M_INFO);
 }
 
 }
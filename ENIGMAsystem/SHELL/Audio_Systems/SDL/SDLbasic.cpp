@@ -24,18 +24,24 @@ void sound_delete(int sound) {
 
 bool sound_play(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) return enigma::music_play(sound, false);
   if (Mix_PlayChannel(-1,snd.mc, 0) == -1) { return false; }
   return true;
 }
 
 bool sound_loop(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) return enigma::music_play(sound, true);
   if (Mix_PlayChannel(-1,snd.mc, -1) == -1) { return false; }
   return true;
 }
 
 void sound_stop(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) {
+    if (enigma::music_sound == sound) Mix_HaltMusic();
+    return;
+  }
   int channel_count = Mix_AllocateChannels(-1);
   for(int i = 0;i <= channel_count ; i++) {
     if (Mix_GetChunk(i) == snd.mc) {
@@ -46,10 +52,16 @@ void sound_stop(int sound) {
 
 void sound_stop_all() {
   Mix_HaltChannel(-1);
+  Mix_HaltMusic();
 }
 
 bool sound_pause(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) {
+    if (enigma::music_sound != sound || !Mix_PlayingMusic() || Mix_PausedMusic()) return false;
+    Mix_PauseMusic();
+    return true;
+  }
   int channel_count = Mix_AllocateChannels(-1);
   for(int i = 0;i <= channel_count ; i++) {
     if (Mix_GetChunk(i) == snd.mc && Mix_Playing(i) == 1) {
@@ -62,10 +74,16 @@ bool sound_pause(int sound) {
 
 void sound_pause_all() {
   Mix_Pause(-1);
+  Mix_PauseMusic();
 }
 
 bool sound_resume(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) {
+    if (enigma::music_sound != sound || !Mix_PausedMusic()) return false;
+    Mix_ResumeMusic();
+    return true;
+  }
   int channel_count = Mix_AllocateChannels(-1);
   for(int i = 0;i <= channel_count ; i++) {
     if (Mix_GetChunk(i) == snd.mc && Mix_Paused(i) == 1) {
@@ -78,10 +96,12 @@ bool sound_resume(int sound) {
 
 void sound_resume_all() {
   Mix_Resume(-1);
+  Mix_ResumeMusic();
 }
 
 bool sound_isplaying(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) return enigma::music_sound == sound && Mix_PlayingMusic() && !Mix_PausedMusic();
   int channel_count = Mix_AllocateChannels(-1);
   for(int i = 0;i <= channel_count ; i++) {
     if (Mix_GetChunk(i) == snd.mc && Mix_Playing(i) == 1) { return true; }
@@ -91,6 +111,7 @@ bool sound_isplaying(int sound) {
 
 bool sound_ispaused(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) return enigma::music_sound == sound && Mix_PausedMusic();
   int channel_count = Mix_AllocateChannels(-1);
   for(int i = 0;i <= channel_count ; i++) {
     if (Mix_GetChunk(i) == snd.mc && Mix_Paused(i) == 1) { return true; }
@@ -100,6 +121,7 @@ bool sound_ispaused(int sound) {
 
 void sound_pan(int sound, float value) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) return;  // The music stream can't be panned
   int channel_count = Mix_AllocateChannels(-1);
   for(int i = 0;i <= channel_count ; i++) {
     if (Mix_GetChunk(i) == snd.mc) {
@@ -109,6 +131,7 @@ void sound_pan(int sound, float value) {
 }
 float sound_get_volume(int sound) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) return (float)Mix_VolumeMusic(-1) / MIX_MAX_VOLUME;
   return (float)snd.mc->volume / MIX_MAX_VOLUME;
 }
 
@@ -119,6 +142,13 @@ float sound_get_length(int sound) {
   int freq = 0;
   Uint16 fmt = 0;
   int chans = 0;
+  if (snd.mm) {
+#if SDL_MIXER_VERSION_ATLEAST(2, 6, 0)
+    return Mix_MusicDuration(snd.mm) * 1000;
+#else
+    return 0;
+#endif
+  }
   if (!Mix_QuerySpec(&freq, &fmt, &chans)) { return 0; }
   points = (snd.mc->alen / ((fmt & 0xFF) / 8));
   frames = (points / chans);
@@ -127,11 +157,16 @@ float sound_get_length(int sound) {
 
 void sound_volume(int sound, float value) {
   const Sound& snd = sounds.get(sound);
+  if (snd.mm) {
+    Mix_VolumeMusic((int)(value * MIX_MAX_VOLUME));
+    return;
+  }
   Mix_VolumeChunk(snd.mc,(int)(value * MIX_MAX_VOLUME));
 }
 
 void sound_global_volume(float mastervolume) {
   Mix_Volume(-1, (int)(mastervolume * MIX_MAX_VOLUME));
+  Mix_VolumeMusic((int)(mastervolume * MIX_MAX_VOLUME));
 }
 
 void sound_3d_set_sound_position(int snd, float x, float y, float z) {
@@ -8,6 +8,8 @@
 
 AssetArray<Sound> sounds;
 namespace enigma {
+int music_sound = -1;
+
 int audiosystem_initialize() {
   SDL_Init(SDL_INIT_AUDIO);
   int flags = MIX_INIT_OGG|MIX_INIT_MOD|MIX_INIT_FLAC|MIX_INIT_MP3;
@@ -22,6 +24,7 @@ int audiosystem_initialize() {
 void audiosystem_update(void) {}
 
 void audiosystem_cleanup() {
+  Mix_HaltMusic();
   Mix_CloseAudio();
   Mix_Quit();
 }
@@ -37,4 +40,24 @@ int sound_add_from_buffer(int id, void* buffer, size_t bufsize) {
   return 0;
 }
 
+int sound_add_from_buffer_streamed(int id, void* buffer, size_t bufsize) {
+  Sound snd;
+  snd.encoded = std::make_shared<std::vector<unsigned char>>((unsigned char*) buffer, (unsigned char*) buffer + bufsize);
+  SDL_RWops* rw = SDL_RWFromConstMem(snd.encoded->data(), bufsize);
+  snd.mm = Mix_LoadMUS_RW(rw, true);
+  if (!snd.mm) {
+    DEBUG_MESSAGE(std::string("Failed to open the stream for id -") + std::to_string(id), MESSAGE_TYPE::M_ERROR);
+    snd.encoded.reset();
+    return sound_add_from_buffer(id, buffer, bufsize);
+  }
+  sounds.assign(id, std::move(snd));
+  return 0;
+}
+
+bool music_play(int sound, bool loop) {
+  if (Mix_PlayMusic(sounds.get(sound).mm, loop ? -1 : 0) == -1) return false;
+  music_sound = sound;
+  return true;
+}
+
 }
@@ -6,10 +6,15 @@
 
 namespace enigma {
 int sound_add_from_buffer(int, void *, unsigned long long);
+int sound_add_from_buffer_streamed(int id, void* buffer, size_t size);
 int audiosystem_initialize();
 void audiosystem_update(void);
 void audiosystem_cleanup();
 
+// SDL_mixer has a single music stream, separate from its channels.
+extern int music_sound;  // Sound in the music stream, or -1
+bool music_play(int sound, bool loop);
+
 }
 
 #endif
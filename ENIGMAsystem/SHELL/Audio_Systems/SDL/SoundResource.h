@@ -4,14 +4,17 @@
 #include "Universal_System/Resources/AssetArray.h"
 #include "Universal_System/mathnc.h"
 #include <SDL_mixer.h>
+#include <memory>
+#include <vector>
 using enigma::AssetArray;
 
 
 enum load_state { LOADSTATE_NONE, LOADSTATE_INDICATED, LOADSTATE_COMPLETE };
 
 struct Sound {
-  Mix_Chunk *mc;
-  Mix_Music *mm;
+  Mix_Chunk *mc = nullptr;
+  Mix_Music *mm = nullptr;  // Streamed sounds; SDL_mixer decodes these as they play
+  std::shared_ptr<std::vector<unsigned char>> encoded;  // Backs mm, which reads it lazily
   float X = 0, Y = 0, Z = 0 , minD = 1, maxD = 1000000000;
   
   static const char* getAssetTypeName() { return "sound"; }
@@ -24,13 +27,17 @@ struct Sound {
     Mix_SetPosition(channel ,(Sint16)(enigma_user::point_direction(0,0,X,Y)),(Uint8)dist3d);
   }
 
-  bool isDestroyed() const { return !mc; }
+  bool isDestroyed() const { return !mc && !mm; }
   
   void destroy() {
-    if (!isDestroyed()) {
-      Mix_FreeChunk(mc);
-    }
+    if (mc) Mix_FreeChunk(mc);
+    if (mm) Mix_FreeMusic(mm);
+    mc = nullptr;
+    mm = nullptr;
+    encoded.reset();
   }
+
+  size_t memory() const { return mc ? mc->alen : encoded ? encoded->size() : 0; }
   
 };
 
@@ -249,4 +249,14 @@ void audio_play_sound_on(int emitter, int sound, bool loop, double priority)
 
 }
 
+size_t audio_sound_get_memory_usage(int index)
+{
+  return 0;
+}
+
+void audio_debug_memory_usage()
+{
+
+}
+
 }
@@ -64,6 +64,11 @@ namespace enigma {
 
   }
 
+  int sound_add_from_buffer_streamed(int id, void* buffer, size_t bufsize)
+  {
+    return sound_add_from_buffer(id, buffer, bufsize);
+  }
+
 
   int sound_add_from_stream(int id, size_t (*callback)(void *userdata, void *buffer, size_t size), void (*seek)(void *userdata, float position), void (*cleanup)(void *userdata), void *userdata)
   {
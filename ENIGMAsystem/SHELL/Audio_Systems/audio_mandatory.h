@@ -34,6 +34,10 @@ namespace enigma
   // This function is called for each sound in the game's module.
   int sound_add_from_buffer(int id, void* buffer, size_t size); // It should add the sound under the given ID.
 
+  // This function is called instead for sounds flagged as music or streamed.
+  // The sound should stay encoded and be decoded as it plays; the buffer is only valid during the call.
+  int sound_add_from_buffer_streamed(int id, void* buffer, size_t size);
+
   /** This function creates a stream-based sound. 
   @param id
   @param callback
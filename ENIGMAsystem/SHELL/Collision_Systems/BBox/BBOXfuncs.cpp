@@ -28,6 +28,7 @@
 #include <limits>
 #include <cmath>
 #include "Universal_System/Instances/instance.h"
+#include "Universal_System/Instances/instance_index.h"
 
 #include <floatcomp.h>
 
@@ -60,6 +61,22 @@ static inline void get_border(int *leftv, int *rightv, int *topv, int *bottomv,
     }
 }
 
+// Distance between a box and inst2's bounding box, were inst2 at (x2, y2); HUGE_VAL if inst2 has no mask.
+static double bbox_distance(int left1, int top1, int right1, int bottom1, const enigma::object_collisions* inst2, cs_scalar x2, cs_scalar y2)
+{
+    if (inst2->sprite_index == -1 && (inst2->mask_index == -1))
+        return HUGE_VAL;
+
+    const enigma::BoundingBox &box2 = inst2->$bbox_relative();
+    int left2, top2, right2, bottom2;
+    get_border(&left2, &right2, &top2, &bottom2, box2.left(), box2.top(), box2.right(), box2.bottom(), x2, y2,
+               inst2->image_xscale, inst2->image_yscale, inst2->image_angle);
+
+    const int right  = std::min(right1, right2),   left = std::max(left1, left2),
+              bottom = std::min(bottom1, bottom2), top  = std::max(top1, top2);
+    return hypot((left > right ? left - right : 0), (top > bottom ? top - bottom : 0));
+}
+
 static inline int min(int x, int y) { return x<y? x : y; }
 static inline double min(double x, double y) { return x<y? x : y; }
 static inline int max(int x, int y) { return x>y? x : y; }
@@ -174,7 +191,6 @@ double distance_to_object(int object)
     if (inst1->sprite_index == -1 && (inst1->mask_index == -1))
         return -1;
     double distance = std::numeric_limits<double>::infinity();
-    double tempdist;
     const enigma::BoundingBox &box = inst1->$bbox_relative();
     const double x1 = inst1->x, y1 = inst1->y,
                  xscale1 = inst1->image_xscale, yscale1 = inst1->image_yscale,
@@ -183,31 +199,23 @@ double distance_to_object(int object)
 
     get_border(&left1, &right1, &top1, &bottom1, box.left(), box.top(), box.right(), box.bottom(), x1, y1, xscale1, yscale1, ia1);
 
+    if (const enigma::InstanceIndex *index = enigma::instance_index(object))
+    {
+        // Boxes are no nearer than their origins, less how far each box reaches from its origin
+        const double reach1 = hypot(std::max(x1 - left1, right1 - x1), std::max(y1 - top1, bottom1 - y1)) + 1;
+        index->nearest(x1, y1, reach1 + index->reach(), [&](const enigma::InstanceIndex::Entry &e) {
+            if (e.inst == inst1) return double(HUGE_VAL);
+            const enigma::object_collisions* inst2 = (const enigma::object_collisions*) e.inst;
+            return bbox_distance(left1, top1, right1, bottom1, inst2, inst2->x, inst2->y);
+        }, &distance);
+        return (std::isinf(distance) ? -1 : distance);
+    }
+
     for (enigma::iterator it = enigma::fetch_inst_iter_by_int(object); it; ++it)
     {
         const enigma::object_collisions* inst2 = (enigma::object_collisions*)*it;
         if (inst1 == inst2) continue;
-        if (inst2->sprite_index == -1 && (inst2->mask_index == -1))
-            continue;
-
-        const enigma::BoundingBox &box2 = inst2->$bbox_relative();
-        const double x2 = inst2->x, y2 = inst2->y,
-                     xscale2 = inst2->image_xscale, yscale2 = inst2->image_yscale,
-                     ia2 = inst2->image_angle;
-        int left2, top2, right2, bottom2;
-
-        get_border(&left2, &right2, &top2, &bottom2, box2.left(), box2.top(), box2.right(), box2.bottom(), x2, y2, xscale2, yscale2, ia2);
-
-        const int right  = min(right1, right2),   left = max(left1, left2),
-                  bottom = min(bottom1, bottom2), top  = max(top1, top2);
-
-        tempdist = hypot((left > right ? left - right : 0),
-                         (top > bottom ? top - bottom : 0));
-
-        if (tempdist < distance)
-        {
-            distance = tempdist;
-        }
+        distance = std::min(distance, bbox_distance(left1, top1, right1, bottom1, inst2, inst2->x, inst2->y));
     }
     return (std::isinf(distance) ? -1 : distance);
 }
@@ -745,76 +753,54 @@ bool move_bounce_object(int object, bool adv, bool solid_only)
 
 typedef std::pair<int,enigma::object_basic*> inode_pair;
 
+static void instance_border(const enigma::object_collisions* inst, int *left, int *right, int *top, int *bottom)
+{
+    const enigma::BoundingBox &box = inst->$bbox_relative();
+    get_border(left, right, top, bottom, box.left(), box.top(), box.right(), box.bottom(), inst->x, inst->y,
+               inst->image_xscale, inst->image_yscale, inst->image_angle);
+}
+
+static bool bbox_in_region(const enigma::object_collisions* inst, int rleft, int rtop, int rwidth, int rheight)
+{
+    int left, top, right, bottom;
+    instance_border(inst, &left, &right, &top, &bottom);
+    return left <= (rleft+rwidth) && rleft <= right && top <= (rtop+rheight) && rtop <= bottom;
+}
+
 namespace enigma_user
 {
 
 void instance_deactivate_region(int rleft, int rtop, int rwidth, int rheight, bool inside, bool notme) {
-    for (enigma::iterator it = enigma::instance_list_first(); it; ++it) {
-        if (notme && (*it)->id == enigma::instance_event_iterator->inst->id) continue;
-        enigma::object_collisions* const inst = (enigma::object_collisions*) *it;
+    const double inf = HUGE_VAL;
+    enigma::for_instances_near(inside ? rleft : -inf, inside ? rtop : -inf,
+                               inside ? rleft + rwidth : inf, inside ? rtop + rheight : inf, [&](enigma::object_basic *who) {
+        if (notme && who->id == enigma::instance_event_iterator->inst->id) return;
+        enigma::object_collisions* const inst = (enigma::object_collisions*) who;
 
         if (inst->sprite_index == -1 && (inst->mask_index == -1)) //no sprite/mask then no collision
-            continue;
-
-        const enigma::BoundingBox &box = inst->$bbox_relative();
-        const double x = inst->x, y = inst->y,
-        xscale = inst->image_xscale, yscale = inst->image_yscale,
-        ia = inst->image_angle;
-
-        int left, top, right, bottom;
-        get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(), x, y, xscale, yscale, ia);
+            return;
 
-        if (left <= (rleft+rwidth) && rleft <= right && top <= (rtop+rheight) && rtop <= bottom) {
-            if (inside) {
+        if (bbox_in_region(inst, rleft, rtop, rwidth, rheight) == inside) {
             inst->deactivate();
             enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
-            }
-        } else {
-            if (!inside) {
-                inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id,inst));
-            }
         }
-    }
+    });
 }
 
 void instance_activate_region(int rleft, int rtop, int rwidth, int rheight, bool inside) {
-    std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-    while (iter != enigma::instance_deactivated_list.end()) {
-
-        enigma::object_collisions* const inst = (enigma::object_collisions*) iter->second;
-
-        if (inst->sprite_index == -1 && (inst->mask_index == -1)) { //no sprite/mask then no collision
-            ++iter;
-            continue;
-        }
-
-        const enigma::BoundingBox &box = inst->$bbox_relative();
-        const double x = inst->x, y = inst->y,
-        xscale = inst->image_xscale, yscale = inst->image_yscale,
-        ia = inst->image_angle;
+    const double inf = HUGE_VAL;
+    enigma::for_deactivated_near(inside ? rleft : -inf, inside ? rtop : -inf,
+                                 inside ? rleft + rwidth : inf, inside ? rtop + rheight : inf, [&](enigma::object_basic *who) {
+        enigma::object_collisions* const inst = (enigma::object_collisions*) who;
 
-        int left, top, right, bottom;
-        get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(), x, y, xscale, yscale, ia);
+        if (inst->sprite_index == -1 && (inst->mask_index == -1)) //no sprite/mask then no collision
+            return false;
 
-        bool removed = false;
-        if (left <= (rleft+rwidth) && rleft <= right && top <= (rtop+rheight) && rtop <= bottom) {
-            if (inside) {
-                inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
-            }
-        } else {
-            if (!inside) {
-                inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
-            }
-        }
-        if (!removed) {
-            ++iter;
-        }
-    }
+        if (bbox_in_region(inst, rleft, rtop, rwidth, rheight) != inside)
+            return false;
+        inst->activate();
+        return true;
+    });
 }
 
 }
@@ -833,102 +819,58 @@ static bool line_ellipse_intersects(cs_scalar rx, cs_scalar ry, cs_scalar x, cs_
     }
 }
 
+static bool bbox_in_circle(const enigma::object_collisions* inst, int x, int y, int r)
+{
+    int left, top, right, bottom;
+    instance_border(inst, &left, &right, &top, &bottom);
+    return line_ellipse_intersects(r, r, left-x, top-y, bottom-y) ||
+           line_ellipse_intersects(r, r, right-x, top-y, bottom-y) ||
+           line_ellipse_intersects(r, r, top-y, left-x, right-x) ||
+           line_ellipse_intersects(r, r, bottom-y, left-x, right-x) ||
+           (x >= left && x <= right && y >= top && y <= bottom); // Circle inside bbox.
+}
+
 namespace enigma_user
 {
 
 void instance_deactivate_circle(int x, int y, int r, bool inside, bool notme)
 {
-    for (enigma::iterator it = enigma::instance_list_first(); it; ++it)
+    const double inf = HUGE_VAL;
+    enigma::for_instances_near(inside ? x - r : -inf, inside ? y - r : -inf,
+                               inside ? x + r : inf, inside ? y + r : inf, [&](enigma::object_basic *who)
     {
-        if (notme && (*it)->id == enigma::instance_event_iterator->inst->id)
-            continue;
-        enigma::object_collisions* const inst = (enigma::object_collisions*) *it;
+        if (notme && who->id == enigma::instance_event_iterator->inst->id)
+            return;
+        enigma::object_collisions* const inst = (enigma::object_collisions*) who;
 
         if (inst->sprite_index == -1 && (inst->mask_index == -1)) //no sprite/mask then no collision
-            continue;
-
-        const enigma::BoundingBox &box = inst->$bbox_relative();
-        const double x1 = inst->x, y1 = inst->y,
-        xscale = inst->image_xscale, yscale = inst->image_yscale,
-        ia = inst->image_angle;
-
-        int left, top, right, bottom;
-        get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(), x1, y1, xscale, yscale, ia);
-
-        const bool intersects = line_ellipse_intersects(r, r, left-x, top-y, bottom-y) ||
-                                 line_ellipse_intersects(r, r, right-x, top-y, bottom-y) ||
-                                 line_ellipse_intersects(r, r, top-y, left-x, right-x) ||
-                                 line_ellipse_intersects(r, r, bottom-y, left-x, right-x) ||
-                                 (x >= left && x <= right && y >= top && y <= bottom); // Circle inside bbox.
+            return;
 
-        if (intersects)
+        if (bbox_in_circle(inst, x, y, r) == inside)
         {
-            if (inside)
-            {
-                inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id, inst));
-            }
-        }
-        else
-        {
-            if (!inside)
-            {
-                inst->deactivate();
-                enigma::instance_deactivated_list.insert(inode_pair(inst->id, inst));
-            }
+            inst->deactivate();
+            enigma::instance_deactivated_list.insert(inode_pair(inst->id, inst));
         }
-    }
+    });
 }
 
 
 void instance_activate_circle(int x, int y, int r, bool inside)
 {
-    std::map<int,enigma::object_basic*>::iterator iter = enigma::instance_deactivated_list.begin();
-    while (iter != enigma::instance_deactivated_list.end()) {
-        enigma::object_collisions* const inst = (enigma::object_collisions*) iter->second;
-
-        if (inst->sprite_index == -1 && (inst->mask_index == -1)) { //no sprite/mask then no collision
-            ++iter;
-            continue;
-        }
-
-        const enigma::BoundingBox &box = inst->$bbox_relative();
-        const double x1 = inst->x, y1 = inst->y,
-        xscale = inst->image_xscale, yscale = inst->image_yscale,
-        ia = inst->image_angle;
-
-        int left, top, right, bottom;
-        get_border(&left, &right, &top, &bottom, box.left(), box.top(), box.right(), box.bottom(), x1, y1, xscale, yscale, ia);
+    const double inf = HUGE_VAL;
+    enigma::for_deactivated_near(inside ? x - r : -inf, inside ? y - r : -inf,
+                                 inside ? x + r : inf, inside ? y + r : inf, [&](enigma::object_basic *who)
+    {
+        enigma::object_collisions* const inst = (enigma::object_collisions*) who;
 
-        const bool intersects = line_ellipse_intersects(r, r, left-x, top-y, bottom-y) ||
-                                 line_ellipse_intersects(r, r, right-x, top-y, bottom-y) ||
-                                 line_ellipse_intersects(r, r, top-y, left-x, right-x) ||
-                                 line_ellipse_intersects(r, r, bottom-y, left-x, right-x) ||
-                                 (x >= left && x <= right && y >= top && y <= bottom); // Circle inside bbox.
+        if (inst->sprite_index == -1 && (inst->mask_index == -1)) //no sprite/mask then no collision
+            return false;
 
-        bool removed = false;
-        if (intersects)
-        {
-            if (inside)
-            {
-                inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
-            }
-        }
-        else
-        {
-            if (!inside)
-            {
-                inst->activate();
-                enigma::instance_deactivated_list.erase(iter++);
-                removed = true;
-            }
-        }
-        if (!removed) {
-            ++iter;
-        }
-    }
+        if (bbox_in_circle(inst, x, y, r) != inside)
+            return false;
+        inst->activate();
+        return true;
+    });
 }
 
 void position_change(cs_scalar x1, cs_scalar y1, int obj, bool perf)
@@ -113,6 +113,7 @@ void surface_set_target(int id)
 
   get_surface(surface,id);
   m_deviceContext->OMSetRenderTargets(1, &surface.renderTargetView, NULL);
+  enigma::surface_target_changed(id);
 }
 
 void surface_reset_target()
@@ -120,6 +121,7 @@ void surface_reset_target()
   draw_batch_flush(batch_flush_deferred);
 
   m_deviceContext->OMSetRenderTargets(1, &m_renderTargetView, NULL);
+  enigma::surface_target_changed(-1);
 }
 
 int surface_get_target()
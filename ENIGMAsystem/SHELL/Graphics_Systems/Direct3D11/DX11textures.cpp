@@ -115,6 +115,10 @@ unsigned char* graphics_copy_texture_pixels(int texture, int x, int y, int width
   return pxdata;
 }
 
+std::unique_ptr<TextureReadback> graphics_begin_texture_readback(int texture, int x, int y, int width, int height) {
+  return std::make_unique<CopiedTextureReadback>(graphics_copy_texture_pixels(texture, x, y, width, height));
+}
+
 void graphics_push_texture_pixels(int texture, int x, int y, int width, int height, unsigned char* pxdata) {}
 
 void graphics_push_texture_pixels(int texture, int width, int height, unsigned char* pxdata) {}
@@ -21,6 +21,7 @@
 #include "Graphics_Systems/General/GSprimitives.h"
 #include "Graphics_Systems/General/GScolor_macros.h"
 #include "Graphics_Systems/General/GSstdraw.h"
+#include "Universal_System/profiler.h"
 
 #include "Widget_Systems/widgets_mandatory.h" // for show_error
 
@@ -337,6 +338,7 @@ void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned s
 
   set_primitive_mode(primitive);
   m_deviceContext->Draw(count, start);
+  enigma::profiler_draw_call(count);
 }
 
 void index_submit_range(int buffer, int vertex, int primitive, unsigned start, unsigned count) {
@@ -365,6 +367,7 @@ void index_submit_range(int buffer, int vertex, int primitive, unsigned start, u
 
   set_primitive_mode(primitive);
   m_deviceContext->DrawIndexed(count, start, 0);
+  enigma::profiler_draw_call(count);
 }
 
 } // namespace enigma_user
@@ -73,6 +73,7 @@ void surface_set_target(int id)
 
   get_surface(surface,id);
   d3ddev->SetRenderTarget(0, surface.surf);
+  enigma::surface_target_changed(id);
 
   d3d_set_projection_ortho(0, 0, surface.width, surface.height, 0);
 }
@@ -85,6 +86,7 @@ void surface_reset_target()
   d3ddev->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &pBackBuffer);
   d3ddev->SetRenderTarget(0, pBackBuffer);
   pBackBuffer->Release();
+  enigma::surface_target_changed(-1);
 }
 
 int surface_get_target()
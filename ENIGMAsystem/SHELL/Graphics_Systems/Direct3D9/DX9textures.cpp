@@ -188,6 +188,10 @@ unsigned char* graphics_copy_texture_pixels(int texture, int x, int y, int width
   return surface_copy_pixels(pBuffer, x, y, width, height);
 }
 
+std::unique_ptr<TextureReadback> graphics_begin_texture_readback(int texture, int x, int y, int width, int height) {
+  return std::make_unique<CopiedTextureReadback>(graphics_copy_texture_pixels(texture, x, y, width, height));
+}
+
 unsigned char* graphics_copy_texture_pixels(int texture, unsigned* fullwidth, unsigned* fullheight) {
   DX9Texture* d3dtex = static_cast<DX9Texture*>(enigma::textures[texture].get());
   const unsigned fw = d3dtex->fullwidth, fh = d3dtex->fullheight;
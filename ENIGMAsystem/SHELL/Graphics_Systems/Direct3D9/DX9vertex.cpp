@@ -20,6 +20,7 @@
 #include "Graphics_Systems/General/GSprimitives.h" // for enigma_user::draw_primitive_count
 #include "Graphics_Systems/General/GScolor_macros.h"
 #include "Graphics_Systems/General/GSstdraw.h"
+#include "Universal_System/profiler.h"
 
 #include <map>
 using std::map;
@@ -224,6 +225,7 @@ void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned s
   int primitive_count = enigma_user::draw_primitive_count(primitive, count);
 
   d3ddev->DrawPrimitive(primitive_types[primitive], start, primitive_count);
+  enigma::profiler_draw_call(count);
 }
 
 void index_submit_range(int buffer, int vertex, int primitive, unsigned start, unsigned count) {
@@ -246,6 +248,7 @@ void index_submit_range(int buffer, int vertex, int primitive, unsigned start, u
   int primitive_count = enigma_user::draw_primitive_count(primitive, count);
 
   d3ddev->DrawIndexedPrimitive(primitive_types[primitive], 0, 0, count, start, primitive_count);
+  enigma::profiler_draw_call(count);
 }
 
 } // namespace enigma_user
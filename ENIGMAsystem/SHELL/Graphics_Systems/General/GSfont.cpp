@@ -30,7 +30,10 @@
 #include "Universal_System/Resources/sprites.h"
 
 #include <cmath>
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <stdint.h>
 
 using namespace std;
@@ -62,7 +65,7 @@ unsigned valign = enigma_user::fa_top; //default alignment
 
 const string unicodeAnds = "\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x1F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x0F\x07\x07\x07\x07\x03\x03\x01";
 
-static uint32_t getUnicodeCharacter(const string str, size_t& pos) {
+static uint32_t getUnicodeCharacter(const string& str, size_t& pos) {
   uint32_t character = 0;
   if (str[pos] & 0x80) {
     character = (str[pos] & unicodeAnds[(str[pos] >> 1) & 0x1F]);
@@ -97,7 +100,7 @@ unsigned draw_get_valign(){
 
 namespace enigma {
   inline float get_space_width(const SpriteFont& fnt) {
-    fontglyph g = findGlyph(fnt, ' ');
+    const fontglyph& g = findGlyph(fnt, ' ');
     // Use the width of the space glyph when available,
     // else use the backup.
     // FIXME: Find out why the width is not available on Linux.
@@ -336,70 +339,187 @@ unsigned int string_width_ext_line_count(variant vstr, gs_scalar w)
 
 ////////////////////////////////////////////////////
 
-namespace enigma_user
-{
+namespace enigma {
+namespace {
+
+// A glyph placed relative to the point its text is drawn at.
+struct GlyphQuad {
+  gs_scalar x, y, x2, y2;
+  float tx, ty, tx2, ty2;
+};
+
+struct TextLayoutKey {
+  int font;
+  unsigned version;  // Of the font, which may have changed since
+  unsigned halign, valign;
+  bool ext;
+  gs_scalar sep, w;
+  string str;
+
+  bool operator==(const TextLayoutKey& other) const {
+    return font == other.font && version == other.version && halign == other.halign && valign == other.valign
+        && ext == other.ext && sep == other.sep && w == other.w && str == other.str;
+  }
+};
+
+struct TextLayoutKeyHash {
+  size_t operator()(const TextLayoutKey& key) const {
+    size_t h = std::hash<string>()(key.str);
+    h = h * 31 + size_t(key.font);
+    h = h * 31 + key.version;
+    h = h * 31 + (key.halign << 4 | key.valign << 1 | key.ext);
+    h = h * 31 + std::hash<gs_scalar>()(key.sep);
+    return h * 31 + std::hash<gs_scalar>()(key.w);
+  }
+};
 
-void draw_text(gs_scalar x, gs_scalar y, variant vstr)
-{
-  string str = toString(vstr);
-  const SpriteFont& fnt = sprite_fonts[currentfont];
-  gs_scalar yy = valign == fa_top ? y+fnt.yoffset : valign == fa_middle ? y +fnt.yoffset - string_height(str)/2 : y + fnt.yoffset - string_height(str);
-  float slen = get_space_width(fnt);
-  if (halign == fa_left){
-      gs_scalar xx = x;
-      for (size_t i = 0; i < str.length(); i++)
-      {
-        uint32_t character = getUnicodeCharacter(str, i);
+struct CachedTextLayout {
+  std::vector<GlyphQuad> quads;
+  std::list<const TextLayoutKey*>::iterator age;
+};
 
-        if (character == '\r') {
-          xx = x, yy += fnt.height, i += str[i+1] == '\n';
-        } else if (character == '\n') {
-          xx = x, yy += fnt.height;
-        } else {
-          fontglyph g = findGlyph(fnt, character);
-          if (character == ' ' or g.empty()) {
-            xx += slen;
-          } else {
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-            draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-            draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-            draw_primitive_end();
-            xx += gs_scalar(g.xs);
-          }
-        }
+// HUDs and dialog boxes draw the same strings every frame, so the most
+// recently drawn strings are kept laid out.
+const size_t kTextLayoutCacheSize = 256;
+std::unordered_map<TextLayoutKey, CachedTextLayout, TextLayoutKeyHash> text_layouts;
+std::list<const TextLayoutKey*> text_layout_ages;  // Most recently used first
+
+inline void add_glyph_quad(std::vector<GlyphQuad>& quads, gs_scalar xx, gs_scalar yy, const fontglyph& g) {
+  quads.push_back({xx + g.x, yy + g.y, xx + g.x2, yy + g.y2, g.tx, g.ty, g.tx2, g.ty2});
+}
+
+// Lays out str as draw_text would draw it at (0, 0).
+void layout_text(const SpriteFont& fnt, const string& str, std::vector<GlyphQuad>& quads) {
+  using namespace enigma_user;
+  gs_scalar yy = fnt.yoffset;
+  if (valign == fa_middle) yy -= string_height(str)/2;
+  else if (valign != fa_top) yy -= string_height(str);
+
+  int line = 0;
+  auto line_start = [&]() -> gs_scalar {
+    if (halign == fa_left) return 0;
+    return halign == fa_center ? -gs_scalar(string_width_line(str,line)/2) : -gs_scalar(string_width_line(str,line));
+  };
+  const float slen = get_space_width(fnt);
+  gs_scalar xx = line_start();
+  for (size_t i = 0; i < str.length(); i++)
+  {
+    uint32_t character = getUnicodeCharacter(str, i);
+    if (character == '\r' or character == '\n') {
+      if (character == '\r') i += str[i+1] == '\n';
+      line += 1, xx = line_start(), yy += fnt.height;
+    } else {
+      const fontglyph& g = findGlyph(fnt, character);
+      if (character == ' ' or g.empty()) {
+        xx += slen;
+      } else {
+        add_glyph_quad(quads, xx, yy, g);
+        xx += gs_scalar(g.xs);
       }
-  } else {
-      gs_scalar xx = halign == fa_center ? x-gs_scalar(string_width_line(str,0)/2) : x-gs_scalar(string_width_line(str,0)), line = 0;
-      for (size_t i = 0; i < str.length(); i++)
-      {
-        uint32_t character = getUnicodeCharacter(str, i);
+    }
+  }
+}
 
-        if (character == '\r') {
-          line +=1, yy += fnt.height, i += str[i+1] == '\n';
-          xx = halign == fa_center ? x-gs_scalar(string_width_line(str,line)/2) : x-gs_scalar(string_width_line(str,line));
-        } else if (character == '\n') {
-          line +=1, yy += fnt.height;
-          xx = halign == fa_center ? x-gs_scalar(string_width_line(str,line)/2) : x-gs_scalar(string_width_line(str,line));
-        } else {
-          fontglyph g = findGlyph(fnt, character);
-          if (character == ' ' or g.empty()) {
-            xx += slen;
-          } else {
-            draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-            draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-            draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-            draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-            draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-            draw_primitive_end();
-            xx += gs_scalar(g.xs);
-          }
+// Lays out str as draw_text_ext would draw it at (0, 0).
+void layout_text_ext(const SpriteFont& fnt, const string& str, gs_scalar sep, gs_scalar w, std::vector<GlyphQuad>& quads) {
+  using namespace enigma_user;
+  gs_scalar yy = fnt.yoffset;
+  if (valign == fa_middle) yy -= string_height_ext(str,sep,w)/2;
+  else if (valign != fa_top) yy -= string_height_ext(str,sep,w);
+
+  int line = 0;
+  auto line_start = [&]() -> gs_scalar {
+    if (halign == fa_left) return 0;
+    return halign == fa_center ? -gs_scalar(string_width_ext_line(str,w,line)/2) : -gs_scalar(string_width_ext_line(str,w,line));
+  };
+  const float slen = get_space_width(fnt);
+  gs_scalar xx = line_start(), width = 0, tw = 0;
+  for (size_t i = 0; i < str.length(); i++)
+  {
+    uint32_t character = getUnicodeCharacter(str, i);
+    if (character == '\r' or character == '\n') {
+      if (character == '\r') i += str[i+1] == '\n';
+      line += 1, xx = line_start(), yy += (sep+2 ? fnt.height : sep), width = 0;
+    } else {
+      const fontglyph& g = findGlyph(fnt, character);
+      if (character == ' ' or g.empty()) {
+        xx += slen, width += slen, tw = 0;
+        // Wrap before the next word if it won't fit
+        for (size_t c = i+1; c < str.length(); c++)
+        {
+          const uint32_t next = getUnicodeCharacter(str, c);
+          if (next == ' ' or next == '\r' or next == '\n')
+            break;
+          const fontglyph& ng = findGlyph(fnt, next);
+          tw += (!ng.empty() ? ng.xs : slen);
         }
+        if (width+tw >= w && w != -1)
+          line += 1, xx = line_start(), yy += (sep==-1 ? fnt.height : sep), width = 0, tw = 0;
+      } else {
+        add_glyph_quad(quads, xx, yy, g);
+        xx += gs_scalar(g.xs);
+        width += g.xs;
       }
+    }
+  }
+}
+
+// Returns the layout of str in the current font and alignment, from the
+// cache if it was drawn recently.
+const std::vector<GlyphQuad>& text_layout(int font, const SpriteFont& fnt, string&& str, bool ext,
+                                          gs_scalar sep = 0, gs_scalar w = 0) {
+  TextLayoutKey key = {font, fnt.version, halign, valign, ext, sep, w, std::move(str)};
+  auto it = text_layouts.find(key);
+  if (it != text_layouts.end()) {
+    text_layout_ages.splice(text_layout_ages.begin(), text_layout_ages, it->second.age);
+    return it->second.quads;
+  }
+
+  if (text_layouts.size() >= kTextLayoutCacheSize) {
+    text_layouts.erase(text_layouts.find(*text_layout_ages.back()));
+    text_layout_ages.pop_back();
+  }
+  std::vector<GlyphQuad> quads;
+  if (ext) layout_text_ext(fnt, key.str, sep, w, quads);
+  else layout_text(fnt, key.str, quads);
+
+  it = text_layouts.emplace(std::move(key), CachedTextLayout{std::move(quads), {}}).first;
+  text_layout_ages.push_front(&it->first);
+  it->second.age = text_layout_ages.begin();
+  return it->second.quads;
+}
+
+// Submits a layout as one batch of triangles. The top and bottom of each
+// glyph are shifted right and down by the given skew.
+void draw_glyph_quads(const SpriteFont& fnt, const std::vector<GlyphQuad>& quads, gs_scalar x, gs_scalar y,
+                      gs_scalar top = 0, gs_scalar bottom = 0) {
+  using namespace enigma_user;
+  if (quads.empty()) return;
+  const gs_scalar xt = x + top, yt = y + top, xb = x + bottom, yb = y + bottom;
+  draw_primitive_begin_texture(pr_trianglelist, fnt.texture);
+  for (const GlyphQuad& q : quads) {
+    draw_vertex_texture(xt + q.x,  yt + q.y,  q.tx,  q.ty);
+    draw_vertex_texture(xt + q.x2, yt + q.y,  q.tx2, q.ty);
+    draw_vertex_texture(xb + q.x,  yb + q.y2, q.tx,  q.ty2);
+    draw_vertex_texture(xb + q.x,  yb + q.y2, q.tx,  q.ty2);
+    draw_vertex_texture(xt + q.x2, yt + q.y,  q.tx2, q.ty);
+    draw_vertex_texture(xb + q.x2, yb + q.y2, q.tx2, q.ty2);
   }
+  draw_primitive_end();
 }
 
+}  // namespace
+}  // namespace enigma
+
+namespace enigma_user
+{
+
+void draw_text(gs_scalar x, gs_scalar y, variant vstr)
+{
+  const int font = currentfont;
+  const SpriteFont& fnt = sprite_fonts[font];
+  draw_glyph_quads(fnt, text_layout(font, fnt, toString(vstr), false), x, y);
+}
 
 void draw_text_sprite(gs_scalar x, gs_scalar y, variant vstr, int sep, int lineWidth, int sprite, int firstChar, int scale)
 {
@@ -470,143 +590,16 @@ void draw_text_sprite(gs_scalar x, gs_scalar y, variant vstr, int sep, int lineW
 
 void draw_text_skewed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar top, gs_scalar bottom)
 {
-  string str = toString(vstr);
-  const SpriteFont& fnt = sprite_fonts[currentfont];
-  gs_scalar yy = valign == fa_top ? y+fnt.yoffset : valign == fa_middle ? y +fnt.yoffset - string_height(str)/2 : y + fnt.yoffset - string_height(str);
-  float slen = get_space_width(fnt);
-  if (halign == fa_left){
-    gs_scalar xx = x;
-    for (size_t i = 0; i < str.length(); i++)
-    {
-      uint32_t character = getUnicodeCharacter(str, i);
-      if (character == '\r') {
-        xx = x, yy += fnt.height, i += str[i+1] == '\n';
-      } else if (character == '\n') {
-        xx = x, yy += fnt.height;
-      } else {
-        fontglyph g = findGlyph(fnt, character);
-        if (character == ' ' or g.empty()) {
-          xx += slen;
-        } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x + top,     yy + g.y + top, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2 + top,    yy + g.y + top, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x + bottom,  yy + g.y2 + bottom, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2 + bottom, yy + g.y2 + bottom, g.tx2, g.ty2);
-          draw_primitive_end();
-
-          xx += gs_scalar(g.xs);
-        }
-      }
-    }
-  } else {
-    gs_scalar xx = halign == fa_center ? x-gs_scalar(string_width_line(str,0)/2) : x-gs_scalar(string_width_line(str,0)), line = 0;
-    for (size_t i = 0; i < str.length(); i++)
-    {
-      uint32_t character = getUnicodeCharacter(str, i);
-      if (character == '\r') {
-        line +=1, yy += fnt.height, i += str[i+1] == '\n';
-        xx = halign == fa_center ? x-gs_scalar(string_width_line(str,line)/2) : x-gs_scalar(string_width_line(str,line));
-      } else if (character == '\n') {
-        line +=1, yy += fnt.height;
-        xx = halign == fa_center ? x-gs_scalar(string_width_line(str,line)/2) : x-gs_scalar(string_width_line(str,line));
-      } else {
-        fontglyph g = findGlyph(fnt, character);
-        if (character == ' ' or g.empty()) {
-          xx += slen;
-        } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x + top,     yy + g.y + top, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2 + top,    yy + g.y + top, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x + bottom,  yy + g.y2 + bottom, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2 + bottom, yy + g.y2 + bottom, g.tx2, g.ty2);
-          draw_primitive_end();
-          xx += gs_scalar(g.xs);
-        }
-      }
-    }
-  }
+  const int font = currentfont;
+  const SpriteFont& fnt = sprite_fonts[font];
+  draw_glyph_quads(fnt, text_layout(font, fnt, toString(vstr), false), x, y, top, bottom);
 }
 
 void draw_text_ext(gs_scalar x, gs_scalar y, variant vstr, gs_scalar sep, gs_scalar w)
 {
-  string str = toString(vstr);
-  const SpriteFont& fnt = sprite_fonts[currentfont];
-
-  gs_scalar yy = valign == fa_top ? y+fnt.yoffset : valign == fa_middle ? y + fnt.yoffset - string_height_ext(str,sep,w)/2 : y + fnt.yoffset - string_height_ext(str,sep,w);
-  float slen = get_space_width(fnt);
-  if (halign == fa_left){
-    gs_scalar xx = x, width = 0, tw = 0;
-    for (size_t i = 0; i < str.length(); i++)
-    {
-      uint32_t character = getUnicodeCharacter(str, i);
-      if (character == '\r') {
-        xx = x, yy += (sep+2 ? fnt.height : sep), i += str[i+1] == '\n';
-      } else if (character == '\n') {
-            xx = x, yy += (sep+2 ? fnt.height : sep);
-      } else {
-        fontglyph g = findGlyph(fnt, character);
-        if (character == ' ' or g.empty()) {
-          xx += slen, width = xx-x;
-          tw = 0;
-          for (size_t c = i+1; c < str.length(); c++)
-          {
-            character = getUnicodeCharacter(str, c);
-            if (character == ' ' or character == '\r' or character == '\n')
-              break;
-            g = findGlyph(fnt, character);
-            tw += (!g.empty()?g.xs:slen);
-          }
-          if (width+tw >= w && w != -1)
-          xx = x, yy += (sep==-1 ? fnt.height : sep), width = 0, tw = 0;
-        } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-          draw_primitive_end();
-          xx += gs_scalar(g.xs);
-        }
-      }
-    }
-  } else {
-    gs_scalar xx = halign == fa_center ? x-gs_scalar(string_width_ext_line(str,w,0)/2) : x-gs_scalar(string_width_ext_line(str,w,0)), line = 0, width = 0, tw = 0;
-    for (size_t i = 0; i < str.length(); i++)
-    {
-      uint32_t character = getUnicodeCharacter(str, i);
-      if (character == '\r') {
-        line += 1, xx = halign == fa_center ? x-gs_scalar(string_width_ext_line(str,w,line)/2) : x-gs_scalar(string_width_ext_line(str,w,line)), yy += (sep+2 ? fnt.height : sep), i += str[i+1] == '\n', width = 0;
-      } else if (character == '\n') {
-        line += 1, xx = halign == fa_center ? x-gs_scalar(string_width_ext_line(str,w,line)/2) : x-gs_scalar(string_width_ext_line(str,w,line)), yy += (sep+2 ? fnt.height : sep), width = 0;
-      } else {
-        fontglyph g = findGlyph(fnt, character);
-        if (character == ' ' or g.empty()) {
-          xx += slen, width += slen, tw = 0;
-          for (size_t c = i+1; c < str.length(); c++)
-          {
-            character = getUnicodeCharacter(str, c);
-            if (character == ' ' or character == '\r' or character == '\n')
-              break;
-            g = findGlyph(fnt, character);
-            tw += (!g.empty() ? g.xs : slen);
-          }
-
-          if (width+tw >= w && w != -1)
-            line += 1, xx = halign == fa_center ? x-gs_scalar(string_width_ext_line(str,w,line)/2) : x-gs_scalar(string_width_ext_line(str,w,line)), yy += (sep==-1 ? fnt.height : sep), width = 0, tw = 0;
-        } else {
-          draw_primitive_begin_texture(pr_trianglestrip, fnt.texture);
-          draw_vertex_texture(xx + g.x,  yy + g.y, g.tx, g.ty);
-          draw_vertex_texture(xx + g.x2, yy + g.y, g.tx2, g.ty);
-          draw_vertex_texture(xx + g.x,  yy + g.y2, g.tx,  g.ty2);
-          draw_vertex_texture(xx + g.x2, yy + g.y2, g.tx2, g.ty2);
-          draw_primitive_end();
-          xx += gs_scalar(g.xs);
-          width += g.xs;
-        }
-      }
-    }
-  }
+  const int font = currentfont;
+  const SpriteFont& fnt = sprite_fonts[font];
+  draw_glyph_quads(fnt, text_layout(font, fnt, toString(vstr), true, sep, w), x, y);
 }
 
 void draw_text_transformed(gs_scalar x, gs_scalar y, variant vstr, gs_scalar xscale, gs_scalar yscale, double rot)
@@ -20,6 +20,7 @@
 #include "GSstdraw.h"
 #include "GSmodel.h"
 #include "GStextures.h"
+#include "Universal_System/profiler.h"
 
 #ifdef DEBUG_MODE
 #include "Widget_Systems/widgets_mandatory.h"
@@ -100,6 +101,7 @@ void draw_batch_flush(int kind) {
     enigma::draw_set_state_dirty(false);
     d3d_model_draw(draw_get_batch_stream());
     enigma::draw_set_state_dirty(wasStateDirty);
+    ++enigma::frame_counts.batches;
   }
   d3d_model_clear(draw_get_batch_stream());
 
@@ -36,6 +36,7 @@
 #include "Universal_System/roomsystem.h"
 #include "Universal_System/Resources/backgrounds_internal.h"
 #include "Universal_System/Resources/sprites_internal.h"
+#include "Universal_System/profiler.h"
 #include "Platforms/General/PFwindow.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 
@@ -331,11 +332,13 @@ void screen_init() {
 
 void screen_refresh() {
   draw_batch_flush(batch_flush_deferred);
+  enigma::profiler_scope profile(enigma_user::profiler_swap);
   enigma::ScreenRefresh();
 }
 
 void screen_redraw()
 {
+  enigma::profiler_scope profile(enigma_user::profiler_draw);
   enigma::scene_begin();
 
   if (!view_enabled)
@@ -22,6 +22,7 @@
 
 #include "Universal_System/roomsystem.h"
 #include "Universal_System/math_consts.h"
+#include "Universal_System/profiler.h"
 
 #include <list>
 #include <math.h>
@@ -68,6 +69,7 @@ void draw_state_flush() {
 
   enigma::graphics_state_flush();
   drawStateDirty = false; // state is not dirty now
+  ++enigma::frame_counts.state_flushes;
 
   flushing = false; // done flushing state
 }
@@ -20,6 +20,7 @@
 #include "GSsurface_impl.h"
 #include "GSprimitives.h"
 #include "GScolor_macros.h"
+#include "GStextures_impl.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 
 #include "Universal_System/image_formats.h"
@@ -28,10 +29,15 @@
 #include "Universal_System/Resources/backgrounds_internal.h"
 #include "Collision_Systems/collision_types.h"
 #include "Universal_System/math_consts.h"
+#include "Universal_System/buffers_internal.h"
+#include "Widget_Systems/widgets_mandatory.h"
+#include "libEGMstd.h"
 
 #include <stdio.h> //for file writing (surface_save)
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <map>
 #include <math.h>
 
 using namespace std;
@@ -42,6 +48,48 @@ namespace enigma {
 
 vector<BaseSurface*> surfaces;
 
+static int surface_target = -1;
+
+void surface_contents_changed(int id) {
+  if (id < 0 || size_t(id) >= surfaces.size() || !surfaces[id]) return;
+  surfaces[id]->mirror.clear();
+  surfaces[id]->reads = 0;
+}
+
+void surface_target_changed(int id) {
+  surface_target = id;
+  surface_contents_changed(id);
+}
+
+// Puts the BGRA bytes of a pixel in px, or zeroes if it's off the surface.
+static void surface_read_pixel(int id, BaseSurface& base, int x, int y, unsigned char px[4]) {
+  if (x < 0 || y < 0 || x >= base.width || y >= base.height) {
+    std::fill(px, px + 4, 0);
+    return;
+  }
+  // Being drawn to, so any copy would be out of date by the next read
+  if (id != surface_target && base.mirror.empty() && ++base.reads > 1) {
+    unsigned char* surfbuf = graphics_copy_texture_pixels(base.texture, 0, 0, base.width, base.height);
+    if (surfbuf) base.mirror.assign(surfbuf, surfbuf + size_t(base.width) * base.height * 4);
+    delete[] surfbuf;
+  }
+  if (id != surface_target && !base.mirror.empty()) {
+    std::copy_n(&base.mirror[(size_t(y) * base.width + x) * 4], 4, px);
+    return;
+  }
+  unsigned char* surfbuf = graphics_copy_texture_pixels(base.texture, x, y, 1, 1);
+  std::copy_n(surfbuf, 4, px);
+  delete[] surfbuf;
+}
+
+struct SurfaceRead {
+  std::unique_ptr<TextureReadback> readback;
+  int width, height;
+};
+
+static std::map<int, SurfaceRead> surface_reads;
+static int surface_read_next = 0;
+
 } // namespace enigma
 
 namespace enigma_user {
@@ -308,11 +356,9 @@ int surface_getpixel(int id, int x, int y)
   draw_batch_flush(batch_flush_deferred);
 
   get_surfacev(surf,id,-1);
-  const enigma::BaseSurface& base = ((enigma::BaseSurface&)surf);
-  unsigned char *surfbuf=enigma::graphics_copy_texture_pixels(base.texture,x,y,1,1);
-  int ret = surfbuf[2] + (surfbuf[1] << 8) + (surfbuf[0] << 16);
-  delete[] surfbuf;
-  return ret;
+  unsigned char px[4];
+  enigma::surface_read_pixel(id, (enigma::BaseSurface&)surf, x, y, px);
+  return px[2] + (px[1] << 8) + (px[0] << 16);
 }
 
 int surface_getpixel_ext(int id, int x, int y)
@@ -320,23 +366,60 @@ int surface_getpixel_ext(int id, int x, int y)
   draw_batch_flush(batch_flush_deferred);
 
   get_surfacev(surf,id,-1);
-  const enigma::BaseSurface& base = ((enigma::BaseSurface&)surf);
-  unsigned char *surfbuf=enigma::graphics_copy_texture_pixels(base.texture,x,y,1,1);
-  int ret = surfbuf[2] + (surfbuf[1] << 8) + (surfbuf[0] << 16) + (surfbuf[3] << 24);
-  delete[] surfbuf;
-  return ret;
+  unsigned char px[4];
+  enigma::surface_read_pixel(id, (enigma::BaseSurface&)surf, x, y, px);
+  return px[2] + (px[1] << 8) + (px[0] << 16) + (px[3] << 24);
 }
 
 int surface_getpixel_alpha(int id, int x, int y)
 {
   draw_batch_flush(batch_flush_deferred);
 
+  get_surfacev(surf,id,-1);
+  unsigned char px[4];
+  enigma::surface_read_pixel(id, (enigma::BaseSurface&)surf, x, y, px);
+  return px[3];
+}
+
+int surface_read_async(int id, int x, int y, int w, int h)
+{
+  draw_batch_flush(batch_flush_deferred);
+
   get_surfacev(surf,id,-1);
   const enigma::BaseSurface& base = ((enigma::BaseSurface&)surf);
-  unsigned char *surfbuf=enigma::graphics_copy_texture_pixels(base.texture,x,y,1,1);
-  int ret = surfbuf[3];
-  delete[] surfbuf;
-  return ret;
+  if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > base.width || y + h > base.height) {
+    DEBUG_MESSAGE("Reading outside of surface " + toString(id), MESSAGE_TYPE::M_USER_ERROR);
+    return -1;
+  }
+  std::unique_ptr<enigma::TextureReadback> readback = enigma::graphics_begin_texture_readback(base.texture, x, y, w, h);
+  if (!readback) return -1;
+  const int request = enigma::surface_read_next++;
+  enigma::surface_reads[request] = {std::move(readback), w, h};
+  return request;
+}
+
+bool surface_read_async_ready(int request)
+{
+  auto it = enigma::surface_reads.find(request);
+  return it != enigma::surface_reads.end() && it->second.readback->ready();
+}
+
+bool surface_read_async_buffer(int request, int buffer, unsigned offset)
+{
+  auto it = enigma::surface_reads.find(request);
+  if (it == enigma::surface_reads.end()) return false;
+  get_bufferr(binbuff, buffer, false);
+  const enigma::SurfaceRead& read = it->second;
+  unsigned char* pixels = read.readback->pixels();
+  if (pixels) binbuff->WriteAt(offset, pixels, unsigned(read.width) * read.height * 4);
+  delete[] pixels;
+  enigma::surface_reads.erase(it);
+  return pixels != nullptr;
+}
+
+void surface_read_async_free(int request)
+{
+  enigma::surface_reads.erase(request);
 }
 
 int surface_save(int id, string filename)
@@ -432,6 +515,7 @@ void surface_copy_part(int destination, gs_scalar x, gs_scalar y, int source, in
   unsigned char *surfbuf=enigma::graphics_copy_texture_pixels(sbase.texture,xs,ys,ws,hs);
   enigma::graphics_push_texture_pixels(dbase.texture, x, y, ws, hs, surfbuf);
   delete[] surfbuf;
+  enigma::surface_contents_changed(destination);
 }
 
 void surface_copy(int destination, gs_scalar x, gs_scalar y, int source)
@@ -447,6 +531,7 @@ void surface_copy(int destination, gs_scalar x, gs_scalar y, int source)
   unsigned char *surfbuf=enigma::graphics_copy_texture_pixels(sbase.texture,&sw,&sh);
   enigma::graphics_push_texture_pixels(dbase.texture, x, y, sw, sh, surfbuf);
   delete[] surfbuf;
+  enigma::surface_contents_changed(destination);
 }
 
 } // namespace enigma_user
@@ -58,6 +58,16 @@ namespace enigma_user
   #define surface_get_pixel_ext    surface_getpixel_ext
   #define surface_get_pixel_alpha  surface_getpixel_alpha
 
+  // Reads a rectangle of the surface without waiting for the GPU to finish it,
+  // returning a request id or -1. Drawing can carry on while it's read; check
+  // surface_read_async_ready a frame or so later rather than right away.
+  int surface_read_async(int id, int x, int y, int w, int h);
+  bool surface_read_async_ready(int request);
+  // Writes the pixels to the buffer at offset, four bytes (BGRA) each, row by
+  // row, and frees the request; waits for them if they aren't ready yet.
+  bool surface_read_async_buffer(int request, int buffer, unsigned offset);
+  void surface_read_async_free(int request);
+
   int surface_save(int id, string filename);
   int surface_save_part(int id, string filename, unsigned x, unsigned y, unsigned w, unsigned h);
   void surface_copy(int destination,gs_scalar x, gs_scalar y,int source);
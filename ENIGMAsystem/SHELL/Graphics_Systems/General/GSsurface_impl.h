@@ -30,6 +30,11 @@ namespace enigma {
 
 struct BaseSurface {
   int texture, width, height;
+  // A copy of the pixels for surface_getpixel, taken on the second read since
+  // the surface last changed, so that a surface read all over each step only
+  // waits on the GPU once; empty when out of date.
+  vector<unsigned char> mirror;
+  unsigned reads = 0; // Since the surface last changed
 protected:
   // we want BaseSurface abstract/non-instantiable
   // each backend assumes it can safely cast
@@ -40,6 +45,12 @@ protected:
 
 extern vector<BaseSurface*> surfaces;
 
+// Backends call this when a surface becomes the drawing target, or with -1 when
+// the screen does, so that pixels read from it aren't stale.
+void surface_target_changed(int id);
+// For anything else that changes a surface's pixels
+void surface_contents_changed(int id);
+
 struct Surface; // forward-declaration for get_surface
 extern unsigned int bound_framebuffer;
 
@@ -22,6 +22,7 @@
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Universal_System/image_formats.h"
+#include "Universal_System/profiler.h"
 
 #include <string.h> // for memcpy
 
@@ -162,6 +163,7 @@ void texture_set_stage(int stage, int texid) {
   if (enigma::samplers[stage].texture == texid) return;
   enigma::draw_set_state_dirty();
   enigma::samplers[stage].texture = texid;
+  ++enigma::frame_counts.texture_switches;
 }
 
 int texture_get_stage(int stage) {
@@ -172,6 +174,7 @@ void texture_reset() {
   if (enigma::samplers[0].texture == -1) return;
   enigma::draw_set_state_dirty();
   enigma::samplers[0].texture = -1;
+  ++enigma::frame_counts.texture_switches;
 }
 
 void texture_set_enabled(bool enable){}
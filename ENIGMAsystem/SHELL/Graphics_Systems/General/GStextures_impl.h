@@ -44,6 +44,29 @@ protected:
 
 extern vector<std::unique_ptr<Texture>> textures;
 
+/// Pixels on their way back from the GPU, from graphics_begin_texture_readback.
+struct TextureReadback {
+  virtual ~TextureReadback() = default;
+  /// Whether pixels() can return without waiting on the GPU.
+  virtual bool ready() { return true; }
+  /// The pixels, as from graphics_copy_texture_pixels, waiting for them if need
+  /// be; they're yours to free, and there are none after the first call.
+  virtual unsigned char* pixels() = 0;
+};
+
+/// For backends that copy the pixels as the readback starts.
+struct CopiedTextureReadback : TextureReadback {
+  explicit CopiedTextureReadback(unsigned char* pxdata): pxdata(pxdata) {}
+  ~CopiedTextureReadback() { delete[] pxdata; }
+  unsigned char* pixels() override {
+    unsigned char* ret = pxdata;
+    pxdata = nullptr;
+    return ret;
+  }
+ private:
+  unsigned char* pxdata;
+};
+
 } // namespace enigma
 
 #endif // ENIGMA_GSTEXTURES_IMPL_H
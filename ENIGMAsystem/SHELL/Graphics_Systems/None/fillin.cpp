@@ -18,6 +18,7 @@
 #include "Graphics_Systems/graphics_mandatory.h" // Room dimensions.
 #include "Graphics_Systems/General/GSbackground.h"
 #include "Graphics_Systems/General/GStextures.h"
+#include "Graphics_Systems/General/GStextures_impl.h"
 #include "Graphics_Systems/General/GStiles.h"
 #include "Graphics_Systems/General/GSvertex.h"
 #include "Graphics_Systems/General/GSsurface.h"
@@ -63,6 +64,7 @@ namespace enigma
 	unsigned char* graphics_copy_screen_pixels(unsigned* fullwidth, unsigned* fullheight, bool* flipped) {return nullptr;}
 	unsigned char* graphics_copy_texture_pixels(int texture, unsigned* fullwidth, unsigned* fullheight) {return NULL;}
 	unsigned char* graphics_copy_texture_pixels(int texture, int x, int y, int width, int height) {return NULL;}
+	std::unique_ptr<TextureReadback> graphics_begin_texture_readback(int texture, int x, int y, int width, int height) {return nullptr;}
 	void graphics_push_texture_pixels(int texture, int x, int y, int width, int height, unsigned char* pxdata) {}
 	void graphics_push_texture_pixels(int texture, int width, int height, unsigned char* pxdata) {}
 
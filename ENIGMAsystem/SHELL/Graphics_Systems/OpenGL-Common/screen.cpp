@@ -17,7 +17,6 @@
 *** with this code. If not, see <http://www.gnu.org/licenses/>
 **/
 
-#include "profiler.h"
 #include "screen.h"
 #include "OpenGLHeaders.h"
 #include "Graphics_Systems/General/GSscreen.h"
@@ -37,11 +36,13 @@ void graphics_set_viewport(float x, float y, float width, float height) {
   glScissor(x,y,width,height);
 }
 
-void scene_begin() {}
+void scene_begin() {
+  gpu_timer_begin();
+}
 
 void scene_end() {
-  gpuprof.end_frame();
   msaa_fbo_blit();
+  gpu_timer_end();
 }
 
 unsigned char* graphics_copy_screen_pixels(unsigned* fullwidth, unsigned* fullheight, bool* flipped) {
@@ -2,6 +2,9 @@ namespace enigma {
 
 void gl_screen_init();
 void msaa_fbo_blit();
+// Time the GPU's work on a frame for the profiler, where the context can
+void gpu_timer_begin();
+void gpu_timer_end();
 
 unsigned char* graphics_copy_screen_pixels(int ,int,int,int,bool*);
 unsigned char* graphics_copy_screen_pixels(unsigned*, unsigned*, bool*);
@@ -3,7 +3,6 @@
 #include "stdraw.cpp"
 #include "textures.cpp"
 #include "std.cpp"
-#include "profiler.cpp"
 #include "shader.cpp"
 #include "surface.cpp"
 #include "vertex.cpp"
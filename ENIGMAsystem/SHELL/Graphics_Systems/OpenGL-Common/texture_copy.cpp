@@ -1,5 +1,7 @@
 #include "Graphics_Systems/OpenGL-Common/textures_impl.h"
 
+#include <cstring> // for std::memcpy
+
 namespace enigma {
 
 unsigned char* graphics_copy_texture_pixels(int texture, unsigned* fullwidth, unsigned* fullheight) {
@@ -12,4 +14,95 @@ unsigned char* graphics_copy_texture_pixels(int texture, unsigned* fullwidth, un
   return ret;
 }
 
+namespace {
+
+// Attaches the texture to a framebuffer kept for reading, so that glReadPixels
+// can take just the part wanted rather than glGetTexImage taking all of it.
+class texture_read_binding {
+  GLint previous;
+ public:
+  texture_read_binding(int texture) {
+    static GLuint fbo = 0;
+    if (!fbo) glGenFramebuffers(1, &fbo);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, get_texture_peer(texture), 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  }
+  ~texture_read_binding() {
+    // Detached, so that deleting the texture actually frees it
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+  }
+};
+
+// Reads into a pixel buffer object, which the GPU fills once it gets to it;
+// the fence says when that is.
+struct GLTextureReadback : TextureReadback {
+  GLuint pbo;
+  GLsync fence;
+  size_t size;
+
+  GLTextureReadback(int texture, int x, int y, int width, int height): size(size_t(width) * height * 4) {
+    texture_read_binding binding(texture);
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    glReadPixels(x, y, width, height, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence = GLEW_ARB_sync ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+  }
+  ~GLTextureReadback() {
+    if (fence) glDeleteSync(fence);
+    if (pbo) glDeleteBuffers(1, &pbo);
+  }
+
+  bool ready() override {
+    // Without fences there's no asking, so pixels() may have to wait
+    if (!fence || !pbo) return true;
+    const GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+  }
+
+  unsigned char* pixels() override {
+    if (!pbo) return nullptr;
+    unsigned char* ret = new unsigned char[size];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, size, ret);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteBuffers(1, &pbo);
+    pbo = 0;
+    return ret;
+  }
+};
+
+} // namespace anonymous
+
+unsigned char* graphics_copy_texture_pixels(int texture, int x, int y, int width, int height) {
+  const int bpp = 4; // bytes per pixel
+  const int dp = width*bpp; // destination pitch
+  unsigned char* ret = new unsigned char[height*dp];
+
+  if (GLEW_ARB_framebuffer_object) {
+    texture_read_binding binding(texture);
+    glReadPixels(x, y, width, height, GL_BGRA, GL_UNSIGNED_BYTE, ret);
+    return ret;
+  }
+
+  unsigned fw, fh;
+  unsigned char* pxdata = graphics_copy_texture_pixels(texture, &fw, &fh);
+  const int sp = fw*bpp; // source pitch
+  for (int i = 0; i < height; ++i) {
+    std::memcpy(ret + i*dp, pxdata + (i+y)*sp + x*bpp, dp);
+  }
+  delete[] pxdata;
+  return ret;
+}
+
+std::unique_ptr<TextureReadback> graphics_begin_texture_readback(int texture, int x, int y, int width, int height) {
+  if (GLEW_ARB_framebuffer_object && GLEW_ARB_pixel_buffer_object)
+    return std::make_unique<GLTextureReadback>(texture, x, y, width, height);
+  return std::make_unique<CopiedTextureReadback>(graphics_copy_texture_pixels(texture, x, y, width, height));
+}
+
 } //namespace enigma
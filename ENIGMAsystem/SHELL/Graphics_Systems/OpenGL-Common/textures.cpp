@@ -24,7 +24,6 @@
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Universal_System/image_formats.h"
 #include "Universal_System/nlpo2.h"
-#include <cstring> // for std::memcpy
 
 #include "Platforms/General/PFwindow.h"
 
@@ -84,21 +83,4 @@ void graphics_delete_texture(int texid) {
   }
 }
 
-unsigned char* graphics_copy_texture_pixels(int texture, int x, int y, int width, int height) {
-  unsigned fw, fh;
-  //We could use glCopyImageSubData here instead of cropping, but it's GL4.3
-  unsigned char* pxdata = graphics_copy_texture_pixels(texture, &fw, &fh);
-  const int bpp = 4; // bytes per pixel
-  const int dp=width*bpp, // destination pitch
-            sp=fw*bpp; // source pitch
-
-  unsigned char* cropped = new unsigned char[height*dp];
-  for (int i = 0; i < height; ++i) {
-    std::memcpy(cropped + i*dp, pxdata + (i+y)*sp + x*bpp, dp);
-  }
-  delete[] pxdata;
-
-  return cropped;
-}
-
 } // namespace enigma
@@ -17,7 +17,6 @@
 *** with this code. If not, see <http://www.gnu.org/licenses/>
 **/
 
-#include "profiler.h"
 #include "shader.h"
 #include "GLSLshader.h"
 
@@ -27,6 +26,7 @@
 #include "Graphics_Systems/General/GScolors.h"
 #include "Graphics_Systems/General/GScolor_macros.h"
 #include "Graphics_Systems/General/GSstdraw.h"
+#include "Universal_System/profiler.h"
 
 #include <map>
 
@@ -213,15 +213,11 @@ void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned s
 
   const auto& vertexBuffer = enigma::vertexBuffers[buffer];
 
-  #ifdef DEBUG_MODE
-  enigma::GPUProfilerBatch& vbd = enigma::gpuprof.add_drawcall();
-  ++vbd.drawcalls;
-  #endif
-
   enigma::graphics_prepare_buffer(buffer, false);
   enigma::graphics_apply_vertex_format(vertexBuffer->format, offset);
 
 	glDrawArrays(primitive_types[primitive], start, count);
+  enigma::profiler_draw_call(count);
 }
 
 void index_submit_range(int buffer, int vertex, int primitive, unsigned start, unsigned count) {
@@ -230,11 +226,6 @@ void index_submit_range(int buffer, int vertex, int primitive, unsigned start, u
   const auto& vertexBuffer = enigma::vertexBuffers[vertex];
   const auto& indexBuffer = enigma::indexBuffers[buffer];
 
-  #ifdef DEBUG_MODE
-  enigma::GPUProfilerBatch& vbd = enigma::gpuprof.add_drawcall();
-  ++vbd.drawcalls;
-  #endif
-
   enigma::graphics_prepare_buffer(vertex, false);
   enigma::graphics_prepare_buffer(buffer, true);
   enigma::graphics_apply_vertex_format(vertexBuffer->format, 0);
@@ -248,6 +239,7 @@ void index_submit_range(int buffer, int vertex, int primitive, unsigned start, u
   }
 
   glDrawElements(primitive_types[primitive], count, indexType, (GLvoid*)(intptr_t)start);
+  enigma::profiler_draw_call(count);
 }
 
 } // namespace enigma_user
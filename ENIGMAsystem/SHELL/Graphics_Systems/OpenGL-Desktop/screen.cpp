@@ -1,11 +1,53 @@
 #include "Graphics_Systems/OpenGL-Common/screen.h"
 #include "OpenGLHeaders.h"
 #include "Platforms/General/PFwindow.h"
+#include "Universal_System/profiler.h"
+
+namespace {
+
+// A few frames' worth of timer queries, each read once the GPU has its result,
+// so that timing never makes the game wait on the GPU.
+const unsigned gpu_timer_count = 4;
+GLuint gpu_timers[gpu_timer_count];
+unsigned gpu_timer_next = 0, gpu_timer_pending = 0;
+bool gpu_timer_running = false;
+
+} // namespace anonymous
 
 namespace enigma {
 
 GLuint msaa_fbo = 0;
 
+void gpu_timer_begin() {
+  if (gpu_timer_running || !GLEW_ARB_timer_query || !profiler_timing()) return;
+  if (!gpu_timers[0]) glGenQueries(gpu_timer_count, gpu_timers);
+
+  // Oldest first
+  while (gpu_timer_pending) {
+    const GLuint query = gpu_timers[(gpu_timer_next + gpu_timer_count - gpu_timer_pending) % gpu_timer_count];
+    GLint available = 0;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) break;
+    GLuint64 elapsed = 0; // nanoseconds
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    profiler_gpu_time(elapsed / 1e6);
+    --gpu_timer_pending;
+  }
+  // The GPU is that far behind; this frame goes untimed rather than waiting
+  if (gpu_timer_pending == gpu_timer_count) return;
+
+  glBeginQuery(GL_TIME_ELAPSED, gpu_timers[gpu_timer_next]);
+  gpu_timer_running = true;
+}
+
+void gpu_timer_end() {
+  if (!gpu_timer_running) return;
+  glEndQuery(GL_TIME_ELAPSED);
+  gpu_timer_running = false;
+  gpu_timer_next = (gpu_timer_next + 1) % gpu_timer_count;
+  ++gpu_timer_pending;
+}
+
 void gl_screen_init() {
   //TODO: This never reports higher than 8, but display_aa should be 14 if 2,4,and 8 are supported and 8 only when only 8 is supported
   glGetIntegerv(GL_MAX_SAMPLES_EXT, &enigma_user::display_aa);
@@ -2,7 +2,6 @@
 #include "Graphics_Systems/OpenGL-Common/textures.cpp"
 #include "Graphics_Systems/OpenGL-Common/screen.cpp" 
 #include "Graphics_Systems/OpenGL-Common/surface.cpp" 
-#include "Graphics_Systems/OpenGL-Common/profiler.cpp"
 #include "Graphics_Systems/OpenGL-Common/types.cpp"
 #include "Graphics_Systems/OpenGL-Common/texture_copy.cpp"
 #include "Graphics_Systems/OpenGL-Common/scissor.cpp"
@@ -24,6 +24,7 @@
 #include "Graphics_Systems/General/GSprimitives.h"
 #include "Graphics_Systems/General/GScolor_macros.h"
 #include "Graphics_Systems/General/GSstdraw.h"
+#include "Universal_System/profiler.h"
 
 #include <map>
 using std::map;
@@ -266,6 +267,7 @@ void vertex_submit_offset(int buffer, int primitive, unsigned offset, unsigned s
   enigma::ClientState state = enigma::graphics_apply_vertex_format(vertexBuffer->format, (GLvoid*)((intptr_t)base_pointer + offset));
 
   glDrawArrays(primitive_types[primitive], start, count);
+  enigma::profiler_draw_call(count);
 
   enigma::graphics_reset_client_state(state);
 }
@@ -289,6 +291,7 @@ void index_submit_range(int buffer, int vertex, int primitive, unsigned start, u
   }
 
   glDrawElements(primitive_types[primitive], count, indexType, (GLvoid*)((intptr_t)base_index_pointer + start));
+  enigma::profiler_draw_call(count);
 
   enigma::graphics_reset_client_state(state);
   if (enigma::vbo_is_supported)
@@ -1,12 +1,24 @@
 #include "Platforms/General/PFwindow.h"
+#include "Graphics_Systems/graphics_mandatory.h"
+#include "Graphics_Systems/General/GStextures_impl.h"
 
 namespace enigma {
 
 void msaa_fbo_blit() {}
+void gpu_timer_begin() {}
+void gpu_timer_end() {}
 void gl_screen_init() {}
 void init_vao() {}
 void graphics_flush_ext() {}
 
+unsigned char* graphics_copy_texture_pixels(int texture, int x, int y, int width, int height) {
+  return new unsigned char[width*height*4]();
+}
+
+std::unique_ptr<TextureReadback> graphics_begin_texture_readback(int texture, int x, int y, int width, int height) {
+  return std::make_unique<CopiedTextureReadback>(graphics_copy_texture_pixels(texture, x, y, width, height));
+}
+
 } // namespace enigma
 
 namespace enigma_user {
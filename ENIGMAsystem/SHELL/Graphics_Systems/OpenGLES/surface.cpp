@@ -39,6 +39,7 @@ void surface_set_target(int id)
   //This fixes several consecutive surface_set_target() calls without surface_reset_target.
   if (enigma::bound_framebuffer != 0) { d3d_transform_stack_pop(); d3d_projection_stack_pop();}
   enigma::bound_framebuffer = surf.fbo;
+  enigma::surface_target_changed(id);
   glBindFramebuffer(GL_FRAMEBUFFER, surf.fbo); //bind it
   d3d_transform_stack_push();
   d3d_projection_stack_push();
@@ -51,6 +52,7 @@ void surface_reset_target(void)
 {
   draw_batch_flush(batch_flush_deferred);
   enigma::bound_framebuffer = 0;
+  enigma::surface_target_changed(-1);
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
   d3d_transform_stack_pop();
   d3d_projection_stack_pop();
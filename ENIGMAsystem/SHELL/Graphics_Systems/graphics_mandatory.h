@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
 
 namespace enigma
 {
@@ -59,6 +60,13 @@ namespace enigma
   void graphics_push_texture_pixels(int texture, int x, int y, int width, int height, unsigned char* pxdata);
   void graphics_push_texture_pixels(int texture, int width, int height, unsigned char* pxdata);
 
+  #ifndef JUST_DEFINE_IT_RUN
+  struct TextureReadback;
+  /// Start reading a rectangle of a texture back without waiting for the GPU to finish
+  /// drawing it; see TextureReadback. Backends that can't do that copy the pixels at once.
+  std::unique_ptr<TextureReadback> graphics_begin_texture_readback(int texture, int x, int y, int width, int height);
+  #endif
+
   /// NOTE: The following texture functions are implemented generically from the ones above!
 
   /// Make an exact duplicate of a texture that will be assigned a new id.
@@ -33,6 +33,10 @@ int fputc_wrapper(int character, FILE_t* context);
 int feof_wrapper(FILE_t* context);
 int64_t ftell_wrapper(FILE_t* context);
 size_t fwrite_wrapper(const void *ptr, size_t size, size_t count, FILE_t* context);
+// Maps `length` bytes of the file starting at `offset` read-only. Returns NULL
+// where the backend can't map files; callers should fall back to fread_wrapper.
+const void* fmap_wrapper(FILE_t* context, int64_t offset, size_t length);
+void funmap_wrapper(const void* view, int64_t offset, size_t length);
 
 #include <string>
 
@@ -60,6 +64,8 @@ size_t file_bin_position(int fileid);
 void file_bin_seek(int fileid, size_t pos);
 void file_bin_write_byte(int fileid, unsigned char byte);
 int file_bin_read_byte(int fileid);
+unsigned file_bin_read_buffer(int fileid, int buffer, unsigned offset, unsigned size);
+unsigned file_bin_write_buffer(int fileid, int buffer, unsigned offset, unsigned size);
 
 } //namespace enigma_user
 
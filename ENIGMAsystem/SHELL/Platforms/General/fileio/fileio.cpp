@@ -1,5 +1,23 @@
 #include "Platforms/General/fileio.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static int64_t map_granularity() {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#else
+  return sysconf(_SC_PAGESIZE);
+#endif
+}
+
 size_t fread_wrapper(void* ptr, size_t size, size_t maxnum, FILE_t* context) { 
   return fread(ptr, size, maxnum, context);
 }
@@ -43,3 +61,31 @@ int64_t ftell_wrapper(FILE_t* context) {
 size_t fwrite_wrapper(const void *ptr, size_t size, size_t count, FILE_t* context) {
   return fwrite(ptr, size, count, context);
 }
+
+const void* fmap_wrapper(FILE_t* context, int64_t offset, size_t length) {
+  // Views must start on a granularity boundary; map from the one below offset
+  const int64_t base = offset - offset % map_granularity();
+  const size_t span = length + (offset - base);
+#ifdef _WIN32
+  HANDLE file = (HANDLE)_get_osfhandle(_fileno(context));
+  HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping) return NULL;
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, DWORD(uint64_t(base) >> 32), DWORD(base), span);
+  CloseHandle(mapping);  // The view keeps the mapping alive
+  if (!view) return NULL;
+#else
+  void* view = mmap(NULL, span, PROT_READ, MAP_PRIVATE, fileno(context), base);
+  if (view == MAP_FAILED) return NULL;
+#endif
+  return static_cast<const char*>(view) + (offset - base);
+}
+
+void funmap_wrapper(const void* view, int64_t offset, size_t length) {
+  const int64_t lead = offset % map_granularity();
+#ifdef _WIN32
+  (void) length;
+  UnmapViewOfFile(static_cast<const char*>(view) - lead);
+#else
+  munmap(const_cast<char*>(static_cast<const char*>(view) - lead), length + lead);
+#endif
+}
@@ -50,3 +50,9 @@ int64_t ftell_wrapper(FILE_t* context) {
 size_t fwrite_wrapper(const void *ptr, size_t size, size_t count, FILE_t* context) {
   return SDL_RWwrite(context, ptr, size, count);
 }
+
+const void* fmap_wrapper(FILE_t*, int64_t, size_t) {
+  return nullptr;  // RWops may be backed by assets or memory; nothing to map
+}
+
+void funmap_wrapper(const void*, int64_t, size_t) {}
@@ -16,6 +16,7 @@
 **/
 
 #include "ASYNCdialog.h"
+#include "ASYNCfile.h"
 #include "Widget_Systems/General/WSdialogs.h"
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
@@ -99,6 +100,7 @@ namespace enigma {
 
 void extension_async_init() {
   extension_update_hooks.push_back(process_async_jobs);
+  extension_update_hooks.push_back(process_async_files);
 }
 
 } // namespace enigma
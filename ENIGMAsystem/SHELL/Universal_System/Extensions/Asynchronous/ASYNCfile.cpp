@@ -0,0 +1,310 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "ASYNCfile.h"
+#include "ASYNCdialog.h"
+#include "Universal_System/Extensions/DataStructures/include.h"
+#include "Universal_System/Instances/instance_system.h"
+#include "Universal_System/Instances/instance.h"
+#include "Universal_System/buffers.h"
+#include "Universal_System/buffers_internal.h"
+#include "libEGMstd.h"
+
+// include after variant
+#include "implement.h"
+
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace enigma_user;
+
+namespace enigma {
+  namespace extension_cast {
+    extension_async *as_extension_async(object_basic*);
+  }
+}
+
+namespace {
+
+enum file_request_kind { load_buffer, save_buffer, load_text, save_text };
+
+struct file_request {
+  int id;
+  file_request_kind kind;
+  string filename;
+  int buffer;
+  unsigned long buffer_serial; // Of the buffer when requested, or 0 if there was none
+  unsigned offset;
+  int size;      // To load; -1 for the whole file
+  string data;   // Read, or to be written
+  bool status;   // Set by the I/O thread
+  bool finished; // Main thread only; set once the main thread has the result
+};
+typedef std::shared_ptr<file_request> request_ptr;
+
+bool read_file(file_request &request) {
+  std::ios::openmode mode = request.kind == load_text ? std::ios::in : std::ios::in | std::ios::binary;
+  std::ifstream file(request.filename.c_str(), mode | std::ios::ate);
+  const std::streamoff end = file.tellg();
+  if (!file.is_open() || end < 0) return false;
+  size_t size = end;
+  if (request.size >= 0) size = std::min<size_t>(size, request.size);
+  request.data.resize(size);
+  file.seekg(0);
+  file.read(&request.data[0], size);
+  // In text mode on Windows, line endings read shorter than the file is
+  request.data.resize(file.gcount());
+  return !file.bad();
+}
+
+bool write_file(file_request &request) {
+  std::ios::openmode mode = request.kind == save_text ? std::ios::out : std::ios::out | std::ios::binary;
+  std::ofstream file(request.filename.c_str(), mode | std::ios::trunc);
+  if (!file.is_open()) return false;
+  file.write(request.data.data(), request.data.size());
+  file.close();
+  return !file.fail();
+}
+
+// Two threads are enough to keep a read going beside a write; more would
+// mostly queue up on the same disk. They're started on the first request and
+// kept for the rest of the game.
+struct file_worker_pool {
+  static const unsigned thread_count = 2;
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable wake, finished;
+  std::deque<request_ptr> queue;
+  std::set<string> busy;         // Files a thread is working on
+  std::vector<request_ptr> done; // Waiting for the main thread
+  // What the biggest save so far was written from, kept for the next save's
+  // copy; copying into fresh memory costs several times what copying does.
+  string spare;
+  bool stopping = false;
+
+  // Queued saves still go through, so that the last save before the game
+  // ends isn't lost; queued loads have nobody left to deliver to.
+  ~file_worker_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.erase(std::remove_if(queue.begin(), queue.end(), [](const request_ptr &request) {
+        return request->kind == load_buffer || request->kind == load_text;
+      }), queue.end());
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) thread.join();
+  }
+
+  // The first queued request that no earlier one, running or queued, is using
+  // the file of; mutex held.
+  std::deque<request_ptr>::iterator next() {
+    std::set<string> blocked;
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+      if (!busy.count((*it)->filename) && !blocked.count((*it)->filename)) return it;
+      blocked.insert((*it)->filename);
+    }
+    return queue.end();
+  }
+
+  void worker() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      std::deque<request_ptr>::iterator it;
+      wake.wait(lock, [&] { return (it = next()) != queue.end() || (stopping && queue.empty()); });
+      if (it == queue.end()) return;
+      request_ptr request = *it;
+      queue.erase(it);
+      busy.insert(request->filename);
+      lock.unlock();
+      const bool load = request->kind == load_buffer || request->kind == load_text;
+      request->status = load ? read_file(*request) : write_file(*request);
+      lock.lock();
+      if (!load) {
+        if (request->data.capacity() > spare.capacity()) spare.swap(request->data);
+        string().swap(request->data);
+      }
+      busy.erase(request->filename);
+      done.push_back(request);
+      finished.notify_all();
+      // Whatever was waiting on this file can go now
+      wake.notify_all();
+    }
+  }
+
+  void submit(const request_ptr &request) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      while (threads.size() < thread_count) threads.emplace_back([this] { worker(); });
+      queue.push_back(request);
+    }
+    wake.notify_one();
+  }
+
+  string take_spare() {
+    std::lock_guard<std::mutex> lock(mutex);
+    string storage;
+    storage.swap(spare);
+    return storage;
+  }
+
+  // True if the request hadn't started, and now won't
+  bool remove(int id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+      if ((*it)->id != id) continue;
+      queue.erase(it);
+      return true;
+    }
+    return false;
+  }
+
+  // Moves the finished requests into out, first waiting for one if asked.
+  void collect(std::vector<request_ptr> &out, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (wait) finished.wait(lock, [&] { return !done.empty(); });
+    out.insert(out.end(), done.begin(), done.end());
+    done.clear();
+  }
+};
+
+file_worker_pool workers;
+int next_request = 0;
+std::map<int, request_ptr> requests; // Not yet delivered, by id
+std::set<int> cancelled;
+
+void fireAsyncSaveLoadEvent() {
+  enigma::instance_event_iterator = &enigma::dummy_event_iterator;
+  for (enigma::iterator it = enigma::instance_list_first(); it; ++it)
+  {
+    enigma::object_basic* const inst = ((enigma::object_basic*)*it);
+    enigma::extension_async* const inst_async = enigma::extension_cast::as_extension_async(inst);
+    inst_async->myevent_saveload();
+  }
+}
+
+void deliver(file_request &request) {
+  if (request.kind == load_buffer && request.status) {
+    // The buffer may have gone since the request was made, and another taken its id
+    if (buffer_exists(request.buffer) && enigma::buffers[request.buffer]->serial == request.buffer_serial)
+      enigma::buffers[request.buffer]->WriteAt(request.offset, request.data.data(), request.data.size());
+    else
+      request.status = false;
+  }
+  ds_map_overwrite(async_load, "id", request.id);
+  ds_map_overwrite(async_load, "status", request.status);
+  if (request.kind == load_text) ds_map_overwrite(async_load, "result", request.data);
+  fireAsyncSaveLoadEvent();
+}
+
+// Fires the events of finished requests up to the last id given, lowest id
+// first; each waits for every one before it.
+void deliver_files(bool wait = false, int last = INT_MAX) {
+  if (requests.empty()) return;
+  std::vector<request_ptr> loaded;
+  workers.collect(loaded, wait);
+  for (const request_ptr &request : loaded) request->finished = true;
+  while (!requests.empty() && requests.begin()->first <= last && requests.begin()->second->finished) {
+    request_ptr request = requests.begin()->second;
+    requests.erase(requests.begin());
+    deliver(*request);
+  }
+}
+
+int queue_file_request(file_request_kind kind, const string &filename, string data = string(),
+                       int buffer = -1, unsigned offset = 0, int size = -1) {
+  if (!ds_map_exists(async_load)) async_load = ds_map_create();
+  request_ptr request = std::make_shared<file_request>();
+  request->id = next_request++;
+  request->kind = kind;
+  request->filename = filename;
+  request->buffer = buffer;
+  request->buffer_serial = buffer_exists(buffer) ? enigma::buffers[buffer]->serial : 0;
+  request->offset = offset;
+  request->size = size;
+  request->data.swap(data);
+  request->status = false;
+  request->finished = false;
+  requests[request->id] = request;
+  workers.submit(request);
+  return request->id;
+}
+
+}
+
+namespace enigma {
+
+void process_async_files() {
+  deliver_files();
+}
+
+} // namespace enigma
+
+namespace enigma_user {
+  int buffer_load_async(int buffer, string filename, unsigned offset, int size) {
+    return queue_file_request(load_buffer, filename, string(), buffer, offset, size);
+  }
+
+  int buffer_save_async(int buffer, string filename, unsigned offset, unsigned size) {
+    get_bufferr(binbuff, buffer, -1);
+    string data = workers.take_spare();
+    data.clear();
+    if (offset < binbuff->GetSize()) {
+      size = std::min(size, binbuff->GetSize() - offset);
+      data.assign(reinterpret_cast<const char*>(&binbuff->data[offset]), size);
+    }
+    return queue_file_request(save_buffer, filename, std::move(data));
+  }
+
+  int file_text_load_async(string filename) {
+    return queue_file_request(load_text, filename);
+  }
+
+  int file_text_save_async(string filename, string text) {
+    return queue_file_request(save_text, filename, std::move(text));
+  }
+
+  bool file_async_cancel(int request) {
+    auto it = requests.find(request);
+    if (it == requests.end()) return false;
+    // A request already running finishes, but nothing hears of it
+    workers.remove(request);
+    requests.erase(it);
+    cancelled.insert(request);
+    return true;
+  }
+
+  int file_async_status(int request) {
+    if (request < 0 || request >= next_request || cancelled.count(request)) return -1;
+    return requests.count(request) ? 0 : 1;
+  }
+
+  bool file_async_wait(int request) {
+    if (request < 0 || request >= next_request) return false;
+    deliver_files(false, request);
+    while (requests.count(request)) deliver_files(true, request);
+    return !cancelled.count(request);
+  }
+}
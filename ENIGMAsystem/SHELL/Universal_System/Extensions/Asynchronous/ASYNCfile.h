@@ -0,0 +1,54 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_ASYNCFILE_H
+#define ENIGMA_ASYNCFILE_H
+
+#include <string>
+using std::string;
+
+namespace enigma {
+
+void process_async_files();
+
+} // namespace enigma
+
+// Each of these runs on an I/O thread and returns a request id at once. When it
+// finishes, the Save/Load event fires with async_load holding the "id" and a
+// "status" of whether it worked. Requests finish in the order they were made,
+// and those on the same file also run in that order.
+namespace enigma_user {
+  // Reads up to size bytes of the file (all of it when size is -1) into the
+  // buffer at offset, once the event fires; the buffer grows or wraps as it would
+  // for buffer_write.
+  int buffer_load_async(int buffer, string filename, unsigned offset, int size);
+  // Saves size bytes of the buffer from offset, as they are when called.
+  int buffer_save_async(int buffer, string filename, unsigned offset, unsigned size);
+  // async_load's "result" holds the file's text.
+  int file_text_load_async(string filename);
+  int file_text_save_async(string filename, string text);
+
+  // Keeps the request's event from firing, and the request from running if it
+  // hasn't started; false if it already fired or was cancelled.
+  bool file_async_cancel(int request);
+  // 1 once the event has fired, 0 while pending, -1 for an unknown or cancelled request
+  int file_async_status(int request);
+  // Blocks until the request's event has fired, firing any before it, so that
+  // async_load holds its results; false if it never will
+  bool file_async_wait(int request);
+}
+
+#endif // ENIGMA_ASYNCFILE_H
@@ -31,6 +31,7 @@ namespace enigma {
     virtual variant myevent_asyncsteam() { return 0; }
     virtual variant myevent_asyncsocial() { return 0; }
     virtual variant myevent_asyncpushnotification() { return 0; }
+    virtual variant myevent_saveload() { return 0; }
   };
 }
 
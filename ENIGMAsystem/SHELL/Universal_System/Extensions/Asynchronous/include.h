@@ -16,3 +16,4 @@
 **/
 
 #include "ASYNCdialog.h"
+#include "ASYNCfile.h"
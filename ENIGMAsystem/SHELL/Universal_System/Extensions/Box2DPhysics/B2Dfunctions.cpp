@@ -26,6 +26,7 @@
 #include "Box2DWorld.h"
 #include "Box2DShape.h"
 #include "B2Dfunctions.h"
+#include <cmath>
 bool systemPaused = false;
 
 vector<B2DWorld*> b2dworlds(0);
@@ -33,13 +34,41 @@ vector<B2DBody*> b2dbodies;
 
 void B2DWorld::world_update()
 {
-  if (!systemPaused && !paused) {
+  if (systemPaused || paused) return;
+  interpolation = 1;
+  world_step(1);
+}
+
+void B2DWorld::world_advance(double elapsed)
+{
+  if (systemPaused || paused) return;
+  int steps = updates;
+  if (realtime) {
+    accumulator += elapsed;
+    steps = int(accumulator / timeStep);
+    if (steps > max_updates) steps = max_updates;
+    accumulator -= steps * timeStep;
+    if (accumulator >= timeStep) accumulator = fmod(accumulator, timeStep);
+    interpolation = accumulator / timeStep;
+  } else {
+    interpolation = 1;
+  }
+  world_step(steps);
+}
+
+void B2DWorld::world_step(int steps)
+{
+  for (int i = 0; i < steps; i++) {
+    if (i + 1 == steps) {
+      for (b2Body* b = world->GetBodyList(); b; b = b->GetNext()) {
+        static_cast<B2DBody*>(b->GetUserData())->settle();
+      }
+    }
     world->Step(timeStep, velocityIterations, positionIterations);
-    world->ClearForces();
   }
+  if (steps) world->ClearForces();
 }
 
-#include <cmath>
 #include <cstdlib>
 #include <string>
 using std::string;
@@ -47,11 +76,10 @@ using std::string;
 namespace enigma {
   bool has_been_initialized = false;
 
+  void box2dphysics_update();
+
   void update_worlds_automatically() {
-    vector<B2DWorld*>::iterator it_end = b2dworlds.end();
-    for (vector<B2DWorld*>::iterator it = b2dworlds.begin(); it != it_end; it++) {
-      (*it)->world_update();
-    }
+    box2dphysics_update();
   }
 
   // Should be called whenever a world is created.
@@ -89,6 +117,7 @@ void b2d_world_delete(int index)
 {
   get_world(b2dworld, index);
   delete b2dworld;
+  b2dworlds[index] = NULL;
 }
 
 void b2d_world_pause_enable(int index, bool paused)
@@ -107,6 +136,7 @@ void b2d_world_update(int index)
 {
   get_world(b2dworld, index);
   b2dworld->world_update();
+  enigma::box2d_place_instances(b2dworld);
 }
 
 void b2d_world_update_settings(int index, double timeStep, int velocityIterations, int positionIterations)
@@ -131,14 +161,29 @@ void b2d_world_update_iterations(int index, int iterationsperstep)
 
 void b2d_world_update_speed(int updatesperstep)
 {
-  // provide overloads if we do adopt this system so that you can still
-  // change indexed worlds
+  for (vector<B2DWorld*>::iterator it = b2dworlds.begin(); it != b2dworlds.end(); it++) {
+    if (*it) (*it)->updates = updatesperstep;
+  }
 }
 
 void b2d_world_update_speed(int index, int updatesperstep)
 {
-  // this sets the number of updates the physics system takes each step
-  // not needed for the current implementation
+  get_world(b2dworld, index);
+  b2dworld->updates = updatesperstep;
+}
+
+void b2d_world_update_realtime(int index, bool realtime, int maxupdates)
+{
+  get_world(b2dworld, index);
+  b2dworld->realtime = realtime;
+  b2dworld->max_updates = maxupdates;
+  b2dworld->accumulator = 0;
+}
+
+double b2d_world_get_interpolation(int index)
+{
+  get_worldr(b2dworld, index, 1);
+  return b2dworld->interpolation;
 }
 
 void b2d_world_draw_debug()
@@ -269,6 +314,8 @@ int b2d_body_create(int world)
   b2BodyDef bodyDef;
   bodyDef.type = b2_dynamicBody;
   b2dbody->body = b2dworld->world->CreateBody(&bodyDef);
+  b2dbody->body->SetUserData(b2dbody);
+  b2dbody->settle();
   b2dbodies.push_back(b2dbody);
   b2dbodies[i]->world = world;
   return i;
@@ -302,6 +349,7 @@ int b2d_body_create_circle(int world, double radius)
 void b2d_body_bind(int id, int obj)
 {
   get_body(b2dbody, id);
+  b2dbody->instance = obj;
 }
 
 void b2d_body_delete(int id)
@@ -333,18 +381,21 @@ void b2d_body_set_transform(int id, double x, double y, double angle)
 {
   get_body(b2dbody, id);
   b2dbody->body->SetTransform(b2Vec2(x, y), cs_angle_to_radians(angle));
+  b2dbody->settle();
 }
 
 void b2d_body_set_position(int id, double x, double y)
 {
   get_body(b2dbody, id);
   b2dbody->body->SetTransform(b2Vec2(x, y), b2dbodies[id]->body->GetAngle());
+  b2dbody->settle();
 }
 
 void b2d_body_set_angle(int id, double angle)
 {
   get_body(b2dbody, id);
   b2dbody->body->SetTransform(b2dbodies[id]->body->GetPosition(), cs_angle_to_radians(angle));
+  b2dbody->settle();
 }
 
 void b2d_body_set_angle_fixed(int id, bool fixed)
@@ -38,6 +38,15 @@ void b2d_world_dump(int index);
 void b2d_world_update_settings(int index, double timeStep, int velocityIterations, int positionIterations);
 void b2d_world_update_iterations(int index, int iterationsperstep);
 void b2d_world_update_speed(int index, int updatesperstep);
+void b2d_world_update_speed(int updatesperstep);
+// Step as often as real time calls for, rather than a set number of times each
+// game step; bound instances are placed between the last two steps to match
+void b2d_world_update_realtime(int index, bool realtime, int maxupdates = 8);
+double b2d_world_get_interpolation(int index);
+// Threads worlds are stepped on; 0 means one per hardware thread. The default
+// is 1: Box2D 2.3 updates a few global statistics counters without locking,
+// so stepping worlds in parallel races on them.
+void b2d_world_update_threads(int count);
 void b2d_world_clear_forces(int index);
 void b2d_world_set_gravity(int index, double gx, double gy);
 void b2d_world_set_scale(int index, int pixelstometers);
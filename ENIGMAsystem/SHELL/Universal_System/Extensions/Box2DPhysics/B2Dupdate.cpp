@@ -16,15 +16,64 @@
 **/
 
 #include "Box2DWorld.h"
+#include "B2Dfunctions.h"
+#include "Platforms/General/PFmain.h"
+#include "Universal_System/Instances/instance_system_base.h"
+#include "Universal_System/Object_Tiers/graphics_object.h"
+#include "Universal_System/scalar.h"
+#include "Universal_System/worker_pool.h"
 
 #include <vector>
 using std::vector;
 
 namespace enigma {
+  namespace {
+    // Each world has its own allocators and islands, so separate worlds can
+    // mostly be stepped at once. Box2D 2.3 still counts GJK and TOI calls in
+    // unsynchronized globals (b2_gjkCalls, b2_toiCalls and so on), which
+    // threads stepping worlds at once race on. Only those statistics suffer,
+    // but it is a data race all the same, so worlds are stepped one after
+    // another unless the game asks for threads with b2d_world_update_threads.
+    worker_pool workers;
+    int world_thread_count = 1; // 0 means one per hardware thread.
+    vector<B2DWorld*> advancing;
+  }
+
   void box2dphysics_update() {
+    const double elapsed = enigma_user::delta_time / 1000000.0;
+    advancing.clear();
     for (std::vector<B2DWorld*>::iterator it = b2dworlds.begin(); it != b2dworlds.end(); it++) {
-      (*it)->world_update();
+      if (*it) advancing.push_back(*it);
+    }
+
+    workers.parallel_for(world_thread_count, advancing.size(), [elapsed](size_t i) {
+      advancing[i]->world_advance(elapsed);
+    });
+
+    // Instances are only touched from here, once every world is done.
+    for (std::vector<B2DWorld*>::iterator it = advancing.begin(); it != advancing.end(); it++) {
+      box2d_place_instances(*it);
+    }
+  }
+
+  void box2d_place_instances(B2DWorld* world) {
+    const double t = world->interpolation;
+    for (b2Body* b = world->world->GetBodyList(); b; b = b->GetNext()) {
+      const B2DBody* body = static_cast<const B2DBody*>(b->GetUserData());
+      if (body->instance == -4) continue;
+      object_graphics* inst = static_cast<object_graphics*>(fetch_instance_by_int(body->instance));
+      if (!inst) continue;
+      const b2Vec2 position = b->GetPosition();
+      inst->x = body->previous_position.x + (position.x - body->previous_position.x) * t;
+      inst->y = body->previous_position.y + (position.y - body->previous_position.y) * t;
+      inst->image_angle = -cs_angle_from_radians(body->previous_angle + (b->GetAngle() - body->previous_angle) * t);
     }
   }
 }
 
+namespace enigma_user {
+  void b2d_world_update_threads(int count)
+  {
+    enigma::world_thread_count = count > 0 ? count : 0;
+  }
+}
@@ -34,6 +34,16 @@ struct B2DWorld {
   int32 positionIterations;
   int32 pixelstometers;
   bool paused;
+  // Steps taken each game step, unless stepping in real time.
+  int updates;
+  // In real time, the world takes as many steps as the time elapsed since the
+  // last game step calls for, up to max_updates; any more time is dropped.
+  bool realtime;
+  int max_updates;
+  double accumulator; // Seconds elapsed that are yet to be stepped.
+  // How far real time has gone from the last step toward the next, 0 to 1.
+  // Bound instances are placed that far between their last two positions.
+  double interpolation;
 
   B2DWorld()
   {
@@ -44,24 +54,54 @@ struct B2DWorld {
     world = new b2World(gravity);
     timeStep = 1.0f / 60.0f;
     velocityIterations = 8;
+    positionIterations = 3;
     pixelstometers = 32;
     paused = false;
+    updates = 1;
+    realtime = false;
+    max_updates = 8;
+    accumulator = 0;
+    interpolation = 1;
   }
 
+  // A single step, as b2d_world_update takes; the time since the last
+  // game step makes no difference.
   void world_update();
+  // The automatic update, given the seconds since the last game step.
+  // Touches nothing outside this world and Box2D's own globals.
+  void world_advance(double elapsed);
+  // Takes the steps, remembering each body's transform before the last one.
+  void world_step(int steps);
 };
 extern vector<B2DWorld*> b2dworlds;
 
+namespace enigma {
+  // Moves the instances bound to the world's bodies to where its last update
+  // left them, interpolated as it calls for.
+  void box2d_place_instances(B2DWorld* world);
+}
+
 struct B2DBody {
   int world;
   vector<int> fixtures;
   b2Body* body;
+  int instance; // Moved along with the body, or noone.
+  // Where the body was before its world's last step, to interpolate from.
+  b2Vec2 previous_position;
+  float32 previous_angle;
 
-  B2DBody()
+  B2DBody(): instance(-4), previous_angle(0)
   {
 
   }
 
+  // Forget the previous step's transform, as after teleporting the body.
+  void settle()
+  {
+    previous_position = body->GetPosition();
+    previous_angle = body->GetAngle();
+  }
+
   ~B2DBody()
   {
     this->body->GetWorld()->DestroyBody(this->body);
@@ -27,11 +27,15 @@
  \********************************************************************************/
 
 #include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include <random>
 #include <algorithm>
 #include <iterator>
 #include <map>
 #include <deque>
+#include <functional>
 #include <vector>
 
 #include <sstream>
@@ -39,9 +43,20 @@
 
 #include <floatcomp.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENIGMA_GRID_SSE 1
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 #include "include.h"
+#include "data_structures_internal.h"
+
+using enigma::ds_mark;
+using enigma::ds_unmarked;
+using enigma::ds_marked_map;
+using enigma::ds_marked_list;
 
 template<typename T> static inline T maxv(T a, T b) { return (a > b) ? a : b; }
 template<typename T> static inline T minv(T a, T b) { return (a < b) ? a : b; }
@@ -57,54 +72,198 @@ void mt_random_shuffle(RandomIt first, RandomIt last) {
   std::shuffle(first, last, g);
 }
 
+// Row kernels for grid, over the count cells from row on. The double versions
+// of the reductions are where numeric grids spend their time, so they go two
+// lanes at a time with SSE2 where it's there; the compiler vectorizes the
+// element-wise ones well enough on its own.
+template <typename t, typename u> static inline void row_set(t *row, unsigned count, const u &val)
+{
+    for (unsigned i = 0; i < count; i++) row[i] = val;
+}
+template <typename t, typename u> static inline void row_add(t *row, unsigned count, const u &val)
+{
+    for (unsigned i = 0; i < count; i++) row[i] += val;
+}
+template <typename t> static inline void row_multiply(t *row, unsigned count, const double val)
+{
+    for (unsigned i = 0; i < count; i++) row[i] *= val;
+}
+// These go front to back, as the source may be the same row
+template <typename t, typename u> static inline void row_set_from(t *row, const u *source, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) row[i] = source[i];
+}
+template <typename t, typename u> static inline void row_add_from(t *row, const u *source, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) row[i] += source[i];
+}
+template <typename t, typename u> static inline void row_multiply_from(t *row, const u *source, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++) row[i] *= source[i];
+}
+template <typename t> static inline void row_sum(const t *row, unsigned count, t &sum)
+{
+    for (unsigned i = 0; i < count; i++) sum += row[i];
+}
+template <typename t> static inline void row_max(const t *row, unsigned count, t &best)
+{
+    for (unsigned i = 0; i < count; i++) if (row[i] > best) best = row[i];
+}
+template <typename t> static inline void row_min(const t *row, unsigned count, t &best)
+{
+    for (unsigned i = 0; i < count; i++) if (row[i] < best) best = row[i];
+}
+// The index of the first cell equal to val, or -1
+template <typename t> static inline long row_find(const t *row, unsigned count, const t &val)
+{
+    for (unsigned i = 0; i < count; i++) if (tequal(row[i], val)) return i;
+    return -1;
+}
+
+static inline void row_sum(const double *row, unsigned count, double &sum)
+{
+    unsigned i = 0;
+#ifdef ENIGMA_GRID_SSE
+    __m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4)
+    {
+        a = _mm_add_pd(a, _mm_loadu_pd(row + i));
+        b = _mm_add_pd(b, _mm_loadu_pd(row + i + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(a, b));
+    sum += lanes[0] + lanes[1];
+#endif
+    for (; i < count; i++) sum += row[i];
+}
+static inline void row_max(const double *row, unsigned count, double &best)
+{
+    unsigned i = 0;
+#ifdef ENIGMA_GRID_SSE
+    __m128d m = _mm_set1_pd(best);
+    for (; i + 2 <= count; i += 2) m = _mm_max_pd(m, _mm_loadu_pd(row + i));
+    best = maxv(_mm_cvtsd_f64(m), _mm_cvtsd_f64(_mm_unpackhi_pd(m, m)));
+#endif
+    for (; i < count; i++) if (row[i] > best) best = row[i];
+}
+static inline void row_min(const double *row, unsigned count, double &best)
+{
+    unsigned i = 0;
+#ifdef ENIGMA_GRID_SSE
+    __m128d m = _mm_set1_pd(best);
+    for (; i + 2 <= count; i += 2) m = _mm_min_pd(m, _mm_loadu_pd(row + i));
+    best = minv(_mm_cvtsd_f64(m), _mm_cvtsd_f64(_mm_unpackhi_pd(m, m)));
+#endif
+    for (; i < count; i++) if (row[i] < best) best = row[i];
+}
+// Reals stand in for variants here, so they compare as variants do
+static inline long row_find(const double *row, unsigned count, const double &val)
+{
+    for (unsigned i = 0; i < count; i++)
+        if (row[i] - variant::epsilon <= val && row[i] + variant::epsilon >= val) return i;
+    return -1;
+}
+
 template <typename t>
 class grid
 {
+    template <typename> friend class grid;
+
     unsigned int xgrid, ygrid;
-    t *grid_array;
+    vector<t> grid_array;
+
+    t* row(int y) { return grid_array.data() + size_t(y) * xgrid; }
+    const t* row(int y) const { return grid_array.data() + size_t(y) * xgrid; }
+    // Clips the region of source from corner (sx1, sy1) to (sx2, sy2), placed
+    // at (x, y) in this grid, to both grids: upx by upy cells from (tx1, ty1)
+    // in source, to (dx, dy) here
+    template <typename u>
+    bool clip_grid_region(const grid<u>& source, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y, int &tx1, int &ty1, int &dx, int &dy, int &upx, int &upy) const
+    {
+        if (x >= xgrid || y >= ygrid) return false;
+        tx1 = minv(int(sx1), int(sx2)); ty1 = minv(int(sy1), int(sy2)); dx = x; dy = y;
+        const int tx2 = maxv(int(sx1), int(sx2)), ty2 = maxv(int(sy1), int(sy2));
+        // Cells left of or above source would land left of or above (x, y)
+        if (tx1 < 0) dx -= tx1, tx1 = 0;
+        if (ty1 < 0) dy -= ty1, ty1 = 0;
+        if (dx >= int(xgrid) || dy >= int(ygrid) || tx1 >= int(source.xgrid) || ty1 >= int(source.ygrid)) return false;
+        upx = minv(tx2 - tx1 + 1, minv(int(xgrid) - dx, int(source.xgrid) - tx1));
+        upy = minv(ty2 - ty1 + 1, minv(int(ygrid) - dy, int(source.ygrid) - ty1));
+        return upx > 0 && upy > 0;
+    }
 
     public:
-    grid() {}
-    grid(const unsigned int w, const unsigned int h) {
-      ygrid = h; xgrid = w; grid_array = new t[w*h];
-    }
-    ~grid() {}
+    grid(): xgrid(0), ygrid(0) {}
+    grid(const unsigned int w, const unsigned int h): xgrid(w), ygrid(h), grid_array(size_t(w) * h) {}
 
-    void destroy()
+    // Takes on the size and cells of another kind of grid
+    template <typename u> void assign(const grid<u>& source)
+    {
+        xgrid = source.xgrid;
+        ygrid = source.ygrid;
+        grid_array.assign(source.grid_array.begin(), source.grid_array.end());
+    }
+    const t* data() const
+    {
+        return grid_array.data();
+    }
+    // Clips the region between two corners to the grid, as the cells from
+    // (px1, py1) up to but not including (px2, py2); false if none are left.
+    // Corners come in unsigned, but negative ones clip like any other.
+    bool clip_region(const unsigned int x1, const unsigned int y1, const unsigned int x2, const unsigned int y2, int &px1, int &py1, int &px2, int &py2) const
     {
-        delete[] grid_array;
+        const int tx1 = minv(int(x1), int(x2)), ty1 = minv(int(y1), int(y2)), tx2 = maxv(int(x1), int(x2)), ty2 = maxv(int(y1), int(y2)), xd = xgrid - tx1, yd = ygrid - ty1;
+        if (xd <= 0 || yd <= 0) return false;
+        px1 = maxv(tx1, 0); py1 = maxv(ty1, 0); px2 = minv(tx2 + 1, (int)xgrid); py2 = minv(ty2 + 1, (int)ygrid);
+        return px1 < px2 && py1 < py2;
     }
+    // Calls f(y, x1, x2) for each row y with cells in the disk, in order, where
+    // those are x1 to x2 inclusive. Returns false if the disk misses the grid.
+    template <typename F> bool for_disk_rows(const double x, const double y, const double r, F f) const
+    {
+        const double rr = r*r;
+        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
+        if (tx2 < 0 || ty2 < 0 || tx1 >= int(xgrid) || ty1 >= int(ygrid)) return false;
+        const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
+        for (int i = py1; i < py2; i++)
+        {
+            const double dy2 = (y - i)*(y - i);
+            if (!(dy2 <= rr)) continue;
+            const auto inside = [&](int ii) { return (x - ii)*(x - ii) + dy2 <= rr; };
+            // The cells inside are a single run, as they only get farther from
+            // the center going out; sqrt finds its ends to within a cell, and
+            // the same test as for single cells settles them
+            const double half = sqrt(rr - dy2);
+            int lo = int(minv(maxv(ceil(x - half), double(px1)), double(px2))), hi;
+            while (lo > px1 && inside(lo - 1)) lo--;
+            while (lo < px2 && !inside(lo)) lo++;
+            hi = int(minv(maxv(floor(x + half), double(lo - 1)), double(px2 - 1)));
+            while (hi + 1 < px2 && inside(hi + 1)) hi++;
+            while (hi >= lo && !inside(hi)) hi--;
+            if (lo <= hi) f(i, lo, hi);
+        }
+        return true;
+    }
+
     void clear(const t val)
     {
-        for (unsigned i = 0; i < ygrid; i++)
-            for (unsigned ii = 0; ii < xgrid; ii++)
-                grid_array[i * xgrid + ii] = val;
+        row_set(grid_array.data(), grid_array.size(), val);
     }
     void resize(unsigned w, unsigned h)
     {
-        grid<variant> temp(w, h);
+        // New cells are 0, as in GM
+        vector<t> resized(size_t(w) * h, t(0));
         const unsigned int wm = minv(xgrid, w), hm = minv(ygrid, h);
         for (unsigned i = 0; i < hm; i++)
-            for (unsigned ii = 0; ii < wm; ii++)
-                temp.grid_array[i * w + ii] = grid_array[i * xgrid + ii];
-        delete[] grid_array;
-        (*this) = temp;
+            std::move(row(i), row(i) + wm, resized.begin() + size_t(i) * w);
+        grid_array.swap(resized);
+        xgrid = w; ygrid = h;
     }
-    void copy(const grid& copy_id)
-    {
-        delete[] grid_array;
-        grid_array = new t[copy_id.ygrid*copy_id.xgrid];
-        xgrid = copy_id.xgrid;
-        ygrid = copy_id.ygrid;
-        for (unsigned i = 0; i < ygrid; i++)
-            for (unsigned ii = 0; ii < xgrid; ii++)
-                grid_array[i * xgrid + ii] = copy_id.grid_array[i * copy_id.xgrid + ii];
-    }
-    unsigned int width()
+    unsigned int width() const
     {
         return xgrid;
     }
-    unsigned int height()
+    unsigned int height() const
     {
         return ygrid;
     }
@@ -125,360 +284,985 @@ class grid
     }
     void insert_region(const unsigned int x1, const unsigned int y1, unsigned int x2, const unsigned int y2, const t val)
     {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   grid_array[i * xgrid + ii] = val;
-       }
+        int px1, py1, px2, py2;
+        if (clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            for (int i = py1; i < py2; i++)
+                row_set(row(i) + px1, px2 - px1, val);
     }
     void add_region(const unsigned int x1, const unsigned int y1, unsigned int x2, const unsigned int y2, const t val)
     {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   grid_array[i * xgrid + ii] += val;
-       }
+        int px1, py1, px2, py2;
+        if (clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            for (int i = py1; i < py2; i++)
+                row_add(row(i) + px1, px2 - px1, val);
     }
     void multiply_region(const unsigned int x1, const unsigned int y1, unsigned int x2, const unsigned int y2, const double val)
     {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   grid_array[i * xgrid + ii] *= val;
-       }
+        int px1, py1, px2, py2;
+        if (clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            for (int i = py1; i < py2; i++)
+                row_multiply(row(i) + px1, px2 - px1, val);
     }
     void insert_disk(const double x, const double y, const double r, const t val)
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
-        {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        grid_array[i * xgrid + ii] = val;
-        }
+        for_disk_rows(x, y, r, [&](int i, int lo, int hi) { row_set(row(i) + lo, hi - lo + 1, val); });
     }
     void add_disk(const double x, const double y, const double r, const t val)
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
-        {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        grid_array[i * xgrid + ii] += val;
-        }
+        for_disk_rows(x, y, r, [&](int i, int lo, int hi) { row_add(row(i) + lo, hi - lo + 1, val); });
     }
     void multiply_disk(const double x, const double y, const double r, const double val)
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        for_disk_rows(x, y, r, [&](int i, int lo, int hi) { row_multiply(row(i) + lo, hi - lo + 1, val); });
+    }
+    template <typename u>
+    void insert_grid_region(const grid<u>& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    {
+        int tx1, ty1, dx, dy, upx, upy;
+        if (clip_grid_region(source_id, sx1, sy1, sx2, sy2, x, y, tx1, ty1, dx, dy, upx, upy))
+            for (int i = 0; i < upy; i++)
+                row_set_from(row(dy + i) + dx, source_id.row(ty1 + i) + tx1, upx);
+    }
+    template <typename u>
+    void add_grid_region(const grid<u>& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    {
+        int tx1, ty1, dx, dy, upx, upy;
+        if (clip_grid_region(source_id, sx1, sy1, sx2, sy2, x, y, tx1, ty1, dx, dy, upx, upy))
+            for (int i = 0; i < upy; i++)
+                row_add_from(row(dy + i) + dx, source_id.row(ty1 + i) + tx1, upx);
+    }
+    template <typename u>
+    void multiply_grid_region(const grid<u>& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    {
+        int tx1, ty1, dx, dy, upx, upy;
+        if (clip_grid_region(source_id, sx1, sy1, sx2, sy2, x, y, tx1, ty1, dx, dy, upx, upy))
+            for (int i = 0; i < upy; i++)
+                row_multiply_from(row(dy + i) + dx, source_id.row(ty1 + i) + tx1, upx);
+    }
+
+    // The queries return an undefined variant where the region or disk misses
+    // the grid
+    t find(unsigned int x, unsigned int y) const
+    {
+        return (grid_array[y * xgrid + x]);
+    }
+    variant find_region_sum(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
+    {
+        int px1, py1, px2, py2;
+        if (!clip_region(x1, y1, x2, y2, px1, py1, px2, py2)) return variant();
+        t sum = 0;
+        for (int i = py1; i < py2; i++)
+            row_sum(row(i) + px1, px2 - px1, sum);
+        return sum;
+    }
+    variant find_region_max(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
+    {
+        int px1, py1, px2, py2;
+        if (!clip_region(x1, y1, x2, y2, px1, py1, px2, py2)) return variant();
+        t max_check = row(py1)[px1];
+        for (int i = py1; i < py2; i++)
+            row_max(row(i) + px1, px2 - px1, max_check);
+        return max_check;
+    }
+    variant find_region_min(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
+    {
+        int px1, py1, px2, py2;
+        if (!clip_region(x1, y1, x2, y2, px1, py1, px2, py2)) return variant();
+        t min_check = row(py1)[px1];
+        for (int i = py1; i < py2; i++)
+            row_min(row(i) + px1, px2 - px1, min_check);
+        return min_check;
+    }
+    variant find_region_mean(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
+    {
+        int px1, py1, px2, py2;
+        if (!clip_region(x1, y1, x2, y2, px1, py1, px2, py2)) return variant();
+        t sum = 0;
+        for (int i = py1; i < py2; i++)
+            row_sum(row(i) + px1, px2 - px1, sum);
+        const double region_size = (py2 - py1)*(px2 - px1);
+        return sum/region_size;
+    }
+    variant find_disk_sum(const double x, const double y, const double r) const
+    {
+        t sum = 0;
+        if (!for_disk_rows(x, y, r, [&](int i, int lo, int hi) { row_sum(row(i) + lo, hi - lo + 1, sum); }))
+            return variant();
+        return sum;
+    }
+    variant find_disk_max(const double x, const double y, const double r) const
+    {
+        t max_check = 0;
+        bool any = false;
+        for_disk_rows(x, y, r, [&](int i, int lo, int hi)
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        grid_array[i * xgrid + ii] *= val;
-        }
+            if (!any) max_check = row(i)[lo], any = true;
+            row_max(row(i) + lo, hi - lo + 1, max_check);
+        });
+        return any ? variant(max_check) : variant();
     }
-    void insert_grid_region(const grid& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    variant find_disk_min(const double x, const double y, const double r) const
     {
-        if (x < xgrid && y < ygrid)
+        t min_check = 0;
+        bool any = false;
+        for_disk_rows(x, y, r, [&](int i, int lo, int hi)
         {
-            const int tx1 = minv(sx1, sx2),  ty1 = minv(sy1, sy2), tx2 = maxv(sx1, sx2), ty2 = maxv(sy1, sy2), xd = source_id.xgrid - tx1, yd = source_id.ygrid - ty1;
-            if (xd > 0 && yd > 0)
+            if (!any) min_check = row(i)[lo], any = true;
+            row_min(row(i) + lo, hi - lo + 1, min_check);
+        });
+        return any ? variant(min_check) : variant();
+    }
+    variant find_disk_mean(const double x, const double y, const double r) const
+    {
+        t sum = 0;
+        double region_size = 0;
+        if (!for_disk_rows(x, y, r, [&](int i, int lo, int hi) { row_sum(row(i) + lo, hi - lo + 1, sum); region_size += hi - lo + 1; }))
+            return variant();
+        return sum/region_size;
+    }
+    bool value_region_exists(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const t val) const
+    {
+        int px1, py1, px2, py2;
+        if (clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            for (int i = py1; i < py2; i++)
+                if (row_find(row(i) + px1, px2 - px1, val) != -1)
+                    return true;
+        return false;
+    }
+    int value_region_x(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const t val) const
+    {
+        int px1, py1, px2, py2;
+        if (clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            for (int i = py1; i < py2; i++)
             {
-                const int upx = minv(tx2 - tx1 + 1, minv(int(xgrid - x), xd)), upy = minv(ty2 - ty1 + 1, minv(int(ygrid - y), yd));
-                for (int i = 0; i < upy; i++)
-                    for (int ii = 0; ii < upx; ii++)
-                        grid_array[(y + i)*xgrid + (x + ii)] = source_id.grid_array[(ty1 + i)*source_id.xgrid + (tx1 + ii)];
+                const long found = row_find(row(i) + px1, px2 - px1, val);
+                if (found != -1) return px1 + found;
             }
+        return 0;
+    }
+    int value_region_y(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const t val) const
+    {
+        int px1, py1, px2, py2;
+        if (clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            for (int i = py1; i < py2; i++)
+                if (row_find(row(i) + px1, px2 - px1, val) != -1)
+                    return i;
+        return 0;
+    }
+    // The first cell of the disk holding val, as (x, y), or false
+    bool value_disk_find(const double x, const double y, const double r, const t val, int &found_x, int &found_y) const
+    {
+        bool found = false;
+        for_disk_rows(x, y, r, [&](int i, int lo, int hi)
+        {
+            if (found) return;
+            const long at = row_find(row(i) + lo, hi - lo + 1, val);
+            if (at != -1) found = true, found_x = lo + at, found_y = i;
+        });
+        return found;
+    }
+    bool value_disk_exists(const double x, const double y, const double r, const t val) const
+    {
+        int found_x, found_y;
+        return value_disk_find(x, y, r, val, found_x, found_y);
+    }
+    int value_disk_x(const double x, const double y, const double r, const t val) const
+    {
+        int found_x, found_y;
+        return value_disk_find(x, y, r, val, found_x, found_y) ? found_y : 0;
+    }
+    int value_disk_y(const double x, const double y, const double r, const t val) const
+    {
+        int found_x, found_y;
+        return value_disk_find(x, y, r, val, found_x, found_y) ? found_x : 0;
+    }
+    void shuffle()
+    {
+        if (!grid_array.empty())
+            mt_random_shuffle(grid_array.begin(), grid_array.end() - 1);
+    }
+};
+
+// The grid behind ds_grids. A grid holds nothing but reals until a cell gets
+// a string (or anything else), so until then its cells are packed doubles,
+// which the region and disk operations above run through a row at a time;
+// the first non-real moves them all into variants, until the grid is cleared
+// to a real. A numeric grid can also keep a summed-area table, built on the
+// first sum or mean after a change, which answers region sums and means in
+// constant time and disk sums in time proportional to the radius.
+class variant_grid
+{
+    grid<double> reals;
+    grid<variant> cells;
+    bool numeric = true;
+    bool summed = false;           // Whether to keep the table
+    mutable vector<double> sums;   // Of the cells above and left of each corner
+    mutable bool sums_valid = false;
+
+    static bool is_real(const variant &v) { return v.type == enigma_user::ty_real; }
+    void to_cells()
+    {
+        if (!numeric) return;
+        cells.assign(reals);
+        reals = grid<double>();
+        numeric = false;
+        sums.clear();
+    }
+    // Runs f on whichever grid holds the cells, with val as that grid's cell
+    // type, moving the cells into variants first if val isn't a real
+    template <typename F> void write(const variant &val, F f)
+    {
+        sums_valid = false;
+        if (numeric && is_real(val)) f(reals, val.rval.d);
+        else
+        {
+            to_cells();
+            f(cells, val);
         }
     }
-    void add_grid_region(const grid& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    template <typename F> void write(F f)
     {
-        if (x < xgrid && y < ygrid)
+        sums_valid = false;
+        if (numeric) f(reals);
+        else f(cells);
+    }
+    template <typename F> variant read(F f) const
+    {
+        return numeric ? variant(f(reals)) : variant(f(cells));
+    }
+    // Looks for val with f, where no real cell matches anything but a real
+    template <typename F> auto find_value(const variant &val, F f) const -> decltype(f(cells, val))
+    {
+        if (!numeric) return f(cells, val);
+        return is_real(val) ? f(reals, val.rval.d) : 0;
+    }
+    bool tabled() const
+    {
+        if (!numeric || !summed) return false;
+        if (!sums_valid)
         {
-            const int tx1 = minv(sx1, sx2),  ty1 = minv(sy1, sy2), tx2 = maxv(sx1, sx2), ty2 = maxv(sy1, sy2), xd = source_id.xgrid - tx1, yd = source_id.ygrid - ty1;
-            if (xd > 0 && yd > 0)
+            const unsigned int w = reals.width(), h = reals.height();
+            const double *cell = reals.data();
+            sums.assign(size_t(w + 1) * (h + 1), 0);
+            for (unsigned int y = 0; y < h; y++)
             {
-                const int upx = minv(tx2 - tx1 + 1, minv(int(xgrid - x), xd)), upy = minv(ty2 - ty1 + 1, minv(int(ygrid - y), yd));
-                for (int i = 0; i < upy; i++)
-                    for (int ii = 0; ii < upx; ii++)
-                        grid_array[(y + i)*xgrid + (x + ii)] += source_id.grid_array[(ty1 + i)*source_id.xgrid + (tx1 + ii)];
+                double across = 0;
+                for (unsigned int x = 0; x < w; x++)
+                {
+                    across += *cell++;
+                    sums[(y + 1) * size_t(w + 1) + x + 1] = sums[y * size_t(w + 1) + x + 1] + across;
+                }
             }
+            sums_valid = true;
         }
+        return true;
     }
-    void multiply_grid_region(const grid& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    // The sum of the cells from (x1, y1) up to but not including (x2, y2);
+    // a difference of running totals, so on a big grid of big values it can
+    // be out in the last few digits
+    double table_sum(int x1, int y1, int x2, int y2) const
     {
-        if (x < xgrid && y < ygrid)
+        const size_t w = reals.width() + 1;
+        return sums[y2 * w + x2] - sums[y1 * w + x2] - sums[y2 * w + x1] + sums[y1 * w + x1];
+    }
+
+    public:
+    variant_grid() {}
+    variant_grid(const unsigned int w, const unsigned int h): reals(w, h) {}
+
+    unsigned int width() const { return numeric ? reals.width() : cells.width(); }
+    unsigned int height() const { return numeric ? reals.height() : cells.height(); }
+    void set_summed(bool enable)
+    {
+        summed = enable;
+        if (!enable) sums.clear(), sums_valid = false;
+    }
+    void clear(const variant &val)
+    {
+        if (!numeric && is_real(val))
         {
-            const int tx1 = minv(sx1, sx2),  ty1 = minv(sy1, sy2), tx2 = maxv(sx1, sx2), ty2 = maxv(sy1, sy2), xd = source_id.xgrid - tx1, yd = source_id.ygrid - ty1;
-            if (xd > 0 && yd > 0)
-            {
-                const int upx = minv(tx2 - tx1 + 1, minv(int(xgrid - x), xd)), upy = minv(ty2 - ty1 + 1, minv(int(ygrid - y), yd));
-                for (int i = 0; i < upy; i++)
-                    for (int ii = 0; ii < upx; ii++)
-                        grid_array[(y + i)*xgrid + (x + ii)] *= source_id.grid_array[(ty1 + i)*source_id.xgrid + (tx1 + ii)];
-            }
+            reals = grid<double>(cells.width(), cells.height());
+            cells = grid<variant>();
+            numeric = true;
         }
+        write(val, [&](auto &g, const auto &v) { g.clear(v); });
+    }
+    void copy(const variant_grid &source)
+    {
+        if (&source == this) return;
+        reals = source.reals;
+        cells = source.cells;
+        numeric = source.numeric;
+        sums_valid = false;
+    }
+    void resize(unsigned w, unsigned h) { write([&](auto &g) { g.resize(w, h); }); }
+    void insert(const unsigned int x, const unsigned int y, const variant &val) { write(val, [&](auto &g, const auto &v) { g.insert(x, y, v); }); }
+    void add(const unsigned int x, const unsigned int y, const variant &val) { write(val, [&](auto &g, const auto &v) { g.add(x, y, v); }); }
+    void multiply(const unsigned int x, const unsigned int y, const double val) { write([&](auto &g) { g.multiply(x, y, val); }); }
+    void insert_region(const unsigned int x1, const unsigned int y1, unsigned int x2, const unsigned int y2, const variant &val)
+    {
+        write(val, [&](auto &g, const auto &v) { g.insert_region(x1, y1, x2, y2, v); });
+    }
+    void add_region(const unsigned int x1, const unsigned int y1, unsigned int x2, const unsigned int y2, const variant &val)
+    {
+        write(val, [&](auto &g, const auto &v) { g.add_region(x1, y1, x2, y2, v); });
+    }
+    void multiply_region(const unsigned int x1, const unsigned int y1, unsigned int x2, const unsigned int y2, const double val)
+    {
+        write([&](auto &g) { g.multiply_region(x1, y1, x2, y2, val); });
+    }
+    void insert_disk(const double x, const double y, const double r, const variant &val)
+    {
+        write(val, [&](auto &g, const auto &v) { g.insert_disk(x, y, r, v); });
+    }
+    void add_disk(const double x, const double y, const double r, const variant &val)
+    {
+        write(val, [&](auto &g, const auto &v) { g.add_disk(x, y, r, v); });
+    }
+    void multiply_disk(const double x, const double y, const double r, const double val)
+    {
+        write([&](auto &g) { g.multiply_disk(x, y, r, val); });
+    }
+    // Runs f(g, s) on this grid's cells and source's, first moving these cells
+    // into variants if those are
+    template <typename F> void write_from(const variant_grid &source, F f)
+    {
+        if (!source.numeric) to_cells();
+        write([&](auto &g)
+        {
+            if (source.numeric) f(g, source.reals);
+            else f(g, source.cells);
+        });
+    }
+    void insert_grid_region(const variant_grid& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    {
+        write_from(source_id, [&](auto &g, const auto &s) { g.insert_grid_region(s, sx1, sy1, sx2, sy2, x, y); });
+    }
+    void add_grid_region(const variant_grid& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    {
+        write_from(source_id, [&](auto &g, const auto &s) { g.add_grid_region(s, sx1, sy1, sx2, sy2, x, y); });
+    }
+    void multiply_grid_region(const variant_grid& source_id, const unsigned int sx1, const unsigned int sy1, const unsigned int sx2, const unsigned int sy2, const unsigned int x, const unsigned int y)
+    {
+        write_from(source_id, [&](auto &g, const auto &s) { g.multiply_grid_region(s, sx1, sy1, sx2, sy2, x, y); });
     }
 
-    t find(unsigned int x, unsigned int y)
+    variant find(unsigned int x, unsigned int y) const { return read([&](const auto &g) { return g.find(x, y); }); }
+    variant find_region_sum(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
     {
-        return (grid_array[y * xgrid + x]);
+        int px1, py1, px2, py2;
+        if (tabled() && reals.clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            return table_sum(px1, py1, px2, py2);
+        return read([&](const auto &g) { return g.find_region_sum(x1, y1, x2, y2); });
     }
-    t find_region_sum(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           variant sum = 0;
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   sum += grid_array[i * xgrid + ii];
-           return sum;
-       }
-       return t();
-    }
-    t find_region_max(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       t val_check;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           t max_check = grid_array[py1 * xgrid + px1];
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-               {
-                   val_check = grid_array[i * xgrid + ii];
-                   if (val_check > max_check)
-                       max_check = val_check;
-               }
-           return max_check;
-       }
-       return t();
-    }
-    t find_region_min(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       t val_check;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           t min_check = grid_array[py1 * xgrid + px1];
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-               {
-                   val_check = grid_array[i * xgrid + ii];
-                   if (val_check < min_check)
-                       min_check = val_check;
-               }
-           return min_check;
-       }
-       return t();
-    }
-    t find_region_mean(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           t sum = 0;
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   sum += grid_array[i * xgrid + ii];
-           const double region_size = (py2 - py1)*(px2 - px1);
-           return sum/region_size;
-       }
-       return t();
-    }
-    t find_disk_sum(const double x, const double y, const double r)
+    variant find_region_max(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        return read([&](const auto &g) { return g.find_region_max(x1, y1, x2, y2); });
+    }
+    variant find_region_min(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
+    {
+        return read([&](const auto &g) { return g.find_region_min(x1, y1, x2, y2); });
+    }
+    variant find_region_mean(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) const
+    {
+        int px1, py1, px2, py2;
+        if (tabled() && reals.clip_region(x1, y1, x2, y2, px1, py1, px2, py2))
+            return table_sum(px1, py1, px2, py2) / ((py2 - py1)*(px2 - px1));
+        return read([&](const auto &g) { return g.find_region_mean(x1, y1, x2, y2); });
+    }
+    variant find_disk_sum(const double x, const double y, const double r) const
+    {
+        if (tabled())
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            t sum = t();
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        sum += grid_array[i * xgrid + ii];
+            double sum = 0;
+            if (!reals.for_disk_rows(x, y, r, [&](int i, int lo, int hi) { sum += table_sum(lo, i, hi + 1, i + 1); }))
+                return variant();
             return sum;
         }
-        return t();
+        return read([&](const auto &g) { return g.find_disk_sum(x, y, r); });
     }
-    t find_disk_max(const double x, const double y, const double r)
+    variant find_disk_max(const double x, const double y, const double r) const
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        return read([&](const auto &g) { return g.find_disk_max(x, y, r); });
+    }
+    variant find_disk_min(const double x, const double y, const double r) const
+    {
+        return read([&](const auto &g) { return g.find_disk_min(x, y, r); });
+    }
+    variant find_disk_mean(const double x, const double y, const double r) const
+    {
+        if (tabled())
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            t max_check = grid_array[py1 * xgrid + px1];
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                    {
-                        const double val_check = grid_array[i * xgrid + ii];
-                        if (val_check > max_check)
-                            max_check = val_check;
-                    }
-            return max_check;
+            double sum = 0, region_size = 0;
+            if (!reals.for_disk_rows(x, y, r, [&](int i, int lo, int hi) { sum += table_sum(lo, i, hi + 1, i + 1); region_size += hi - lo + 1; }))
+                return variant();
+            return sum/region_size;
         }
-        return t();
+        return read([&](const auto &g) { return g.find_disk_mean(x, y, r); });
     }
-    t find_disk_min(const double x, const double y, const double r)
+    bool value_region_exists(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const variant &val) const
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        return find_value(val, [&](const auto &g, const auto &v) { return g.value_region_exists(x1, y1, x2, y2, v); });
+    }
+    int value_region_x(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const variant &val) const
+    {
+        return find_value(val, [&](const auto &g, const auto &v) { return g.value_region_x(x1, y1, x2, y2, v); });
+    }
+    int value_region_y(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const variant &val) const
+    {
+        return find_value(val, [&](const auto &g, const auto &v) { return g.value_region_y(x1, y1, x2, y2, v); });
+    }
+    bool value_disk_exists(const double x, const double y, const double r, const variant &val) const
+    {
+        return find_value(val, [&](const auto &g, const auto &v) { return g.value_disk_exists(x, y, r, v); });
+    }
+    int value_disk_x(const double x, const double y, const double r, const variant &val) const
+    {
+        return find_value(val, [&](const auto &g, const auto &v) { return g.value_disk_x(x, y, r, v); });
+    }
+    int value_disk_y(const double x, const double y, const double r, const variant &val) const
+    {
+        return find_value(val, [&](const auto &g, const auto &v) { return g.value_disk_y(x, y, r, v); });
+    }
+    void shuffle() { write([&](auto &g) { g.shuffle(); }); }
+};
+
+// Every kind of data structure keeps its instances in one of these, indexed
+// directly by id. Ids are handed out in order and never reused.
+template <typename t>
+class ds_registry
+{
+    vector<t*> items;
+    t stray;
+
+    public:
+    ~ds_registry()
+    {
+        for (t *item : items) delete item;
+    }
+    unsigned int add(t *item)
+    {
+        items.push_back(item);
+        return items.size() - 1;
+    }
+    bool exists(const unsigned int id) const
+    {
+        return id < items.size() && items[id];
+    }
+    void erase(const unsigned int id)
+    {
+        if (exists(id))
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            t min_check = grid_array[lrint(y) * xgrid + lrint(x)];
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                    {
-                        const double val_check = grid_array[i * xgrid + ii];
-                        if (val_check < min_check)
-                            min_check = val_check;
-                    }
-            return min_check;
+            delete items[id];
+            items[id] = NULL;
         }
-        return t();
     }
-    t find_disk_mean(const double x, const double y, const double r)
+    // A missing id gets an empty scratch structure, so stray ids can't crash
+    t& operator[](const unsigned int id)
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        if (exists(id)) return *items[id];
+        stray = t();
+        return stray;
+    }
+};
+
+// How the hashed structures below treat variant keys: as variants compare, so
+// reals within variant::epsilon are equal and strings sort after reals. Reals
+// hash by which cell of a grid of 4 * epsilon they round into, so a key near
+// the edge of its cell is also looked for in the next one.
+struct variant_key
+{
+    static bool is_string(const variant &v) { return v.type == enigma_user::ty_string; }
+    static size_t mix(uint64_t bits)
+    {
+        bits ^= bits >> 33; bits *= 0xff51afd7ed558ccdULL;
+        bits ^= bits >> 33; bits *= 0xc4ceb9fe1a85ec53ULL;
+        return size_t(bits ^ (bits >> 33));
+    }
+    // Keys within epsilon of a real are at most a quarter of a cell away from it
+    static double scaled(double value) { return value * (0.25 / variant::epsilon) + 0.5; }
+    static size_t cell_hash(double cell)
+    {
+        if (cell == 0) cell = 0;  // -0 and 0 are the same cell
+        uint64_t bits;
+        memcpy(&bits, &cell, sizeof(bits));
+        return mix(bits);
+    }
+    static size_t hash(const variant &key)
+    {
+        return is_string(key) ? std::hash<std::string>()(key.sval()) : cell_hash(floor(scaled(key.rval.d)));
+    }
+    static bool equal(const variant &a, const variant &b)
+    {
+        if (is_string(a) != is_string(b)) return false;
+        return is_string(a) ? a.sval() == b.sval() : fabs(a.rval.d - b.rval.d) <= variant::epsilon;
+    }
+    static bool less(const variant &a, const variant &b)
+    {
+        if (is_string(a) != is_string(b)) return is_string(b);
+        return is_string(a) ? a.sval() < b.sval() : a.rval.d + variant::epsilon < b.rval.d;
+    }
+    // The order ds_map_write and ds_priority_write list entries in: by key,
+    // exactly, then by the order they were added
+    template <typename E> static bool entry_less(const E &a, const E &b)
+    {
+        if (is_string(a.key) != is_string(b.key)) return is_string(b.key);
+        if (is_string(a.key) ? a.key.sval() != b.key.sval() : a.key.rval.d != b.key.rval.d)
+            return is_string(a.key) ? a.key.sval() < b.key.sval() : a.key.rval.d < b.key.rval.d;
+        return a.seq < b.seq;
+    }
+};
+
+// Open addressing over a vector of entries owned by someone else, each with a
+// variant key, its variant_key::hash and a seq counting up as entries are
+// added. Equal keys may repeat; a lookup finds the one added first.
+template <typename E>
+class variant_index
+{
+    struct slot
+    {
+        size_t hash;
+        unsigned int index;  // Into entries, + 1; or one of the below
+    };
+    enum : unsigned int { empty_slot = 0, dead_slot = ~0u };
+
+    vector<slot> slots;
+    unsigned int dead_slots = 0;
+    bool duplicates = false;  // Whether a lookup must see every match
+
+    // Searches the probe sequence of hash for a key equal to key, keeping
+    // whichever of found and the matches was added first
+    long probe(const vector<E> &entries, size_t hash, const variant &key, long found) const
+    {
+        const size_t mask = slots.size() - 1;
+        for (size_t s = hash & mask; slots[s].index != empty_slot; s = (s + 1) & mask)
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            t sum = t();
-            double region_size = 0;
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                    {
-                        sum += grid_array[i * xgrid + ii];
-                        ++region_size;
-                    }
-           return sum/region_size;
+            if (slots[s].hash != hash || slots[s].index == dead_slot) continue;
+            const E &e = entries[slots[s].index - 1];
+            if (!variant_key::equal(e.key, key)) continue;
+            if (found == -1 || e.seq < entries[found].seq) found = slots[s].index - 1;
+            if (!duplicates) break;
         }
-        return t();
-    }
-    bool value_region_exists(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const t val)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   if (tequal(grid_array[i * xgrid + ii], val))
-                       return true;
-       }
-       return false;
-    }
-    int value_region_x(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const t val)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   if (tequal(grid_array[i * xgrid + ii], val))
-                      return ii;
-       }
-       return 0;
-    }
-    int value_region_y(unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2, const t val)
-    {
-       const int tx1 = minv(x1, x2),  ty1 = minv(y1, y2), tx2 = maxv(x1, x2), ty2 = maxv(y1, y2), xd = xgrid - tx1, yd = ygrid - ty1;
-       if (xd > 0 && yd > 0)
-       {
-           const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2 + 1, (int)xgrid), py2 = minv(ty2 + 1, (int)ygrid);
-           for (int i = py1; i < py2; i++)
-               for (int ii = px1; ii < px2; ii++)
-                   if (tequal(grid_array[i * xgrid + ii], val))
-                       return i;
-       }
-       return 0;
-    }
-    bool value_disk_exists(const double x, const double y, const double r, const t val)
+        return found;
+    }
+    size_t slot_of(const vector<E> &entries, unsigned int index) const
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        const size_t mask = slots.size() - 1;
+        size_t s = entries[index].hash & mask;
+        while (slots[s].index != index + 1) s = (s + 1) & mask;
+        return s;
+    }
+    void rehash(const vector<E> &entries, size_t capacity)
+    {
+        slots.assign(capacity, slot{0, empty_slot});
+        dead_slots = 0;
+        for (unsigned int i = 0; i < entries.size(); i++)
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        if (tequal(grid_array[i * xgrid + ii], val))
-                            return true;
+            size_t s = entries[i].hash & (capacity - 1);
+            while (slots[s].index != empty_slot) s = (s + 1) & (capacity - 1);
+            slots[s] = slot{entries[i].hash, i + 1};
         }
-        return false;
     }
-    int value_disk_x(const double x, const double y, const double r, const t val)
+
+    public:
+    void clear()
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        slots.clear();
+        dead_slots = 0;
+        duplicates = false;
+    }
+    // The index of the first-added entry equal to key, or -1
+    long find(const vector<E> &entries, const variant &key) const
+    {
+        if (slots.empty()) return -1;
+        if (variant_key::is_string(key)) return probe(entries, variant_key::hash(key), key, -1);
+        // A little over a quarter cell, against rounding
+        const double center = variant_key::scaled(key.rval.d), below = floor(center - 0.26), above = floor(center + 0.26);
+        const long found = probe(entries, variant_key::cell_hash(below), key, -1);
+        if (above == below || (found != -1 && !duplicates)) return found;
+        return probe(entries, variant_key::cell_hash(above), key, found);
+    }
+    // Indexes entries.back(), which was just pushed
+    void insert(const vector<E> &entries)
+    {
+        const E &e = entries.back();
+        if (!duplicates && find(entries, e.key) != -1) duplicates = true;
+        if ((entries.size() + dead_slots) * 4 > slots.size() * 3)
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        if (tequal(grid_array[i * xgrid + ii], val))
-                            return i;
+            size_t capacity = 16;
+            while (capacity < entries.size() * 2) capacity *= 2;
+            rehash(entries, capacity);
+            return;
         }
-        return 0;
+        const size_t mask = slots.size() - 1;
+        size_t s = e.hash & mask;
+        while (slots[s].index != empty_slot && slots[s].index != dead_slot) s = (s + 1) & mask;
+        if (slots[s].index == dead_slot) dead_slots--;
+        slots[s] = slot{e.hash, (unsigned int) entries.size()};
     }
-    int value_disk_y(const double x, const double y, const double r, const t val)
+    // Unindexes entries[index], which the owner is about to overwrite with
+    // entries.back() and pop
+    void erase(const vector<E> &entries, unsigned int index)
     {
-        const double rr = r*r;
-        const int tx1 = int(x - r), ty1 = int(y - r), tx2 = int(x + r + 1), ty2 = int(y + r + 1);
-        if (tx2 >= 0 && ty2 >=0 && tx1 < int(xgrid) && ty1 < int(ygrid))
+        const unsigned int last = entries.size() - 1;
+        slots[slot_of(entries, index)].index = dead_slot;
+        dead_slots++;
+        if (index != last) slots[slot_of(entries, last)].index = index + 1;
+    }
+};
+
+// The map behind ds_maps, keeping GM 8.1's multimap behaviour (duplicate
+// keys, and finding the first one added). The key order that find_first/next
+// and ds_map_write need is sorted only when asked for.
+class variant_map
+{
+    struct entry
+    {
+        variant key, value;
+        size_t hash;
+        unsigned long seq;  // Order of addition among equal keys
+        ds_mark mark;
+    };
+
+    vector<entry> entries;
+    variant_index<entry> index;
+    unsigned long next_seq = 0;
+    mutable vector<unsigned int> order;
+    mutable bool ordered = true;
+
+    void erase_entry(unsigned int i)
+    {
+        index.erase(entries, i);
+        if (i != entries.size() - 1) entries[i] = std::move(entries.back());
+        entries.pop_back();
+        ordered = false;
+    }
+    const vector<unsigned int>& sorted() const
+    {
+        if (!ordered)
         {
-            const int px1 = maxv(tx1, 0), py1 = maxv(ty1, 0), px2 = minv(tx2, (int)xgrid), py2 = minv(ty2, (int)ygrid);
-            for (int i = py1; i < py2; i++)
-                for (int ii = px1; ii < px2; ii++)
-                    if ((x - ii)*(x - ii) + (y - i)*(y - i) <= rr)
-                        if (tequal(grid_array[i * xgrid + ii], val))
-                            return ii;
+            order.resize(entries.size());
+            for (unsigned int i = 0; i < order.size(); i++) order[i] = i;
+            std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+                { return variant_key::entry_less(entries[a], entries[b]); });
+            ordered = true;
         }
-        return 0;
+        return order;
+    }
+
+    public:
+    unsigned int size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear()
+    {
+        entries.clear();
+        index.clear();
+        order.clear();
+        ordered = true;
+    }
+    void add(const variant &key, const variant &value, ds_mark mark = ds_unmarked)
+    {
+        entries.push_back(entry{key, value, variant_key::hash(key), next_seq++, mark});
+        index.insert(entries);
+        ordered = false;
+    }
+    // The value of the first-added entry with the given key, or NULL
+    variant* find(const variant &key)
+    {
+        const long i = index.find(entries, key);
+        return i == -1 ? NULL : &entries[i].value;
+    }
+    ds_mark mark_of(const variant &key) const
+    {
+        const long i = index.find(entries, key);
+        return i == -1 ? ds_unmarked : entries[i].mark;
+    }
+    // Removes the first-added entry with the given key
+    bool erase(const variant &key)
+    {
+        const long i = index.find(entries, key);
+        if (i == -1) return false;
+        erase_entry(i);
+        return true;
+    }
+    // Removes the entries from the first one with key first up to, but not
+    // including, the first one with key last, in key order
+    void erase_range(const variant &first, const variant &last)
+    {
+        const long f = index.find(entries, first), l = index.find(entries, last);
+        if (f == -1 || l == -1) return;
+        const vector<unsigned int> &keys = sorted();
+        const size_t pf = std::find(keys.begin(), keys.end(), f) - keys.begin(),
+                     pl = std::find(keys.begin(), keys.end(), l) - keys.begin();
+        if (pf >= pl) return;
+        vector<variant> doomed;
+        for (size_t i = pf; i < pl; i++) doomed.push_back(entries[keys[i]].key);
+        for (const variant &key : doomed) erase(key);
+    }
+    const variant* first_key() const { return empty() ? NULL : &entries[sorted().front()].key; }
+    const variant* last_key() const { return empty() ? NULL : &entries[sorted().back()].key; }
+    // The smallest key larger than key, or NULL
+    const variant* next_key(const variant &key) const
+    {
+        const vector<unsigned int> &keys = sorted();
+        auto it = std::partition_point(keys.begin(), keys.end(),
+            [&](unsigned int i) { return !variant_key::less(key, entries[i].key); });
+        return it == keys.end() ? NULL : &entries[*it].key;
+    }
+    // The largest key smaller than key, or NULL
+    const variant* previous_key(const variant &key) const
+    {
+        const vector<unsigned int> &keys = sorted();
+        auto it = std::partition_point(keys.begin(), keys.end(),
+            [&](unsigned int i) { return variant_key::less(entries[i].key, key); });
+        return it == keys.begin() ? NULL : &entries[*(it - 1)].key;
+    }
+    // Calls f(key, value) for every entry, in key order
+    template <typename F> void for_each_ordered(F f) const
+    {
+        for (unsigned int i : sorted()) f(entries[i].key, entries[i].value);
+    }
+    // The same, as f(key, value, mark)
+    template <typename F> void for_each_ordered_marked(F f) const
+    {
+        for (unsigned int i : sorted()) f(entries[i].key, entries[i].value, entries[i].mark);
+    }
+    // Calls f(mark, value) for every marked entry
+    template <typename F> void for_each_marked(F f) const
+    {
+        for (const entry &e : entries)
+            if (e.mark != ds_unmarked) f(e.mark, e.value);
+    }
+};
+
+// The list behind ds_lists. Marks are kept alongside the values only as far
+// as the last one ever set, so lists that never hold nested structures pay
+// nothing for them.
+class variant_list
+{
+    vector<unsigned char> marks;
+
+    template <typename F> void permute(F reorder)
+    {
+        vector<unsigned int> order(values.size());
+        for (unsigned int i = 0; i < order.size(); i++) order[i] = i;
+        reorder(order);
+        vector<variant> moved(values.size());
+        vector<unsigned char> moved_marks(values.size());
+        for (unsigned int i = 0; i < order.size(); i++)
+        {
+            moved[i] = std::move(values[order[i]]);
+            moved_marks[i] = mark_of(order[i]);
+        }
+        values.swap(moved);
+        marks.swap(moved_marks);
+    }
+
+    public:
+    vector<variant> values;
+
+    ds_mark mark_of(unsigned int pos) const { return pos < marks.size() ? ds_mark(marks[pos]) : ds_unmarked; }
+    void mark(unsigned int pos, ds_mark m)
+    {
+        if (pos >= values.size()) return;
+        if (pos >= marks.size())
+        {
+            if (m == ds_unmarked) return;
+            marks.resize(pos + 1, ds_unmarked);
+        }
+        marks[pos] = m;
+    }
+    void insert(unsigned int pos, const variant &val)
+    {
+        values.insert(values.begin() + pos, val);
+        if (pos < marks.size()) marks.insert(marks.begin() + pos, ds_unmarked);
+    }
+    // Removes the values from first up to, but not including, last
+    void erase(unsigned int first, unsigned int last)
+    {
+        values.erase(values.begin() + first, values.begin() + last);
+        if (first < marks.size()) marks.erase(marks.begin() + first, marks.begin() + min<size_t>(last, marks.size()));
+    }
+    void clear()
+    {
+        values.clear();
+        marks.clear();
+    }
+    void sort(bool ascend)
+    {
+        if (marks.empty())
+        {
+            if (ascend) std::sort(values.begin(), values.end());
+            else std::sort(values.rbegin(), values.rend());
+            return;
+        }
+        permute([&](vector<unsigned int> &order) {
+            std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+                { return ascend ? values[a] < values[b] : values[b] < values[a]; });
+        });
     }
     void shuffle()
     {
-        mt_random_shuffle(grid_array, grid_array + (xgrid*ygrid - 1));
+        if (marks.empty())
+            mt_random_shuffle(values.begin(), values.end());
+        else
+            permute([](vector<unsigned int> &order) { mt_random_shuffle(order.begin(), order.end()); });
+    }
+    // Calls f(mark, value) for every marked entry
+    template <typename F> void for_each_marked(F f) const
+    {
+        for (size_t i = 0; i < marks.size(); i++)
+            if (marks[i] != ds_unmarked) f(ds_mark(marks[i]), values[i]);
+    }
+};
+
+// The queue behind ds_prioritys: the values, in the order they were added, in
+// a variant_index (the value is the key), with two 4-ary heaps of their
+// indices, one for each end. Entries know where they are in both heaps, so a
+// value can come out of the middle in O(log n). Among equal priorities the
+// smallest value wins, then the first added, as in GM 8.1's scan of its
+// multimap; changing a value's priority counts as adding it again.
+class variant_priority
+{
+    struct entry
+    {
+        variant key, priority;
+        size_t hash;
+        unsigned long seq;
+        unsigned int place[2];  // In heaps[0] and heaps[1]
+    };
+    enum { arity = 4 };
+
+    vector<entry> entries;
+    variant_index<entry> index;
+    vector<unsigned int> heaps[2];  // Smallest priority first, largest first
+    unsigned long next_seq = 0;
+
+    bool before(int h, unsigned int a, unsigned int b) const
+    {
+        const entry &ea = entries[a], &eb = entries[b];
+        if (h ? ea.priority > eb.priority : ea.priority < eb.priority) return true;
+        if (h ? eb.priority > ea.priority : eb.priority < ea.priority) return false;
+        if (variant_key::less(ea.key, eb.key)) return true;
+        if (variant_key::less(eb.key, ea.key)) return false;
+        return ea.seq < eb.seq;
+    }
+    void put(int h, unsigned int pos, unsigned int i)
+    {
+        heaps[h][pos] = i;
+        entries[i].place[h] = pos;
+    }
+    void sift_up(int h, unsigned int pos)
+    {
+        const unsigned int i = heaps[h][pos];
+        while (pos > 0)
+        {
+            const unsigned int parent = (pos - 1) / arity;
+            if (!before(h, i, heaps[h][parent])) break;
+            put(h, pos, heaps[h][parent]);
+            pos = parent;
+        }
+        put(h, pos, i);
+    }
+    void sift_down(int h, unsigned int pos)
+    {
+        const unsigned int i = heaps[h][pos], n = heaps[h].size();
+        for (;;)
+        {
+            const unsigned int first = pos * arity + 1;
+            if (first >= n) break;
+            unsigned int best = first;
+            for (unsigned int c = first + 1; c < first + arity && c < n; c++)
+                if (before(h, heaps[h][c], heaps[h][best])) best = c;
+            if (!before(h, heaps[h][best], i)) break;
+            put(h, pos, heaps[h][best]);
+            pos = best;
+        }
+        put(h, pos, i);
+    }
+    void erase_entry(unsigned int i)
+    {
+        for (int h = 0; h < 2; h++)
+        {
+            const unsigned int pos = entries[i].place[h], moved = heaps[h].back();
+            heaps[h].pop_back();
+            if (moved == i) continue;
+            put(h, pos, moved);
+            sift_up(h, pos);
+            sift_down(h, entries[moved].place[h]);
+        }
+        index.erase(entries, i);
+        const unsigned int last = entries.size() - 1;
+        if (i != last)
+        {
+            entries[i] = std::move(entries[last]);
+            for (int h = 0; h < 2; h++) heaps[h][entries[i].place[h]] = i;
+        }
+        entries.pop_back();
+    }
+    // Removes the value at the front of heap h, returning it, or def if empty
+    variant pop(int h, const variant &def)
+    {
+        if (entries.empty()) return def;
+        const unsigned int i = heaps[h].front();
+        variant key = std::move(entries[i].key);
+        erase_entry(i);
+        return key;
+    }
+
+    public:
+    unsigned int size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear()
+    {
+        entries.clear();
+        index.clear();
+        heaps[0].clear();
+        heaps[1].clear();
+    }
+    void add(const variant &key, const variant &priority)
+    {
+        const unsigned int i = entries.size();
+        entries.push_back(entry{key, priority, variant_key::hash(key), next_seq++, {i, i}});
+        index.insert(entries);
+        for (int h = 0; h < 2; h++)
+        {
+            heaps[h].push_back(i);
+            sift_up(h, i);
+        }
+    }
+    // The priority of the first-added entry with the given value, or NULL
+    const variant* find(const variant &key) const
+    {
+        const long i = index.find(entries, key);
+        return i == -1 ? NULL : &entries[i].priority;
+    }
+    // Removes the first-added entry with the given value
+    bool erase(const variant &key)
+    {
+        const long i = index.find(entries, key);
+        if (i == -1) return false;
+        erase_entry(i);
+        return true;
+    }
+    const variant* min() const { return empty() ? NULL : &entries[heaps[0].front()].key; }
+    const variant* max() const { return empty() ? NULL : &entries[heaps[1].front()].key; }
+    variant pop_min(const variant &def) { return pop(0, def); }
+    variant pop_max(const variant &def) { return pop(1, def); }
+    // Calls f(value, priority) for every entry, in value order
+    template <typename F> void for_each_ordered(F f) const
+    {
+        vector<unsigned int> order(entries.size());
+        for (unsigned int i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+            { return variant_key::entry_less(entries[a], entries[b]); });
+        for (unsigned int i : order) f(entries[i].key, entries[i].priority);
     }
 };
 
 /* ds_grids */
 
-static map<unsigned int, grid<variant> > ds_grids;
-static unsigned int ds_grids_maxid = 0;
+static ds_registry<variant_grid> ds_grids;
 
 namespace enigma_user
 {
@@ -486,16 +1270,13 @@ namespace enigma_user
 unsigned int ds_grid_create(const unsigned int w, const unsigned int h)
 {
   //Creates a new grid. The function returns an integer as an id that must be used in all other functions to access the particular grid.
-  pair<map<unsigned int, grid<variant> >::iterator, bool> ins = ds_grids.insert(pair<unsigned int, grid<variant> >(ds_grids_maxid++, grid<variant>(w, h)));
-  ins.first->second.clear(0);
-  return ds_grids_maxid-1;
+  return ds_grids.add(new variant_grid(w, h));
 }
 
 void ds_grid_destroy(const unsigned int id)
 {
   //Destroys the grid
-  ds_grids[id].destroy();
-  ds_grids.erase(ds_grids.find(id));
+  ds_grids.erase(id);
 }
 
 void ds_grid_clear(const unsigned int id, const variant val)
@@ -689,6 +1470,12 @@ bool ds_grid_value_disk_y(const unsigned int id, const double x, const double y,
   return (ds_grids[id].value_disk_y(x, y, r, val));
 }
 
+void ds_grid_summed_area_enable(const unsigned int id, const bool enable)
+{
+  //Sets whether the grid keeps a summed-area table, for region sums and means in constant time while it holds only reals
+  ds_grids[id].set_summed(enable);
+}
+
 void ds_grid_shuffle(const unsigned int id)
 {
   //Shuffles the values in the grid such that they end up in a random order
@@ -698,15 +1485,13 @@ void ds_grid_shuffle(const unsigned int id)
 bool ds_grid_exists(const unsigned int id)
 {
   //returns whether the grid exists
-  return (ds_grids.find(id) != ds_grids.end());
+  return ds_grids.exists(id);
 }
 
 unsigned int ds_grid_duplicate(const unsigned int source)
 {
   //creates and returns a new grid containing a copy of the source grid
-  ds_grids.insert(pair<unsigned int, grid<variant> >(ds_grids_maxid++, grid<variant>(0, 0)));
-  ds_grids[ds_grids_maxid-1].copy(ds_grids[source]);
-  return ds_grids_maxid-1;
+  return ds_grids.add(new variant_grid(ds_grids[source]));
 }
 
 std::string ds_grid_write(const unsigned int id)
@@ -716,7 +1501,7 @@ std::string ds_grid_write(const unsigned int id)
   ss.width(4);
   ss.fill('0');
 
-  grid<variant> dsGrid = ds_grids[id];
+  const variant_grid &dsGrid = ds_grids[id];
 
   // Write size
   ss << std::hex << dsGrid.width();
@@ -836,8 +1621,25 @@ void ds_grid_read(const unsigned int id, std::string value)
 
 /* ds_maps */
 
-static map<unsigned int, multimap<variant, variant> > ds_maps;
-static unsigned int ds_maps_maxid = 0;
+static ds_registry<variant_map> ds_maps;
+
+// Destroys the nested structure a marked value names
+static void ds_destroy_marked(ds_mark mark, const variant &id)
+{
+  if (mark == ds_marked_map) enigma_user::ds_map_destroy(id);
+  else if (mark == ds_marked_list) enigma_user::ds_list_destroy(id);
+}
+
+// The container goes from the registry before its children do, so a map that
+// has been marked into itself can't recurse forever
+template <typename t> static void ds_destroy_nested(ds_registry<t> &registry, const unsigned int id)
+{
+  if (!registry.exists(id)) return;
+  vector<pair<ds_mark, variant> > nested;
+  registry[id].for_each_marked([&](ds_mark mark, const variant &value) { nested.emplace_back(mark, value); });
+  registry.erase(id);
+  for (const auto &child : nested) ds_destroy_marked(child.first, child.second);
+}
 
 namespace enigma_user
 {
@@ -845,14 +1647,13 @@ namespace enigma_user
 unsigned int ds_map_create()
 {
   //Creates a new map. The function returns an integer as an id that must be used in all other functions to access the particular map.
-  ds_maps.insert(pair<unsigned int, multimap<variant, variant> >(ds_maps_maxid++, multimap<variant, variant>()));
-  return ds_maps_maxid-1;
+  return ds_maps.add(new variant_map());
 }
 
 void ds_map_destroy(const unsigned int id)
 {
-  //Destroys the map
-  ds_maps.erase(ds_maps.find(id));
+  //Destroys the map, along with any maps and lists marked in it
+  ds_destroy_nested(ds_maps, id);
 }
 
 void ds_map_clear(const unsigned int id)
@@ -864,7 +1665,8 @@ void ds_map_clear(const unsigned int id)
 void ds_map_copy(const unsigned int id, const unsigned int source)
 {
   //Copies the source map onto the map
-  ds_maps[id] = ds_maps[source];
+  if (id != source && ds_maps.exists(source))
+    ds_maps[id] = ds_maps[source];
 }
 
 unsigned int ds_map_size(const unsigned int id)
@@ -879,13 +1681,13 @@ bool ds_map_empty(const unsigned int id)
   return ds_maps[id].empty();
 }
 
-void ds_map_add(const unsigned int id, const variant key, const variant val)
+void ds_map_add(const unsigned int id, const variant &key, const variant &val)
 {
   //Adds the value and corresponding key to the map.
-  ds_maps[id].insert(pair<variant, variant>(key, val));
+  ds_maps[id].add(key, val);
 }
 
-void ds_map_replace(const unsigned int id, const variant key, const variant val)
+void ds_map_replace(const unsigned int id, const variant &key, const variant &val)
 {
   //TODO: Studio made it so this function will add the value if it is not in the map.
   //GM 8.1 does not have this behaviour. This has also been tested.
@@ -896,115 +1698,121 @@ void ds_map_replace(const unsigned int id, const variant key, const variant val)
   //not exist in the global async_load map.
 
   //Replaces the value corresponding with the key with a new value
-  multimap<variant, variant>::iterator it = ds_maps[id].find(key);
-  if (it != ds_maps[id].end())
+  if (ds_maps[id].erase(key))
   {
-    ds_maps[id].erase(it);
-    ds_maps[id].insert(pair<variant, variant>(key, val));
+    ds_maps[id].add(key, val);
   }
 }
 
 //NOTE: Special function, see todo comment above.
-void ds_map_overwrite(const unsigned int id, const variant key, const variant val)
+void ds_map_overwrite(const unsigned int id, const variant &key, const variant &val)
 {
   //Replaces the value corresponding with the key with a new value, adding it if it was not found in the map.
-  multimap<variant, variant>::iterator it = ds_maps[id].find(key);
-  if (it != ds_maps[id].end())
-  {
-    ds_maps[id].erase(it);
-  }
-  ds_maps[id].insert(pair<variant, variant>(key, val));
+  ds_maps[id].erase(key);
+  ds_maps[id].add(key, val);
 }
 
-void ds_map_delete(const unsigned int id, const variant key)
+void ds_map_delete(const unsigned int id, const variant &key)
 {
   //Deletes the key and the corresponding value from the map
-  multimap<variant, variant>::iterator it = ds_maps[id].find(key);
-  if (it != ds_maps[id].end())
-  {
-    ds_maps[id].erase(it);
-  }
+  ds_maps[id].erase(key);
 }
 
-void ds_map_delete(const unsigned int id, const variant first, const variant last)
+void ds_map_delete(const unsigned int id, const variant &first, const variant &last)
 {
   //Deletes the keys and corresponding values in the range between first and last
-  multimap<variant, variant>::iterator itf = ds_maps[id].find(first), itl = ds_maps[id].find(last);
-  if (itf != ds_maps[id].end() && itl != ds_maps[id].end())
-  {
-    ds_maps[id].erase(itf, itl);
-  }
+  ds_maps[id].erase_range(first, last);
+}
+
+void ds_map_add_map(const unsigned int id, const variant &key, const unsigned int map)
+{
+  //Adds the map under the key, marked so it is destroyed with this one
+  ds_maps[id].add(key, map, ds_marked_map);
+}
+
+void ds_map_add_list(const unsigned int id, const variant &key, const unsigned int list)
+{
+  //Adds the list under the key, marked so it is destroyed with this map
+  ds_maps[id].add(key, list, ds_marked_list);
+}
+
+void ds_map_replace_map(const unsigned int id, const variant &key, const unsigned int map)
+{
+  //Replaces the value corresponding with the key with the map, marked as in ds_map_add_map
+  if (ds_maps[id].erase(key))
+    ds_maps[id].add(key, map, ds_marked_map);
+}
+
+void ds_map_replace_list(const unsigned int id, const variant &key, const unsigned int list)
+{
+  //Replaces the value corresponding with the key with the list, marked as in ds_map_add_list
+  if (ds_maps[id].erase(key))
+    ds_maps[id].add(key, list, ds_marked_list);
+}
+
+bool ds_map_is_map(const unsigned int id, const variant &key)
+{
+  //returns whether the value under the key is marked as a map
+  return ds_maps[id].mark_of(key) == ds_marked_map;
+}
+
+bool ds_map_is_list(const unsigned int id, const variant &key)
+{
+  //returns whether the value under the key is marked as a list
+  return ds_maps[id].mark_of(key) == ds_marked_list;
 }
 
-bool ds_map_exists(const unsigned int id, const variant key)
+bool ds_map_exists(const unsigned int id, const variant &key)
 {
   //returns whether the key exists in the map
-  return (ds_maps[id].find(key) != ds_maps[id].end());
+  return ds_maps[id].find(key) != NULL;
 }
 
-variant ds_map_find_value(const unsigned int id, const variant key)
+variant ds_map_find_value(const unsigned int id, const variant &key)
 {
   //Returns the value corresponding to the key in the map
-  multimap<variant, variant>::iterator it = ds_maps[id].find(key);
-  return ((it == ds_maps[id].end()) ? variant() : (*it).second);
+  const variant *value = ds_maps[id].find(key);
+  return value ? *value : variant();
 }
 
-variant ds_map_find_previous(const unsigned int id, const variant key)
+variant ds_map_find_previous(const unsigned int id, const variant &key)
 {
   //Returns the largest key in the map smaller than the indicated key
-  multimap<variant, variant>::reverse_iterator rit;
-  variant key_check;
-  for (rit = ds_maps[id].rbegin(); rit != ds_maps[id].rend(); rit++)
-  {
-    if ((key_check = (*rit).first) < key)
-    {
-      return key_check;
-    }
-  }
-  return variant();
+  const variant *previous = ds_maps[id].previous_key(key);
+  return previous ? *previous : variant();
 }
 
-variant ds_map_find_next(const unsigned int id, const variant key)
+variant ds_map_find_next(const unsigned int id, const variant &key)
 {
   //Returns the smallest key in the map larger than the indicated key
-  multimap<variant, variant>::iterator it;
-  variant key_check;
-  for (it = ds_maps[id].begin(); it != ds_maps[id].end(); it++)
-  {
-    if ((key_check = (*it).first) > key)
-    {
-      return key_check;
-    }
-  }
-  return variant();
+  const variant *next = ds_maps[id].next_key(key);
+  return next ? *next : variant();
 }
 
 variant ds_map_find_first(const unsigned int id)
 {
   //Returns the smallest key in the map
-  multimap<variant, variant>::iterator it = ds_maps[id].begin();
-  return (it == ds_maps[id].end()) ? variant() : (*it).first;
+  const variant *first = ds_maps[id].first_key();
+  return first ? *first : variant();
 }
 
 variant ds_map_find_last(const unsigned int id)
 {
   //Returns the largest key in the map
-  multimap<variant, variant>::reverse_iterator rit = ds_maps[id].rbegin();
-  return ((rit == ds_maps[id].rend()) ? variant() : (*rit).first);
+  const variant *last = ds_maps[id].last_key();
+  return last ? *last : variant();
 }
 
 bool ds_map_exists(const unsigned int id)
 {
   //returns whether the map exists
-  return (ds_maps.find(id) != ds_maps.end());
+  return ds_maps.exists(id);
 }
 
 unsigned int ds_map_duplicate(const unsigned int source)
 {
   //creates and returns a new map containing a copy of the source map
-  ds_maps.insert(pair<unsigned int, multimap<variant, variant> >(++ds_maps_maxid, multimap<variant, variant>()));
-  ds_maps[ds_maps_maxid-1] = ds_maps[source];
-  return ds_maps_maxid-1;
+  return ds_maps.add(new variant_map(ds_maps[source]));
 }
 
 std::string ds_map_write(const unsigned int id)
@@ -1014,55 +1822,52 @@ std::string ds_map_write(const unsigned int id)
   ss.width(4);
   ss.fill('0');
 
-  std::multimap<variant, variant> dsMap = ds_maps[id];
+  const variant_map &dsMap = ds_maps[id];
 
   // Write size
   ss << std::hex << dsMap.size();
 
-  std::multimap<variant, variant>::iterator it = dsMap.begin();
-  while (it != dsMap.end())
+  dsMap.for_each_ordered([&](const variant &key, const variant &value)
   {
     // Write type
     ss.width(2);
-    ss << (unsigned int)(((*it).first.type == ty_real) ? 0x00 : 0x01);
+    ss << (unsigned int)((key.type == ty_real) ? 0x00 : 0x01);
 
     // Write data
-    if ((*it).first.type == ty_real)
+    if (key.type == ty_real)
     {
       ss.width(16);
-            char* b = (char*)&(*it).first.rval.d;
+            char* b = (char*)&key.rval.d;
             for (unsigned i = 0; i < sizeof(double); ++i)
             ss << b[i];
     }
     else
     {
-      ss.width(4); ss << (*it).first.string_length();
+      ss.width(4); ss << key.string_length();
       ss.width(1);
-      for (size_t j = 0; j < (*it).first.string_length(); ++j)
-        ss << (*it).first.char_at(j);
+      for (size_t j = 0; j < key.string_length(); ++j)
+        ss << key.char_at(j);
     }
 
     // Write type
     ss.width(2);
-    ss << (unsigned int)(((*it).second.type == ty_real) ? 0x00 : 0x01);
+    ss << (unsigned int)((value.type == ty_real) ? 0x00 : 0x01);
 
     // Write data
-    if ((*it).second.type == ty_real)
+    if (value.type == ty_real)
     {
       ss.width(16);
-      char* b = (char*)&(*it).second.rval.d;
+      char* b = (char*)&value.rval.d;
       for (unsigned i = 0; i < sizeof(double); ++i)
         ss << b[i];    }
     else
     {
-      ss.width(4); ss << (*it).second.string_length();
+      ss.width(4); ss << value.string_length();
       ss.width(1);
-      for (size_t j = 0; j < (*it).second.string_length(); ++j)
-        ss << (*it).second.char_at(j);
+      for (size_t j = 0; j < value.string_length(); ++j)
+        ss << value.char_at(j);
     }
-
-    ++it;
-  }
+  });
 
   return ss.str();
 }
@@ -1150,7 +1955,7 @@ void ds_map_read(const unsigned int id, std::string value)
     }
 
     // Push value
-    ds_maps[id].insert(std::pair<variant, variant>(variKey, variValue));
+    ds_maps[id].add(variKey, variValue);
   }
 }
 
@@ -1158,8 +1963,7 @@ void ds_map_read(const unsigned int id, std::string value)
 
 /* ds_lists */
 
-static map<unsigned int, vector<variant> > ds_lists;
-static unsigned int ds_lists_maxid = 0;
+static ds_registry<variant_list> ds_lists;
 
 namespace enigma_user
 {
@@ -1167,14 +1971,13 @@ namespace enigma_user
 unsigned int ds_list_create()
 {
   //Creates a new list. The function returns an integer as an id that must be used in all other functions to access the particular list.
-  ds_lists.insert(pair<unsigned int, vector<variant> >(ds_lists_maxid++, vector<variant>()));
-  return ds_lists_maxid-1;
+  return ds_lists.add(new variant_list());
 }
 
 void ds_list_destroy(const unsigned int id)
 {
-  //Destroys the list
-  ds_lists.erase(ds_lists.find(id));
+  //Destroys the list, along with any maps and lists marked in it
+  ds_destroy_nested(ds_lists, id);
 }
 
 void ds_list_clear(const unsigned int id)
@@ -1186,70 +1989,73 @@ void ds_list_clear(const unsigned int id)
 void ds_list_copy(const unsigned int id, const unsigned int source)
 {
   //Copies the source list onto the list
-  ds_lists[id] = ds_lists[source];
+  if (id != source && ds_lists.exists(source))
+    ds_lists[id] = ds_lists[source];
 }
 
 unsigned int ds_list_size(const unsigned int id)
 {
   //Returns the size of the list
-  return ds_lists[id].size();
+  return ds_lists[id].values.size();
 }
 
 bool ds_list_empty(const unsigned int id)
 {
   //Returns whether the list contains no values
-  return ds_lists[id].empty();
+  return ds_lists[id].values.empty();
 }
 
 void ds_list_add(const unsigned int id, const enigma::varargs &values)
 {
   //Adds the values at the end of the list.
   for (int i = 0; i < values.argc; ++i)
-    ds_lists[id].push_back(values.get(i));
+    ds_lists[id].values.push_back(values.get(i));
 }
 
 void ds_list_insert(const unsigned int id, const unsigned int pos, const variant val)
 {
   //Inserts val and the given pos in the list
 
-  if (pos <= ds_lists[id].size())
+  if (pos <= ds_lists[id].values.size())
   {
-    ds_lists[id].insert(ds_lists[id].begin() + pos, val);
+    ds_lists[id].insert(pos, val);
   }
 }
 
 void ds_list_replace(const unsigned int id, const unsigned int pos, const variant val)
 {
   //replaces the value at pos with the val in the list
-  if (pos < ds_lists[id].size())
+  if (pos < ds_lists[id].values.size())
   {
-    ds_lists[id][pos] = val;
+    ds_lists[id].values[pos] = val;
+    ds_lists[id].mark(pos, ds_unmarked);
   }
 }
 
 void ds_list_delete(const unsigned int id, const unsigned int pos)
 {
   //deletes the value at the given pos in the list
-  if (pos < ds_lists[id].size())
+  if (pos < ds_lists[id].values.size())
   {
-    ds_lists[id].erase(ds_lists[id].begin() + pos);
+    ds_lists[id].erase(pos, pos + 1);
   }
 }
 
 void ds_list_delete(const unsigned int id, const unsigned int first, const unsigned int last)
 {
   //Deletes the values in the range between first and last
-  if (first < ds_lists[id].size() && last < ds_lists[id].size())
+  if (first < ds_lists[id].values.size() && last < ds_lists[id].values.size())
   {
-    ds_lists[id].erase(ds_lists[id].begin() + first, ds_lists[id].begin() + last+1);
+    ds_lists[id].erase(first, last + 1);
   }
 }
 
 int ds_list_find_index(const unsigned int id, const variant val)
 {
-  for (size_t i = 0; i < ds_lists[id].size(); i++)
+  const vector<variant> &values = ds_lists[id].values;
+  for (size_t i = 0; i < values.size(); i++)
   {
-    if (ds_lists[id][i] == val)
+    if (values[i] == val)
     {
       return i;
     }
@@ -1260,41 +2066,56 @@ int ds_list_find_index(const unsigned int id, const variant val)
 variant ds_list_find_value(const unsigned int id, const unsigned int pos)
 {
   //Returns the value stored at the indicated position in the list
-  vector<variant>::iterator it = ds_lists[id].begin() + pos;
-  return ((it == ds_lists[id].end()) ? variant() : (*it));
+  vector<variant>::iterator it = ds_lists[id].values.begin() + pos;
+  return ((it == ds_lists[id].values.end()) ? variant() : (*it));
 }
 
 void ds_list_sort(const unsigned int id, const bool ascend)
 {
   //Sorts the values in the list. When ascend is true the values are sorted in ascending order, otherwise in descending order.
-  if (ascend)
-  {
-    sort(ds_lists[id].begin(), ds_lists[id].end());
-  }
-  else
-  {
-    sort(ds_lists[id].rbegin(), ds_lists[id].rend());
-  }
+  ds_lists[id].sort(ascend);
 }
 
 void ds_list_shuffle(const unsigned int id)
 {
   //shuffles the values in the list into a random order
-  mt_random_shuffle(ds_lists[id].begin(), ds_lists[id].end());
+  ds_lists[id].shuffle();
+}
+
+void ds_list_mark_as_map(const unsigned int id, const unsigned int pos)
+{
+  //Marks the value at pos as the id of a map, to be destroyed with the list
+  ds_lists[id].mark(pos, ds_marked_map);
+}
+
+void ds_list_mark_as_list(const unsigned int id, const unsigned int pos)
+{
+  //Marks the value at pos as the id of a list, to be destroyed with the list
+  ds_lists[id].mark(pos, ds_marked_list);
+}
+
+bool ds_list_is_map(const unsigned int id, const unsigned int pos)
+{
+  //returns whether the value at pos is marked as a map
+  return ds_lists[id].mark_of(pos) == ds_marked_map;
+}
+
+bool ds_list_is_list(const unsigned int id, const unsigned int pos)
+{
+  //returns whether the value at pos is marked as a list
+  return ds_lists[id].mark_of(pos) == ds_marked_list;
 }
 
 bool ds_list_exists(const unsigned int id)
 {
   //returns whether the list exists
-  return (ds_lists.find(id) != ds_lists.end());
+  return ds_lists.exists(id);
 }
 
 unsigned int ds_list_duplicate(const unsigned int source)
 {
   //creates and returns a new list containing a copy of the source list
-  ds_lists.insert(pair<unsigned int, vector<variant> >(++ds_lists_maxid, vector<variant>()));
-  ds_lists[ds_lists_maxid-1] = ds_lists[source];
-  return ds_lists_maxid-1;
+  return ds_lists.add(new variant_list(ds_lists[source]));
 }
 
 std::string ds_list_write(const unsigned int id)
@@ -1304,7 +2125,7 @@ std::string ds_list_write(const unsigned int id)
   ss.width(4);
   ss.fill('0');
 
-  std::vector<variant> dsList = ds_lists[id];
+  const std::vector<variant> &dsList = ds_lists[id].values;
 
   // Write count
   ss << dsList.size();
@@ -1369,7 +2190,7 @@ void ds_list_read(const unsigned int id, std::string value)
       i += 16;
 
       vari.rval.d = d;
-      ds_lists[id].push_back(vari);
+      ds_lists[id].values.push_back(vari);
     }
     else
     {
@@ -1385,17 +2206,32 @@ void ds_list_read(const unsigned int id, std::string value)
       vari = value.substr(i, len);
       i += len;
 
-      ds_lists[id].push_back(vari);
+      ds_lists[id].values.push_back(vari);
     }
   }
 }
 
 }
 
+namespace enigma
+{
+
+void ds_map_visit(unsigned int id, const std::function<void(const variant&, const variant&, ds_mark)> &f)
+{
+  ds_maps[id].for_each_ordered_marked(f);
+}
+
+void ds_list_visit(unsigned int id, const std::function<void(const variant&, ds_mark)> &f)
+{
+  const variant_list &list = ds_lists[id];
+  for (unsigned int i = 0; i < list.values.size(); i++) f(list.values[i], list.mark_of(i));
+}
+
+}
+
 /* ds_prioritys */
 
-static map<unsigned int, multimap<variant, variant> > ds_prioritys;
-static unsigned int ds_prioritys_maxid = 0;
+static ds_registry<variant_priority> ds_prioritys;
 
 namespace enigma_user
 {
@@ -1403,14 +2239,13 @@ namespace enigma_user
 unsigned int ds_priority_create()
 {
   //Creates a new priority queue. The function returns an integer as an id that must be used in all other functions to access the particular priority queue.
-  ds_prioritys.insert(pair<unsigned int, multimap<variant, variant> >(ds_prioritys_maxid++, multimap<variant, variant>()));
-  return ds_prioritys_maxid-1;
+  return ds_prioritys.add(new variant_priority());
 }
 
 void ds_priority_destroy(const unsigned int id)
 {
   //Destroys the priority queue
-  ds_prioritys.erase(ds_prioritys.find(id));
+  ds_prioritys.erase(id);
 }
 
 void ds_priority_clear(const unsigned int id)
@@ -1437,118 +2272,74 @@ bool ds_priority_empty(const unsigned int id)
   return ds_prioritys[id].empty();
 }
 
-void ds_priority_add(const unsigned int id, const variant val, const variant prio)
+void ds_priority_add(const unsigned int id, const variant &val, const variant &prio)
 {
   //Adds the value with the given priority to the priority queue
-  ds_prioritys[id].insert(pair<variant, variant>(val, prio));
+  ds_prioritys[id].add(val, prio);
 }
 
-void ds_priority_change_priority(const unsigned int id, const variant val, const variant prio)
+void ds_priority_change_priority(const unsigned int id, const variant &val, const variant &prio)
 {
   //Changes the priority of the given value in the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].find(val);
-  if (it != ds_prioritys[id].end())
-  {
-    ds_prioritys[id].erase(it);
-    ds_prioritys[id].insert(pair<variant, variant>(val, prio));
-  }
+  if (ds_prioritys[id].erase(val))
+    ds_prioritys[id].add(val, prio);
 }
 
-variant ds_priority_find_priority(const unsigned int id, const variant val)
+variant ds_priority_find_priority(const unsigned int id, const variant &val)
 {
   //Returns the priority of the given value in the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].find(val);
-  return ((it == ds_prioritys[id].end()) ? variant() : (*it).second);
+  const variant *prio = ds_prioritys[id].find(val);
+  return prio ? *prio : variant();
 }
 
-void ds_priority_delete_value(const unsigned int id, const variant val)
+void ds_priority_delete_value(const unsigned int id, const variant &val)
 {
   //Deletes the given value (with its priority) from the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].find(val);
-  if (it != ds_prioritys[id].end())
-  {
-    ds_prioritys[id].erase(it);
-  }
+  ds_prioritys[id].erase(val);
 }
 
-bool ds_priority_value_exists(const unsigned int id, const variant val)
+bool ds_priority_value_exists(const unsigned int id, const variant &val)
 {
   //returns whether the value exists in the priority queue
-  return (ds_prioritys[id].find(val) != ds_prioritys[id].end());
+  return ds_prioritys[id].find(val) != NULL;
 }
 
 variant ds_priority_delete_min(const unsigned int id)
 {
-  //Returns the value with the smallest priority but does not delete it from the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].begin(), it_check;
-  if (it == ds_prioritys[id].end()) {return 0;}
-  it_check = it++;
-  while (it != ds_prioritys[id].end())
-  {
-    if ((*it).second < (*it_check).second) {it_check = it;}
-    it++;
-  }
-  const variant val = (*it_check).first;
-  ds_prioritys[id].erase(it_check);
-  return val;
+  //Deletes the value with the smallest priority from the priority queue and returns it
+  return ds_prioritys[id].pop_min(0);
 }
 
 variant ds_priority_find_min(const unsigned int id)
 {
   //Returns the value with the smallest priority but does not delete it from the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].begin(), it_check;
-  if (it == ds_prioritys[id].end()) {return variant();}
-  it_check = it++;
-  while (it != ds_prioritys[id].end())
-  {
-    if ((*it).second < (*it_check).second) {it_check = it;}
-    it++;
-  }
-  return ((*it_check).first);
+  const variant *val = ds_prioritys[id].min();
+  return val ? *val : variant();
 }
 
 variant ds_priority_delete_max(const unsigned int id)
 {
-  //Returns the value with the smallest priority but does not delete it from the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].begin(), it_check;
-  if (it == ds_prioritys[id].end()) {return variant();}
-  it_check = it++;
-  while (it != ds_prioritys[id].end())
-  {
-    if ((*it).second > (*it_check).second) {it_check = it;}
-    it++;
-  }
-  const variant val = (*it_check).first;
-  ds_prioritys[id].erase(it_check);
-  return val;
+  //Deletes the value with the largest priority from the priority queue and returns it
+  return ds_prioritys[id].pop_max(variant());
 }
 
 variant ds_priority_find_max(const unsigned int id)
 {
-  //Returns the value with the smallest priority but does not delete it from the priority queue
-  multimap<variant, variant>::iterator it = ds_prioritys[id].begin(), it_check;
-  if (it == ds_prioritys[id].end()) {return variant();}
-  it_check = it++;
-  while (it != ds_prioritys[id].end())
-  {
-    if ((*it).second > (*it_check).second) {it_check = it;}
-    it++;
-  }
-  return ((*it_check).first);
+  //Returns the value with the largest priority but does not delete it from the priority queue
+  const variant *val = ds_prioritys[id].max();
+  return val ? *val : variant();
 }
 
 bool ds_priority_exists(const unsigned int id)
 {
   //returns whether the priority queue exists
-  return (ds_prioritys.find(id) != ds_prioritys.end());
+  return ds_prioritys.exists(id);
 }
 
 unsigned int ds_priority_duplicate(const unsigned int source)
 {
   //creates and returns a new priority queue containing a copy of the source priority queue
-  ds_prioritys.insert(pair<unsigned int, multimap<variant, variant> >(++ds_prioritys_maxid, multimap<variant, variant>()));
-  ds_prioritys[ds_prioritys_maxid-1] = ds_prioritys[source];
-  return ds_prioritys_maxid-1;
+  return ds_prioritys.add(new variant_priority(ds_prioritys[source]));
 }
 
 std::string ds_priority_write(const unsigned int id)
@@ -1558,40 +2349,37 @@ std::string ds_priority_write(const unsigned int id)
   ss.width(4);
   ss.fill('0');
 
-  std::multimap<variant, variant> dsPriority = ds_prioritys[id];
+  const variant_priority &dsPriority = ds_prioritys[id];
 
   // Write size
   ss << std::hex << dsPriority.size();
 
-  std::multimap<variant, variant>::iterator it = dsPriority.begin();
-  while (it != dsPriority.end())
+  dsPriority.for_each_ordered([&](const variant &val, const variant &prio)
   {
     // Write type
     ss.width(2);
-    ss << (unsigned int)(((*it).first.type == ty_real) ? 0x00 : 0x01);
+    ss << (unsigned int)((val.type == ty_real) ? 0x00 : 0x01);
     ss.width(16);
-    char* b = (char*)&(*it).second.rval.d;
+    char* b = (char*)&prio.rval.d;
     for (unsigned i = 0; i < sizeof(double); ++i)
         ss << b[i];
 
     // Write data
-    if ((*it).first.type == ty_real)
+    if (val.type == ty_real)
     {
       ss.width(16);
-      char* b = (char*)&(*it).first.rval.d;
+      char* b = (char*)&val.rval.d;
       for (unsigned i = 0; i < sizeof(double); ++i)
           ss << b[i];
     }
     else
     {
-      ss.width(4); ss << (*it).first.string_length();
+      ss.width(4); ss << val.string_length();
       ss.width(1);
-      for (size_t j = 0; j < (*it).first.string_length(); ++j)
-        ss << (*it).first.char_at(j);
+      for (size_t j = 0; j < val.string_length(); ++j)
+        ss << val.char_at(j);
     }
-
-    ++it;
-  }
+  });
 
   return ss.str();
 }
@@ -1658,7 +2446,7 @@ void ds_priority_read(const unsigned int id, std::string value)
     }
 
     // Push value
-    ds_prioritys[id].insert(std::pair<variant, variant>(vari, prio));
+    ds_prioritys[id].add(vari, prio);
   }
 }
 
@@ -1666,8 +2454,7 @@ void ds_priority_read(const unsigned int id, std::string value)
 
 /* ds_queues */
 
-static map<unsigned int, deque<variant> > ds_queues;
-static unsigned int ds_queues_maxid = 0;
+static ds_registry<deque<variant> > ds_queues;
 
 namespace enigma_user
 {
@@ -1675,14 +2462,13 @@ namespace enigma_user
 unsigned int ds_queue_create()
 {
   //Creates a new queue. The function returns an integer as an id that must be used in all other functions to access the particular queue.
-  ds_queues.insert(pair<unsigned int, deque<variant> >(ds_queues_maxid++, deque<variant>()));
-  return ds_queues_maxid-1;
+  return ds_queues.add(new deque<variant>());
 }
 
 void ds_queue_destroy(const unsigned int id)
 {
   //Destroys the queue
-  ds_queues.erase(ds_queues.find(id));
+  ds_queues.erase(id);
 }
 
 void ds_queue_clear(const unsigned int id)
@@ -1743,15 +2529,13 @@ variant ds_queue_tail(const unsigned int id)
 bool ds_queue_exists(const unsigned int id)
 {
   //returns whether the queue exists
-  return (ds_queues.find(id) != ds_queues.end());
+  return ds_queues.exists(id);
 }
 
 unsigned int ds_queue_duplicate(const unsigned int source)
 {
   //creates and returns a new queue containing a copy of the source queue
-  ds_queues.insert(pair<unsigned int, deque<variant> >(++ds_queues_maxid, deque<variant>()));
-  ds_queues[ds_queues_maxid-1] = ds_queues[source];
-  return ds_queues_maxid-1;
+  return ds_queues.add(new deque<variant>(ds_queues[source]));
 }
 
 std::string ds_queue_write(const unsigned int id)
@@ -1850,8 +2634,7 @@ void ds_queue_read(const unsigned int id, std::string value)
 
 /* ds_stacks */
 
-static map<unsigned int, deque<variant> > ds_stacks;
-static unsigned int ds_stacks_maxid = 0;
+static ds_registry<deque<variant> > ds_stacks;
 
 namespace enigma_user
 {
@@ -1859,14 +2642,13 @@ namespace enigma_user
 unsigned int ds_stack_create()
 {
   //Creates a new stack. The function returns an integer as an id that must be used in all other functions to access the particular stack.
-  ds_stacks.insert(pair<unsigned int, deque<variant> >(ds_stacks_maxid++, deque<variant>()));
-  return ds_stacks_maxid-1;
+  return ds_stacks.add(new deque<variant>());
 }
 
 void ds_stack_destroy(const unsigned int id)
 {
   //Destroys the stack
-  ds_stacks.erase(ds_stacks.find(id));
+  ds_stacks.erase(id);
 }
 
 void ds_stack_clear(const unsigned int id)
@@ -1920,15 +2702,13 @@ variant ds_stack_top(const unsigned int id)
 bool ds_stack_exists(const unsigned int id)
 {
   //returns whether the stack exists
-  return (ds_stacks.find(id) != ds_stacks.end());
+  return ds_stacks.exists(id);
 }
 
 unsigned int ds_stack_duplicate(const unsigned int source)
 {
   //creates and returns a new stack containing a copy of the source stack
-  ds_stacks.insert(pair<unsigned int, deque<variant> >(++ds_stacks_maxid, deque<variant>()));
-  ds_stacks[ds_stacks_maxid-1] = ds_stacks[source];
-  return ds_stacks_maxid-1;
+  return ds_stacks.add(new deque<variant>(ds_stacks[source]));
 }
 
 std::string ds_stack_write(const unsigned int id)
@@ -0,0 +1,41 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#  error This file includes non-ENIGMA STL headers and should not be included from SHELLmain.
+#endif
+
+#ifndef ENIGMA_DATASTRUCTURES_INTERNAL_H
+#define ENIGMA_DATASTRUCTURES_INTERNAL_H
+
+#include "Universal_System/var4.h"
+
+#include <functional>
+
+namespace enigma
+{
+  // What a ds_map value or ds_list entry has been marked as: the id of a
+  // nested map or list, which goes when its container is destroyed
+  enum ds_mark { ds_unmarked, ds_marked_map, ds_marked_list };
+
+  // For extensions that walk whole structures, such as json_encode, without a
+  // lookup per entry: f(key, value, mark) for each entry of the map, in key
+  // order, and f(value, mark) for each entry of the list, in order
+  void ds_map_visit(unsigned int id, const std::function<void(const variant&, const variant&, ds_mark)> &f);
+  void ds_list_visit(unsigned int id, const std::function<void(const variant&, ds_mark)> &f);
+}
+
+#endif // ENIGMA_DATASTRUCTURES_INTERNAL_H
@@ -68,6 +68,7 @@ int ds_grid_value_y(const unsigned int id, const unsigned int x1, const unsigned
 bool ds_grid_value_disk_exists(const unsigned int id, const double x, const double y, const double r, const variant val);
 bool ds_grid_value_disk_x(const unsigned int id, const double x, const double y, const double r, const variant val);
 bool ds_grid_value_disk_y(const unsigned int id, const double x, const double y, const double r, const variant val);
+void ds_grid_summed_area_enable(const unsigned int id, const bool enable);
 void ds_grid_shuffle(const unsigned int id);
 bool ds_grid_exists(const unsigned int id);
 unsigned int ds_grid_duplicate(const unsigned int source);
@@ -80,15 +81,21 @@ void ds_map_clear(const unsigned int id);
 void ds_map_copy(const unsigned int id, const unsigned int source);
 unsigned int ds_map_size(const unsigned int id);
 bool ds_map_empty(const unsigned int id);
-void ds_map_add(const unsigned int id, const variant key, const variant val);
-void ds_map_replace(const unsigned int id, const variant key, const variant val);
-void ds_map_overwrite(const unsigned int id, const variant key, const variant val);
-void ds_map_delete(const unsigned int id, const variant key);
-void ds_map_delete(const unsigned int id, const variant first, const variant last);
-bool ds_map_exists(const unsigned int id, const variant key);
-variant ds_map_find_value(const unsigned int id, const variant key);
-variant ds_map_find_previous(const unsigned int id, const variant key);
-variant ds_map_find_next(const unsigned int id, const variant key);
+void ds_map_add(const unsigned int id, const variant &key, const variant &val);
+void ds_map_replace(const unsigned int id, const variant &key, const variant &val);
+void ds_map_overwrite(const unsigned int id, const variant &key, const variant &val);
+void ds_map_delete(const unsigned int id, const variant &key);
+void ds_map_delete(const unsigned int id, const variant &first, const variant &last);
+void ds_map_add_map(const unsigned int id, const variant &key, const unsigned int map);
+void ds_map_add_list(const unsigned int id, const variant &key, const unsigned int list);
+void ds_map_replace_map(const unsigned int id, const variant &key, const unsigned int map);
+void ds_map_replace_list(const unsigned int id, const variant &key, const unsigned int list);
+bool ds_map_is_map(const unsigned int id, const variant &key);
+bool ds_map_is_list(const unsigned int id, const variant &key);
+bool ds_map_exists(const unsigned int id, const variant &key);
+variant ds_map_find_value(const unsigned int id, const variant &key);
+variant ds_map_find_previous(const unsigned int id, const variant &key);
+variant ds_map_find_next(const unsigned int id, const variant &key);
 variant ds_map_find_first(const unsigned int id);
 variant ds_map_find_last(const unsigned int id);
 bool ds_map_exists(const unsigned int id);
@@ -111,6 +118,10 @@ int ds_list_find_index(const unsigned int id, const variant val);
 variant ds_list_find_value(const unsigned int id, const unsigned int pos);
 void ds_list_sort(const unsigned int id, const bool ascend);
 void ds_list_shuffle(const unsigned int id);
+void ds_list_mark_as_map(const unsigned int id, const unsigned int pos);
+void ds_list_mark_as_list(const unsigned int id, const unsigned int pos);
+bool ds_list_is_map(const unsigned int id, const unsigned int pos);
+bool ds_list_is_list(const unsigned int id, const unsigned int pos);
 bool ds_list_exists(const unsigned int id);
 unsigned int ds_list_duplicate(const unsigned int source);
 std::string ds_list_write(const unsigned int id);
@@ -122,11 +133,11 @@ void ds_priority_clear(const unsigned int id);
 void ds_priority_copy(const unsigned int id, const unsigned int source);
 unsigned int ds_priority_size(const unsigned int id);
 bool ds_priority_empty(const unsigned int id);
-void ds_priority_add(const unsigned int id, const variant val, const variant prio);
-void ds_priority_change_priority(const unsigned int id, const variant val, const variant prio);
-variant ds_priority_find_priority(const unsigned int id, const variant val);
-void ds_priority_delete_value(const unsigned int id, const variant val);
-bool ds_priority_value_exists(const unsigned int id, const variant val);
+void ds_priority_add(const unsigned int id, const variant &val, const variant &prio);
+void ds_priority_change_priority(const unsigned int id, const variant &val, const variant &prio);
+variant ds_priority_find_priority(const unsigned int id, const variant &val);
+void ds_priority_delete_value(const unsigned int id, const variant &val);
+bool ds_priority_value_exists(const unsigned int id, const variant &val);
 variant ds_priority_delete_min(const unsigned int id);
 variant ds_priority_find_min(const unsigned int id);
 variant ds_priority_delete_max(const unsigned int id);
@@ -21,201 +21,567 @@
 **/
 
 #include "Widget_Systems/widgets_mandatory.h"
+#include "Universal_System/buffers_internal.h"
+#include "Universal_System/estring.h"
 #include "json.h"
-#include <cstdio>
-#include <iostream>
 #include "../DataStructures/include.h"
-#include "libjson.h"
+#include "../DataStructures/data_structures_internal.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
 
 using std::string;
+using std::vector;
 
-namespace enigma_user
+namespace
 {
-	int RecursiveDSList(Json::Value value);
-
-	int RecursiveDSMap(Json::Value root)
+	// Reads JSON text in a single pass, telling a handler what it finds as it
+	// goes rather than building a tree of it: begin_object(), key(string),
+	// end_object(), begin_array(), end_array() and value(variant). Open
+	// containers are kept on a stack of its own, so nesting costs no recursion.
+	// Like the reader this replaced, it allows // and /* */ comments.
+	class json_reader
 	{
-		int jsonObject=ds_map_create();
+		const char *const begin, *const end;
+		const char *at;
+		string text;  // The last string read, reused from one to the next
+		string error;
 
-		Json::Value::Members m=root.getMemberNames();
-		for (Json::Value::Members::iterator it = m.begin() ; it != m.end(); ++it)
+		bool fail(const string &message)
+		{
+			error = message;
+			return false;
+		}
+		bool skip_space()
 		{
-			if (root[*it].isNull())
+			while (at < end)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",0);
-				ds_map_add(jsonObject,*it,dsmap);
+				const char c = *at;
+				if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+					at++;
+				else if (c == '/' && end - at > 1 && at[1] == '/')
+				{
+					while (at < end && *at != '\n') at++;
+				}
+				else if (c == '/' && end - at > 1 && at[1] == '*')
+				{
+					at += 2;
+					while (end - at > 1 && !(at[0] == '*' && at[1] == '/')) at++;
+					if (end - at < 2) return fail("Unterminated comment");
+					at += 2;
+				}
+				else
+					break;
 			}
-			else if (root[*it].isBool())
+			return true;
+		}
+		static int hex_digit(char c)
+		{
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			return -1;
+		}
+		bool read_hex4(unsigned &code)
+		{
+			if (end - at < 4) return fail("Bad \\u escape");
+			code = 0;
+			for (int i = 0; i < 4; i++)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asInt());
-				ds_map_add(jsonObject,*it,dsmap);
+				const int d = hex_digit(*at++);
+				if (d < 0) return fail("Bad \\u escape");
+				code = code << 4 | d;
 			}
-			else if (root[*it].isInt())
+			return true;
+		}
+		void append_utf8(unsigned code)
+		{
+			if (code < 0x80)
+				text += char(code);
+			else if (code < 0x800)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asInt());
-				ds_map_add(jsonObject,*it,dsmap);
+				text += char(0xC0 | code >> 6);
+				text += char(0x80 | (code & 0x3F));
 			}
-			else if (root[*it].isUInt())
+			else if (code < 0x10000)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asUInt());
-				ds_map_add(jsonObject,*it,dsmap);
+				text += char(0xE0 | code >> 12);
+				text += char(0x80 | (code >> 6 & 0x3F));
+				text += char(0x80 | (code & 0x3F));
 			}
-			else if (root[*it].isIntegral())
+			else
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asInt());
-				ds_map_add(jsonObject,*it,dsmap);
+				text += char(0xF0 | code >> 18);
+				text += char(0x80 | (code >> 12 & 0x3F));
+				text += char(0x80 | (code >> 6 & 0x3F));
+				text += char(0x80 | (code & 0x3F));
 			}
-			else if (root[*it].isDouble())
+		}
+		// Reads a string, the opening quote already passed, into text
+		bool read_string()
+		{
+			text.clear();
+			for (;;)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asDouble());
-				ds_map_add(jsonObject,*it,dsmap);
+				const char *run = at;
+				while (at < end && *at != '"' && *at != '\\') at++;
+				text.append(run, at - run);
+				if (at == end) return fail("Unterminated string");
+				if (*at++ == '"') return true;
+				if (at == end) return fail("Unterminated string");
+				switch (*at++)
+				{
+					case '"': text += '"'; break;
+					case '\\': text += '\\'; break;
+					case '/': text += '/'; break;
+					case 'b': text += '\b'; break;
+					case 'f': text += '\f'; break;
+					case 'n': text += '\n'; break;
+					case 'r': text += '\r'; break;
+					case 't': text += '\t'; break;
+					case 'u':
+					{
+						unsigned code;
+						if (!read_hex4(code)) return false;
+						if (code >= 0xD800 && code < 0xDC00)
+						{
+							unsigned low;
+							if (end - at < 2 || at[0] != '\\' || at[1] != 'u') return fail("Missing low surrogate");
+							at += 2;
+							if (!read_hex4(low)) return false;
+							if (low < 0xDC00 || low >= 0xE000) return fail("Bad low surrogate");
+							code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+						}
+						append_utf8(code);
+						break;
+					}
+					default:
+						return fail("Bad escape sequence");
+				}
 			}
-			else if (root[*it].isNumeric())
+		}
+		// Reads a number. Integers of up to 15 digits, which is most of them,
+		// are exact when summed digit by digit, so only the rest go to strtod.
+		bool read_number(double &number)
+		{
+			const char *const start = at;
+			if (at < end && *at == '-') at++;
+			const char *const digits = at;
+			long long whole = 0;
+			for (; at < end && *at >= '0' && *at <= '9'; at++)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asDouble());
-				ds_map_add(jsonObject,*it,dsmap);
+				// Past 15 digits the value goes to strtod, and summing on could overflow
+				if (at - digits < 15) whole = whole * 10 + (*at - '0');
 			}
-			else if (root[*it].isString())
+			if (at == digits) return fail("Expected a value");
+			bool integral = at - digits <= 15;
+			if (at < end && *at == '.')
 			{
-				//ds_map with key "default" and value
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[*it].asString());
-				ds_map_add(jsonObject,*it,dsmap);
+				integral = false;
+				if (++at == end || *at < '0' || *at > '9') return fail("Bad number");
+				while (at < end && *at >= '0' && *at <= '9') at++;
 			}
-			else if (root[*it].isArray())
+			if (at < end && (*at == 'e' || *at == 'E'))
 			{
-				//ds_map with key "default" and ds_list of the objects or values
-				int dsmap=RecursiveDSList(root[*it]);
-				if (dsmap==-1)
-				{
-					return -1;
-				}
-				ds_map_add(jsonObject,*it,dsmap);
+				integral = false;
+				if (++at < end && (*at == '+' || *at == '-')) at++;
+				if (at == end || *at < '0' || *at > '9') return fail("Bad number");
+				while (at < end && *at >= '0' && *at <= '9') at++;
 			}
-			else if (root[*it].isObject())
+			if (integral)
 			{
-				int dsmap=RecursiveDSMap(root[*it]);
-				if (dsmap==-1)
+				number = *start == '-' ? -double(whole) : double(whole);
+				return true;
+			}
+			// The text needn't be null terminated, so strtod gets a copy
+			const string digits_text(start, at);
+			number = strtod(digits_text.c_str(), NULL);
+			return true;
+		}
+		bool read_literal(const char *word, size_t length)
+		{
+			if (size_t(end - at) < length || string(at, length) != word) return fail("Expected a value");
+			at += length;
+			return true;
+		}
+		// Reads a member's key and the colon after it
+		template <typename H> bool read_key(H &handler)
+		{
+			if (!skip_space()) return false;
+			if (at == end || *at != '"') return fail("Expected a string key");
+			at++;
+			if (!read_string()) return false;
+			if (!skip_space()) return false;
+			if (at == end || *at != ':') return fail("Expected ':' after a key");
+			at++;
+			handler.key(text);
+			return true;
+		}
+
+		public:
+		json_reader(const char *data, size_t size): begin(data), end(data + size), at(data) {}
+
+		template <typename H> bool parse(H &handler)
+		{
+			vector<char> nest;  // '{' or '[' for each open container
+			for (;;)
+			{
+				// A value
+				if (!skip_space()) return false;
+				if (at == end) return fail("Expected a value");
+				switch (*at)
+				{
+					case '{':
+						at++;
+						handler.begin_object();
+						if (!skip_space()) return false;
+						if (at < end && *at == '}')
+						{
+							at++;
+							handler.end_object();
+							break;
+						}
+						nest.push_back('{');
+						if (!read_key(handler)) return false;
+						continue;
+					case '[':
+						at++;
+						handler.begin_array();
+						if (!skip_space()) return false;
+						if (at < end && *at == ']')
+						{
+							at++;
+							handler.end_array();
+							break;
+						}
+						nest.push_back('[');
+						continue;
+					case '"':
+						at++;
+						if (!read_string()) return false;
+						handler.value(variant(text));
+						break;
+					case 't':
+						if (!read_literal("true", 4)) return false;
+						handler.value(variant(1));
+						break;
+					case 'f':
+						if (!read_literal("false", 5)) return false;
+						handler.value(variant(0));
+						break;
+					case 'n':
+					{
+						if (!read_literal("null", 4)) return false;
+						variant null;
+						null.type = enigma_user::ty_undefined;
+						handler.value(null);
+						break;
+					}
+					default:
+					{
+						double number;
+						if (!read_number(number)) return false;
+						handler.value(variant(number));
+					}
+				}
+				// After a value, close what's finished, then on to the next one
+				for (;;)
 				{
-					return -1;
+					if (!skip_space()) return false;
+					if (nest.empty())
+					{
+						if (at != end) return fail("Unexpected text after the end");
+						return true;
+					}
+					if (at == end) return fail("Unexpected end of text");
+					const bool in_object = nest.back() == '{';
+					if (*at == ',')
+					{
+						at++;
+						if (in_object && !read_key(handler)) return false;
+						break;
+					}
+					if (*at != (in_object ? '}' : ']')) return fail(in_object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+					at++;
+					nest.pop_back();
+					if (in_object) handler.end_object();
+					else handler.end_array();
 				}
-				ds_map_add(jsonObject,*it,dsmap);
 			}
-			else
+		}
+
+		string error_message() const
+		{
+			int line = 1, column = 1;
+			for (const char *c = begin; c < at; c++)
 			{
-				return -1;
+				if (*c == '\n') line++, column = 1;
+				else column++;
 			}
+			return error + " at line " + enigma_user::toString(line) + ", column " + enigma_user::toString(column);
 		}
-		return jsonObject;
-	}
-	
-	int RecursiveDSList(Json::Value root)
+	};
+
+	// Builds GM's layout from what the reader finds: objects become ds_maps and
+	// arrays ds_lists, each marked in its parent so destroying the top map
+	// frees the lot. An array or a plain value at the top goes in a map under
+	// "default".
+	class ds_builder
 	{
-		int jsonObject=ds_map_create();
-		int jsonArray=ds_list_create();
-		ds_map_add(jsonObject,"default",jsonArray);
+		struct container
+		{
+			unsigned int id;
+			bool is_map;
+		};
+		vector<container> nest;
+		variant pending_key;
 
-		for (int i=0; i<root.size(); ++i)
+		// A key given twice keeps its last value, as it did with jsoncpp
+		void make_room(unsigned int map)
 		{
-			if (root[i].isNull())
-			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",0);
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
-			}
-			else if (root[i].isBool())
+			if (!enigma_user::ds_map_exists(map, pending_key)) return;
+			const variant old = enigma_user::ds_map_find_value(map, pending_key);
+			if (enigma_user::ds_map_is_map(map, pending_key)) enigma_user::ds_map_destroy(old);
+			else if (enigma_user::ds_map_is_list(map, pending_key)) enigma_user::ds_list_destroy(old);
+			enigma_user::ds_map_delete(map, pending_key);
+		}
+		void place(const variant &value)
+		{
+			if (nest.empty())
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asInt());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				root = enigma_user::ds_map_create();
+				enigma_user::ds_map_add(root, "default", value);
+				return;
 			}
-			else if (root[i].isInt())
+			const container &parent = nest.back();
+			if (parent.is_map)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asInt());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				make_room(parent.id);
+				enigma_user::ds_map_add(parent.id, pending_key, value);
 			}
-			else if (root[i].isUInt())
+			else
+				enigma_user::ds_list_insert(parent.id, enigma_user::ds_list_size(parent.id), value);
+		}
+		void open(bool is_map)
+		{
+			const unsigned int id = is_map ? enigma_user::ds_map_create() : enigma_user::ds_list_create();
+			if (nest.empty())
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asUInt());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				if (is_map)
+					root = id;
+				else
+				{
+					root = enigma_user::ds_map_create();
+					enigma_user::ds_map_add_list(root, "default", id);
+				}
 			}
-			else if (root[i].isIntegral())
+			else
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asInt());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				const container &parent = nest.back();
+				if (parent.is_map)
+				{
+					make_room(parent.id);
+					if (is_map) enigma_user::ds_map_add_map(parent.id, pending_key, id);
+					else enigma_user::ds_map_add_list(parent.id, pending_key, id);
+				}
+				else
+				{
+					const unsigned int pos = enigma_user::ds_list_size(parent.id);
+					enigma_user::ds_list_insert(parent.id, pos, id);
+					if (is_map) enigma_user::ds_list_mark_as_map(parent.id, pos);
+					else enigma_user::ds_list_mark_as_list(parent.id, pos);
+				}
 			}
-			else if (root[i].isDouble())
+			nest.push_back(container{id, is_map});
+		}
+
+		public:
+		int root = -1;
+
+		void begin_object() { open(true); }
+		void begin_array() { open(false); }
+		void end_object() { nest.pop_back(); }
+		void end_array() { nest.pop_back(); }
+		void key(const string &k) { pending_key = k; }
+		void value(const variant &v) { place(v); }
+	};
+
+	int decode(const char *data, size_t size)
+	{
+		json_reader reader(data, size);
+		ds_builder builder;
+		if (!reader.parse(builder))
+		{
+			DEBUG_MESSAGE("Failed to parse JSON: " + reader.error_message(), MESSAGE_TYPE::M_ERROR);
+			if (builder.root != -1) enigma_user::ds_map_destroy(builder.root);
+			return -1;
+		}
+		return builder.root;
+	}
+
+	// Writes a ds_map out as JSON, following marks into nested maps and lists
+	class json_writer
+	{
+		string &out;
+		vector<std::pair<bool, unsigned int> > path;  // The maps and lists open, to catch cycles
+
+		void write_string(const string &s)
+		{
+			static const char hex[] = "0123456789abcdef";
+			out += '"';
+			size_t run = 0;
+			for (size_t i = 0; i < s.size(); i++)
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asDouble());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				const unsigned char c = s[i];
+				if (c >= 0x20 && c != '"' && c != '\\') continue;
+				out.append(s, run, i - run);
+				run = i + 1;
+				out += '\\';
+				switch (c)
+				{
+					case '"': out += '"'; break;
+					case '\\': out += '\\'; break;
+					case '\b': out += 'b'; break;
+					case '\f': out += 'f'; break;
+					case '\n': out += 'n'; break;
+					case '\r': out += 'r'; break;
+					case '\t': out += 't'; break;
+					default:
+						out += "u00";
+						out += hex[c >> 4];
+						out += hex[c & 15];
+				}
 			}
-			else if (root[i].isNumeric())
+			out.append(s, run, string::npos);
+			out += '"';
+		}
+		// The shortest text that reads back as the same number
+		void write_real(double d)
+		{
+			if (!std::isfinite(d))
 			{
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asDouble());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				out += "null";
+				return;
 			}
-			else if (root[i].isString())
+			char text[32];
+			if (d == std::floor(d) && std::fabs(d) < 1e15)
 			{
-				//ds_map with key "default" and value
-				int dsmap=ds_map_create();
-				ds_map_add(dsmap,"default",root[i].asString());
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
+				// Whole numbers, most of what's written, without going through printf
+				long long whole = std::llabs((long long) d);
+				char *digit = text + sizeof(text);
+				do *--digit = '0' + whole % 10; while (whole /= 10);
+				if (d < 0) *--digit = '-';
+				out.append(digit, text + sizeof(text) - digit);
+				return;
 			}
-			else if (root[i].isArray())
-			{
-				//ds_map with key "default" and ds_list of the objects or values
-				int dsmap=RecursiveDSList(root[i]);
-				if (dsmap==-1)
+#ifdef __cpp_lib_to_chars
+			out.append(text, std::to_chars(text, text + sizeof(text), d).ptr);
+#else
+			int precision = 15;
+			do snprintf(text, sizeof(text), "%.*g", precision, d);
+			while (precision++ < 17 && strtod(text, NULL) != d);
+			out += text;
+#endif
+		}
+		void write_value(const variant &v, enigma::ds_mark mark)
+		{
+			if (mark == enigma::ds_marked_map) write_map(v);
+			else if (mark == enigma::ds_marked_list) write_list(v);
+			else if (v.type == enigma_user::ty_string) write_string(v.sval());
+			else if (v.type == enigma_user::ty_real) write_real(v.rval.d);
+			else out += "null";
+		}
+		bool enter(bool is_map, unsigned int id)
+		{
+			for (const auto &open : path)
+				if (open.first == is_map && open.second == id)
 				{
-					return -1;
+					DEBUG_MESSAGE("json_encode: " + string(is_map ? "map " : "list ") + enigma_user::toString(id) + " contains itself", MESSAGE_TYPE::M_ERROR);
+					out += "null";
+					return false;
 				}
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
-			}
-			else if (root[i].isObject())
+			path.push_back(std::make_pair(is_map, id));
+			return true;
+		}
+
+		public:
+		explicit json_writer(string &text): out(text) {}
+
+		void write_map(unsigned int id)
+		{
+			if (!enter(true, id)) return;
+			out += '{';
+			bool first = true;
+			enigma::ds_map_visit(id, [&](const variant &key, const variant &value, enigma::ds_mark mark)
 			{
-				int dsmap=RecursiveDSMap(root[i]);
-				if (dsmap==-1)
-				{
-					return -1;
-				}
-				ds_list_add(jsonArray,(enigma::varargs(), dsmap));
-			}
-			else
+				if (!first) out += ',';
+				first = false;
+				// JSON keys are strings, so real keys are written as their text
+				if (key.type == enigma_user::ty_string) write_string(key.sval());
+				else write_string(enigma_user::toString(key));
+				out += ':';
+				write_value(value, mark);
+			});
+			out += '}';
+			path.pop_back();
+		}
+		void write_list(unsigned int id)
+		{
+			if (!enter(false, id)) return;
+			out += '[';
+			bool first = true;
+			enigma::ds_list_visit(id, [&](const variant &value, enigma::ds_mark mark)
 			{
-				return -1;
-			}
+				if (!first) out += ',';
+				first = false;
+				write_value(value, mark);
+			});
+			out += ']';
+			path.pop_back();
 		}
-		return jsonObject;
+	};
+
+	// Kept between calls, so encoding doesn't regrow a string from nothing
+	// every time
+	string encoded;
+
+	const string& encode(unsigned int ds_map)
+	{
+		encoded.clear();
+		json_writer(encoded).write_map(ds_map);
+		return encoded;
 	}
-	
+}
+
+namespace enigma_user
+{
 	variant json_decode(string data)
 	{
-		Json::Value root;
-		Json::Reader reader;
-		bool parsingSuccessful = reader.parse( string(data), root );
-		if ( !parsingSuccessful )
-		{
-			DEBUG_MESSAGE("Failed to parse configuration" + reader.getFormattedErrorMessages(), MESSAGE_TYPE::M_ERROR);
-			return -1;
-		}
-		return RecursiveDSMap(root);
+		return decode(data.data(), data.size());
+	}
+
+	variant json_decode_buffer(int buffer, unsigned offset, unsigned size)
+	{
+		get_bufferr(binbuff, buffer, -1);
+		const unsigned total = binbuff->GetSize();
+		if (offset > total) offset = total;
+		if (size > total - offset) size = total - offset;
+		return decode(reinterpret_cast<const char*>(binbuff->data.data()) + offset, size);
 	}
 
 	string json_encode(variant ds_map)
 	{
-		Json::Value root;
-		return string("{  }");
+		return encode(ds_map);
+	}
+
+	void json_encode_buffer(variant ds_map, int buffer)
+	{
+		get_buffer(binbuff, buffer);
+		const string &text = encode(ds_map);
+		binbuff->Write(text.data(), text.size());
 	}
 }
@@ -32,9 +32,16 @@
 
 namespace enigma_user
 {
+	// Objects become ds_maps and arrays ds_lists, nested ones marked in their
+	// parents; an array or plain value at the top is put under "default" in a
+	// map. Returns the map, or -1 if the text isn't JSON.
 	variant json_decode(std::string data);
+	// As json_decode, reading size bytes of the buffer from offset
+	variant json_decode_buffer(int buffer, unsigned offset, unsigned size);
 
 	std::string json_encode(variant ds_map);
+	// As json_encode, writing the text at the buffer's position
+	void json_encode_buffer(variant ds_map, int buffer);
 }
 
 
@@ -1,3 +1,5 @@
 #include "motion_planning.h"
 #include "mp_movement.h"
 #include "actions.h"
+#include "mp_path_async.h"
+#include "mp_flowfield.h"
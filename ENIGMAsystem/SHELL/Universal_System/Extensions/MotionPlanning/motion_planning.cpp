@@ -29,19 +29,69 @@
 #include <vector>
 #include <cmath>
 #include <map>
+#include <algorithm>
 using namespace std;
 
 //#include "Graphics_Systems/OpenGL/OpenGLHeaders.h" //For drawing straight lines
 #include "../Paths/pathstruct.h"
 #include "libEGMstd.h"
 #include "motion_planning_struct.h"
+#include "mp_hierarchy.h"
 #include "motion_planning.h"
 #include "Collision_Systems/General/CSfuncs.h"
 #include "Universal_System/scalar.h"
 
 namespace enigma {
-	extern size_t grid_idmax;
 	extern unsigned bound_texture;
+
+	//Tells the grid which cells changed cost, or that everything did if the threshold moved
+	static void grid_changed(grid *gr, unsigned old_threshold, unsigned h0, unsigned v0, unsigned h1, unsigned v1)
+	{
+	    if (gr->threshold != old_threshold) gr->all_changed();
+	    else if (h0 <= h1 && v0 <= v1) gr->cells_changed(h0, v0, h1, v1);
+	}
+}
+
+namespace enigma
+{
+
+bool grid_cell_at(const grid *gr, double x, double y, unsigned &cell)
+{
+    int h = floor((x-gr->left)/int(gr->cellwidth)), v = floor((y-gr->top)/int(gr->cellheight));
+    if (h<0 or v<0) return false;
+    if (h>int(gr->hcells)-1 or v>int(gr->vcells)-1) return false;
+    cell = h*gr->vcells+v;
+    return true;
+}
+
+void write_grid_path(grid *gr, unsigned pathid, double xstart, double ystart, double xgoal, double ygoal, const vector<node*> &nodelist, bool status)
+{
+    unsigned start = 0, goal = 0;
+    grid_cell_at(gr, xstart, ystart, start);
+    grid_cell_at(gr, xgoal, ygoal, goal);
+    enigma::path *path = enigma::pathstructarray[pathid];
+    path->pointarray.clear();
+
+    //push the very first point
+    enigma::path_point point(xstart,ystart,gr->speed_modifier/double(gr->nodearray[start].cost));
+    path->pointarray.push_back(point);
+    for (vector<node*>::const_iterator it=nodelist.begin(); it != nodelist.end(); it++)
+    {
+            point = enigma::path_point(gr->left+((*it)->x+0.5)*gr->cellwidth,gr->top+((*it)->y+0.5)*gr->cellheight,gr->speed_modifier/double((*it)->cost));
+            path->pointarray.push_back(point);
+    }
+
+    //push the very last point if we can reach the destination
+    if (status == true){
+        point = enigma::path_point(xgoal,ygoal,gr->speed_modifier/double(gr->nodearray[goal].cost));
+        path->pointarray.push_back(point);
+    } else if (path->pointarray.size()==1) {
+        point = enigma::path_point(path->pointarray.back().x,path->pointarray.back().y,gr->speed_modifier/double(gr->nodearray[goal].cost));
+        path->pointarray.push_back(point);
+    }
+    enigma::path_recalculate(pathid);
+}
+
 }
 
 namespace enigma_user
@@ -61,9 +111,10 @@ void mp_grid_destroy(unsigned id)
 
 unsigned mp_grid_duplicate(unsigned id)
 {
-    enigma::gridstructarray_reallocate();
-    enigma::gridstructarray[enigma::grid_idmax] = new enigma::grid(*enigma::gridstructarray[id]);
-    return enigma::grid_idmax-1;
+    enigma::grid *src = enigma::gridstructarray[id];
+    unsigned copy = mp_grid_create(src->left, src->top, src->hcells, src->vcells, src->cellwidth, src->cellheight, src->speed_modifier);
+    mp_grid_copy(copy, id);
+    return copy;
 }
 
 void mp_grid_copy(unsigned id, unsigned srcid)
@@ -83,7 +134,7 @@ void mp_grid_copy(unsigned id, unsigned srcid)
     grid->top = sgrid->top;
     for (unsigned int i = 0; i < sgrid->hcells*sgrid->vcells; i++)
     {
-        enigma::node node(floor(i / sgrid->vcells),i % sgrid->vcells,0,0,0,sgrid->nodearray[i].cost);
+        enigma::node node(i / sgrid->vcells,i % sgrid->vcells,sgrid->nodearray[i].cost);
         grid->nodearray.push_back(node);
     }
 
@@ -110,6 +161,7 @@ void mp_grid_copy(unsigned id, unsigned srcid)
 
         }
     }
+    grid->all_changed();
 }
 
 void mp_grid_clear_all(unsigned id, unsigned cost)
@@ -117,12 +169,15 @@ void mp_grid_clear_all(unsigned id, unsigned cost)
     for (vector<enigma::node>::iterator it = enigma::gridstructarray[id]->nodearray.begin(); it!=enigma::gridstructarray[id]->nodearray.end(); ++it)
         (*it).cost = cost;
     enigma::gridstructarray[id]->threshold = cost;
+    enigma::gridstructarray[id]->all_changed();
 }
 
 void mp_grid_clear_cell(unsigned id,int h,int v, unsigned cost)
 {
+    unsigned threshold = enigma::gridstructarray[id]->threshold;
     enigma::gridstructarray[id]->nodearray[h*enigma::gridstructarray[id]->vcells+v].cost = cost;
     if (enigma::gridstructarray[id]->threshold<cost){enigma::gridstructarray[id]->threshold=cost;}
+    enigma::grid_changed(enigma::gridstructarray[id], threshold, h, v, h, v);
 }
 
 void mp_grid_add_rectangle(unsigned id,double x1,double y1,double x2,double y2, unsigned cost)
@@ -140,24 +195,29 @@ void mp_grid_add_rectangle(unsigned id,double x1,double y1,double x2,double y2,
         }
     }
     if (cost>max_cost){max_cost=cost;}
+    unsigned threshold = grid->threshold;
     if (grid->threshold<max_cost){grid->threshold=max_cost;}
+    enigma::grid_changed(grid, threshold, tx1, ty1, tx2-1, ty2-1);
 }
 
 void mp_grid_add_instances(unsigned id,int obj,bool prec,unsigned cost)
 {
     enigma::grid *grid = enigma::gridstructarray[id];
-    unsigned max_cost=0;
+    unsigned max_cost=0, h0=grid->hcells, v0=grid->vcells, h1=0, v1=0;
     double x=grid->left, y=grid->top;
     for (unsigned int i=0; i<grid->hcells; i++){
         for (unsigned int c=0; c<grid->vcells; c++){
             if (grid->nodearray[i*grid->vcells+c].cost>max_cost){max_cost=grid->nodearray[i*grid->vcells+c].cost;}
             if (collision_rectangle(x+i*grid->cellwidth,y+c*grid->cellheight,x+(i+1)*grid->cellwidth,y+(c+1)*grid->cellheight,obj,prec,false)!=-4){
                 grid->nodearray[i*grid->vcells+c].cost = cost;
+                h0=min(h0,i), v0=min(v0,c), h1=max(h1,i), v1=max(v1,c);
             }
         }
     }
     if (cost>max_cost){max_cost=cost;}
+    unsigned threshold = grid->threshold;
     if (grid->threshold<max_cost){grid->threshold=max_cost;}
+    enigma::grid_changed(grid, threshold, h0, v0, h1, v1);
 }
 
 void mp_grid_reset_threshold(unsigned id)
@@ -166,6 +226,7 @@ void mp_grid_reset_threshold(unsigned id)
     unsigned max_cost=0;
     for (vector<enigma::node>::iterator it = grid->nodearray.begin(); it!=grid->nodearray.end(); ++it)
         if ((*it).cost>max_cost){max_cost=(*it).cost;}
+    if (grid->threshold!=max_cost) grid->all_changed();
     grid->threshold=max_cost;
 }
 
@@ -177,9 +238,11 @@ void mp_grid_clear_rectangle(unsigned id,double x1,double y1,double x2,double y2
 void mp_grid_add_cell(unsigned id,int h,int v, unsigned cost)
 {
     unsigned max_cost=enigma::gridstructarray[id]->nodearray[h*enigma::gridstructarray[id]->vcells+v].cost;
+    unsigned threshold = enigma::gridstructarray[id]->threshold;
     enigma::gridstructarray[id]->nodearray[h*enigma::gridstructarray[id]->vcells+v].cost = cost;
     if (cost>max_cost){max_cost=cost;}
     if (enigma::gridstructarray[id]->threshold<max_cost){enigma::gridstructarray[id]->threshold=max_cost;}
+    enigma::grid_changed(enigma::gridstructarray[id], threshold, h, v, h, v);
 }
 
 unsigned mp_grid_get_cell(unsigned id,int h,int v)
@@ -194,6 +257,7 @@ unsigned mp_grid_get_threshold(unsigned id)
 
 void mp_grid_set_threshold(unsigned id, unsigned value)
 {
+    if (enigma::gridstructarray[id]->threshold != value) enigma::gridstructarray[id]->all_changed();
     enigma::gridstructarray[id]->threshold = value;
 }
 
@@ -210,41 +274,39 @@ void mp_grid_set_speed_modifier(unsigned id, double value)
 bool mp_grid_path(unsigned id,unsigned pathid,double xstart,double ystart,double xgoal,double ygoal,bool allowdiag)
 {
     enigma::grid *gr = enigma::gridstructarray[id];
-    int vc = int(enigma::gridstructarray[id]->vcells),
-    xs = floor((xstart-gr->left)/int(gr->cellwidth)), ys = floor((ystart-gr->top)/int(gr->cellheight)),
-    xg = floor((xgoal-gr->left)/int(gr->cellwidth)), yg = floor((ygoal-gr->top)/int(gr->cellheight));
-    if (xs<0 or xg<0) return false;
-    if (xs>int(gr->hcells)-1 or xg>int(gr->hcells)-1) return false;
-    if (ys<0 or yg<0) return false;
-    if (ys>int(gr->vcells)-1 or yg>int(gr->vcells)-1) return false;
-    
-    bool status = true; //status to check if we can reach the destination
-    multimap<unsigned,enigma::node*> nodelist = enigma::find_path(id, &gr->nodearray[xs*vc+ys], &gr->nodearray[xg*vc+yg], allowdiag, status);
-    enigma::path *path = enigma::pathstructarray[pathid];
-    path->pointarray.clear();
+    unsigned start, goal;
+    if (!enigma::grid_cell_at(gr, xstart, ystart, start) or !enigma::grid_cell_at(gr, xgoal, ygoal, goal)) return false;
 
-    //push the very first point
-    enigma::path_point point(xstart,ystart,gr->speed_modifier/double(gr->nodearray[xs*vc+ys].cost));
-    path->pointarray.push_back(point);
-    multimap<unsigned,enigma::node*>::reverse_iterator it;
-    for (it=nodelist.rbegin(); it != nodelist.rend(); it++)
-    {
-            point = enigma::path_point(gr->left+((*it).second->x+0.5)*gr->cellwidth,gr->top+((*it).second->y+0.5)*gr->cellheight,gr->speed_modifier/double((*it).second->cost));
-            path->pointarray.push_back(point);
-    }
-
-    //push the very last point if we can reach the destination
-    if (status == true){
-        point = enigma::path_point(xgoal,ygoal,gr->speed_modifier/double(gr->nodearray[xg*vc+yg].cost));
-        path->pointarray.push_back(point);
-    } else if (path->pointarray.size()==1) {
-        point = enigma::path_point(path->pointarray.back().x,path->pointarray.back().y,gr->speed_modifier/double(gr->nodearray[xg*vc+yg].cost));
-        path->pointarray.push_back(point);
-    }
-    enigma::path_recalculate(pathid);
+    vector<enigma::node*> nodelist;
+    bool status = enigma::plan_path(id, &gr->nodearray[start], &gr->nodearray[goal], allowdiag, nodelist); //status to check if we can reach the destination
+    enigma::write_grid_path(gr, pathid, xstart, ystart, xgoal, ygoal, nodelist, status);
     return true;
 }
 
+void mp_grid_hierarchy_enable(unsigned id, unsigned cluster_size)
+{
+    enigma::grid *gr = enigma::gridstructarray[id];
+    delete gr->hierarchy;
+    gr->hierarchy = new enigma::grid_hierarchy(cluster_size > 1 ? cluster_size : 16);
+    gr->path_cache.clear();
+}
+
+void mp_grid_hierarchy_disable(unsigned id)
+{
+    enigma::grid *gr = enigma::gridstructarray[id];
+    delete gr->hierarchy;
+    gr->hierarchy = NULL;
+    gr->path_cache.clear();
+}
+
+void mp_grid_path_cache_size(unsigned id, unsigned entries)
+{
+    enigma::grid *gr = enigma::gridstructarray[id];
+    gr->path_cache_size = entries;
+    if (gr->path_cache.size() > entries)
+        gr->path_cache.clear();
+}
+
 }
 
 #include "Graphics_Systems/General/GSfont.h"
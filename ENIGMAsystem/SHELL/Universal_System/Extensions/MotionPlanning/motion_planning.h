@@ -45,5 +45,10 @@ void mp_grid_set_threshold(unsigned id, unsigned threshold = 1);
 void mp_grid_reset_threshold(unsigned id);
 double mp_grid_get_speed_modifier(unsigned id);
 void mp_grid_set_speed_modifier(unsigned id, double value);
+//Searches long paths over clusters of cells, rebuilt as cells change; close to the cheapest path, and much faster
+void mp_grid_hierarchy_enable(unsigned id, unsigned cluster_size = 16);
+void mp_grid_hierarchy_disable(unsigned id);
+//How many found paths the grid remembers until its cells next change; 0 turns the cache off
+void mp_grid_path_cache_size(unsigned id, unsigned entries);
 }
 
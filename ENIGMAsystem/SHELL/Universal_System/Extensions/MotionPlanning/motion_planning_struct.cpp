@@ -27,16 +27,11 @@
 \********************************************************************************/
 
 #include <vector>
-#include <map>
-#include <list>
 #include "motion_planning_struct.h"
+#include "mp_hierarchy.h"
 #include <cmath>
 #include <algorithm>
 #include <cstdlib>
-//#include <iostream>
-using std::multimap;
-using std::pair;
-using std::list;
 
 namespace enigma
 {
@@ -47,13 +42,13 @@ namespace enigma
 namespace enigma
 {
     grid::grid(unsigned int idp,int leftp,int topp,unsigned int hcellsp,unsigned int vcellsp,unsigned int cellwidthp,unsigned int cellheightp,unsigned thresholdp,double speed_modifierp):
-        id(idp), left(leftp), top(topp), hcells(hcellsp), vcells(vcellsp), cellwidth(cellwidthp), cellheight(cellheightp), threshold(thresholdp), speed_modifier(speed_modifierp), nodearray()
+        id(idp), left(leftp), top(topp), hcells(hcellsp), vcells(vcellsp), cellwidth(cellwidthp), cellheight(cellheightp), threshold(thresholdp), speed_modifier(speed_modifierp), nodearray(), version(0), hierarchy(NULL), changes_from(0), cache_version(0), path_cache_size(256)
     {
         gridstructarray[id] = this;
         gridstructarray[id]->nodearray.reserve(hcells*vcells);
         for (unsigned int i = 0; i < hcells*vcells; i++)
         {
-            node nnode(floor(i / vcells),i % vcells,0,0,0,1);
+            node nnode(i / vcells,i % vcells,1);
             gridstructarray[id]->nodearray.push_back(nnode);
         }
 
@@ -86,7 +81,30 @@ namespace enigma
         if (enigma::grid_idmax < id+1)
           enigma::grid_idmax = id+1;
     }
-    grid::~grid() { gridstructarray[id] = NULL; }
+    grid::~grid() { gridstructarray[id] = NULL; delete hierarchy; }
+
+    //Changes remembered before the oldest is forgotten
+    static const size_t change_log_size = 64;
+
+    void grid::cells_changed(unsigned h0, unsigned v0, unsigned h1, unsigned v1)
+    {
+        version++;
+        if (hierarchy) hierarchy->cells_changed(h0, v0, h1, v1);
+        change c = {version, h0, v0, h1, v1};
+        changes.push_back(c);
+        if (changes.size() > change_log_size) {
+            changes_from = changes.front().version;
+            changes.pop_front();
+        }
+    }
+
+    void grid::all_changed()
+    {
+        version++;
+        if (hierarchy) hierarchy->all_changed();
+        changes.clear();
+        changes_from = version;
+    }
 
     void gridstructarray_reallocate()
     {
@@ -96,138 +114,240 @@ namespace enigma
         delete[] gridold;
     }
 
-    //Helper functions
-    static inline unsigned find_heuristic(const node* n0, const node* n1, bool allow_diag) //Distance from n0 to n1
+    void search_scratch::begin(size_t cells)
     {
-        if (!allow_diag){
-            return fabs((int)n0->x-(int)n1->x) + fabs((int)n0->y-(int)n1->y);
-        } else {
-            return fmax(fabs((int)n0->x-(int)n1->x) , fabs((int)n0->y-(int)n1->y));
+        if (stamp.size() != cells) { //first search, or the grid was resized by mp_grid_copy
+            stamp.assign(cells, 0);
+            G.resize(cells);
+            F.resize(cells);
+            came_from.resize(cells);
+            heap_index.resize(cells);
+            generation = 0;
         }
+        if (++generation == 0) { //stamps wrapped around, so old ones could look current
+            std::fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        heap.clear();
+        closed.clear();
     }
 
-    static inline int find_priority(multimap<unsigned,node*> &m, node* value){
-        multimap<unsigned,node*>::iterator it;
-        for (it = m.begin(); it != m.end(); it++)
-            if (it->second == value) return (int)it->first;
-        return -1;
+    void search_scratch::open(unsigned cell)
+    {
+        stamp[cell] = generation;
+        heap.push_back(cell);
+        heap_up(heap.size() - 1);
     }
 
-    static inline bool check_corners(unsigned id, node* n0, node* n1) //There must be a better way to do this
+    unsigned search_scratch::close_best()
     {
-        for (vector<enigma::node*>::iterator it0 = n0->neighbor_nodes.begin(); it0!=n0->neighbor_nodes.end(); ++it0)
-        {
-            for (vector<enigma::node*>::iterator it1 = n1->neighbor_nodes.begin(); it1!=n1->neighbor_nodes.end(); ++it1)
-            {
-                if ((*it0)==(*it1) && (*it0)->cost >= gridstructarray[id]->threshold)
-                return true;
-            }
+        const unsigned best = heap[0];
+        heap[0] = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) heap_down(0);
+        heap_index[best] = closed_cell;
+        closed.push_back(best);
+        return best;
+    }
+
+    void search_scratch::heap_up(unsigned pos)
+    {
+        const unsigned cell = heap[pos];
+        while (pos > 0) {
+            const unsigned parent = (pos - 1)/2;
+            if (!before(cell, heap[parent])) break;
+            heap[pos] = heap[parent];
+            heap_index[heap[pos]] = pos;
+            pos = parent;
         }
-        return false;
+        heap[pos] = cell;
+        heap_index[cell] = pos;
     }
 
-    multimap<unsigned,node*> find_path(unsigned id, node* n0, node* n1, bool allow_diag, bool &status)
+    void search_scratch::heap_down(unsigned pos)
     {
-        node* current;
-        for (unsigned int i = 0; i < gridstructarray[id]->hcells*gridstructarray[id]->vcells; i++)
-        {
-            gridstructarray[id]->nodearray[i].F=0;
-            gridstructarray[id]->nodearray[i].G=0;
-            gridstructarray[id]->nodearray[i].H=0;
-            gridstructarray[id]->nodearray[i].came_from=NULL;
+        const unsigned cell = heap[pos], size = heap.size();
+        for (;;) {
+            unsigned child = 2*pos + 1;
+            if (child >= size) break;
+            if (child + 1 < size && before(heap[child + 1], heap[child])) child++;
+            if (!before(heap[child], cell)) break;
+            heap[pos] = heap[child];
+            heap_index[heap[pos]] = pos;
+            pos = child;
         }
+        heap[pos] = cell;
+        heap_index[cell] = pos;
+    }
 
-        node* start = n0;
-        node* destination = n1;
-        multimap<unsigned,node*> OPEN;
-        list<node*> CLOSED;
-        multimap<unsigned,node*> mm_ret;
+    //Helper functions
+    static inline unsigned difference(unsigned a, unsigned b) { return a > b ? a - b : b - a; }
 
+    //The A* search behind find_path, over cells whose costs cost(cell) returns
+    template<typename Costs>
+    static bool search_cells(const Costs &cost, unsigned hc, unsigned vc, unsigned threshold, search_scratch &s,
+                             unsigned start, unsigned destination, bool allow_diag, vector<unsigned> &path)
+    {
+        path.clear();
         if (start == destination)
-            return mm_ret;
-        start->H = find_heuristic(start,destination,allow_diag);
-        start->F = start->H;
-        OPEN.insert(pair<unsigned,node*>(start->F,start));
+            return true;
 
-        while (find(CLOSED.begin(), CLOSED.end(), destination) == CLOSED.end() && !OPEN.empty())
-        //loop until destination is in the closed list or the open multimap is empty
+        const unsigned gx = destination / vc, gy = destination % vc;
+        s.begin(size_t(hc)*vc);
+        s.G[start] = 0;
+        s.F[start] = cell_heuristic(difference(start / vc, gx), difference(start % vc, gy), allow_diag);
+        s.came_from[start] = start;
+        s.open(start);
+
+        static const int offsets[8][2] = {{-1,0},{-1,-1},{-1,1},{0,-1},{1,0},{1,-1},{1,1},{0,1}};
+        bool found = false;
+        while (!s.heap.empty())
         {
-            //this is basically ds_priority_delete_min
-            {
-              multimap<unsigned,node*>::iterator it = OPEN.begin(), it_check;
-              it_check = it++;
-              while (it != OPEN.end())
-              {
-                  if ((*it).first < (*it_check).first) {it_check = it;}
-                  it++;
-              }
-              current = (*it_check).second;
-              OPEN.erase(it_check);
+            const unsigned current = s.close_best();
+            if (current == destination) {
+                found = true;
+                break;
             }
 
-            CLOSED.push_front(current);
-            for (vector<enigma::node*>::iterator it = current->neighbor_nodes.begin(); it!=current->neighbor_nodes.end(); ++it)
-            { //go trough all the neighbors (should be faster then 8 if cycles like in the init)
-                if (!allow_diag && (*it)->x != current->x && (*it)->y != current->y)
+            const unsigned cx = current / vc, cy = current % vc;
+            for (int i = 0; i < 8; i++)
+            {
+                const bool diagonal = offsets[i][0] && offsets[i][1];
+                if (diagonal && !allow_diag)
+                    continue;
+                const unsigned nx = cx + offsets[i][0], ny = cy + offsets[i][1];
+                if (nx >= hc || ny >= vc) //unsigned, so this also catches stepping off the left or top
+                    continue;
+                const unsigned next = nx*vc + ny;
+                const unsigned next_cost = cost(next);
+                if (next_cost >= threshold)
+                    continue;
+                //Don't cut the corner of a blocked cell
+                if (diagonal && (cost(cx*vc + ny) >= threshold || cost(nx*vc + cy) >= threshold))
                     continue;
 
-                bool cutting = false;
-                if (allow_diag == true  && (*it)->x != current->x && (*it)->y != current->y)
-                        cutting = check_corners(id, current, (*it));
-
-                if (find(CLOSED.begin(), CLOSED.end(), (*it)) == CLOSED.end() && (*it)->cost<gridstructarray[id]->threshold && cutting == false){
-                    if (find_priority(OPEN,(*it)) == -1){ //if the node isn't on the open list
-                        (*it)->came_from = current;
-                        (*it)->G = current->G + (*it)->cost;
-                        if ((*it)->x != current->x && (*it)->y != current->y)
-                            (*it)->G += ceil((*it)->cost/2.5); //if it is diagonal increase the move cost
-                        (*it)->H = find_heuristic(*it,destination,allow_diag);
-                        (*it)->F = (*it)->G + (*it)->H;
-                        OPEN.insert(pair<unsigned,node*>((*it)->F,(*it)));
-
-                    }else{ //if the node is already on the open list we just have to see if it is a better path
-                        unsigned temp_G = current->G + (*it)->cost;
-                        if (temp_G < (*it)->G) {
-                            (*it)->came_from = current;
-                            (*it)->G = current->G + (*it)->cost;
-                            if ((*it)->x != current->x && (*it)->y != current->y)
-                                (*it)->G += ceil((*it)->cost/2.5);
-                            (*it)->H = find_heuristic(*it,destination,allow_diag);
-                            (*it)->F = (*it)->G + (*it)->H;
-                        }
-                    }
+                const unsigned G = s.G[current] + step_cost(next_cost, diagonal);
+                if (!s.seen(next)) { //first time we've seen the cell
+                    s.G[next] = G;
+                    s.F[next] = G + cell_heuristic(difference(nx, gx), difference(ny, gy), allow_diag);
+                    s.came_from[next] = current;
+                    s.open(next);
+                } else if (s.is_open(next) && G < s.G[next]) { //a better way to an open cell
+                    s.F[next] -= s.G[next] - G;
+                    s.G[next] = G;
+                    s.came_from[next] = current;
+                    s.decreased(next);
                 }
             }
         }
-        node *last, *nearest;
-        unsigned i = 0;
-        status = true;
-        if (find(CLOSED.begin(), CLOSED.end(), destination) == CLOSED.end())
-        {   //this is for if the destionation can't be found if
-            status = false;
-            nearest = start;
-
-            list<node*>::iterator it;
-            for (it=CLOSED.begin(); it != CLOSED.end(); it++){
-                (*it)->H = find_heuristic(*it,destination,allow_diag);
-                if ((*it)->H < nearest->H)
-                    nearest = *it;
+
+        unsigned last = destination;
+        if (!found)
+        {   //head for the closed cell nearest the destination, preferring the most recently closed
+            const auto distance = [&](unsigned cell) {
+                const unsigned dx = difference(cell / vc, gx), dy = difference(cell % vc, gy);
+                return allow_diag ? std::max(dx, dy) : dx + dy;
+            };
+            last = start;
+            unsigned nearest = distance(start);
+            for (vector<unsigned>::reverse_iterator it = s.closed.rbegin(); it != s.closed.rend(); ++it) {
+                const unsigned d = distance(*it);
+                if (d < nearest)
+                    nearest = d, last = *it;
             }
-            destination = nearest;
-            if (start == destination)
-                return mm_ret;
+            if (last == start)
+                return false;
+        }
+
+        for (last = s.came_from[last]; last != start; last = s.came_from[last])
+            path.push_back(last);
+        std::reverse(path.begin(), path.end());
+        return found;
+    }
+
+    bool find_path(unsigned id, node* n0, node* n1, bool allow_diag, vector<node*> &path)
+    {
+        grid *gr = gridstructarray[id];
+        const node *nodes = &gr->nodearray[0];
+        vector<unsigned> &cells = gr->scratch.path;
+        const bool found = search_cells([nodes](unsigned cell) { return nodes[cell].cost; }, gr->hcells, gr->vcells, gr->threshold,
+                                        gr->scratch, n0 - nodes, n1 - nodes, allow_diag, cells);
+        path.clear();
+        for (vector<unsigned>::iterator it = cells.begin(); it != cells.end(); ++it)
+            path.push_back(&gr->nodearray[*it]);
+        return found;
+    }
+
+    bool find_path(const grid_snapshot &snapshot, search_scratch &s, unsigned start, unsigned goal, bool allow_diag, vector<unsigned> &path)
+    {
+        const unsigned *costs = &snapshot.costs[0];
+        return search_cells([costs](unsigned cell) { return costs[cell]; }, snapshot.hcells, snapshot.vcells, snapshot.threshold,
+                            s, start, goal, allow_diag, path);
+    }
+
+    std::shared_ptr<const grid_snapshot> grid::snapshot()
+    {
+        if (!last_snapshot || last_snapshot->version != version) {
+            std::shared_ptr<grid_snapshot> copy = std::make_shared<grid_snapshot>();
+            copy->version = version;
+            copy->hcells = hcells;
+            copy->vcells = vcells;
+            copy->threshold = threshold;
+            copy->costs.reserve(nodearray.size());
+            for (vector<node>::iterator it = nodearray.begin(); it != nodearray.end(); ++it)
+                copy->costs.push_back(it->cost);
+            last_snapshot = copy;
         }
+        return last_snapshot;
+    }
 
-        //mm_ret.insert(pair<unsigned,node*>(i,destination));
-        last = destination;
-        while (last->came_from != start){
-            i += 1;
-            mm_ret.insert(pair<unsigned,node*>(i,last->came_from));
-            last = last->came_from;
+    const grid::cached_path* grid::find_cached(unsigned start, unsigned goal, bool allow_diag)
+    {
+        if (cache_version != version) {
+            path_cache.clear();
+            cache_version = version;
         }
+        std::unordered_map<unsigned long long, cached_path>::const_iterator it =
+            path_cache.find((start*(unsigned long long)nodearray.size() + goal)*2 + allow_diag);
+        return it == path_cache.end() ? NULL : &it->second;
+    }
+
+    void grid::cache(unsigned start, unsigned goal, bool allow_diag, bool found, const vector<unsigned> &cells)
+    {
+        if (!path_cache_size)
+            return;
+        if (cache_version != version) {
+            path_cache.clear();
+            cache_version = version;
+        }
+        if (path_cache.size() >= path_cache_size) //full; start over rather than track what's least used
+            path_cache.clear();
+        cached_path &entry = path_cache[(start*(unsigned long long)nodearray.size() + goal)*2 + allow_diag];
+        entry.found = found;
+        entry.cells = cells;
+    }
 
-        //delete CLOSED;
-        //delete OPEN;
-        return mm_ret; //return the multimap containing a list of all the nodes that are in the path.
+    bool plan_path(unsigned id, node* n0, node* n1, bool allow_diag, vector<node*> &path)
+    {
+        grid *gr = gridstructarray[id];
+        const unsigned start = n0 - &gr->nodearray[0], goal = n1 - &gr->nodearray[0];
+        if (gr->path_cache_size) {
+            if (const grid::cached_path *hit = gr->find_cached(start, goal, allow_diag)) {
+                path.clear();
+                for (vector<unsigned>::const_iterator c = hit->cells.begin(); c != hit->cells.end(); ++c)
+                    path.push_back(&gr->nodearray[*c]);
+                return hit->found;
+            }
+        }
+
+        const bool found = gr->hierarchy ? gr->hierarchy->find_path(*gr, n0, n1, allow_diag, path) : find_path(id, n0, n1, allow_diag, path);
+        if (gr->path_cache_size) {
+            vector<unsigned> &cells = gr->scratch.path;
+            cells.clear();
+            for (vector<node*>::iterator c = path.begin(); c != path.end(); ++c)
+                cells.push_back(*c - &gr->nodearray[0]);
+            gr->cache(start, goal, allow_diag, found, cells);
+        }
+        return found;
     }
 }
@@ -38,24 +38,87 @@
 	#error The motion planning extension requires the paths extension.
 #endif
 
+#ifndef ENIGMA_MOTION_PLANNING_STRUCT_H
+#define ENIGMA_MOTION_PLANNING_STRUCT_H
+
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <memory>
+#include <deque>
 #include <cstddef>
 
 
 using std::vector;
-using std::multimap;
 
 namespace enigma
 {
   struct node
   {
-    unsigned x, y, F, H, G, cost;
-    node* came_from;
+    unsigned x, y, cost;
     vector<node*> neighbor_nodes;
-    node(unsigned X = 0, unsigned Y = 0, unsigned f = 0, unsigned h = 0, unsigned g = 0, unsigned Cost = 0, node* CameFrom = NULL):
-      x(X), y(Y), F(f), H(h), G(g), cost(Cost), came_from(CameFrom) {}
+    node(unsigned X = 0, unsigned Y = 0, unsigned Cost = 0): x(X), y(Y), cost(Cost) {}
+  };
+
+  //Entering a cell costs its cost, plus ceil(cost/2.5) when entered diagonally
+  inline unsigned step_cost(unsigned cost, bool diagonal) {
+    return diagonal ? cost + (2*cost + 4)/5 : cost;
+  }
+
+  //Octile distance over cells of cost 1, the cheapest a passable cell normally is.
+  //With diagonal steps into such cells costing 2 this never overestimates.
+  inline unsigned cell_heuristic(unsigned dx, unsigned dy, bool allow_diag)
+  {
+    if (!allow_diag)
+      return dx + dy;
+    const int straight = step_cost(1, false), diagonal = step_cost(1, true);
+    return straight*(dx + dy) + (diagonal - 2*straight)*int(dx < dy ? dx : dy);
+  }
+  inline unsigned find_heuristic(const node* n0, const node* n1, bool allow_diag) {
+    return cell_heuristic(n0->x > n1->x ? n0->x - n1->x : n1->x - n0->x,
+                          n0->y > n1->y ? n0->y - n1->y : n1->y - n0->y, allow_diag);
+  }
+
+  //Per-search state, kept with the grid so repeated searches allocate nothing.
+  //A cell's entries are only meaningful while its stamp equals generation, so
+  //starting a search is just bumping generation instead of resetting every cell.
+  struct search_scratch
+  {
+    static constexpr unsigned closed_cell = unsigned(-1);
+    vector<unsigned> stamp, G, F, came_from;
+    vector<unsigned> heap_index; //position of an open cell in heap, or closed_cell
+    vector<unsigned> heap;       //binary min-heap of open cells, by F then larger G
+    vector<unsigned> closed;     //cells in the order they were closed
+    vector<unsigned> path;       //the cells found
+    unsigned generation;
+    search_scratch(): generation(0) {}
+
+    void begin(size_t cells);
+    bool seen(unsigned cell) const { return stamp[cell] == generation; }
+    bool is_open(unsigned cell) const { return seen(cell) && heap_index[cell] != closed_cell; }
+    //Adds a cell not yet seen this search, with its G and F set
+    void open(unsigned cell);
+    //Restores heap order after lowering an open cell's F
+    void decreased(unsigned cell) { heap_up(heap_index[cell]); }
+    //Removes and returns the open cell with the least F, marking it closed
+    unsigned close_best();
+
+   private:
+    bool before(unsigned a, unsigned b) const { return F[a] < F[b] || (F[a] == F[b] && G[a] > G[b]); }
+    void heap_up(unsigned pos);
+    void heap_down(unsigned pos);
+  };
+
+  class grid_hierarchy;
+
+  //A grid's costs as they were at some version. Never changed once taken, so
+  //searches on other threads can share it while the grid itself moves on.
+  struct grid_snapshot
+  {
+    unsigned long version;
+    unsigned hcells, vcells, threshold;
+    vector<unsigned> costs;
   };
+
   struct grid
   {
     unsigned int id;
@@ -64,10 +127,56 @@ namespace enigma
     unsigned threshold;
     double speed_modifier;
     vector<node> nodearray;
+    search_scratch scratch;
+
+    unsigned long version;      //bumped whenever a cost or the threshold changes
+    grid_hierarchy* hierarchy;  //NULL unless mp_grid_hierarchy_enable was called
+
+    //The latest cost changes, so what's derived from the grid can catch up
+    //without starting over. It covers every change after version changes_from;
+    //anything older than that must be rebuilt.
+    struct change { unsigned long version; unsigned h0, v0, h1, v1; };
+    std::deque<change> changes;
+    unsigned long changes_from;
+
+    //Found paths by (start cell, goal cell, diagonals), valid while cache_version is version
+    struct cached_path { bool found; vector<unsigned> cells; };
+    std::unordered_map<unsigned long long, cached_path> path_cache;
+    unsigned long cache_version;
+    size_t path_cache_size;
+    //Returns the cached path, or NULL; either empties the cache first if the grid changed
+    const cached_path* find_cached(unsigned start, unsigned goal, bool allow_diag);
+    void cache(unsigned start, unsigned goal, bool allow_diag, bool found, const vector<unsigned> &cells);
+
+    std::shared_ptr<const grid_snapshot> last_snapshot;
+    //The grid's costs as they are now, copied only if they changed since the last call
+    std::shared_ptr<const grid_snapshot> snapshot();
+
     grid(unsigned int id,int left,int top,unsigned int hcells,unsigned int vcells,unsigned int cellwidth,unsigned int cellheight, unsigned int threshold, double speed_modifier);
+    grid(const grid&) = delete;
+    grid& operator=(const grid&) = delete;
     ~grid();
+
+    //Call after changing the costs of the cells from (h0,v0) to (h1,v1), inclusive
+    void cells_changed(unsigned h0, unsigned v0, unsigned h1, unsigned v1);
+    //Call after changing the threshold, or the grid's size
+    void all_changed();
   };
   extern grid** gridstructarray;
+  extern size_t grid_idmax;
   void gridstructarray_reallocate();
-  multimap<unsigned,node*> find_path(unsigned id, node* n0, node* n1, bool allow_diag, bool &status);
+  //Finds the cell under (x,y), returning false if that's off the grid
+  bool grid_cell_at(const grid *gr, double x, double y, unsigned &cell);
+  //Fills path resource pathid with a path found from (xstart,ystart) toward (xgoal,ygoal)
+  void write_grid_path(grid *gr, unsigned pathid, double xstart, double ystart, double xgoal, double ygoal, const vector<node*> &nodelist, bool status);
+  //Fills path with the cells between n0 and n1, exclusive, in walking order.
+  //Returns false if n1 can't be reached, in which case path leads toward the
+  //reachable cell nearest to it instead.
+  bool find_path(unsigned id, node* n0, node* n1, bool allow_diag, vector<node*> &path);
+  //The same over a snapshot, with the caller's scratch, giving cell indices
+  bool find_path(const grid_snapshot &snapshot, search_scratch &s, unsigned start, unsigned goal, bool allow_diag, vector<unsigned> &path);
+  //The same, answered from the grid's path cache or hierarchy when it has them
+  bool plan_path(unsigned id, node* n0, node* n1, bool allow_diag, vector<node*> &path);
 }
+
+#endif
@@ -0,0 +1,290 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+#include "Universal_System/Object_Tiers/collisions_object.h"
+#include "Universal_System/Instances/instance_system.h"
+#include "mp_flowfield.h"
+#include "mp_movement.h"
+#include "motion_planning_struct.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace enigma
+{
+  bool grid_cell_at(const grid *gr, double x, double y, unsigned &cell);
+
+  namespace {
+    const unsigned unreached = unsigned(-1);
+    const unsigned char no_step = 8;
+    //Neighbor offsets by direction, counterclockwise from the right in 45 degree
+    //steps, so the way back along step i is step (i+4)%8
+    const int steps[8][2] = {{1,0},{1,-1},{0,-1},{-1,-1},{-1,0},{-1,1},{0,1},{1,1}};
+
+    struct flowfield
+    {
+      unsigned grid;
+      double xgoal, ygoal;
+      unsigned goal;
+      bool allow_diag;
+      bool built;
+      unsigned long version;        //of the grid the field is up to date with
+      vector<unsigned> dist;        //cost of reaching the goal from each cell, or unreached
+      vector<unsigned char> next;   //the step toward the goal from each cell, or no_step
+      vector<unsigned char> mark;   //cells being redone; zero between updates
+      vector<std::pair<unsigned, unsigned> > heap; //(dist, cell), with stale entries skipped
+      vector<unsigned> redo;
+    };
+
+    vector<flowfield*> flowfields;
+
+    //Calls f(neighbor, step) for each cell next to cell on the grid
+    template<typename F>
+    inline void for_neighbors(const flowfield &ff, const enigma::grid *gr, unsigned cell, F f)
+    {
+      const unsigned vc = gr->vcells, cx = cell / vc, cy = cell % vc;
+      for (unsigned char i = 0; i < 8; i++) {
+        if (!ff.allow_diag && (i & 1))
+          continue;
+        const unsigned nx = cx + steps[i][0], ny = cy + steps[i][1];
+        if (nx < gr->hcells && ny < gr->vcells) //unsigned, so this also catches stepping off the left or top
+          f(nx*vc + ny, i);
+      }
+    }
+
+    //Dijkstra outward from the cells on the heap, which must be settled already.
+    //Cells are walked from the goal, so a cell's distance is what it costs to enter
+    //the cell it steps to, plus that cell's distance.
+    void spread(flowfield &ff, const enigma::grid *gr)
+    {
+      const node *nodes = &gr->nodearray[0];
+      const unsigned vc = gr->vcells, threshold = gr->threshold;
+      while (!ff.heap.empty())
+      {
+        std::pop_heap(ff.heap.begin(), ff.heap.end(), std::greater<std::pair<unsigned, unsigned> >());
+        const std::pair<unsigned, unsigned> top = ff.heap.back();
+        ff.heap.pop_back();
+        const unsigned current = top.second;
+        if (top.first != ff.dist[current])
+          continue;
+
+        const unsigned cx = current / vc, cy = current % vc;
+        for_neighbors(ff, gr, current, [&](unsigned cell, unsigned char i) {
+          if (nodes[cell].cost >= threshold)
+            return;
+          const bool diagonal = i & 1;
+          //Don't cut the corner of a blocked cell
+          if (diagonal && (nodes[(cx + steps[i][0])*vc + cy].cost >= threshold || nodes[cx*vc + cy + steps[i][1]].cost >= threshold))
+            return;
+          const unsigned d = ff.dist[current] + step_cost(nodes[current].cost, diagonal);
+          if (d < ff.dist[cell]) {
+            ff.dist[cell] = d;
+            ff.next[cell] = (i + 4) % 8;
+            ff.heap.push_back(std::make_pair(d, cell));
+            std::push_heap(ff.heap.begin(), ff.heap.end(), std::greater<std::pair<unsigned, unsigned> >());
+          }
+        });
+      }
+    }
+
+    void rebuild(flowfield &ff, const enigma::grid *gr)
+    {
+      const size_t cells = gr->nodearray.size();
+      ff.dist.assign(cells, unreached);
+      ff.next.assign(cells, no_step);
+      ff.mark.assign(cells, 0);
+      ff.heap.clear();
+      if (ff.goal < cells && gr->nodearray[ff.goal].cost < gr->threshold) {
+        ff.dist[ff.goal] = 0;
+        ff.heap.push_back(std::make_pair(0u, ff.goal));
+        spread(ff, gr);
+      }
+    }
+
+    //Redoes the changed cells, every cell whose way to the goal passed through
+    //one, and, with diagonals, the cells around them whose step may have cut a
+    //corner that's now blocked. The rest keep their distances, which are still
+    //achievable, and the redone cells are filled in again from their edges.
+    void update(flowfield &ff, const enigma::grid *gr)
+    {
+      const unsigned vc = gr->vcells, grow = ff.allow_diag;
+      ff.redo.clear();
+      for (std::deque<grid::change>::const_iterator it = gr->changes.begin(); it != gr->changes.end(); ++it)
+      {
+        if (it->version <= ff.version)
+          continue;
+        const unsigned h0 = it->h0 > grow ? it->h0 - grow : 0, v0 = it->v0 > grow ? it->v0 - grow : 0;
+        const unsigned h1 = std::min(it->h1 + grow, gr->hcells - 1), v1 = std::min(it->v1 + grow, gr->vcells - 1);
+        for (unsigned h = h0; h <= h1; h++)
+          for (unsigned v = v0; v <= v1; v++)
+            if (!ff.mark[h*vc + v])
+              ff.mark[h*vc + v] = 1, ff.redo.push_back(h*vc + v);
+      }
+      for (size_t i = 0; i < ff.redo.size(); i++)
+      {
+        const unsigned cell = ff.redo[i];
+        for_neighbors(ff, gr, cell, [&](unsigned neighbor, unsigned char step) {
+          if (!ff.mark[neighbor] && ff.next[neighbor] == (step + 4) % 8)
+            ff.mark[neighbor] = 1, ff.redo.push_back(neighbor);
+        });
+      }
+
+      const bool goal_changed = ff.mark[ff.goal];
+      const size_t redone = ff.redo.size();
+      ff.heap.clear();
+      for (size_t i = 0; i < redone; i++) {
+        ff.dist[ff.redo[i]] = unreached;
+        ff.next[ff.redo[i]] = no_step;
+      }
+      //Spread from the settled cells bordering those being redone
+      for (size_t i = 0; i < redone; i++)
+      {
+        for_neighbors(ff, gr, ff.redo[i], [&](unsigned neighbor, unsigned char) {
+          if (!ff.mark[neighbor] && ff.dist[neighbor] != unreached) {
+            ff.mark[neighbor] = 2, ff.redo.push_back(neighbor);
+            ff.heap.push_back(std::make_pair(ff.dist[neighbor], neighbor));
+          }
+        });
+      }
+      for (vector<unsigned>::iterator it = ff.redo.begin(); it != ff.redo.end(); ++it)
+        ff.mark[*it] = 0;
+
+      if (goal_changed)
+        rebuild(ff, gr);
+      else {
+        std::make_heap(ff.heap.begin(), ff.heap.end(), std::greater<std::pair<unsigned, unsigned> >());
+        spread(ff, gr);
+      }
+    }
+
+    //Returns the field brought up to date with its grid, or NULL if either is gone
+    flowfield *current_field(int field, enigma::grid *&gr)
+    {
+      if (field < 0 || size_t(field) >= flowfields.size() || !flowfields[field])
+        return NULL;
+      flowfield &ff = *flowfields[field];
+      if (ff.grid >= grid_idmax || !(gr = gridstructarray[ff.grid]))
+        return NULL;
+      if (!ff.built || ff.version < gr->changes_from || ff.dist.size() != gr->nodearray.size())
+        rebuild(ff, gr);
+      else if (ff.version != gr->version)
+        update(ff, gr);
+      ff.built = true;
+      ff.version = gr->version;
+      return &ff;
+    }
+  }
+}
+
+namespace enigma_user
+{
+
+int mp_grid_flowfield_create(unsigned id, double xgoal, double ygoal, bool allowdiag)
+{
+    enigma::grid *gr = enigma::gridstructarray[id];
+    unsigned goal;
+    if (!enigma::grid_cell_at(gr, xgoal, ygoal, goal))
+        return -1;
+    enigma::flowfield *ff = new enigma::flowfield();
+    ff->grid = id;
+    ff->xgoal = xgoal, ff->ygoal = ygoal;
+    ff->goal = goal;
+    ff->allow_diag = allowdiag;
+    ff->built = false;
+    ff->version = 0;
+    enigma::flowfields.push_back(ff);
+    return enigma::flowfields.size() - 1;
+}
+
+void mp_grid_flowfield_destroy(int field)
+{
+    if (field < 0 || size_t(field) >= enigma::flowfields.size())
+        return;
+    delete enigma::flowfields[field];
+    enigma::flowfields[field] = NULL;
+}
+
+bool mp_grid_flowfield_set_goal(int field, double xgoal, double ygoal)
+{
+    enigma::grid *gr;
+    enigma::flowfield *ff = enigma::current_field(field, gr);
+    unsigned goal;
+    if (!ff || !enigma::grid_cell_at(gr, xgoal, ygoal, goal))
+        return false;
+    ff->xgoal = xgoal, ff->ygoal = ygoal;
+    if (goal != ff->goal) {
+        ff->goal = goal;
+        ff->built = false;
+    }
+    return true;
+}
+
+double mp_grid_flowfield_direction(int field, double x, double y)
+{
+    enigma::grid *gr;
+    enigma::flowfield *ff = enigma::current_field(field, gr);
+    unsigned cell;
+    if (!ff || !enigma::grid_cell_at(gr, x, y, cell) || ff->dist[cell] == enigma::unreached)
+        return -1;
+    if (cell == ff->goal) {
+        if (x == ff->xgoal && y == ff->ygoal)
+            return -1;
+        const double dir = atan2(y - ff->ygoal, ff->xgoal - x)*(180/M_PI);
+        return dir < 0 ? dir + 360 : dir;
+    }
+    return 45*ff->next[cell];
+}
+
+double mp_grid_flowfield_distance(int field, double x, double y)
+{
+    enigma::grid *gr;
+    enigma::flowfield *ff = enigma::current_field(field, gr);
+    unsigned cell;
+    if (!ff || !enigma::grid_cell_at(gr, x, y, cell) || ff->dist[cell] == enigma::unreached)
+        return -1;
+    return ff->dist[cell];
+}
+
+bool mp_grid_flowfield_step(int field, double stepsize, bool checkall)
+{
+    enigma::object_collisions* const inst = ((enigma::object_collisions*)enigma::instance_event_iterator->inst);
+    enigma::grid *gr;
+    enigma::flowfield *ff = enigma::current_field(field, gr);
+    unsigned cell;
+    if (!ff || !enigma::grid_cell_at(gr, inst->x, inst->y, cell) || ff->dist[cell] == enigma::unreached)
+        return false;
+    if (cell == ff->goal) {
+        mp_potential_step(ff->xgoal, ff->ygoal, stepsize, checkall);
+        return inst->x == ff->xgoal && inst->y == ff->ygoal;
+    }
+    //Head for the middle of the next cell, which keeps instances off the walls
+    const unsigned next = cell + enigma::steps[ff->next[cell]][0]*gr->vcells + enigma::steps[ff->next[cell]][1];
+    mp_potential_step(gr->left + (next / gr->vcells + 0.5)*gr->cellwidth, gr->top + (next % gr->vcells + 0.5)*gr->cellheight, stepsize, checkall);
+    return false;
+}
+
+}
@@ -0,0 +1,51 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+#ifndef ENIGMA_MP_FLOWFIELD_H
+#define ENIGMA_MP_FLOWFIELD_H
+
+namespace enigma_user
+{
+  //Flow fields hold the cheapest way from every cell of a grid to one goal, so any
+  //number of instances heading there can look up their next step instead of each
+  //searching for a path. A field catches up with changes to the grid's cells the
+  //next time it is sampled, redoing only the part of it the changes affected.
+
+  //Returns the new field's id, or -1 if the goal is off the grid
+  int mp_grid_flowfield_create(unsigned id, double xgoal, double ygoal, bool allowdiag);
+  void mp_grid_flowfield_destroy(int field);
+  bool mp_grid_flowfield_set_goal(int field, double xgoal, double ygoal);
+  //The direction to head from the given position, in degrees, or -1 if the goal
+  //can't be reached from there or it's the goal itself
+  double mp_grid_flowfield_direction(int field, double x, double y);
+  //What it costs to reach the goal from the given position's cell, as mp_grid_path
+  //counts it, or -1 if the goal can't be reached from there
+  double mp_grid_flowfield_distance(int field, double x, double y);
+  //Steps the current instance along the field as mp_potential_step would, steering
+  //around other instances. Returns whether the instance has reached the goal.
+  bool mp_grid_flowfield_step(int field, double stepsize, bool checkall);
+}
+
+#endif
@@ -0,0 +1,384 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+#include "mp_hierarchy.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace enigma
+{
+    static const int offsets[8][2] = {{-1,0},{-1,-1},{-1,1},{0,-1},{1,0},{1,-1},{1,1},{0,1}};
+
+    //Openings this long get an entrance at each end rather than one in the middle
+    static const unsigned wide_opening = 6;
+
+    unsigned grid_hierarchy::cluster_of(const grid &gr, unsigned cell) const {
+        return (cell / gr.vcells / cluster_size)*rows + cell % gr.vcells / cluster_size;
+    }
+
+    void grid_hierarchy::bounds(const grid &gr, unsigned k, unsigned &x0, unsigned &y0, unsigned &x1, unsigned &y1) const
+    {
+        x0 = k / rows * cluster_size, y0 = k % rows * cluster_size;
+        x1 = std::min(x0 + cluster_size, gr.hcells), y1 = std::min(y0 + cluster_size, gr.vcells);
+    }
+
+    void grid_hierarchy::cells_changed(unsigned h0, unsigned v0, unsigned h1, unsigned v1)
+    {
+        for (int i = 0; i < 2; i++) {
+            layer &l = layers[i];
+            if (!l.built) continue;
+            for (unsigned cx = h0 / cluster_size; cx <= h1 / cluster_size && cx < columns; cx++)
+                for (unsigned cy = v0 / cluster_size; cy <= v1 / cluster_size && cy < rows; cy++)
+                    l.clusters[cx*rows + cy].dirty = true;
+        }
+    }
+
+    void grid_hierarchy::all_changed() {
+        layers[0].built = layers[1].built = false;
+    }
+
+    //Finds the openings across the border to the right of, or below, cluster k
+    void grid_hierarchy::find_transitions(const grid &gr, unsigned k, bool right, vector<transition> &out) const
+    {
+        unsigned x0, y0, x1, y1;
+        bounds(gr, k, x0, y0, x1, y1);
+        const unsigned vc = gr.vcells, length = right ? y1 - y0 : x1 - x0;
+        const auto across = [&](unsigned i) {
+            transition t;
+            t.a = right ? (x1 - 1)*vc + y0 + i : (x0 + i)*vc + y1 - 1;
+            t.b = right ? x1*vc + y0 + i : (x0 + i)*vc + y1;
+            t.a_cost = gr.nodearray[t.a].cost, t.b_cost = gr.nodearray[t.b].cost;
+            return t;
+        };
+
+        out.clear();
+        unsigned run = 0;
+        for (unsigned i = 0; i <= length; i++)
+        {
+            if (i < length) {
+                const transition t = across(i);
+                if (gr.nodearray[t.a].cost < gr.threshold && gr.nodearray[t.b].cost < gr.threshold) {
+                    run++;
+                    continue;
+                }
+            }
+            if (run >= wide_opening) {
+                out.push_back(across(i - run));
+                out.push_back(across(i - 1));
+            } else if (run) {
+                out.push_back(across(i - run + run/2));
+            }
+            run = 0;
+        }
+    }
+
+    //Dijkstra over the cells of cluster k, from source or, in reverse, toward it.
+    //dist and parent are indexed by the cell's place in the cluster, column by column.
+    void grid_hierarchy::search_cluster(const grid &gr, unsigned k, unsigned source, bool reverse, bool allow_diag,
+                                        vector<unsigned> &dist, vector<unsigned> &parent) const
+    {
+        unsigned x0, y0, x1, y1;
+        bounds(gr, k, x0, y0, x1, y1);
+        const unsigned vc = gr.vcells, w = x1 - x0, h = y1 - y0;
+        dist.assign(w*h, unreached);
+        parent.assign(w*h, unreached);
+
+        typedef std::pair<unsigned, unsigned> entry;
+        std::priority_queue<entry, vector<entry>, std::greater<entry> > open;
+        const unsigned src = (source / vc - x0)*h + source % vc - y0;
+        dist[src] = 0;
+        open.push(entry(0, src));
+        while (!open.empty())
+        {
+            const entry top = open.top();
+            open.pop();
+            if (top.first != dist[top.second])
+                continue;
+            const unsigned p = top.second, px = p / h, py = p % h;
+            for (int i = 0; i < 8; i++)
+            {
+                const bool diagonal = offsets[i][0] && offsets[i][1];
+                if (diagonal && !allow_diag)
+                    continue;
+                const unsigned nx = px + offsets[i][0], ny = py + offsets[i][1];
+                if (nx >= w || ny >= h)
+                    continue;
+                const unsigned cost = gr.nodearray[(x0 + nx)*vc + y0 + ny].cost;
+                if (cost >= gr.threshold)
+                    continue;
+                if (diagonal && (gr.nodearray[(x0 + px)*vc + y0 + ny].cost >= gr.threshold
+                              || gr.nodearray[(x0 + nx)*vc + y0 + py].cost >= gr.threshold))
+                    continue;
+
+                //Searching in reverse, the step is from the neighbor into p
+                const unsigned d = top.first + step_cost(reverse ? gr.nodearray[(x0 + px)*vc + y0 + py].cost : cost, diagonal);
+                const unsigned q = nx*h + ny;
+                if (d < dist[q]) {
+                    dist[q] = d;
+                    parent[q] = p;
+                    open.push(entry(d, q));
+                }
+            }
+        }
+    }
+
+    void grid_hierarchy::link_cluster(const grid &gr, layer &l, unsigned k, bool allow_diag)
+    {
+        cluster &c = l.clusters[k];
+        for (vector<unsigned>::iterator it = c.entrances.begin(); it != c.entrances.end(); ++it)
+            l.entrance_index[*it] = unreached;
+
+        const unsigned cx = k / rows, cy = k % rows;
+        const vector<transition> none;
+        const vector<transition> &right = cx + 1 < columns ? l.right_borders[k] : none,
+                                 &left = cx > 0 ? l.right_borders[k - rows] : none,
+                                 &lower = cy + 1 < rows ? l.lower_borders[k] : none,
+                                 &upper = cy > 0 ? l.lower_borders[k - 1] : none;
+        c.entrances.clear();
+        for (size_t i = 0; i < right.size(); i++) c.entrances.push_back(right[i].a);
+        for (size_t i = 0; i < left.size(); i++) c.entrances.push_back(left[i].b);
+        for (size_t i = 0; i < lower.size(); i++) c.entrances.push_back(lower[i].a);
+        for (size_t i = 0; i < upper.size(); i++) c.entrances.push_back(upper[i].b);
+        std::sort(c.entrances.begin(), c.entrances.end());
+        c.entrances.erase(std::unique(c.entrances.begin(), c.entrances.end()), c.entrances.end());
+        for (size_t i = 0; i < c.entrances.size(); i++)
+            l.entrance_index[c.entrances[i]] = i;
+
+        unsigned x0, y0, x1, y1;
+        bounds(gr, k, x0, y0, x1, y1);
+        const unsigned vc = gr.vcells, h = y1 - y0;
+        const auto local = [&](unsigned cell) { return (cell / vc - x0)*h + cell % vc - y0; };
+        const auto global = [&](unsigned p) { return (x0 + p / h)*vc + y0 + p % h; };
+
+        c.links.assign(c.entrances.size(), vector<link>());
+        vector<unsigned> dist, parent;
+        for (size_t i = 0; i < c.entrances.size(); i++)
+        {
+            search_cluster(gr, k, c.entrances[i], false, allow_diag, dist, parent);
+            const unsigned from = local(c.entrances[i]);
+            for (size_t j = 0; j < c.entrances.size(); j++)
+            {
+                const unsigned to = local(c.entrances[j]);
+                if (i == j || dist[to] == unreached)
+                    continue;
+                c.links[i].push_back(link());
+                link &lk = c.links[i].back();
+                lk.to = c.entrances[j];
+                lk.cost = dist[to];
+                for (unsigned p = parent[to]; p != from; p = parent[p])
+                    lk.cells.push_back(global(p));
+                std::reverse(lk.cells.begin(), lk.cells.end());
+            }
+        }
+
+        const auto cross = [&](unsigned from, unsigned to) {
+            c.links[l.entrance_index[from]].push_back(link());
+            link &lk = c.links[l.entrance_index[from]].back();
+            lk.to = to;
+            lk.cost = step_cost(gr.nodearray[to].cost, false);
+        };
+        for (size_t i = 0; i < right.size(); i++) cross(right[i].a, right[i].b);
+        for (size_t i = 0; i < left.size(); i++) cross(left[i].b, left[i].a);
+        for (size_t i = 0; i < lower.size(); i++) cross(lower[i].a, lower[i].b);
+        for (size_t i = 0; i < upper.size(); i++) cross(upper[i].b, upper[i].a);
+        c.dirty = false;
+    }
+
+    //Finds the openings of every border a dirty cluster touches, and relinks
+    //the dirty clusters along with any neighbor whose openings changed, or
+    //whose openings' cells changed cost
+    void grid_hierarchy::update(grid &gr, layer &l, bool allow_diag)
+    {
+        if (!l.built) {
+            columns = (gr.hcells + cluster_size - 1) / cluster_size;
+            rows = (gr.vcells + cluster_size - 1) / cluster_size;
+            l.clusters.assign(columns*rows, cluster());
+            l.right_borders.assign(columns*rows, vector<transition>());
+            l.lower_borders.assign(columns*rows, vector<transition>());
+            l.entrance_index.assign(gr.nodearray.size(), unreached);
+            l.built = true;
+        }
+
+        const unsigned count = columns*rows;
+        vector<char> right(count, 0), lower(count, 0), relink(count, 0);
+        bool any = false;
+        for (unsigned k = 0; k < count; k++)
+        {
+            if (!l.clusters[k].dirty)
+                continue;
+            any = true;
+            relink[k] = 1;
+            const unsigned cx = k / rows, cy = k % rows;
+            if (cx + 1 < columns) right[k] = 1;
+            if (cx > 0) right[k - rows] = 1;
+            if (cy + 1 < rows) lower[k] = 1;
+            if (cy > 0) lower[k - 1] = 1;
+        }
+        if (!any)
+            return;
+
+        vector<transition> found;
+        for (unsigned k = 0; k < count; k++)
+        {
+            if (right[k]) {
+                find_transitions(gr, k, true, found);
+                if (found != l.right_borders[k]) {
+                    l.right_borders[k].swap(found);
+                    relink[k] = relink[k + rows] = 1;
+                }
+            }
+            if (lower[k]) {
+                find_transitions(gr, k, false, found);
+                if (found != l.lower_borders[k]) {
+                    l.lower_borders[k].swap(found);
+                    relink[k] = relink[k + 1] = 1;
+                }
+            }
+        }
+        for (unsigned k = 0; k < count; k++)
+            if (relink[k])
+                link_cluster(gr, l, k, allow_diag);
+    }
+
+    bool grid_hierarchy::find_path(grid &gr, node* n0, node* n1, bool allow_diag, vector<node*> &path)
+    {
+        const unsigned start = n0 - &gr.nodearray[0], goal = n1 - &gr.nodearray[0];
+        if (start == goal || n1->cost >= gr.threshold)
+            return enigma::find_path(gr.id, n0, n1, allow_diag, path);
+        layer &l = layers[allow_diag];
+        update(gr, l, allow_diag);
+        const unsigned ks = cluster_of(gr, start), kg = cluster_of(gr, goal);
+        if (ks == kg)
+            return enigma::find_path(gr.id, n0, n1, allow_diag, path);
+
+        const unsigned vc = gr.vcells;
+        unsigned x0, y0, x1, y1;
+
+        //Link the start to the entrances of its cluster...
+        const cluster &cs = l.clusters[ks];
+        search_cluster(gr, ks, start, false, allow_diag, start_dist, start_parent);
+        bounds(gr, ks, x0, y0, x1, y1);
+        unsigned h = y1 - y0, from = (start / vc - x0)*h + start % vc - y0;
+        start_links.clear();
+        for (size_t i = 0; i < cs.entrances.size(); i++)
+        {
+            const unsigned e = cs.entrances[i], p = (e / vc - x0)*h + e % vc - y0;
+            if (e == start || start_dist[p] == unreached)
+                continue;
+            start_links.push_back(link());
+            link &lk = start_links.back();
+            lk.to = e;
+            lk.cost = start_dist[p];
+            for (unsigned q = start_parent[p]; q != from; q = start_parent[q])
+                lk.cells.push_back((x0 + q / h)*vc + y0 + q % h);
+            std::reverse(lk.cells.begin(), lk.cells.end());
+        }
+
+        //...and the entrances of the goal's cluster to the goal
+        const cluster &cg = l.clusters[kg];
+        search_cluster(gr, kg, goal, true, allow_diag, goal_dist, goal_parent);
+        bounds(gr, kg, x0, y0, x1, y1);
+        h = y1 - y0;
+        const unsigned to = (goal / vc - x0)*h + goal % vc - y0;
+        goal_links.assign(cg.entrances.size(), link());
+        for (size_t i = 0; i < cg.entrances.size(); i++)
+        {
+            const unsigned e = cg.entrances[i], p = (e / vc - x0)*h + e % vc - y0;
+            if (e == goal || goal_dist[p] == unreached)
+                continue;
+            link &lk = goal_links[i];
+            lk.to = goal;
+            lk.cost = goal_dist[p];
+            for (unsigned q = goal_parent[p]; q != to; q = goal_parent[q])
+                lk.cells.push_back((x0 + q / h)*vc + y0 + q % h);
+        }
+
+        //A* from entrance to entrance, in the same scratch the cell search uses
+        search_scratch &s = gr.scratch;
+        s.begin(gr.nodearray.size());
+        via.resize(gr.nodearray.size());
+        const auto relax = [&](unsigned current, const link &lk) {
+            const unsigned G = s.G[current] + lk.cost;
+            if (!s.seen(lk.to)) {
+                s.G[lk.to] = G;
+                s.F[lk.to] = G + find_heuristic(&gr.nodearray[lk.to], n1, allow_diag);
+                s.came_from[lk.to] = current;
+                via[lk.to] = &lk;
+                s.open(lk.to);
+            } else if (s.is_open(lk.to) && G < s.G[lk.to]) {
+                s.F[lk.to] -= s.G[lk.to] - G;
+                s.G[lk.to] = G;
+                s.came_from[lk.to] = current;
+                via[lk.to] = &lk;
+                s.decreased(lk.to);
+            }
+        };
+        s.G[start] = 0;
+        s.F[start] = find_heuristic(n0, n1, allow_diag);
+        s.came_from[start] = start;
+        s.open(start);
+
+        bool found = false;
+        while (!s.heap.empty())
+        {
+            const unsigned current = s.close_best();
+            if (current == goal) {
+                found = true;
+                break;
+            }
+            if (current == start)
+                for (size_t i = 0; i < start_links.size(); i++)
+                    relax(current, start_links[i]);
+            const unsigned index = l.entrance_index[current];
+            if (index == unreached)
+                continue;
+            const unsigned k = cluster_of(gr, current);
+            const vector<link> &links = l.clusters[k].links[index];
+            for (size_t i = 0; i < links.size(); i++)
+                relax(current, links[i]);
+            if (k == kg && goal_links[index].to != unreached)
+                relax(current, goal_links[index]);
+        }
+        //The goal may still be reachable by leaving and re-entering a cluster,
+        //which the links don't cover; the cell search settles it either way
+        if (!found)
+            return enigma::find_path(gr.id, n0, n1, allow_diag, path);
+
+        path.clear();
+        for (unsigned c = goal; c != start; c = s.came_from[c])
+        {
+            if (c != goal)
+                path.push_back(&gr.nodearray[c]);
+            const vector<unsigned> &cells = via[c]->cells;
+            for (vector<unsigned>::const_reverse_iterator it = cells.rbegin(); it != cells.rend(); ++it)
+                path.push_back(&gr.nodearray[*it]);
+        }
+        std::reverse(path.begin(), path.end());
+        return true;
+    }
+}
@@ -0,0 +1,111 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#  error This file includes non-ENIGMA STL headers and should not be included from SHELLmain.
+#endif
+
+#ifndef ENIGMA_MP_HIERARCHY_H
+#define ENIGMA_MP_HIERARCHY_H
+
+#include "motion_planning_struct.h"
+
+namespace enigma
+{
+  //An HPA* abstraction of a grid. The grid is cut into square clusters, and
+  //the cells on either side of each opening between two clusters become
+  //entrances. The entrances of a cluster are linked by the cheapest paths
+  //between them that stay inside it, so a long search can step from entrance
+  //to entrance instead of from cell to cell. Paths found this way are close
+  //to the cheapest, but not always the cheapest.
+  class grid_hierarchy
+  {
+   public:
+    explicit grid_hierarchy(unsigned cluster_size): cluster_size(cluster_size), columns(0), rows(0) {}
+
+    //Marks the clusters holding the cells from (h0,v0) to (h1,v1) to be relinked before the next search
+    void cells_changed(unsigned h0, unsigned v0, unsigned h1, unsigned v1);
+    void all_changed();
+
+    //Like enigma::find_path, which it defers to within a cluster and when the goal can't be reached
+    bool find_path(grid &gr, node* n0, node* n1, bool allow_diag, vector<node*> &path);
+
+   private:
+    static constexpr unsigned unreached = unsigned(-1);
+
+    struct link
+    {
+      unsigned to, cost;
+      vector<unsigned> cells; //walked between the two ends, exclusive
+      link(): to(unreached), cost(0) {}
+    };
+    struct cluster
+    {
+      vector<unsigned> entrances;  //cells, sorted
+      vector<vector<link> > links; //leaving each entrance
+      bool dirty;
+      cluster(): dirty(true) {}
+    };
+    //A step across the border between two clusters; a is in the left or upper one.
+    //The costs of both cells are kept, as the links across are priced by them.
+    struct transition
+    {
+      unsigned a, b;
+      unsigned a_cost, b_cost;
+      bool operator==(const transition &o) const {
+        return a == o.a && b == o.b && a_cost == o.a_cost && b_cost == o.b_cost;
+      }
+    };
+    //The hierarchy for searches with or without diagonal moves
+    struct layer
+    {
+      bool built;
+      vector<cluster> clusters;                   //by column*rows + row
+      vector<vector<transition> > right_borders;  //by the cluster on the left
+      vector<vector<transition> > lower_borders;  //by the cluster above
+      vector<unsigned> entrance_index;            //by cell, its place in its cluster's entrances
+      layer(): built(false) {}
+    };
+
+    unsigned cluster_size;
+    unsigned columns, rows;
+    layer layers[2];
+
+    //Scratch for searches within a cluster and for the search across them
+    vector<unsigned> start_dist, start_parent, goal_dist, goal_parent;
+    vector<link> start_links, goal_links;
+    vector<const link*> via;
+
+    unsigned cluster_of(const grid &gr, unsigned cell) const;
+    void bounds(const grid &gr, unsigned k, unsigned &x0, unsigned &y0, unsigned &x1, unsigned &y1) const;
+    void update(grid &gr, layer &l, bool allow_diag);
+    void find_transitions(const grid &gr, unsigned k, bool right, vector<transition> &out) const;
+    void link_cluster(const grid &gr, layer &l, unsigned k, bool allow_diag);
+    void search_cluster(const grid &gr, unsigned k, unsigned source, bool reverse, bool allow_diag,
+                        vector<unsigned> &dist, vector<unsigned> &parent) const;
+  };
+}
+
+#endif
@@ -0,0 +1,191 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+#include "mp_path_async.h"
+#include "motion_planning_struct.h"
+#include "../Paths/path_functions.h"
+#include "Platforms/platforms_mandatory.h"
+#include "Universal_System/worker_pool.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace enigma
+{
+  namespace {
+    struct path_request
+    {
+      int id;
+      unsigned grid, path;
+      double xstart, ystart, xgoal, ygoal;
+      bool allow_diag;
+      unsigned start, goal;
+      unsigned long version; //of the grid when requested
+      size_t cells;          //in the grid when requested
+      std::shared_ptr<const grid_snapshot> snapshot;
+      bool found;
+      vector<unsigned> path_cells;
+      bool finished; //main thread only; set once the main thread has the result
+    };
+    typedef std::shared_ptr<path_request> request_ptr;
+
+    std::mutex finished_mutex;
+    std::condition_variable finished;
+    std::vector<request_ptr> searched; // Waiting for the main thread.
+    // Declared after what its tasks use, so that it stops them first at exit.
+    worker_pool workers;
+
+    void search(const request_ptr& request)
+    {
+      static thread_local search_scratch scratch;
+      request->found = find_path(*request->snapshot, scratch, request->start, request->goal,
+                                 request->allow_diag, request->path_cells);
+      request->snapshot.reset();
+      std::lock_guard<std::mutex> lock(finished_mutex);
+      searched.push_back(request);
+      finished.notify_all();
+    }
+
+    // Moves the searched requests into out, first waiting for one if asked.
+    void collect(std::vector<request_ptr>& out, bool wait)
+    {
+      std::unique_lock<std::mutex> lock(finished_mutex);
+      if (wait) finished.wait(lock, [] { return !searched.empty(); });
+      out.insert(out.end(), searched.begin(), searched.end());
+      searched.clear();
+    }
+
+    int path_thread_count = 0; // 0 means one per hardware thread, less the main thread.
+    bool deliver_in_order = false;
+    int next_request = 0;
+    std::map<int, request_ptr> requests; // Not yet delivered, by id.
+    std::set<int> dropped;               // Whose grid or path went away first.
+
+    void deliver(const path_request& request)
+    {
+      grid* gr = request.grid < grid_idmax ? gridstructarray[request.grid] : NULL;
+      if (!gr || gr->nodearray.size() != request.cells || !enigma_user::path_exists(request.path)) {
+        dropped.insert(request.id);
+        return;
+      }
+      vector<node*> nodelist;
+      nodelist.reserve(request.path_cells.size());
+      for (unsigned cell : request.path_cells) nodelist.push_back(&gr->nodearray[cell]);
+      write_grid_path(gr, request.path, request.xstart, request.ystart, request.xgoal, request.ygoal,
+                      nodelist, request.found);
+      if (request.version == gr->version)
+        gr->cache(request.start, request.goal, request.allow_diag, request.found, request.path_cells);
+    }
+
+    // Fills in the paths of finished requests, lowest id first. In order,
+    // a request also waits for every one before it.
+    void deliver_paths(bool wait = false)
+    {
+      if (requests.empty()) return;
+      std::vector<request_ptr> done;
+      collect(done, wait);
+      for (const request_ptr& request : done) request->finished = true;
+      for (auto it = requests.begin(); it != requests.end(); ) {
+        if (!it->second->finished) {
+          if (deliver_in_order) break;
+          ++it;
+          continue;
+        }
+        deliver(*it->second);
+        requests.erase(it++);
+      }
+    }
+  }
+
+  void extension_motion_planning_init() {
+    extension_update_hooks.push_back([] { deliver_paths(); });
+  }
+}
+
+namespace enigma_user
+{
+  int mp_grid_path_async(unsigned id, unsigned path, double xstart, double ystart, double xgoal, double ygoal, bool allowdiag)
+  {
+    enigma::grid* gr = enigma::gridstructarray[id];
+    unsigned start, goal;
+    if (!enigma::grid_cell_at(gr, xstart, ystart, start) || !enigma::grid_cell_at(gr, xgoal, ygoal, goal)) return -1;
+
+    enigma::request_ptr request = std::make_shared<enigma::path_request>();
+    request->id = enigma::next_request++;
+    request->grid = id;
+    request->path = path;
+    request->xstart = xstart, request->ystart = ystart;
+    request->xgoal = xgoal, request->ygoal = ygoal;
+    request->allow_diag = allowdiag;
+    request->start = start, request->goal = goal;
+    request->version = gr->version;
+    request->cells = gr->nodearray.size();
+    request->found = false;
+    request->finished = false;
+    enigma::requests[request->id] = request;
+
+    if (gr->path_cache_size) {
+      if (const enigma::grid::cached_path* hit = gr->find_cached(start, goal, allowdiag)) {
+        request->found = hit->found;
+        request->path_cells = hit->cells;
+        request->finished = true;
+        return request->id;
+      }
+    }
+    request->snapshot = gr->snapshot();
+    const size_t hardware = std::thread::hardware_concurrency();
+    enigma::workers.resize(enigma::path_thread_count > 0 ? enigma::path_thread_count : hardware > 2 ? hardware - 1 : 1);
+    enigma::workers.submit([request] { enigma::search(request); });
+    return request->id;
+  }
+
+  int mp_grid_path_async_status(int request)
+  {
+    if (request < 0 || request >= enigma::next_request || enigma::dropped.count(request)) return -1;
+    return enigma::requests.count(request) ? 0 : 1;
+  }
+
+  bool mp_grid_path_async_wait(int request)
+  {
+    if (request < 0 || request >= enigma::next_request) return false;
+    enigma::deliver_paths();
+    while (enigma::requests.count(request)) enigma::deliver_paths(true);
+    return !enigma::dropped.count(request);
+  }
+
+  void mp_grid_path_async_threads(int count)
+  {
+    enigma::path_thread_count = count > 0 ? count : 0;
+  }
+
+  void mp_grid_path_async_ordered(bool ordered)
+  {
+    enigma::deliver_in_order = ordered;
+  }
+}
@@ -0,0 +1,50 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+#ifndef ENIGMA_MP_PATH_ASYNC_H
+#define ENIGMA_MP_PATH_ASYNC_H
+
+namespace enigma {
+  void extension_motion_planning_init();
+}
+
+namespace enigma_user
+{
+  //Like mp_grid_path, but searched on a worker thread against the grid as it is now.
+  //The path is filled in at the start of a later step; returns a request id, or -1
+  //if either point is off the grid.
+  int mp_grid_path_async(unsigned id, unsigned path, double xstart, double ystart, double xgoal, double ygoal, bool allowdiag);
+  //1 once the path has been filled in, 0 while pending, -1 for an unknown request
+  //or one whose grid or path was destroyed before it finished
+  int mp_grid_path_async_status(int request);
+  //Blocks until the request's path is filled in; false if it never will be
+  bool mp_grid_path_async_wait(int request);
+  //Worker threads to search on; 0 means one per hardware thread beside the main one
+  void mp_grid_path_async_threads(int count);
+  //Fill in paths strictly in the order they were requested
+  void mp_grid_path_async_ordered(bool ordered);
+}
+
+#endif
@@ -46,12 +46,15 @@ namespace enigma_user {
   void part_system_automatic_update(int id, bool automatic);
   void part_system_automatic_draw(int id, bool automatic);
   void part_system_update(int id);
+  void part_system_update_threads(int count);
   void part_system_drawit(int id);
   // Particles.
   void part_particles_create(int id, double x, double y, int particle_type_id, int number);
   void part_particles_create_color(int id, double x, double y, int particle_type_id, int color, int number);
   void part_particles_clear(int id);
   int part_particles_count(int id);
+  // A hash of the state of every particle in the system, for comparing runs.
+  int part_particles_checksum(int id);
 
   // Emitters.
 
@@ -44,7 +44,7 @@ namespace enigma {
 
     }
 
-    void draw_particles(std::vector<particle_instance>& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
+    void draw_particles(particle_list& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
         double a_x_offset, double a_y_offset)
     {
 
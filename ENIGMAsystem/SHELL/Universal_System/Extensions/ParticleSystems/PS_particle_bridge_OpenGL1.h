@@ -181,7 +181,7 @@ namespace enigma {
       }
     }
 
-    void draw_particles(std::vector<particle_instance>& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
+    void draw_particles(particle_list& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
         double a_x_offset, double a_y_offset)
     {
       using namespace enigma::particle_bridge;
@@ -197,19 +197,11 @@ namespace enigma {
       glPushAttrib(GL_CURRENT_BIT | GL_COLOR_BUFFER_BIT); // Attrib push 1.
 
       // Draw the particle system either from oldest to youngest or reverse.
-      if (oldtonew) {
-        const std::vector<particle_instance>::iterator end = pi_list.end();
-        for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != end; it++)
-        {
-          draw_particle(&(*it));
-        }
-      }
-      else {
-        const std::vector<particle_instance>::reverse_iterator rend = pi_list.rend();
-        for (std::vector<particle_instance>::reverse_iterator it = pi_list.rbegin(); it != rend; it++)
-        {
-          draw_particle(&(*it));
-        }
+      const size_t count = pi_list.count();
+      for (size_t i = 0; i < count; i++)
+      {
+        particle_instance pi = pi_list.get(oldtonew ? i : count - 1 - i);
+        draw_particle(&pi);
       }
 
       glPopAttrib(); // Attrib pop 1.
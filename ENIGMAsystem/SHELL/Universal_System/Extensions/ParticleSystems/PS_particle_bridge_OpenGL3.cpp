@@ -0,0 +1,353 @@
+/** Copyright (C) 2008-2013 Josh Ventura, forthevin, Robert B. Colton
+***
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+
+#include "graphics_info.h"
+
+#if defined(ENIGMA_GS_OPENGL3) && ENIGMA_GS_OPENGL3
+
+#include "PS_particle_system.h"
+#include "PS_particle_sprites.h"
+#include "PS_particle.h"
+
+#include "OpenGLHeaders.h"
+#include "Graphics_Systems/OpenGL-Common/shader.h"
+#include "Graphics_Systems/General/GSmatrix_impl.h"
+#include "Graphics_Systems/General/GSprimitives.h"
+#include "Graphics_Systems/General/GSstdraw.h"
+#include "Graphics_Systems/General/GStextures.h"
+#include "Graphics_Systems/General/GSblend.h"
+#include "Graphics_Systems/General/GScolor_macros.h"
+#include "Universal_System/profiler.h"
+#include "Universal_System/Resources/sprites_internal.h"
+#include "Universal_System/Resources/sprites.h"
+#include "Widget_Systems/widgets_mandatory.h"
+
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Each particle is uploaded once per draw as a single instance holding its
+// position, scale, angle, color and sprite frame. The vertex shader expands
+// the instances into quads, so the CPU does no per-vertex work at all.
+
+namespace enigma {
+  namespace particle_bridge {
+    namespace {
+      // What the vertex shader needs of one particle.
+      struct particle_vertex
+      {
+        GLfloat x, y;
+        GLfloat xscale, yscale;
+        GLfloat angle; // Degrees.
+        GLubyte color[4]; // Red, green, blue and alpha.
+        GLfloat left, top, width, height; // The unscaled quad, relative to the origin.
+        GLfloat tx, ty, tw, th; // The subimage's texture rectangle.
+      };
+
+      // A run of particles drawn with the same texture and blending.
+      struct particle_batch
+      {
+        size_t first, count;
+        int texture;
+        bool additive;
+      };
+
+      const char* vertex_source = R"CODE(#version 330
+uniform mat4 u_Matrix;
+
+in vec2 in_Position;
+in vec2 in_Scale;
+in float in_Angle;
+in vec4 in_Color;
+in vec4 in_Quad;
+in vec4 in_TexRect;
+
+out vec2 v_TextureCoord;
+out vec4 v_Color;
+
+void main() {
+  // Vertices 0 to 3 are the corners of a triangle strip.
+  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  vec2 offset = (in_Quad.xy + corner*in_Quad.zw)*in_Scale;
+  float angle = radians(-in_Angle), c = cos(angle), s = sin(angle);
+  vec2 position = in_Position + vec2(offset.x*c - offset.y*s, offset.x*s + offset.y*c);
+  gl_Position = u_Matrix*vec4(position, 0.0, 1.0);
+  v_TextureCoord = in_TexRect.xy + corner*in_TexRect.zw;
+  v_Color = in_Color;
+}
+)CODE";
+
+      const char* fragment_source = R"CODE(#version 330
+uniform sampler2D u_Texture;
+uniform float u_AlphaTest;
+
+in vec2 v_TextureCoord;
+in vec4 v_Color;
+out vec4 out_FragColor;
+
+void main() {
+  out_FragColor = texture(u_Texture, v_TextureCoord)*v_Color;
+  if (out_FragColor.a <= u_AlphaTest) discard;
+}
+)CODE";
+
+      GLuint shader_program = 0, vao = 0, vbo = 0;
+      GLint matrix_uniform, alpha_test_uniform;
+      std::vector<particle_vertex> vertices;
+      std::vector<particle_batch> batches;
+
+      GLuint load_and_compile_shader(const char* src, GLenum shader_type)
+      {
+        GLuint shader = glCreateShader(shader_type);
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+
+        GLint test;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &test);
+        if (!test) {
+          const size_t buffer_size = 512;
+          char buffer[buffer_size];
+          glGetShaderInfoLog(shader, buffer_size, NULL, buffer);
+          DEBUG_MESSAGE(std::string("Particle shader compilation failed with this message: ") + buffer, MESSAGE_TYPE::M_ERROR);
+          glDeleteShader(shader);
+          return 0;
+        }
+        return shader;
+      }
+
+      const struct { const char* name; GLint size; GLenum type; GLboolean normalize; size_t offset; } attributes[] = {
+        {"in_Position", 2, GL_FLOAT, GL_FALSE, offsetof(particle_vertex, x)},
+        {"in_Scale", 2, GL_FLOAT, GL_FALSE, offsetof(particle_vertex, xscale)},
+        {"in_Angle", 1, GL_FLOAT, GL_FALSE, offsetof(particle_vertex, angle)},
+        {"in_Color", 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(particle_vertex, color)},
+        {"in_Quad", 4, GL_FLOAT, GL_FALSE, offsetof(particle_vertex, left)},
+        {"in_TexRect", 4, GL_FLOAT, GL_FALSE, offsetof(particle_vertex, tx)},
+      };
+      const size_t attribute_count = sizeof(attributes)/sizeof(attributes[0]);
+      GLint attribute_locations[attribute_count];
+
+      // Points the instance attributes at the particles from `first` on.
+      void set_attributes(size_t first)
+      {
+        for (size_t i = 0; i < attribute_count; i++)
+        {
+          if (attribute_locations[i] < 0) continue;
+          glVertexAttribPointer(attribute_locations[i], attributes[i].size, attributes[i].type, attributes[i].normalize,
+                                sizeof(particle_vertex), (const GLvoid*)(first*sizeof(particle_vertex) + attributes[i].offset));
+        }
+      }
+
+      double wiggle;
+      int subimage_index;
+      double x_offset;
+      double y_offset;
+
+      // Queues a particle the way the fallback bridge would draw it.
+      void add_particle(const particle_instance& pi)
+      {
+        int sprite_id, subimg = 0;
+        double x = pi.x, y = pi.y;
+        double xscale, yscale, rot_degrees;
+        bool additive;
+        if (pi.pt->alive) {
+          particle_type* pt = pi.pt;
+          const double size = std::max(0.0, pi.size + pt->size_wiggle*particle_system::get_wiggle_result(pi.size_wiggle_offset, wiggle));
+          if (size <= 0) return;
+          rot_degrees = pi.angle + pt->ang_wiggle*particle_system::get_wiggle_result(pi.ang_wiggle_offset, wiggle);
+          if (pt->ang_relative) {
+            rot_degrees += pi.direction;
+          }
+          xscale = pt->xscale*size, yscale = pt->yscale*size;
+          additive = pt->blend_additive;
+
+          if (!pt->is_particle_sprite) {
+            sprite_id = pt->sprite_id;
+            if (!enigma_user::sprite_exists(sprite_id)) return;
+            if (!pt->sprite_animated) {
+              subimg = pi.sprite_subimageindex_initial;
+            }
+            else {
+              const int subimage_count = sprites.get(sprite_id).SubimageCount();
+              if (pt->sprite_stretched) {
+                subimg = int(subimage_count*(1.0 - 1.0*pi.life_current/pi.life_start));
+                subimg = subimg >= subimage_count ? subimage_count - 1 : subimg;
+                subimg = subimg % subimage_count;
+              }
+              else {
+                subimg = (subimage_index + pi.sprite_subimageindex_initial) % subimage_count;
+              }
+            }
+          }
+          else {
+            sprite_id = get_particle_actual_sprite(pt->part_sprite->shape);
+          }
+        }
+        else { // Drawn in a limited way if the particle type is not alive.
+          if (pi.size <= 0) return;
+          particle_sprite* ps = get_particle_sprite(pt_sh_pixel);
+          if (ps == NULL) return;
+          sprite_id = get_particle_actual_sprite(ps->shape);
+          x = round(x), y = round(y);
+          xscale = yscale = pi.size;
+          rot_degrees = pi.angle;
+          additive = false;
+        }
+
+        const Sprite& spr2d = sprites.get(sprite_id);
+        const int usi = spr2d.ModSubimage(subimg);
+        const TexRect& texRect = spr2d.GetTextureRect(usi);
+        const int texture = spr2d.GetTexture(usi);
+
+        particle_vertex v;
+        v.x = x + x_offset, v.y = y + y_offset;
+        v.xscale = xscale, v.yscale = yscale;
+        v.angle = rot_degrees;
+        v.color[0] = COL_GET_R(pi.color), v.color[1] = COL_GET_G(pi.color), v.color[2] = COL_GET_B(pi.color);
+        v.color[3] = std::min(std::max(pi.alpha, 0), 255);
+        v.left = -spr2d.xoffset, v.top = -spr2d.yoffset;
+        v.width = spr2d.width, v.height = spr2d.height;
+        v.tx = texRect.x, v.ty = texRect.y, v.tw = texRect.w, v.th = texRect.h;
+
+        if (batches.empty() || batches.back().texture != texture || batches.back().additive != additive) {
+          particle_batch batch = {vertices.size(), 0, texture, additive};
+          batches.push_back(batch);
+        }
+        batches.back().count++;
+        vertices.push_back(v);
+      }
+    }
+
+    void initialize_particle_bridge()
+    {
+      GLuint vertex_shader = load_and_compile_shader(vertex_source, GL_VERTEX_SHADER);
+      GLuint fragment_shader = load_and_compile_shader(fragment_source, GL_FRAGMENT_SHADER);
+      if (vertex_shader && fragment_shader) {
+        shader_program = glCreateProgram();
+        glAttachShader(shader_program, vertex_shader);
+        glAttachShader(shader_program, fragment_shader);
+        glLinkProgram(shader_program);
+        GLint linked;
+        glGetProgramiv(shader_program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+          DEBUG_MESSAGE("Particle shader program failed to link", MESSAGE_TYPE::M_ERROR);
+          glDeleteProgram(shader_program);
+          shader_program = 0;
+        }
+      }
+      // Flag the shaders for deletion; the program keeps them while it lives.
+      if (vertex_shader) glDeleteShader(vertex_shader);
+      if (fragment_shader) glDeleteShader(fragment_shader);
+      if (!shader_program) return;
+
+      matrix_uniform = glGetUniformLocation(shader_program, "u_Matrix");
+      alpha_test_uniform = glGetUniformLocation(shader_program, "u_AlphaTest");
+      glUseProgram(shader_program);
+      glUniform1i(glGetUniformLocation(shader_program, "u_Texture"), 0);
+      glUseProgram(shaderprograms[bound_shader].shaderprogram);
+
+      // The attributes live in their own vertex array, leaving the one the
+      // graphics system tracks untouched.
+      GLint engine_vao;
+      glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &engine_vao);
+      glGenVertexArrays(1, &vao);
+      glGenBuffers(1, &vbo);
+      glBindVertexArray(vao);
+      for (size_t i = 0; i < attribute_count; i++)
+      {
+        attribute_locations[i] = glGetAttribLocation(shader_program, attributes[i].name);
+        if (attribute_locations[i] < 0) continue;
+        glEnableVertexAttribArray(attribute_locations[i]);
+        glVertexAttribDivisor(attribute_locations[i], 1);
+      }
+      glBindVertexArray(engine_vao);
+    }
+
+    void draw_particles(particle_list& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
+      double a_x_offset, double a_y_offset)
+    {
+      if (!shader_program || pi_list.empty()) return;
+      wiggle = a_wiggle;
+      subimage_index = a_subimage_index;
+      x_offset = a_x_offset;
+      y_offset = a_y_offset;
+
+      // Draw the particle system either from oldest to youngest or reverse.
+      vertices.clear();
+      batches.clear();
+      const size_t count = pi_list.count();
+      for (size_t i = 0; i < count; i++)
+      {
+        add_particle(pi_list.get(oldtonew ? i : count - 1 - i));
+      }
+      if (vertices.empty()) return;
+
+      // Whatever was drawn before goes first.
+      enigma_user::draw_batch_flush(enigma_user::batch_flush_deferred);
+      int blend_src  = enigma::blendMode[0];
+      int blend_dest = enigma::blendMode[1];
+
+      GLint engine_vao;
+      glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &engine_vao);
+      glBindBuffer(GL_ARRAY_BUFFER, bound_vbo = vbo);
+      glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(particle_vertex), vertices.data(), GL_STREAM_DRAW);
+
+      bool bound = false;
+      for (const particle_batch& batch : batches)
+      {
+        // Texture and blending go through the graphics system's own state,
+        // which is flushed with its shader bound.
+        enigma_user::texture_set(batch.texture);
+        if (&batch == &batches[0] || batch.additive != (&batch)[-1].additive) {
+          enigma_user::draw_set_blend_mode(batch.additive ? enigma_user::bm_add : enigma_user::bm_normal);
+        }
+        if (draw_get_state_dirty()) {
+          if (bound) {
+            glBindVertexArray(engine_vao);
+            glUseProgram(shaderprograms[bound_shader].shaderprogram);
+            bound = false;
+          }
+          enigma_user::draw_state_flush();
+        }
+        if (!bound) {
+          glUseProgram(shader_program);
+          glBindVertexArray(vao);
+          const glm::mat4 matrix = projection*view*world;
+          glUniformMatrix4fv(matrix_uniform, 1, GL_FALSE, glm::value_ptr(matrix));
+          glUniform1f(alpha_test_uniform, alphaTest ? alphaTestRef/255.0f : -1.0f);
+          bound = true;
+        }
+
+        set_attributes(batch.first);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.count);
+        enigma::profiler_draw_call(4 * batch.count);
+      }
+      if (bound) {
+        glBindVertexArray(engine_vao);
+        glUseProgram(shaderprograms[bound_shader].shaderprogram);
+      }
+
+      if (enigma::blendMode[0] != blend_src || enigma::blendMode[1] != blend_dest){
+        enigma_user::draw_set_blend_mode_ext(blend_src, blend_dest);
+      }
+    }
+  }
+}
+
+#endif
@@ -134,7 +134,7 @@ namespace enigma {
         enigma_user::draw_sprite_ext(sprite_id, 0, x + x_offset, y + y_offset, xscale, yscale, rot_degrees, color, (double)alpha/255.0);
       }
     }
-    void draw_particles(std::vector<particle_instance>& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
+    void draw_particles(particle_list& pi_list, bool oldtonew, double a_wiggle, int a_subimage_index,
       double a_x_offset, double a_y_offset)
     {
         using namespace enigma::particle_bridge;
@@ -147,18 +147,11 @@ namespace enigma {
         int blend_src  = enigma::blendMode[0];
         int blend_dest = enigma::blendMode[1];
 
-        if (oldtonew) {
-          const std::vector<particle_instance>::iterator end = pi_list.end();
-          for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != end; it++)
-          {
-            draw_particle(&(*it));
-          }
-        } else {
-          const std::vector<particle_instance>::reverse_iterator rend = pi_list.rend();
-          for (std::vector<particle_instance>::reverse_iterator it = pi_list.rbegin(); it != rend; it++)
-          {
-            draw_particle(&(*it));
-          }
+        const size_t count = pi_list.count();
+        for (size_t i = 0; i < count; i++)
+        {
+          particle_instance pi = pi_list.get(oldtonew ? i : count - 1 - i);
+          draw_particle(&pi);
         }
 
         if (enigma::blendMode[0] != blend_src || enigma::blendMode[1] != blend_dest){
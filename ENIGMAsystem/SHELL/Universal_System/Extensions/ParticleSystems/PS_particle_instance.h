@@ -29,25 +29,132 @@
 #define ENIGMA_PS_PARTICLEINSTANCE
 
 #include "PS_particle_type.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
 
 namespace enigma
 {
+  // A single particle, as created and as read back from a particle_list.
   struct particle_instance
   {
     particle_type* pt;
 
     int sprite_subimageindex_initial;
-    double size;
-    double size_wiggle_offset; // [-1;1].
-    double angle;
-    double ang_wiggle_offset; // [-1;1].
+    float size;
+    float size_wiggle_offset; // [-1;1].
+    float angle;
+    float ang_wiggle_offset; // [-1;1].
     int color;
     int alpha;
     int life_current, life_start;
-    double x, y;
-    double speed, direction;
-    double speed_wiggle_offset; // [-1;1].
-    double dir_wiggle_offset; // [-1;1].
+    float x, y;
+    float speed, direction;
+    float speed_wiggle_offset; // [-1;1].
+    float dir_wiggle_offset; // [-1;1].
+  };
+
+  // The particles of a system, kept field by field so that each pass over
+  // them only streams through the fields it uses. Particles stay in the
+  // order they were created, oldest first.
+  struct particle_list
+  {
+    std::vector<particle_type*> pt;
+
+    std::vector<int> sprite_subimageindex_initial;
+    std::vector<float> size, size_wiggle_offset;
+    std::vector<float> angle, ang_wiggle_offset;
+    std::vector<int> color, alpha;
+    std::vector<int> life_current, life_start;
+    std::vector<float> x, y;
+    std::vector<float> speed, direction;
+    std::vector<float> speed_wiggle_offset, dir_wiggle_offset;
+
+    size_t count() const { return pt.size(); }
+    bool empty() const { return pt.empty(); }
+
+    particle_instance get(size_t i) const
+    {
+      particle_instance pi;
+      pi.pt = pt[i];
+      pi.sprite_subimageindex_initial = sprite_subimageindex_initial[i];
+      pi.size = size[i], pi.size_wiggle_offset = size_wiggle_offset[i];
+      pi.angle = angle[i], pi.ang_wiggle_offset = ang_wiggle_offset[i];
+      pi.color = color[i], pi.alpha = alpha[i];
+      pi.life_current = life_current[i], pi.life_start = life_start[i];
+      pi.x = x[i], pi.y = y[i];
+      pi.speed = speed[i], pi.direction = direction[i];
+      pi.speed_wiggle_offset = speed_wiggle_offset[i], pi.dir_wiggle_offset = dir_wiggle_offset[i];
+      return pi;
+    }
+    void push_back(const particle_instance& pi)
+    {
+      pt.push_back(pi.pt);
+      sprite_subimageindex_initial.push_back(pi.sprite_subimageindex_initial);
+      size.push_back(pi.size), size_wiggle_offset.push_back(pi.size_wiggle_offset);
+      angle.push_back(pi.angle), ang_wiggle_offset.push_back(pi.ang_wiggle_offset);
+      color.push_back(pi.color), alpha.push_back(pi.alpha);
+      life_current.push_back(pi.life_current), life_start.push_back(pi.life_start);
+      x.push_back(pi.x), y.push_back(pi.y);
+      speed.push_back(pi.speed), direction.push_back(pi.direction);
+      speed_wiggle_offset.push_back(pi.speed_wiggle_offset), dir_wiggle_offset.push_back(pi.dir_wiggle_offset);
+    }
+    // Copies particle `from` over particle `to`, for compacting the list in place.
+    void move(size_t from, size_t to)
+    {
+      pt[to] = pt[from];
+      sprite_subimageindex_initial[to] = sprite_subimageindex_initial[from];
+      size[to] = size[from], size_wiggle_offset[to] = size_wiggle_offset[from];
+      angle[to] = angle[from], ang_wiggle_offset[to] = ang_wiggle_offset[from];
+      color[to] = color[from], alpha[to] = alpha[from];
+      life_current[to] = life_current[from], life_start[to] = life_start[from];
+      x[to] = x[from], y[to] = y[from];
+      speed[to] = speed[from], direction[to] = direction[from];
+      speed_wiggle_offset[to] = speed_wiggle_offset[from], dir_wiggle_offset[to] = dir_wiggle_offset[from];
+    }
+    // Copies particles [from;from+n) down over [to;to+n), where to <= from.
+    void move(size_t from, size_t to, size_t n)
+    {
+      shift(pt, from, to, n);
+      shift(sprite_subimageindex_initial, from, to, n);
+      shift(size, from, to, n), shift(size_wiggle_offset, from, to, n);
+      shift(angle, from, to, n), shift(ang_wiggle_offset, from, to, n);
+      shift(color, from, to, n), shift(alpha, from, to, n);
+      shift(life_current, from, to, n), shift(life_start, from, to, n);
+      shift(x, from, to, n), shift(y, from, to, n);
+      shift(speed, from, to, n), shift(direction, from, to, n);
+      shift(speed_wiggle_offset, from, to, n), shift(dir_wiggle_offset, from, to, n);
+    }
+    void resize(size_t n)
+    {
+      pt.resize(n);
+      sprite_subimageindex_initial.resize(n);
+      size.resize(n), size_wiggle_offset.resize(n);
+      angle.resize(n), ang_wiggle_offset.resize(n);
+      color.resize(n), alpha.resize(n);
+      life_current.resize(n), life_start.resize(n);
+      x.resize(n), y.resize(n);
+      speed.resize(n), direction.resize(n);
+      speed_wiggle_offset.resize(n), dir_wiggle_offset.resize(n);
+    }
+    void clear() { resize(0); }
+    // Drops every particle whose life has run out, keeping the rest in order.
+    void remove_dead()
+    {
+      size_t live = 0;
+      for (size_t i = 0; i < count(); i++) {
+        if (life_current[i] <= 0) continue;
+        if (live != i) move(i, live);
+        live++;
+      }
+      resize(live);
+    }
+
+  private:
+    template<typename T> static void shift(std::vector<T>& v, size_t from, size_t to, size_t n)
+    {
+      std::copy(v.begin() + from, v.begin() + from + n, v.begin() + to);
+    }
   };
 }
 
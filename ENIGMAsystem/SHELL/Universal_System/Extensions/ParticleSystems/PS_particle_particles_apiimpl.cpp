@@ -30,6 +30,7 @@
 #include "PS_particle_type.h"
 #include "PS_particle_system_manager.h"
 #include <cstddef>
+#include <cstdint>
 
 using enigma::particle_system;
 using enigma::particle_type;
@@ -63,9 +64,9 @@ namespace enigma_user {
   {
     particle_system* p_s = enigma::get_particlesystem(id);
     if (p_s != NULL) {
-      for (std::vector<enigma::particle_instance>::iterator it = p_s->pi_list.begin(); it != p_s->pi_list.end(); it++)
+      for (size_t i = 0; i < p_s->pi_list.count(); i++)
       {
-        particle_type* pt = it->pt;
+        particle_type* pt = p_s->pi_list.pt[i];
 
         // Death handling.
         pt->particle_count--;
@@ -83,9 +84,33 @@ namespace enigma_user {
   {
     particle_system* p_s = enigma::get_particlesystem(id);
     if (p_s != NULL) {
-      return p_s->pi_list.size();
+      return p_s->pi_list.count();
     }
     return 0;
   }
+  int part_particles_checksum(int id)
+  {
+    particle_system* p_s = enigma::get_particlesystem(id);
+    if (p_s == NULL) {
+      return 0;
+    }
+    // FNV-1a over the state of each particle, in list order.
+    uint32_t hash = 2166136261u;
+    const auto mix = [&hash](const void* data, size_t size) {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+    };
+    const enigma::particle_list& p = p_s->pi_list;
+    for (size_t i = 0; i < p.count(); i++)
+    {
+      mix(&p.pt[i]->id, sizeof(int));
+      mix(&p.x[i], sizeof(float)), mix(&p.y[i], sizeof(float));
+      mix(&p.speed[i], sizeof(float)), mix(&p.direction[i], sizeof(float));
+      mix(&p.size[i], sizeof(float)), mix(&p.angle[i], sizeof(float));
+      mix(&p.color[i], sizeof(int)), mix(&p.alpha[i], sizeof(int));
+      mix(&p.life_current[i], sizeof(int));
+    }
+    return int(hash & 0x7FFFFFFF);
+  }
 }
 
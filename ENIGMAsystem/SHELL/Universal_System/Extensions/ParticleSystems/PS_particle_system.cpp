@@ -35,6 +35,7 @@
 #include "PS_particle_system.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "PS_particle_type.h"
+#include "PS_particle_workers.h"
 #include "Universal_System/Resources/sprites_internal.h"
 #include "Widget_Systems/widgets_mandatory.h" // show_error
 #include "Universal_System/math_consts.h"
@@ -79,7 +80,7 @@ namespace enigma
     oldtonew = true;
     auto_update = true, auto_draw = true;
     depth = 0.0;
-    pi_list = std::vector<particle_instance>();
+    pi_list = particle_list();
     id_to_emitter = std::map<int,particle_emitter*>();
     emitter_max_id = 0;
     id_to_attractor = std::map<int,particle_attractor*>();
@@ -93,204 +94,248 @@ namespace enigma
     hidden = false;
   }
 
-  static inline bool is_dead_from_old_age(particle_instance& pi) {
-    return pi.life_current <= 0;
+  // Death handling. Only the clean-up is made here; the particle itself is
+  // removed by whoever called this. Returns whether the particle type was
+  // deleted, as it is no longer used.
+  static bool release_particle(particle_type* pt)
+  {
+    pt->particle_count--;
+    if (pt->particle_count <= 0 && !pt->alive) {
+      int pid = pt->id;
+      delete pt;
+      enigma::pt_manager.id_to_particletype.erase(pid);
+      return true;
+    }
+    return false;
   }
 
-  void particle_system::update_particlesystem()
+  // Finds the types particles generate on step or death. Particles of a type
+  // tend to come in runs, so the last lookup is remembered.
+  struct generated_type_lookup
   {
-    // Increase wiggle.
-    wiggle += 1.0/wiggle_frequency;
-    if (wiggle > 1.0) {
-      wiggle -= 1.0;
+    bool valid = false;
+    int id;
+    particle_type* pt;
+    particle_type* find(int type_id)
+    {
+      if (!valid || id != type_id) {
+        std::map<int,particle_type*>::iterator it = pt_manager.id_to_particletype.find(type_id);
+        valid = true, id = type_id;
+        pt = it != pt_manager.id_to_particletype.end() ? it->second : NULL;
+      }
+      return pt;
     }
-    // Increase subimage_index.
-    subimage_index++;
+  };
 
-    std::vector<generation_info> particles_to_generate;
-    // Handle life and death.
+  static inline int interpolate_color(int color1, int color2, double part)
+  {
+    const int r1 = color_get_red(color1), g1 = color_get_green(color1), b1 = color_get_blue(color1);
+    const int r2 = color_get_red(color2), g2 = color_get_green(color2), b2 = color_get_blue(color2);
+    return make_color_rgb(int((1-part)*r1 + part*r2),int((1-part)*g1 + part*g2),int((1-part)*b1 + part*b2));
+  }
+
+  // A run of particles of one system, updated by one worker. Whatever needs
+  // the shared particle types changed is recorded here and done afterwards,
+  // in particle order, so the outcome doesn't depend on how the work is spread.
+  struct particle_chunk
+  {
+    particle_system* ps;
+    size_t begin, end;
+    size_t live; // Surviving particles, moved to the front of the chunk.
+    std::vector<particle_type*> released; // Types of the particles removed.
+    std::vector<generation_info> death_particles, step_particles;
+  };
+
+  // Particles per chunk. Chunks are cut by particle count alone, never by
+  // the number of threads.
+  static const size_t particles_per_chunk = 4096;
+
+  static void split_particles(particle_system* ps, std::vector<particle_chunk>& chunks)
+  {
+    const size_t count = ps->pi_list.count();
+    for (size_t begin = 0; begin < count; begin += particles_per_chunk)
     {
-      for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != pi_list.end(); it++)
-      {
-        // Decrease life.
-        it->life_current--;
-        if (it->life_current <= 0) { // Death.
-          particle_type* pt = it->pt;
-
-          // Generated upon end of life.
-          if (pt->alive && pt->death_on) {
-            std::map<int,particle_type*>::iterator death_pt_it = pt_manager.id_to_particletype.find(pt->death_particle_id);
-            if (death_pt_it != pt_manager.id_to_particletype.end()) {
-              generation_info gen_info;
-              gen_info.x = it->x;
-              gen_info.y = it->y;
-              gen_info.number = pt->death_number;
-              gen_info.pt = (*death_pt_it).second;
-              particles_to_generate.push_back(gen_info);
-            }
-          }
+      particle_chunk chunk;
+      chunk.ps = ps;
+      chunk.begin = begin;
+      chunk.end = std::min(begin + particles_per_chunk, count);
+      chunk.live = 0;
+      chunks.push_back(chunk);
+    }
+  }
 
-          // Death handling.
-          // Only the clean-up is made here.
-          pt->particle_count--;
-          if (pt->particle_count <= 0 && !pt->alive) {
-            // Particle type is no longer used, delete it.
-            int pid = pt->id;
-            delete pt;
-            enigma::pt_manager.id_to_particletype.erase(pid);
-          }
-        }
+  static void release_particles(const particle_chunk& chunk, std::vector<particle_type*>& deleted_types)
+  {
+    for (particle_type* pt : chunk.released)
+    {
+      if (release_particle(pt)) {
+        deleted_types.push_back(pt);
       }
-      pi_list.erase(std::remove_if(pi_list.begin(), pi_list.end(), is_dead_from_old_age), pi_list.end());
     }
-    // Shape.
+  }
+
+  void update_particlesystems(particle_system* const* systems, size_t count)
+  {
+    std::vector<particle_chunk> chunks;
+    std::vector<size_t> first_chunk(count + 1);
+    for (size_t s = 0; s < count; s++)
     {
-      std::vector<particle_instance>::iterator end = pi_list.end();
-      for (std::vector<particle_instance>::iterator it = pi_list.begin(); it !=end; it++)
-      {
-        particle_type* pt = it->pt;
-        if (pt->alive) {
-          it->size = std::max(it->size + pt->size_incr, 0.0);
-          it->angle = fmod(it->angle + pt->ang_incr, 360.0);
-        }
+      particle_system* ps = systems[s];
+      // Increase wiggle.
+      ps->wiggle += 1.0/ps->wiggle_frequency;
+      if (ps->wiggle > 1.0) {
+        ps->wiggle -= 1.0;
       }
+      // Increase subimage_index.
+      ps->subimage_index++;
+
+      first_chunk[s] = chunks.size();
+      split_particles(ps, chunks);
     }
-    // Color and blending.
+    first_chunk[count] = chunks.size();
+
+    // Chunks of every system are advanced together.
+    run_particle_jobs(chunks.size(), [&](size_t i) {
+      chunks[i].ps->advance_particles(chunks[i]);
+    });
+
+    // The rest draws random numbers or creates and destroys particle types,
+    // so systems are finished one after another. Types deleted by any of
+    // them may still be referenced by chunks advanced above.
+    std::vector<particle_type*> deleted_types;
+    for (size_t s = 0; s < count; s++)
     {
-      std::vector<particle_instance>::iterator end = pi_list.end();
-      for (std::vector<particle_instance>::iterator it = pi_list.begin(); it !=end; it++)
-      {
-        particle_type* pt = it->pt;
-        // Color.
-        switch(pt->c_mode) {
-        default:
-        case one_color : {break;}
-        case two_color : {
-          if (pt->alive) {
-            const int r1 = color_get_red(pt->color1),
-                g1 = color_get_green(pt->color1),
-                b1 = color_get_blue(pt->color1);
-            const int r2 = color_get_red(pt->color2),
-                g2 = color_get_green(pt->color2),
-                b2 = color_get_blue(pt->color2);
-            const double part = 1.0 - 1.0*it->life_current/it->life_start;
-            it->color = make_color_rgb(int((1-part)*r1 + part*r2),int((1-part)*g1 + part*g2),int((1-part)*b1 + part*b2));
+      systems[s]->finish_update(chunks.data() + first_chunk[s], chunks.data() + first_chunk[s + 1], deleted_types);
+    }
+  }
+
+  void particle_system::update_particlesystem()
+  {
+    particle_system* self = this;
+    update_particlesystems(&self, 1);
+  }
+
+  // Life, shape, color and blending, step and motion, in one pass which
+  // also compacts away the particles that die.
+  void particle_system::advance_particles(particle_chunk& chunk)
+  {
+    particle_list& p = pi_list;
+    generated_type_lookup death_types, step_types;
+    const particle_type* gravity_pt = NULL;
+    double grav_x = 0, grav_y = 0;
+    size_t live = chunk.begin;
+    for (size_t i = chunk.begin; i < chunk.end; i++)
+    {
+      particle_type* pt = p.pt[i];
+      // Decrease life.
+      if (--p.life_current[i] <= 0) { // Death.
+        // Generated upon end of life.
+        if (pt->alive && pt->death_on) {
+          if (particle_type* death_pt = death_types.find(pt->death_particle_id)) {
+            generation_info gen_info = {p.x[i], p.y[i], pt->death_number, death_pt};
+            chunk.death_particles.push_back(gen_info);
           }
-          break;
         }
+        chunk.released.push_back(pt);
+        continue;
+      }
+
+      if (pt->alive) {
+        // Shape.
+        p.size[i] = std::max(p.size[i] + pt->size_incr, 0.0);
+        p.angle[i] = fmod(p.angle[i] + pt->ang_incr, 360.0);
+
+        // Color and blending.
+        const double part = 1.0 - 1.0*p.life_current[i]/p.life_start[i];
+        switch (pt->c_mode) {
+        case two_color : p.color[i] = interpolate_color(pt->color1, pt->color2, part); break;
         case three_color : {
-          if (pt->alive) {
-            double part = 1.0 - 1.0*it->life_current/it->life_start;
-            int first_color, second_color;
-            if (part <= 0.5) {
-              part = 2.0*part;
-              first_color = pt->color1;
-              second_color = pt->color2;
-            }
-            else {
-              part = 2.0*(part - 0.5);
-              first_color = pt->color2;
-              second_color = pt->color3;
-            }
-            const int r1 = color_get_red(first_color),
-                g1 = color_get_green(first_color),
-                b1 = color_get_blue(first_color);
-            const int r2 = color_get_red(second_color),
-                g2 = color_get_green(second_color),
-                b2 = color_get_blue(second_color);
-            it->color = make_color_rgb(int((1-part)*r1 + part*r2),int((1-part)*g1 + part*g2),int((1-part)*b1 + part*b2));
-          }
+          p.color[i] = part <= 0.5 ? interpolate_color(pt->color1, pt->color2, 2.0*part)
+                                   : interpolate_color(pt->color2, pt->color3, 2.0*(part - 0.5));
           break;
         }
-        case mix_color : {break;}
-        case rgb_color : {break;}
-        case hsv_color : {break;}
-        }
-        // Alpha.
-        switch(pt->a_mode) {
-        default:
-        case one_alpha : {break;}
-        case two_alpha : {
-          if (pt->alive) {
-            const int alpha1 = pt->alpha1;
-            const int alpha2 = pt->alpha2;
-            const double part = 1.0 - 1.0*it->life_current/it->life_start;
-            it->alpha = bounds(int((1-part)*alpha1 + part*alpha2), 0, 255);
-          }
-          break;
+        default : break;
         }
+        const int alpha1 = pt->alpha1, alpha2 = pt->alpha2, alpha3 = pt->alpha3;
+        switch (pt->a_mode) {
+        case two_alpha : p.alpha[i] = bounds(int((1-part)*alpha1 + part*alpha2), 0, 255); break;
         case three_alpha : {
-          if (pt->alive) {
-            const int alpha1 = pt->alpha1;
-            const int alpha2 = pt->alpha2;
-            const int alpha3 = pt->alpha3;
-            double part = 1.0 - 1.0*it->life_current/it->life_start;
-            int first_alpha, second_alpha;
-            if (part <= 0.5) {
-              part = 2.0*part;
-              first_alpha = alpha1;
-              second_alpha = alpha2;
-            }
-            else {
-              part = 2.0*(part - 0.5);
-              first_alpha = alpha2;
-              second_alpha = alpha3;
-            }
-            it->alpha = bounds(int((1-part)*first_alpha + part*second_alpha), 0, 255);
-          }
+          p.alpha[i] = part <= 0.5 ? bounds(int((1-2.0*part)*alpha1 + 2.0*part*alpha2), 0, 255)
+                                   : bounds(int((1-2.0*(part - 0.5))*alpha2 + 2.0*(part - 0.5)*alpha3), 0, 255);
           break;
         }
+        default : break;
         }
-      }
-    }
-    // Step.
-    {
-      for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != pi_list.end(); it++)
-      {
-        particle_type* pt = it->pt;
 
         // Generated each step.
-        if (pt->alive && pt->step_on) {
-          std::map<int,particle_type*>::iterator step_pt_it = pt_manager.id_to_particletype.find(pt->step_particle_id);
-          if (step_pt_it != pt_manager.id_to_particletype.end()) {
-            generation_info gen_info;
-            gen_info.x = it->x;
-            gen_info.y = it->y;
-            gen_info.number = pt->step_number;
-            gen_info.pt = (*step_pt_it).second;
-            particles_to_generate.push_back(gen_info);
+        if (pt->step_on) {
+          if (particle_type* step_pt = step_types.find(pt->step_particle_id)) {
+            generation_info gen_info = {p.x[i], p.y[i], pt->step_number, step_pt};
+            chunk.step_particles.push_back(gen_info);
           }
         }
+
+        // Speed, direction and gravity.
+        if (pt != gravity_pt) {
+          gravity_pt = pt;
+          grav_x = pt->grav_amount*cos(pt->grav_dir*M_PI/180.0);
+          grav_y = pt->grav_amount*sin(pt->grav_dir*M_PI/180.0);
+        }
+        double speed = p.speed[i] + pt->speed_incr, direction = p.direction[i] + pt->dir_incr;
+        if (speed < 0) {
+          speed = -speed;
+          direction += 180.0;
+        }
+        direction = fmod(direction, 360.0);
+        const double vx = speed*cos(direction*M_PI/180.0) + grav_x;
+        const double vy = -(speed*sin(direction*M_PI/180.0) + grav_y);
+        p.speed[i] = sqrt(vx*vx + vy*vy);
+        p.direction[i] = fzero(vx) && fzero(vy) ? direction : -atan2(vy,vx)*180.0/M_PI;
+
+        // Move particles. Without wiggle, that's just the velocity found above.
+        if (pt->speed_wiggle == 0 && pt->dir_wiggle == 0) {
+          p.x[i] += vx;
+          p.y[i] += vy;
+        }
+        else {
+          const double speed = p.speed[i] + pt->speed_wiggle*get_wiggle_result(p.speed_wiggle_offset[i]);
+          const double direction = p.direction[i] + pt->dir_wiggle*get_wiggle_result(p.dir_wiggle_offset[i]);
+          p.x[i] += speed*cos(direction*M_PI/180.0);
+          p.y[i] += -speed*sin(direction*M_PI/180.0);
+        }
+      }
+      else {
+        // Move particles.
+        p.x[i] += p.speed[i]*cos(p.direction[i]*M_PI/180.0);
+        p.y[i] += -p.speed[i]*sin(p.direction[i]*M_PI/180.0);
       }
+
+      if (live != i) p.move(i, live);
+      live++;
     }
-    // Move particles.
+    chunk.live = live - chunk.begin;
+  }
+
+  void particle_system::finish_update(particle_chunk* first, particle_chunk* last, std::vector<particle_type*>& deleted_types)
+  {
+    std::vector<generation_info> particles_to_generate;
+    // Deaths, and closing the gaps between the chunks.
     {
-      std::vector<particle_instance>::iterator end = pi_list.end();
-      for (std::vector<particle_instance>::iterator it = pi_list.begin(); it !=end; it++)
+      particle_list& p = pi_list;
+      size_t live = 0;
+      for (particle_chunk* chunk = first; chunk != last; chunk++)
       {
-        particle_type* pt = it->pt;
-        if (pt->alive) {
-          it->speed += pt->speed_incr;
-          it->direction += pt->dir_incr;
-          if (it->speed < 0) {
-            it->speed = -it->speed;
-            it->direction += 180.0;
-          }
-          it->direction = fmod(it->direction, 360.0);
-          const double speed = it->speed, direction = it->direction;
-          const double grav_amount = pt->grav_amount, grav_dir = pt->grav_dir;
-          const double vx = speed*cos(direction*M_PI/180.0) + grav_amount*cos(grav_dir*M_PI/180.0);
-          const double vy = -(speed*sin(direction*M_PI/180.0) + grav_amount*sin(grav_dir*M_PI/180.0));
-          it->speed = sqrt(vx*vx + vy*vy);
-          it->direction = fzero(vx) && fzero(vy) ? direction : -atan2(vy,vx)*180.0/M_PI;
-        }
-        double speed = it->speed, direction = it->direction;
-        if (pt->alive) {
-          speed += pt->speed_wiggle*get_wiggle_result(it->speed_wiggle_offset);
-          direction += pt->dir_wiggle*get_wiggle_result(it->dir_wiggle_offset);
-        }
-        it->x += speed*cos(direction*M_PI/180.0);
-        it->y += -speed*sin(direction*M_PI/180.0);
+        release_particles(*chunk, deleted_types);
+        if (live != chunk->begin) p.move(chunk->begin, live, chunk->live);
+        live += chunk->live;
+        particles_to_generate.insert(particles_to_generate.end(),
+            chunk->death_particles.begin(), chunk->death_particles.end());
+      }
+      p.resize(live);
+      for (particle_chunk* chunk = first; chunk != last; chunk++)
+      {
+        particles_to_generate.insert(particles_to_generate.end(),
+            chunk->step_particles.begin(), chunk->step_particles.end());
       }
     }
     // Changers.
@@ -312,35 +357,25 @@ namespace enigma
         pt1 = (*pt_it1).second;
         pt2 = (*pt_it2).second;
 
-        std::vector<particle_instance>::iterator end2 = pi_list.end();
-        for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != end2; it++)
+        particle_list& p = pi_list;
+        for (size_t i = 0; i < p.count(); i++)
         {
-          if (p_ch->is_inside(it->x, it->y) && it->pt->id == pt1->id && it->life_current > 0) { // Skip particles with life_current <= 0.
-            // Store position of old particle.
-            const double x = it->x, y = it->y;
-            // Destroy the old particle.
-            // Only the clean-up is made here. The actual removal is handle after the loops by remove_if and erase.
-            pt1->particle_count--;
-            if (pt1->particle_count <= 0 && !pt1->alive) {
-              // Particle type is no longer used, delete it.
-              int pid = pt1->id;
-              delete pt1;
-              enigma::pt_manager.id_to_particletype.erase(pid);
-            }
-            // Internally when handling changers, setting life_current to 0 indicates that the particle has been removed.
-            it->life_current = 0;
+          if (p.pt[i] == pt1 && p.life_current[i] > 0 && p_ch->is_inside(p.x[i], p.y[i])) { // Skip particles with life_current <= 0.
             // Create a new particle at its position.
-            generation_info gen_info;
-            gen_info.x = x;
-            gen_info.y = y;
-            gen_info.number = 1;
-            gen_info.pt = pt2;
+            generation_info gen_info = {p.x[i], p.y[i], 1, pt2};
             particles_to_generate.push_back(gen_info);
+            // Internally when handling changers, setting life_current to 0 indicates that the particle has been removed.
+            p.life_current[i] = 0;
+            // Destroy the old particle.
+            if (release_particle(pt1)) {
+              deleted_types.push_back(pt1);
+              break; // It was the last of its type.
+            }
           }
         }
       }
       // Erase all particles with life_current <= 0.
-      pi_list.erase(std::remove_if(pi_list.begin(), pi_list.end(), is_dead_from_old_age), pi_list.end());
+      pi_list.remove_dead();
     }
     // Generate particles.
     for (std::vector<generation_info>::iterator it = particles_to_generate.begin(); it != particles_to_generate.end(); it++)
@@ -348,6 +383,8 @@ namespace enigma
       double x = (*it).x, y = (*it).y;
       int number = (*it).number;
       particle_type* pt = (*it).pt;
+      // Types deleted since this was queued are no longer found.
+      if (std::find(deleted_types.begin(), deleted_types.end(), pt) != deleted_types.end()) continue;
       number = number >= 0 ? number : (rand() % (-number) < 1 ? 1 : 0); // Create particle with probability -1/number.
       create_particles(x, y, pt, number);
     }
@@ -371,110 +408,119 @@ namespace enigma
         }
       }
     }
-    // Attractors.
+    // Attractors, destroyers and deflectors.
     {
-      std::map<int,particle_attractor*>::iterator end = id_to_attractor.end();
-      for (std::map<int,particle_attractor*>::iterator at_it = id_to_attractor.begin(); at_it != end; at_it++)
-      {
-        particle_attractor* p_a = (*at_it).second;
-        std::vector<particle_instance>::iterator end1 = pi_list.end();
-        for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != end1; it++)
-        {
-          // If the particle is not inside the attractor range of influence,
-          // or is at the attractor's exact position,
-          // skip to next attractor.
-          const double dx = it->x - p_a->x;
-          const double dy = it->y - p_a->y;
-          const double relative_distance = sqrt(dx*dx + dy*dy)/std::max(1.0, p_a->dist_effect);
-          if (relative_distance > 1.0 || (fzero(dx) && fzero(dy))) {
-            continue;
-          }
-          const double direction_radians = atan2(-(p_a->y - it->y), p_a->x - it->x);
-          // Determine force.
-          double force_effective_strength;
-          switch (p_a->force_kind)  {
-          case ps_fo_constant : force_effective_strength = p_a->force_strength; break;
-          case ps_fo_linear : force_effective_strength = (1.0 - relative_distance)*p_a->force_strength; break;
-          case ps_fo_quadratic : force_effective_strength = (1.0 - relative_distance)*(1.0 - relative_distance)*p_a->force_strength; break;
-          default : force_effective_strength = p_a->force_strength; break;
-          }
-          // Apply force.
-          if (p_a->additive) {
-            const double vx = it->speed*cos(it->direction*M_PI/180.0) + force_effective_strength*cos(direction_radians);
-            const double vy = -it->speed*sin(it->direction*M_PI/180.0) - force_effective_strength*sin(direction_radians);
-            it->speed = sqrt(vx*vx + vy*vy);
-            const double direction = it->direction;
-            it->direction = fzero(vx) && fzero(vy) ? direction : -atan2(vy,vx)*180.0/M_PI;
-          }
-          else {
-            it->x += force_effective_strength*cos(direction_radians);
-            it->y += -force_effective_strength*sin(direction_radians);
-          }
-        }
+      std::vector<particle_chunk> chunks;
+      if (!id_to_attractor.empty() || !id_to_destroyer.empty() || !id_to_deflector.empty()) {
+        split_particles(this, chunks);
+        run_particle_jobs(chunks.size(), [&](size_t i) {
+          interact_particles(chunks[i]);
+        });
       }
+      for (const particle_chunk& chunk : chunks) {
+        release_particles(chunk, deleted_types);
+      }
+      // Erase all particles with life_current <= 0.
+      pi_list.remove_dead();
     }
-    // Destroyers.
+  }
+
+  // Each particle meets every attractor, then every destroyer, then every
+  // deflector, which is the same as taking the effects one at a time.
+  void particle_system::interact_particles(particle_chunk& chunk)
+  {
+    particle_list& p = pi_list;
+    std::vector<particle_attractor*> attractors;
+    std::vector<particle_destroyer*> destroyers;
+    std::vector<particle_deflector*> deflectors;
+    for (const std::pair<const int,particle_attractor*>& at : id_to_attractor) attractors.push_back(at.second);
+    for (const std::pair<const int,particle_destroyer*>& ds : id_to_destroyer) destroyers.push_back(ds.second);
+    for (const std::pair<const int,particle_deflector*>& df : id_to_deflector) deflectors.push_back(df.second);
+    for (size_t i = chunk.begin; i < chunk.end; i++)
     {
-      std::map<int,particle_destroyer*>::iterator end1 = id_to_destroyer.end();
-      for (std::map<int,particle_destroyer*>::iterator ds_it = id_to_destroyer.begin(); ds_it != end1; ds_it++)
+      // Skip particles with life_current <= 0; they are erased anyway.
+      if (p.life_current[i] <= 0) {
+        continue;
+      }
+      // Attractors.
+      for (particle_attractor* p_a : attractors)
       {
-        particle_destroyer* p_ds = (*ds_it).second;
-        std::vector<particle_instance>::iterator end2 = pi_list.end();
-        for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != end2; it++)
-        {
-          if (p_ds->is_inside(it->x, it->y) && it->life_current > 0) { // Skip particles with life_current <= 0.
-            particle_type* pt = it->pt;
-
-            // Death handling.
-            // Only the clean-up is made here. The actual removal is handle after the loops by remove_if and erase.
-            pt->particle_count--;
-            if (pt->particle_count <= 0 && !pt->alive) {
-              // Particle type is no longer used, delete it.
-              int pid = pt->id;
-              delete pt;
-              enigma::pt_manager.id_to_particletype.erase(pid);
-            }
-            // Internally when handling destroyers, setting life_current to 0 indicates that the particle has been removed.
-            it->life_current = 0;
-          }
+        // If the particle is not inside the attractor range of influence,
+        // or is at the attractor's exact position,
+        // skip to next attractor.
+        const double dx = p.x[i] - p_a->x;
+        const double dy = p.y[i] - p_a->y;
+        const double distance = sqrt(dx*dx + dy*dy);
+        const double relative_distance = distance/std::max(1.0, p_a->dist_effect);
+        if (relative_distance > 1.0 || (fzero(dx) && fzero(dy))) {
+          continue;
+        }
+        // Cosine and sine of the direction towards the attractor.
+        const double dir_cos = -dx/distance, dir_sin = dy/distance;
+        // Determine force.
+        double force_effective_strength;
+        switch (p_a->force_kind)  {
+        case ps_fo_constant : force_effective_strength = p_a->force_strength; break;
+        case ps_fo_linear : force_effective_strength = (1.0 - relative_distance)*p_a->force_strength; break;
+        case ps_fo_quadratic : force_effective_strength = (1.0 - relative_distance)*(1.0 - relative_distance)*p_a->force_strength; break;
+        default : force_effective_strength = p_a->force_strength; break;
+        }
+        // Apply force.
+        if (p_a->additive) {
+          const double vx = p.speed[i]*cos(p.direction[i]*M_PI/180.0) + force_effective_strength*dir_cos;
+          const double vy = -p.speed[i]*sin(p.direction[i]*M_PI/180.0) - force_effective_strength*dir_sin;
+          p.speed[i] = sqrt(vx*vx + vy*vy);
+          const double direction = p.direction[i];
+          p.direction[i] = fzero(vx) && fzero(vy) ? direction : -atan2(vy,vx)*180.0/M_PI;
+        }
+        else {
+          p.x[i] += force_effective_strength*dir_cos;
+          p.y[i] += -force_effective_strength*dir_sin;
         }
       }
-      // Erase all particles with life_current <= 0.
-      pi_list.erase(std::remove_if(pi_list.begin(), pi_list.end(), is_dead_from_old_age), pi_list.end());
-    }
-    // Deflectors.
-    {
-      std::map<int,particle_deflector*>::iterator end = id_to_deflector.end();
-      for (std::map<int,particle_deflector*>::iterator df_it = id_to_deflector.begin(); df_it != end; df_it++)
+      // Destroyers.
+      bool destroyed = false;
+      for (particle_destroyer* p_ds : destroyers)
       {
-        particle_deflector* p_df = (*df_it).second;
-        std::vector<particle_instance>::iterator end2 = pi_list.end();
-        for (std::vector<particle_instance>::iterator it = pi_list.begin(); it != end2; it++)
-        {
-          if (p_df->is_inside(it->x, it->y)) {
-            // Direction changing.
-            it->direction = fmod(it->direction + 360.0, 360.0);
-            switch (p_df->deflection_kind) {
-            case ps_de_horizontal : {
-              it->direction = it->direction <= 180.0 ? 180.0 - it->direction : 540.0 - it->direction;
-              break;
-            }
-            case ps_de_vertical : {
-              it->direction = 360.0 - it->direction;
-              break;
-            }
-            default : {
-              break;
-            }
-            }
-            // Friction handling.
-            const double new_speed = std::max(0.0, it->speed - p_df->friction);
-            const double friction_effect = it->speed - new_speed;
-            it->speed = new_speed;
-            // Move one step.
-            it->x += friction_effect*cos(it->direction*M_PI/180.0);
-            it->y += -friction_effect*sin(it->direction*M_PI/180.0);
+        if (p_ds->is_inside(p.x[i], p.y[i])) {
+          // The actual removal is handled after the loops by remove_dead.
+          chunk.released.push_back(p.pt[i]);
+          // Internally when handling destroyers, setting life_current to 0 indicates that the particle has been removed.
+          p.life_current[i] = 0;
+          destroyed = true;
+          break;
+        }
+      }
+      if (destroyed) {
+        continue;
+      }
+      // Deflectors.
+      for (particle_deflector* p_df : deflectors)
+      {
+        if (p_df->is_inside(p.x[i], p.y[i])) {
+          // Direction changing.
+          double direction = fmod(p.direction[i] + 360.0, 360.0);
+          switch (p_df->deflection_kind) {
+          case ps_de_horizontal : {
+            direction = direction <= 180.0 ? 180.0 - direction : 540.0 - direction;
+            break;
+          }
+          case ps_de_vertical : {
+            direction = 360.0 - direction;
+            break;
+          }
+          default : {
+            break;
+          }
           }
+          p.direction[i] = direction;
+          // Friction handling.
+          const double new_speed = std::max(0.0, p.speed[i] - p_df->friction);
+          const double friction_effect = p.speed[i] - new_speed;
+          p.speed[i] = new_speed;
+          // Move one step.
+          p.x[i] += friction_effect*cos(direction*M_PI/180.0);
+          p.y[i] += -friction_effect*sin(direction*M_PI/180.0);
         }
       }
     }
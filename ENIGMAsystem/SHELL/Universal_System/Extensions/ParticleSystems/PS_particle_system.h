@@ -48,10 +48,12 @@ namespace enigma
     // Initialization
     void initialize_particle_bridge();
     // Drawing
-    void draw_particles(std::vector<particle_instance>& pi_list, bool oldtonew, double wiggle, int subimage_index,
+    void draw_particles(particle_list& pi_list, bool oldtonew, double wiggle, int subimage_index,
         double x_offset, double y_offset);
   }
   
+  struct particle_chunk;
+
   struct particle_system
   {
     // Wiggling.
@@ -66,10 +68,13 @@ namespace enigma
     bool oldtonew;
     double x_offset, y_offset;
     double depth; // Integer stored as double.
-    std::vector<particle_instance> pi_list;
+    particle_list pi_list;
     bool auto_update, auto_draw;
     void initialize();
     void update_particlesystem();
+    void advance_particles(particle_chunk& chunk);
+    void finish_update(particle_chunk* first, particle_chunk* last, std::vector<particle_type*>& deleted_types);
+    void interact_particles(particle_chunk& chunk);
     void draw_particlesystem();
     void create_particles(double x, double y, particle_type* pt, int number, bool use_color=false, int given_color=c_white);
     // Emitters.
@@ -97,6 +102,10 @@ namespace enigma
     // Protection.
     bool hidden;
   };
+
+  // Updates the given systems one step, as if each were updated in turn.
+  // Large systems are split into chunks which are updated in parallel.
+  void update_particlesystems(particle_system* const* systems, size_t count);
 }
 
 #endif // ENIGMA_PS_PARTICLESYSTEM
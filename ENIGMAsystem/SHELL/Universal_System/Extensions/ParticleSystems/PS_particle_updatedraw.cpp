@@ -33,17 +33,22 @@
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Universal_System/Instances/callbacks_events.h"
 
+#include <vector>
+
 namespace enigma
 {
   static void internal_update_particlesystems()
   {
+    // Updated all at once, so that the chunks of small systems share the workers.
+    std::vector<particle_system*> systems;
     std::map<int,particle_system*>::iterator end = ps_manager.id_to_particlesystem.end();
     for (std::map<int,particle_system*>::iterator it = ps_manager.id_to_particlesystem.begin(); it != end; it++)
     {
       if ((*it).second->auto_update) {
-        (*it).second->update_particlesystem();
+        systems.push_back((*it).second);
       }
     }
+    update_particlesystems(systems.data(), systems.size());
   }
 
   static void internal_draw_particlesystems(double high, double low)
@@ -0,0 +1,41 @@
+/********************************************************************************\
+**                                                                              **
+**  This file is a part of the ENIGMA Development Environment.                  **
+**                                                                              **
+**                                                                              **
+**  ENIGMA is free software: you can redistribute it and/or modify it under the **
+**  terms of the GNU General Public License as published by the Free Software   **
+**  Foundation, version 3 of the license or any later version.                  **
+**                                                                              **
+**  This application and its source code is distributed AS-IS, WITHOUT ANY      **
+**  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS   **
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more       **
+**  details.                                                                    **
+**                                                                              **
+**  You should have recieved a copy of the GNU General Public License along     **
+**  with this code. If not, see <http://www.gnu.org/licenses/>                  **
+**                                                                              **
+**  ENIGMA is an environment designed to create games and other programs with a **
+**  high-level, fully compilable language. Developers of ENIGMA or anything     **
+**  associated with ENIGMA are in no way responsible for its users or           **
+**  applications created by its users, or damages caused by the environment     **
+**  or programs made in the environment.                                        **
+**                                                                              **
+\********************************************************************************/
+
+
+#ifndef ENIGMA_PS_PARTICLEWORKERS
+#define ENIGMA_PS_PARTICLEWORKERS
+
+#include <cstddef>
+#include <functional>
+
+namespace enigma
+{
+  // Calls job(i) for every i in [0;count), spread over the particle worker
+  // threads and the calling thread, and returns once every call is done.
+  // Jobs may run in any order and must not depend on each other.
+  void run_particle_jobs(size_t count, const std::function<void(size_t)>& job);
+}
+
+#endif // ENIGMA_PS_PARTICLEWORKERS
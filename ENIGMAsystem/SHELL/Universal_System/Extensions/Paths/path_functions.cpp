@@ -233,6 +233,7 @@ void path_shift(unsigned pathid, cs_scalar xshift, cs_scalar yshift)
     enigma::path *pa = enigma::pathstructarray[pathid];
     for (vector<enigma::path_point>::iterator it = pa->pointarray.begin(); it!=pa->pointarray.end(); ++it)
         (*it).x = (*it).x + xshift, (*it).y = (*it).y + yshift;
+    enigma::path_recalculate(pathid);
 }
 
 void path_flip(unsigned pathid)
@@ -241,6 +242,7 @@ void path_flip(unsigned pathid)
     for (size_t i=0; i<pa->pointarray.size(); i++){
         pa->pointarray[i].y = pa->centery*2-pa->pointarray[i].y;
     }
+    enigma::path_recalculate(pathid);
 }
 
 void path_mirror(unsigned pathid)
@@ -249,6 +251,7 @@ void path_mirror(unsigned pathid)
     for (size_t i=0; i<pa->pointarray.size(); i++){
         pa->pointarray[i].x = pa->centerx*2-pa->pointarray[i].x;
     }
+    enigma::path_recalculate(pathid);
 }
 
 void path_scale(unsigned pathid, cs_scalar xscale, cs_scalar yscale)
@@ -271,6 +274,7 @@ void path_rotate(unsigned pathid, double angle)
         pa->pointarray[i].x = tmpx*cos(a) - tmpy*sin(a) + pa->centerx;
         pa->pointarray[i].y = tmpx*sin(a) + tmpy*cos(a) + pa->centery;
     }
+    enigma::path_recalculate(pathid);
 }
 
 cs_scalar path_get_x(unsigned pathid, double t)
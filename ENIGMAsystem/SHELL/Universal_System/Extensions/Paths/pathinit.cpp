@@ -27,49 +27,36 @@
 
 #include "pathstruct.h"
 #include "Universal_System/Resources/resinit.h"
-#include "Platforms/General/fileio.h"
+#include "Universal_System/Resources/resmodule.h"
 
 #include <cstring>
 
+using namespace enigma::resource_module;
+
 namespace enigma
 {
-  void exe_loadpaths(FILE_t *exe)
+  void exe_loadpaths(const ResourceModule &module)
   {
-    unsigned pathid, pointcount;
-    bool smooth, closed;
-    int x, y, speed, nullhere, precision;
-
-    if (!fread_wrapper(&nullhere,4,1,exe)) return;
-    if (memcmp(&nullhere, "PTH ", sizeof(int)) != 0)
-      return;
-
-    // Determine how many paths we have
-    int pathcount;
-    if (!fread_wrapper(&pathcount,4,1,exe)) return;
-
-    // Fetch the highest ID we will be using
-    int path_highid, buf;
-    if (!fread_wrapper(&path_highid,4,1,exe)) return;
+    auto range = module.entries(RES_PATH);
     paths_init();
 
-    for (int i = 0; i < pathcount; i++)
+    std::vector<unsigned char> storage;
+    for (const TocEntry *entry = range.first; entry != range.second; ++entry)
     {
-      if (!fread_wrapper(&pathid, 4,1,exe)) return;
-      if (!fread_wrapper(&buf, 4,1,exe)) return;
-      smooth = buf; //to fix int to bool issues
-      if (!fread_wrapper(&buf, 4,1,exe)) return;
-      closed = buf;
-      if (!fread_wrapper(&precision, 4,1,exe)) return;
-
-      if (!fread_wrapper(&pointcount,4,1,exe)) return;
+      PathInfo info;
+      const unsigned char *data = module.payload(*entry, storage);
+      if (!data or entry->size < sizeof(info)) continue;
+      memcpy(&info, data, sizeof(info));
+      if (info.point_count < 0 or entry->size < sizeof(info) + info.point_count * sizeof(PathPointInfo)) continue;
+      data += sizeof(info);
 
-      new path(pathid, smooth, closed, precision, pointcount);
-      for (unsigned ii=0;ii<pointcount;ii++)
+      const unsigned pathid = entry->id;
+      new path(pathid, info.smooth, info.closed, info.precision, info.point_count);
+      for (int ii = 0; ii < info.point_count; ii++)
       {
-        if (!fread_wrapper(&x, 4,1,exe)) return;
-        if (!fread_wrapper(&y, 4,1,exe)) return;
-        if (!fread_wrapper(&speed, 4,1,exe)) return;
-        path_add_point(pathid, x, y, speed/100);
+        PathPointInfo pt;
+        memcpy(&pt, data + ii * sizeof(pt), sizeof(pt));
+        path_add_point(pathid, pt.x, pt.y, pt.speed/100);
       }
       path_recalculate(pathid);
     }
@@ -30,6 +30,7 @@
 #include <math.h>
 #include <float.h> //maxiumum values for certain datatypes. Useful for minx = DBL_MAX
 #include <cstdlib> //size_t
+#include <algorithm>
 
 #include "pathstruct.h"
 #include <floatcomp.h>
@@ -43,47 +44,16 @@ namespace enigma {
 
 namespace enigma
 {
-    static inline double llen(const path_point* p0, const path_point* p1)
-    {
-        double x0 = (p1->x-p0->x), y0 = (p1->y-p0->y);
-        return sqrt(x0*x0+y0*y0);
-    }
+    //Lines each curved segment of a smooth path is traced with
+    static const int smooth_steps = 20;
 
-    static inline double blen(const path_point* p0, const path_point* p1, const path_point* p2)
+    //The point t of the way along the quadratic B-spline from the midpoint of p0
+    //and p1 to the midpoint of p1 and p2, which smooth paths are made of
+    static inline path_point spline_point(const path_point& p0, const path_point& p1, const path_point& p2, double t)
     {
-      /*if (p0 == p1) return llen(p0,p1); else if (p1 == p2) return llen(p1,p2);
-      double ax,bx,ay,by;
-      ax = p0->x - 2*p1->x + p2->x;
-      ay = p0->y - 2*p1->y + p2->y;
-      bx = 2*p1->x - 2*p0->x;
-      by = 2*p1->y - 2*p0->y;
-      float A = 4*(ax*ax + ay*ay);
-      float B = 4*(ax*bx + ay*by);
-      float C = bx*bx + by*by;
-
-      float Sabc = 2*sqrt(A+B+C);
-      float A_2 = sqrt(A);
-      float A_32 = 2*A*A_2;
-      float C_2 = 2*sqrt(C);
-      float BA = B/A_2;
-      float BAC2 = BA+C_2;
-      BAC2 = BAC2==0?1:BAC2;
-
-      return ( A_32*Sabc + A_2*B*(Sabc-C_2) + (4*C*A-B*B)*log( (2*A_2+BA+Sabc)/(BAC2)))/(4*A_32);*/
-      double x1=p0->x, y1=p0->y,
-            x2=p1->x, y2=p1->y,
-            x3=p2->x, y3=p2->y,
-            length=0,lx=0.5*(x1+x2), ly=0.5*(y1+y2),x,y;
-
-      double t=0;
-      for (int i=0; i<=20; i++){
-        x = 0.5 * (((x1 - 2 * x2 + x3) * t + 2 * x2 - 2 * x1) * t + x1 + x2);
-        y = 0.5 * (((y1 - 2 * y2 + y3) * t + 2 * y2 - 2 * y1) * t + y1 + y2);
-        length += hypot(x-lx,y-ly);
-        lx = x, ly = y;
-        t += 0.05;
-      }
-      return length;
+      return path_point(0.5 * (((p0.x - 2 * p1.x + p2.x) * t + 2 * p1.x - 2 * p0.x) * t + p0.x + p1.x),
+                        0.5 * (((p0.y - 2 * p1.y + p2.y) * t + 2 * p1.y - 2 * p0.y) * t + p0.y + p1.y),
+                        0.5 * (((p0.speed - 2 * p1.speed + p2.speed) * t + 2 * p1.speed - 2 * p0.speed) * t + p0.speed + p1.speed));
     }
 
     path::path(unsigned pathid, bool smth, bool close, int prec, unsigned pointcount):
@@ -106,25 +76,29 @@ namespace enigma
     {
         path* const pth = pathstructarray[pathid];
         if (!pth) return;
-        pth->total_length = 0; pth->pointoffset.clear();
+        pth->total_length = 0; pth->samples.clear(); pth->sample_index.clear();
         if (!pth->pointarray.size()) return;
 
         const size_t pc = pth->pointarray.size();
         const path_point& start = pth->closed ? pth->pointarray[pc-1] : pth->pointarray[0];
         const path_point& end  =  pth->closed ? pth->pointarray[0] : pth->pointarray[pc-1];
-        //const path_point& beforestart  =  pth->closed ? pth->pointarray[pc-2] : pth->pointarray[0];
-        //const path_point& afterend  =  pth->closed ? pth->pointarray[1] : pth->pointarray[pc-1];
         double minx=DBL_MAX,miny=DBL_MAX,maxx=-DBL_MAX,maxy=-DBL_MAX;
         for (size_t i = 0; i < pc; i++)
         {
-          const double len =
-          (pth->smooth) ?
-            //blen(i==0 ? &beforestart : (i==1 ? &start : &pth->pointarray[i-2]), i==0 ? &start : &pth->pointarray[i-1], &pth->pointarray[i])
-            //blen(&pth->pointarray[i], i==pc-1 ? &end : &pth->pointarray[i+1], i==pc-2 ? &afterend : (i==pc-1 ? &end : &pth->pointarray[i+2]))
-            blen(i==0 ? &start : &pth->pointarray[i-1], &pth->pointarray[i], i+1==pc ? &end : &pth->pointarray[i+1])
-            //blen((i==0 || i==1) ? &start : &pth->pointarray[i-2], (i==0) ? &start : &pth->pointarray[i-1], i+1==pc ? &end : &pth->pointarray[i])
-          :
-            llen(i==0 ? &start : &pth->pointarray[i-1], &pth->pointarray[i]);
+          //Segment i leads up to point i: a curve around it if smooth, else a line from the point before
+          const path_point& p0 = i==0 ? start : pth->pointarray[i-1];
+          const path_point& p1 = pth->pointarray[i];
+          const path_point& p2 = i+1==pc ? end : pth->pointarray[i+1];
+          const int steps = pth->smooth ? smooth_steps : 1;
+          double len = 0;
+          for (int k = 0; k <= steps; k++)
+          {
+            if (k == 0 && !pth->samples.empty()) continue; //where the last segment ended
+            path_point sample = pth->smooth ? spline_point(p0, p1, p2, double(k)/steps) : (k ? p1 : p0);
+            if (k) len += hypot(sample.x - pth->samples.back().x, sample.y - pth->samples.back().y);
+            sample.length = pth->total_length + len;
+            pth->samples.push_back(sample);
+          }
           pth->pointarray[i].length = len;
           pth->total_length += len;
 
@@ -137,13 +111,13 @@ namespace enigma
         pth->centerx = minx + (maxx-minx)/2;
         pth->centery = miny + (maxy-miny)/2;
 
-        double position = 0;
-        for (size_t i = 0; i < pc; i++)
+        const size_t sc = pth->samples.size();
+        pth->sample_index.resize(sc);
+        for (size_t i = 0, s = 0; i < sc; i++)
         {
-          //if (pth->pointarray[i].length) {
-            pth->pointoffset[position/pth->total_length] = i;
-            position += pth->pointarray[i].length;
-          //}
+          const double along = pth->total_length * i / sc;
+          while (s+1 < sc && pth->samples[s+1].length <= along) s++;
+          pth->sample_index[i] = s;
         }
     }
 
@@ -155,57 +129,35 @@ namespace enigma
         delete[] pathold;
     }
 
-    /// Returns an iterator to the point in @param path whose segment covers @param position.
-    inline ppi_t path_point_iterator_at(path* pth, cs_scalar position) {
-      return --pth->pointoffset.upper_bound(position);
-    }
-    inline int path_point_index_at(path* pth, cs_scalar position) {
-      return path_point_iterator_at(pth, position)->second;
+    /// Returns the last sample of @param pth no further along than @param position,
+    /// setting @param t to how far (0 to 1) position is toward the next sample.
+    static inline size_t path_sample_at(const path* pth, cs_scalar position, double &t)
+    {
+      const size_t sc = pth->samples.size();
+      const double along = position * pth->total_length;
+      size_t s = pth->sample_index[position > 0 ? std::min(size_t(position * sc), sc - 1) : 0];
+      while (s+1 < sc && pth->samples[s+1].length <= along) s++;
+      t = 0;
+      if (s+1 < sc) {
+        const double span = pth->samples[s+1].length - pth->samples[s].length;
+        if (span > 0) t = (along - pth->samples[s].length) / span;
+      }
+      return s;
     }
 
     void path_getXY(path *pth, cs_scalar &x, cs_scalar &y, cs_scalar position)
     {
       if (!pth) return;
-      if (!pth->pointarray.size()) return;
+      if (!pth->samples.size()) return;
       if (position < 0)
         position = 1 - fmod(-position, 1);
       else if (position > 1)
         position = fmod(position, 1);
-      ppi_t ppi = path_point_iterator_at(pth, position);
-      double t = position - ppi->first;
-      t /= double(pth->pointarray[ppi->second].length) / pth->total_length;
-      int sid = ppi->second;
-      double x1, x2, x3, y1, y2, y3;
-      const size_t pc = pth->pointarray.size();
-      const path_point& start = pth->closed ? pth->pointarray[pc-1] : pth->pointarray[0];
-      const path_point& end  =  pth->closed ? pth->pointarray[0] : pth->pointarray[pc-1];
-      if (sid==0)
-          x1=start.x, y1=start.y;
-      else
-          x1=pth->pointarray[sid-1].x, y1=pth->pointarray[sid-1].y;
-
-      x2=pth->pointarray[sid].x, y2=pth->pointarray[sid].y;
-
-      if (pth->pointarray.size() == 1) {
-        x = x1, y = y1;
-        return;
-      }
-      else if (pth->pointarray.size() == 2 && fequal(x1, x2) && fequal(y1, y2)) {
-        x = x1, y = y1;
-        return;
-      }
-
-      if (pth->smooth && (pth->pointarray.size()>2 || pth->closed)) {
-        if (size_t(sid)+1 == pc)
-            x3=end.x, y3=end.y;
-        else
-            x3=pth->pointarray[sid+1].x, y3=pth->pointarray[sid+1].y;
-        x = 0.5 * (((x1 - 2 * x2 + x3) * t + 2 * x2 - 2 * x1) * t + x1 + x2);
-        y = 0.5 * (((y1 - 2 * y2 + y3) * t + 2 * y2 - 2 * y1) * t + y1 + y2);
-      } else {
-        x = x1 + (x2-x1) * t;
-        y = y1 + (y2-y1) * t;
-      }
+      double t;
+      const size_t s = path_sample_at(pth, position, t);
+      const path_point &p0 = pth->samples[s], &p1 = pth->samples[t > 0 ? s+1 : s];
+      x = p0.x + (p1.x - p0.x) * t;
+      y = p0.y + (p1.y - p0.y) * t;
     }
 
     void path_getXY_scaled(path *pth, cs_scalar &x, cs_scalar &y, cs_scalar position, cs_scalar scale)
@@ -218,29 +170,11 @@ namespace enigma
     void path_getspeed(path *pth, cs_scalar &speed, cs_scalar position)
     {
       if (!pth) return;
-      if (!pth->pointarray.size()) return;
-      ppi_t ppi = path_point_iterator_at(pth, position);
-      double t = position - ppi->first;
-      t /= double(pth->pointarray[ppi->second].length) / pth->total_length;
-      int sid = ppi->second;
-      double x1, x2, x3;
-      const size_t pc = pth->pointarray.size();
-      const path_point& start = pth->closed ? pth->pointarray[pc-1] : pth->pointarray[0];
-      const path_point& end  =  pth->closed ? pth->pointarray[0] : pth->pointarray[pc-1];
-      if (sid==0)
-          x1=start.speed;
-      else
-          x1=pth->pointarray[sid-1].speed;
-      x2=pth->pointarray[sid].speed;
-      if (pth->smooth){
-          if (size_t(sid)+1==pc)
-              x3=end.speed;
-          else
-              x3=pth->pointarray[sid+1].speed;
-          speed = 0.5 * (((x1 - 2 * x2 + x3) * t + 2 * x2 - 2 * x1) * t + x1 + x2);
-      }else{
-          speed = x1+(x2-x1)*t;
-      }
+      if (!pth->samples.size()) return;
+      double t;
+      const size_t s = path_sample_at(pth, position < 0 ? 0 : position > 1 ? 1 : position, t);
+      const path_point &p0 = pth->samples[s], &p1 = pth->samples[t > 0 ? s+1 : s];
+      speed = p0.speed + (p1.speed - p0.speed) * t;
     }
 
     /// Allocates and zero-fills the path array at game start
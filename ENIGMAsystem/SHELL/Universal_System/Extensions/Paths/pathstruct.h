@@ -26,10 +26,8 @@
 **                                                                              **
 \********************************************************************************/
 
-#include <map>
 #include <vector>
 using std::vector;
-using std::map;
 
 #include "Universal_System/scalar.h"
 
@@ -50,7 +48,11 @@ namespace enigma
     int id, precision;
     bool smooth, closed;
     vector<path_point> pointarray;
-    map<cs_scalar,int> pointoffset;
+    //The path traced out as short lines, each sample's length being how far
+    //along the path it is, so positions are looked up instead of solved for
+    vector<path_point> samples;
+    //sample_index[i] is the last sample no further along than i/samples.size()
+    vector<unsigned> sample_index;
     cs_scalar total_length, centerx, centery;
     path(unsigned pathid, bool smooth, bool closed, int precision, unsigned pointcount);
     ~path();
@@ -63,7 +65,6 @@ namespace enigma
   void path_getXY_scaled(path *pth, cs_scalar &x, cs_scalar &y, cs_scalar position, cs_scalar scale);
   void path_getspeed(path *pth, cs_scalar &speed, cs_scalar position);
   void pathstructarray_reallocate();
-  typedef map<cs_scalar,int>::iterator ppi_t;
 }
 
 namespace enigma
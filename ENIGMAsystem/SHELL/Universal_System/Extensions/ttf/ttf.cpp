@@ -174,6 +174,7 @@ namespace enigma_user {
     }
 
     fnt->glyphRanges[0] = fgr;
+    fnt->indexGlyphs();
     fnt->texture = enigma::graphics_create_texture(enigma::RawImage(pxdata, w, h), false);
     fnt->twid = w;
     fnt->thgt = h;
@@ -57,6 +57,12 @@ int instance_number (int obj);
 enigma::instance_t instance_last(int obj);
 enigma::instance_t instance_nearest (int x,int y,int obj,bool notme = false);
 enigma::instance_t instance_furthest(int x,int y,int obj,bool notme = false);
+// Keeps a spatial index of obj's instances (or of all instances, for `all`)
+// to speed up instance_nearest, distance_to_object, region (de)activation and
+// the like. Indexed queries see instances where they were when the current
+// event began, rather than where earlier instances in it moved them.
+void instance_index_enable(int obj, int cell_size = 64);
+void instance_index_disable(int obj);
 void instance_change(int obj, bool perf = false);
 void instance_copy(bool perf = true); // this is supposed to return an iterator
 inline void action_change_object(int obj, bool perf);
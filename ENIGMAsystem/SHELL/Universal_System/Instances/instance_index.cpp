@@ -0,0 +1,160 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "instance_index.h"
+#include "instance_system.h"
+#include "instance.h"
+#include "Universal_System/Object_Tiers/collisions_object.h"
+#include "Universal_System/Resources/sprites_internal.h"
+
+namespace enigma {
+
+unsigned long instance_index_generation = 0;
+
+namespace {
+
+// Grids are kept to at most this many cells per instance, growing the cell
+// size if the instances are spread too thin.
+const size_t kMaxCellsPerEntry = 4;
+
+struct IndexSlot {
+  InstanceIndex index;
+  unsigned long generation;
+};
+
+std::map<int, IndexSlot> indexes;
+IndexSlot deactivated = {InstanceIndex(), 0};
+
+}  // namespace
+
+void InstanceIndex::add(object_basic *inst) {
+  const object_collisions *coll = static_cast<const object_collisions*>(inst);
+  entries_.push_back({inst, coll->x, coll->y});
+
+  if (coll->sprite_index == -1 && coll->mask_index == -1) return;
+  // Rotation can swing any corner of the box around the origin, so bound by the furthest
+  const BoundingBox box = coll->$bbox_relative();
+  const double dx = std::max(std::abs(box.left()), std::abs(box.right() + 1)),
+               dy = std::max(std::abs(box.top()), std::abs(box.bottom() + 1)),
+               scale = std::max(std::fabs(coll->image_xscale), std::fabs(coll->image_yscale));
+  reach_ = std::max(reach_, std::sqrt(dx * dx + dy * dy) * scale + 1);
+}
+
+void InstanceIndex::finish() {
+  if (entries_.empty()) {
+    cols_ = rows_ = 0;
+    cell_start_.assign(1, 0);
+    return;
+  }
+
+  double x1 = x0_ = entries_[0].x, y1 = y0_ = entries_[0].y;
+  for (const Entry &e : entries_) {
+    x0_ = std::min(x0_, e.x), x1 = std::max(x1, e.x);
+    y0_ = std::min(y0_, e.y), y1 = std::max(y1, e.y);
+  }
+  double cell = requested_cell_size_;
+  const double max_cells = double(entries_.size() * kMaxCellsPerEntry);
+  if ((x1 - x0_) / cell * ((y1 - y0_) / cell) > max_cells)
+    cell = std::sqrt((x1 - x0_) * (y1 - y0_) / max_cells);
+  cell_size_ = cell;
+  cols_ = int((x1 - x0_) / cell) + 1;
+  rows_ = int((y1 - y0_) / cell) + 1;
+
+  // Counting sort into cells
+  std::vector<unsigned> cells(entries_.size());
+  cell_start_.assign(size_t(cols_) * rows_ + 1, 0);
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    int c, r;
+    cell_of(entries_[i].x, entries_[i].y, c, r);
+    cells[i] = std::min(r, rows_ - 1) * cols_ + std::min(c, cols_ - 1);
+    ++cell_start_[cells[i] + 1];
+  }
+  for (size_t i = 1; i < cell_start_.size(); ++i) cell_start_[i] += cell_start_[i - 1];
+  std::vector<unsigned> fill(cell_start_.begin(), cell_start_.end() - 1);
+  std::vector<Entry> sorted(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) sorted[fill[cells[i]]++] = entries_[i];
+  entries_.swap(sorted);
+}
+
+double InstanceIndex::measure_moves() {
+  double moved = 0;
+  for (const Entry &e : entries_) {
+    const object_collisions *inst = static_cast<const object_collisions*>(e.inst);
+    const double dx = inst->x - e.x, dy = inst->y - e.y;
+    moved = std::max(moved, dx * dx + dy * dy);
+  }
+  return moved_ = std::sqrt(moved);
+}
+
+void InstanceIndex::build(iterator it) {
+  entries_.clear();
+  reach_ = 0;
+  moved_ = 0;
+  for (; it; ++it) add(*it);
+  finish();
+}
+
+void InstanceIndex::build(const std::map<int, object_basic*> &instances) {
+  entries_.clear();
+  reach_ = 0;
+  moved_ = 0;
+  for (const auto &inst : instances) add(inst.second);
+  finish();
+}
+
+const InstanceIndex *instance_index(int obj) {
+  auto it = indexes.find(obj);
+  if (it == indexes.end()) return nullptr;
+  IndexSlot &slot = it->second;
+  if (slot.generation != instance_index_generation) {
+    slot.index.build(fetch_inst_iter_by_int(obj));
+    slot.generation = instance_index_generation;
+  } else if (slot.index.measure_moves() > slot.index.cell_size()) {
+    // Past this, the searches would cover too many cells to be worth it
+    slot.index.build(fetch_inst_iter_by_int(obj));
+  }
+  return &slot.index;
+}
+
+const InstanceIndex *deactivated_instance_index() {
+  auto it = indexes.find(enigma_user::all);
+  if (it == indexes.end()) return nullptr;
+  if (deactivated.generation != instance_index_generation) {
+    deactivated.index = InstanceIndex(it->second.index.cell_size());
+    deactivated.index.build(instance_deactivated_list);
+    deactivated.generation = instance_index_generation;
+  } else if (deactivated.index.measure_moves() > deactivated.index.cell_size()) {
+    deactivated.index.build(instance_deactivated_list);
+  }
+  return &deactivated.index;
+}
+
+}  //namespace enigma
+
+namespace enigma_user {
+
+void instance_index_enable(int obj, int cell_size) {
+  // Generation - 1 is never current, so the first query builds it
+  enigma::indexes[obj] = {enigma::InstanceIndex(cell_size > 0 ? cell_size : 64),
+                          enigma::instance_index_generation - 1};
+  enigma::deactivated.generation = enigma::instance_index_generation - 1;
+}
+
+void instance_index_disable(int obj) {
+  enigma::indexes.erase(obj);
+}
+
+}  //namespace enigma_user
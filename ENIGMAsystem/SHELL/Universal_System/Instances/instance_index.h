@@ -0,0 +1,242 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#error This file is high-impact and should not be included from SHELLmain.cpp.
+#endif
+
+#ifndef ENIGMA_INSTANCE_INDEX_H
+#define ENIGMA_INSTANCE_INDEX_H
+
+#include "instance_iterator.h"
+#include "instance_system.h"
+#include "Universal_System/Object_Tiers/object.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <vector>
+
+// Spatial indexes for the instance queries games call per instance per step
+// (instance_nearest, distance_to_object, region activation...). An index is
+// enabled per object with instance_index_enable. Instance variables are plain
+// fields, so moves can't be tracked as they happen; instead an index is
+// rebuilt on first use after instances are created, destroyed, (de)activated,
+// or an event finishes running. Entries therefore record where instances were
+// when the current event began. Each use measures how far instances have
+// moved since then, and the searches widen by that much, so they find the same
+// instances as scanning every one would; callers score candidates by their
+// current x and y. An index whose instances moved further than a cell is
+// rebuilt instead.
+
+namespace enigma {
+
+// Bumped whenever an index may have gone stale.
+extern unsigned long instance_index_generation;
+
+// A uniform grid over instance origins. Entries are sorted by cell, so each
+// cell is a contiguous run of entries starting at cell_start_[cell].
+class InstanceIndex {
+ public:
+  struct Entry {
+    object_basic *inst;
+    double x, y;  // As of the last build
+  };
+
+  explicit InstanceIndex(double cell_size = 64): requested_cell_size_(cell_size), cell_size_(cell_size) {}
+
+  void build(iterator it);
+  void build(const std::map<int, object_basic*> &instances);
+
+  double cell_size() const { return requested_cell_size_; }
+  bool empty() const { return entries_.empty(); }
+
+  // Measures how far any instance has moved from its entry, which every
+  // query then allows for, and returns it.
+  double measure_moves();
+
+  // Calls f(inst) for every instance whose bounding box may intersect the
+  // given rectangle. The caller does the exact test.
+  template<typename F> void query_rect(double left, double top, double right, double bottom, F f) const {
+    if (entries_.empty()) return;
+    int c0, r0, c1, r1;
+    const double margin = reach_ + moved_;
+    cell_of(left - margin, top - margin, c0, r0);
+    cell_of(right + margin, bottom + margin, c1, r1);
+    c0 = std::max(c0, 0), r0 = std::max(r0, 0);
+    c1 = std::min(c1, cols_ - 1), r1 = std::min(r1, rows_ - 1);
+    if (c0 > c1 || r0 > r1) return;
+    for (int r = r0; r <= r1; ++r) {
+      for (unsigned i = cell_start_[r * cols_ + c0]; i < cell_start_[r * cols_ + c1 + 1]; ++i)
+        f(entries_[i].inst);
+    }
+  }
+
+  // Finds the entry minimizing distance(entry), visiting cells outward from
+  // (x, y). `distance` may return HUGE_VAL to skip an entry. It must never
+  // be less than the distance between (x, y) and the instance's current
+  // origin, less `slack`. Returns NULL if every entry was skipped.
+  template<typename D> object_basic *nearest(double x, double y, double slack, D distance,
+                                             double *best_distance = nullptr) const {
+    double best = std::numeric_limits<double>::infinity();
+    object_basic *found = nullptr;
+    slack += moved_;
+    if (!entries_.empty()) {
+      int qc, qr;
+      cell_of(x, y, qc, qr);
+      for (int ring = ring_min(qc, qr), last = ring_max(qc, qr); ring <= last; ++ring) {
+        // Every cell of this ring is at least (ring - 1) cells away
+        if ((ring - 1) * cell_size_ - slack >= best) break;
+        for_ring(qc, qr, ring, [&](int cell) {
+          if (cell_min_distance(cell, x, y) - slack >= best) return;
+          for (unsigned i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i) {
+            const double d = distance(entries_[i]);
+            if (d < best) best = d, found = entries_[i].inst;
+          }
+        });
+      }
+    }
+    if (best_distance) *best_distance = best;
+    return found;
+  }
+
+  // The same, maximizing distance(entry), which must never exceed the
+  // distance between (x, y) and the instance's current origin; -HUGE_VAL
+  // skips an entry. Cells are visited inward.
+  template<typename D> object_basic *furthest(double x, double y, D distance) const {
+    double best = -std::numeric_limits<double>::infinity();
+    object_basic *found = nullptr;
+    if (entries_.empty()) return found;
+    int qc, qr;
+    cell_of(x, y, qc, qr);
+    for (int ring = ring_max(qc, qr), first = ring_min(qc, qr); ring >= first; --ring) {
+      // No cell of this ring reaches past ring + 1 cells, diagonally
+      if ((ring + 1) * cell_size_ * M_SQRT2 + moved_ < best) break;
+      for_ring(qc, qr, ring, [&](int cell) {
+        if (cell_max_distance(cell, x, y) + moved_ < best) return;
+        for (unsigned i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i) {
+          const double d = distance(entries_[i]);
+          if (d > best) best = d, found = entries_[i].inst;
+        }
+      });
+    }
+    return found;
+  }
+
+  // Furthest any indexed instance's bounding box reaches from its origin.
+  double reach() const { return reach_; }
+
+ private:
+  void add(object_basic *inst);
+  void finish();
+
+  void cell_of(double x, double y, int &col, int &row) const {
+    col = int(std::max(std::min(std::floor((x - x0_) / cell_size_), 1e9), -1e9));
+    row = int(std::max(std::min(std::floor((y - y0_) / cell_size_), 1e9), -1e9));
+  }
+
+  // Rings are squares of cells around the query cell; ring 0 is the cell itself.
+  int ring_min(int qc, int qr) const {
+    const int dc = qc < 0 ? -qc : qc >= cols_ ? qc - cols_ + 1 : 0;
+    const int dr = qr < 0 ? -qr : qr >= rows_ ? qr - rows_ + 1 : 0;
+    return std::max(dc, dr);
+  }
+  int ring_max(int qc, int qr) const {
+    return std::max(std::max(qc, cols_ - 1 - qc), std::max(qr, rows_ - 1 - qr));
+  }
+
+  template<typename F> void for_ring(int qc, int qr, int ring, F f) const {
+    const int c0 = std::max(qc - ring, 0), c1 = std::min(qc + ring, cols_ - 1);
+    if (c0 > c1) return;
+    for (int r : {qr - ring, qr + ring}) {
+      if (r >= 0 && r < rows_) {
+        for (int c = c0; c <= c1; ++c) f(r * cols_ + c);
+      }
+      if (!ring) return;
+    }
+    const int r0 = std::max(qr - ring + 1, 0), r1 = std::min(qr + ring - 1, rows_ - 1);
+    for (int c : {qc - ring, qc + ring}) {
+      if (c < 0 || c >= cols_) continue;
+      for (int r = r0; r <= r1; ++r) f(r * cols_ + c);
+    }
+  }
+
+  double cell_min_distance(int cell, double x, double y) const {
+    const double left = x0_ + (cell % cols_) * cell_size_, top = y0_ + (cell / cols_) * cell_size_;
+    const double dx = std::max(std::max(left - x, x - left - cell_size_), 0.0);
+    const double dy = std::max(std::max(top - y, y - top - cell_size_), 0.0);
+    return std::sqrt(dx * dx + dy * dy);
+  }
+  double cell_max_distance(int cell, double x, double y) const {
+    const double left = x0_ + (cell % cols_) * cell_size_, top = y0_ + (cell / cols_) * cell_size_;
+    const double dx = std::max(std::fabs(left - x), std::fabs(left + cell_size_ - x));
+    const double dy = std::max(std::fabs(top - y), std::fabs(top + cell_size_ - y));
+    return std::sqrt(dx * dx + dy * dy);
+  }
+
+  double requested_cell_size_;
+  double cell_size_;                  // Grown from the requested size if instances are sparse
+  std::vector<Entry> entries_;
+  std::vector<unsigned> cell_start_;  // cols_ * rows_ + 1 offsets into entries_
+  double x0_ = 0, y0_ = 0;            // Corner of cell (0, 0)
+  int cols_ = 0, rows_ = 0;
+  double reach_ = 0;
+  double moved_ = 0;                  // As of the last measure_moves()
+};
+
+// Returns the index of the given object's instances, rebuilt if stale, or
+// NULL if none was enabled. `all` indexes every instance.
+const InstanceIndex *instance_index(int obj);
+// Returns an index of deactivated instances when `all` is indexed, else NULL.
+const InstanceIndex *deactivated_instance_index();
+
+// Calls f(inst) for every active instance that may intersect the rectangle:
+// the candidates from the `all` index if there is one, else every instance.
+// f may deactivate or destroy the instance.
+template<typename F> void for_instances_near(double left, double top, double right, double bottom, F f) {
+  const InstanceIndex *index = instance_index(enigma_user::all);
+  if (!index) {
+    for (iterator it = instance_list_first(); it; ++it) f(*it);
+    return;
+  }
+  // Collect first, since f may change what the index holds
+  std::vector<object_basic*> found;
+  index->query_rect(left, top, right, bottom, [&](object_basic *inst) { found.push_back(inst); });
+  for (object_basic *inst : found) f(inst);
+}
+
+// Likewise for deactivated instances. Each one for which f returns true is
+// removed from instance_deactivated_list.
+template<typename F> void for_deactivated_near(double left, double top, double right, double bottom, F f) {
+  const InstanceIndex *index = deactivated_instance_index();
+  if (!index) {
+    for (auto it = instance_deactivated_list.begin(); it != instance_deactivated_list.end();) {
+      if (f(it->second)) instance_deactivated_list.erase(it++);
+      else ++it;
+    }
+    return;
+  }
+  std::vector<object_basic*> found;
+  index->query_rect(left, top, right, bottom, [&](object_basic *inst) { found.push_back(inst); });
+  for (object_basic *inst : found) {
+    if (f(inst)) instance_deactivated_list.erase(inst->id);
+  }
+}
+
+}  //namespace enigma
+
+#endif  //ENIGMA_INSTANCE_INDEX_H
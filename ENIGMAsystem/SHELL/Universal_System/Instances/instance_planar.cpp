@@ -28,13 +28,24 @@
 #include "Universal_System/Object_Tiers/planar_object.h"
 #include "instance_system.h"
 #include "instance.h"
+#include "instance_index.h"
 #include <cfloat>
+#include <cmath>
 
 namespace enigma_user
 {
 
 enigma::instance_t instance_nearest(int x,int y,int obj,bool notme)
 {
+  if (const enigma::InstanceIndex *index = enigma::instance_index(obj)) {
+    const enigma::object_basic *me = notme ? enigma::instance_event_iterator->inst : NULL;
+    const enigma::object_basic *found = index->nearest(x, y, 0, [&](const enigma::InstanceIndex::Entry &e) {
+      const enigma::object_planar *inst = (const enigma::object_planar*) e.inst;
+      return e.inst == me ? HUGE_VAL : hypot(inst->x - x, inst->y - y);
+    });
+    return found ? int(found->id) : noone;
+  }
+
   double dist_lowest = DBL_MAX;
   int retid = noone;
   double xl, yl;
@@ -56,6 +67,15 @@ enigma::instance_t instance_nearest(int x,int y,int obj,bool notme)
 
 enigma::instance_t instance_furthest(int x,int y,int obj,bool notme)
 {
+  if (const enigma::InstanceIndex *index = enigma::instance_index(obj)) {
+    const enigma::object_basic *me = notme ? enigma::instance_event_iterator->inst : NULL;
+    const enigma::object_basic *found = index->furthest(x, y, [&](const enigma::InstanceIndex::Entry &e) {
+      const enigma::object_planar *inst = (const enigma::object_planar*) e.inst;
+      return e.inst == me ? -HUGE_VAL : hypot(inst->x - x, inst->y - y);
+    });
+    return found ? int(found->id) : noone;
+  }
+
   double dist_highest = -1;
   int retid = noone;
   double xl,yl;
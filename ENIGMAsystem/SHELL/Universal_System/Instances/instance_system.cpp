@@ -29,6 +29,7 @@
 
 #include "instance_system.h"
 #include "instance_system_frontend.h"
+#include "instance_index.h"
 
 using namespace std;
 
@@ -324,6 +325,7 @@ namespace enigma
   //Link in an instance
   pinstance_list_iterator link_instance(object_basic* who)
   {
+    instance_index_generation++;
     inst_iter *ins = new inst_iter(who);
     enigma_user::instance_id.push_back(who->id);
     pair<iliter,bool> it = instance_list.insert(inode_pair(who->id,ins));
@@ -367,6 +369,7 @@ namespace enigma
   }
   void unlink_main(instance_list_iterator who)
   {
+    instance_index_generation++;
     inst_iter *a = who->second;
     if (a->prev) a->prev->next = a->next;
     if (a->next) a->next->prev = a->prev;
@@ -375,6 +378,7 @@ namespace enigma
   }
   void unlink_main(pinstance_list_iterator whop)
   {
+    instance_index_generation++;
     inst_iter *a = whop->w->second;
     if (a->prev) a->prev->next = a->next;
     if (a->next) a->next->prev = a->prev;
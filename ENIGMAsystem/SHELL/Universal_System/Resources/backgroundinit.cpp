@@ -19,84 +19,58 @@
 #include "backgrounds_internal.h"
 #include "libEGMstd.h"
 #include "resinit.h"
-#include "Universal_System/zlib.h"
+#include "resmodule.h"
 #include "Universal_System/image_formats.h"
 #include "Universal_System/nlpo2.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
-#include "Platforms/General/fileio.h"
 
 #include <cstring>
 
+using namespace enigma::resource_module;
+
 namespace enigma
 {
-  void exe_loadbackgrounds(FILE_t *exe)
+  void exe_loadbackgrounds(const ResourceModule &module)
   {
-    int nullhere;
-    unsigned bkgid, width, height,transparent,smoothEdges,preload,useAsTileset,tileWidth,tileHeight,hOffset,vOffset,hSep,vSep;
-
-    if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
-    if (memcmp(&nullhere, "BKG ", sizeof(int)) != 0) return;
-
-    // Determine how many backgrounds we have
-    int bkgcount;
-    if (!fread_wrapper(&bkgcount,4,1,exe))
-      return;
+    auto range = module.entries(RES_BACKGROUND);
+    if (range.first == range.second) return;
 
-    // Fetch the highest ID we will be using
-    int bkg_highid;
-    if (!fread_wrapper(&bkg_highid,4,1,exe))
-      return;
-    
-    if (bkgcount == 0) return;
-    backgrounds.resize(bkg_highid+1);
+    // Entries are ordered by id, so the last holds the highest ID we will be using
+    backgrounds.resize((range.second - 1)->id + 1);
 
-    for (int i = 0; i < bkgcount; i++)
+    std::vector<unsigned char> storage;
+    for (const TocEntry *entry = range.first; entry != range.second; ++entry)
     {
-      int unpacked;
-      if (!fread_wrapper(&bkgid, 4,1,exe)) return;
-      if (!fread_wrapper(&width, 4,1,exe)) return;
-      if (!fread_wrapper(&height,4,1,exe)) return;
-      if (!fread_wrapper(&transparent,4,1,exe)) return;
-      if (!fread_wrapper(&smoothEdges,4,1,exe)) return;
-      if (!fread_wrapper(&preload,4,1,exe)) return;
-      if (!fread_wrapper(&useAsTileset,4,1,exe)) return;
-      if (!fread_wrapper(&tileWidth,4,1,exe)) return;
-      if (!fread_wrapper(&tileHeight,4,1,exe)) return;
-      if (!fread_wrapper(&hOffset,4,1,exe)) return;
-      if (!fread_wrapper(&vOffset,4,1,exe)) return;
-      if (!fread_wrapper(&hSep,4,1,exe)) return;
-      if (!fread_wrapper(&vSep,4,1,exe)) return;
-
-      unpacked = width*height*4;
+      BackgroundInfo info;
+      const unsigned char *data = module.payload(*entry, storage);
+      if (!data or entry->size < sizeof(info)) {
+        DEBUG_MESSAGE("Failed to load background " + enigma_user::toString(entry->id) + ": metrics are missing", MESSAGE_TYPE::M_ERROR);
+        continue;
+      }
+      memcpy(&info, data, sizeof(info));
 
-      unsigned int size;
-      if (!fread_wrapper(&size,4,1,exe)){};
-      
-      unsigned char* cpixels=new unsigned char[size+1];
-      if (!cpixels)
+      const TocEntry *image = module.find(RES_BACKGROUND_IMAGE, entry->id);
+      const uint64_t unpacked = uint64_t(info.width) * info.height * 4;
+      if (!image or image->unpacked_size != unpacked)
       {
-        DEBUG_MESSAGE("Failed to load background: Cannot allocate enough memory " + enigma_user::toString(unpacked), MESSAGE_TYPE::M_ERROR);
-        break;
-      }
-      unsigned int sz2=fread_wrapper(cpixels,1,size,exe);
-      if (size!=sz2) {
-        DEBUG_MESSAGE("Failed to load background: Data is truncated before exe end. Read " + enigma_user::toString(sz2) + " out of expected " + enigma_user::toString(size), MESSAGE_TYPE::M_ERROR);
-        return;
+        DEBUG_MESSAGE("Background load error: Background does not match expected size", MESSAGE_TYPE::M_ERROR);
+        continue;
       }
       unsigned char* pixels=new unsigned char[unpacked+1];
-      if (zlib_decompress(cpixels,size,unpacked,pixels) != unpacked)
+      if (!module.decode(*image, pixels))
       {
-        DEBUG_MESSAGE("Background load error: Background does not match expected size", MESSAGE_TYPE::M_ERROR);
+        DEBUG_MESSAGE("Failed to load background: Data could not be decoded", MESSAGE_TYPE::M_ERROR);
+        delete[] pixels;
         continue;
       }
-      delete[] cpixels;
 
       unsigned fw, fh;
-      int texID = graphics_create_texture(RawImage(pixels, width, height), false, &fw, &fh);
-      Background bkg(width, height, fw, fh, texID, useAsTileset, tileWidth, tileHeight, hOffset, vOffset, hSep, vSep);
-      backgrounds.assign(bkgid, std::move(bkg));
+      int texID = graphics_create_texture(RawImage(pixels, info.width, info.height), false, &fw, &fh);
+      Background bkg(info.width, info.height, fw, fh, texID, info.use_as_tileset, info.tile_width, info.tile_height,
+                     info.h_offset, info.v_offset, info.h_sep, info.v_sep);
+      backgrounds.assign(entry->id, std::move(bkg));
     }
   }
 } //namespace enigma
@@ -21,39 +21,57 @@
 #include "fonts_internal.h"
 #include "libEGMstd.h"
 #include "resinit.h"
-#include "Universal_System/zlib.h"
+#include "resmodule.h"
 
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
-#include "Platforms/General/fileio.h"
 
 #include <cstring>
 #include <string>
 
-namespace enigma {
-
-void exe_loadfonts(FILE_t* exe) {
-  int nullhere, fntid;
-  unsigned fontcount, twid, thgt, gwid, ghgt;
-  float advance, baseline, origin, gtx, gty, gtx2, gty2;
-
-  if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
-  if (memcmp(&nullhere, "FNT ", sizeof(int)) != 0) return;
+using namespace enigma::resource_module;
 
-  if (!fread_wrapper(&fontcount, 4, 1, exe)) return;
-  if ((int)fontcount != rawfontcount) {
-    DEBUG_MESSAGE("Resource data does not match up with game metrics. Unable to improvise.", MESSAGE_TYPE::M_ERROR);
-    return;
-  }
+namespace enigma {
 
+void exe_loadfonts(const ResourceModule &module) {
+  if (rawfontcount <= 0) return;
   sprite_fonts.resize(rawfontmaxid+1);
 
+  std::vector<unsigned char> storage, image_storage;
   for (int rf = 0; rf < rawfontcount; rf++) {
-    // int unpacked;
-    if (!fread_wrapper(&fntid, 4, 1, exe)) return;
-    if (!fread_wrapper(&twid, 4, 1, exe)) return;
-    if (!fread_wrapper(&thgt, 4, 1, exe)) return;
+    const int fntid = rawfontdata[rf].id;
+    const TocEntry *entry = module.find(RES_FONT, fntid);
+    const TocEntry *image = module.find(RES_FONT_IMAGE, fntid);
+    if (!entry or !image) {
+      DEBUG_MESSAGE("Resource data does not match up with game metrics. Unable to improvise.", MESSAGE_TYPE::M_ERROR);
+      continue;
+    }
+
+    FontInfo info;
+    const unsigned char *data = module.payload(*entry, storage);
+    if (!data or entry->size < sizeof(info)) {
+      DEBUG_MESSAGE("Font " + std::to_string(fntid) + " is missing its metrics", MESSAGE_TYPE::M_ERROR);
+      continue;
+    }
+    const unsigned char *const data_end = data + entry->size;
+    memcpy(&info, data, sizeof(info));
+    data += sizeof(info);
+
+    const unsigned twid = info.texture_width, thgt = info.texture_height;
+    const unsigned char *mono = nullptr;
+    if (image->unpacked_size == uint64_t(twid) * thgt) {
+      if (image->codec == CODEC_NONE) {
+        mono = module.payload(*image, image_storage);
+      } else {
+        image_storage.resize(image->unpacked_size);
+        if (module.decode(*image, image_storage.data())) mono = image_storage.data();
+      }
+    }
+    if (!mono) {
+      DEBUG_MESSAGE("Font " + std::to_string(fntid) + " has a malformed glyph texture", MESSAGE_TYPE::M_ERROR);
+      continue;
+    }
 
     SpriteFont font;
 
@@ -65,50 +83,39 @@ void exe_loadfonts(FILE_t* exe) {
 
     font.height = 0;
 
-    const unsigned int size = twid * thgt;
-    unsigned char* mono = new unsigned char[size];
-    if (!fread_wrapper(&mono[0], sizeof(char), size, exe)) return;
-    
     unsigned char* pixels = mono_to_rgba(mono, twid, thgt);
-    delete[] mono;
-
-    if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
-    if (memcmp(&nullhere, "done", sizeof(int)) != 0) {
-      DEBUG_MESSAGE(std::string("Unexpected end; eof: ") + ((feof_wrapper(exe) == 0) ? "true" : "false"), MESSAGE_TYPE::M_ERROR);
-      return;
-    }
 
     int ymin = 100, ymax = -100;
-    for (size_t gri = 0; gri < rawfontdata[rf].glyphRangeCount; gri++) {
+    for (int gri = 0; gri < info.range_count; gri++) {
       fontglyphrange fgr;
 
-      unsigned strt, cnt;
-      if (!fread_wrapper(&strt, 4, 1, exe)) return;
-      if (!fread_wrapper(&cnt, 4, 1, exe)) return;
-
-      fgr.glyphstart = strt;
-
-      for (unsigned gi = 0; gi < cnt; gi++) {
-        if (!fread_wrapper(&advance, 4, 1, exe)) return;
-        if (!fread_wrapper(&baseline, 4, 1, exe)) return;
-        if (!fread_wrapper(&origin, 4, 1, exe)) return;
-        if (!fread_wrapper(&gwid, 4, 1, exe)) return;
-        if (!fread_wrapper(&ghgt, 4, 1, exe)) return;
-        if (!fread_wrapper(&gtx, 4, 1, exe)) return;
-        if (!fread_wrapper(&gty, 4, 1, exe)) return;
-        if (!fread_wrapper(&gtx2, 4, 1, exe)) return;
-        if (!fread_wrapper(&gty2, 4, 1, exe)) return;
+      GlyphRangeInfo rinfo;
+      if (data + sizeof(rinfo) > data_end) break;
+      memcpy(&rinfo, data, sizeof(rinfo));
+      data += sizeof(rinfo);
+      if (rinfo.count < 0 or data + rinfo.count * sizeof(GlyphInfo) > data_end) {
+        DEBUG_MESSAGE("Unexpected end of glyph metrics for font " + std::to_string(fntid), MESSAGE_TYPE::M_ERROR);
+        break;
+      }
+
+      fgr.glyphstart = rinfo.start;
+      fgr.glyphs.reserve(rinfo.count);
+
+      for (int gi = 0; gi < rinfo.count; gi++) {
+        GlyphInfo ginfo;
+        memcpy(&ginfo, data, sizeof(ginfo));
+        data += sizeof(ginfo);
         fontglyph fg;
 
-        fg.x = round(origin);
-        fg.y = round(baseline);
-        fg.x2 = round(origin) + gwid;
-        fg.y2 = round(baseline) + ghgt;
-        fg.tx = gtx;
-        fg.ty = gty;
-        fg.tx2 = gtx2;
-        fg.ty2 = gty2;
-        fg.xs = advance;
+        fg.x = round(ginfo.origin);
+        fg.y = round(ginfo.baseline);
+        fg.x2 = round(ginfo.origin) + ginfo.width;
+        fg.y2 = round(ginfo.baseline) + ginfo.height;
+        fg.tx = ginfo.tx;
+        fg.ty = ginfo.ty;
+        fg.tx2 = ginfo.tx2;
+        fg.ty2 = ginfo.ty2;
+        fg.xs = ginfo.advance;
 
         if (fg.y < ymin) ymin = fg.y;
         if (fg.y2 > ymax) ymax = fg.y2;
@@ -125,11 +132,9 @@ void exe_loadfonts(FILE_t* exe) {
     font.texture = graphics_create_texture(RawImage(pixels, twid, thgt), false);
     font.twid = twid;
     font.thgt = thgt;
+    font.indexGlyphs();
 
     sprite_fonts[fntid] = std::move(font);
-
-    if (!fread_wrapper(&nullhere, 4, 1, exe)) return;
-    if (memcmp(&nullhere, "endf", sizeof(int)) != 0) return;
   }
 }
 }  //namespace enigma
@@ -37,7 +37,7 @@ namespace enigma
   struct fontglyph
   {
     fontglyph() : x(0), y(0), x2(0), y2(0), tx(0), ty(0), tx2(0), ty2(0), xs(0) {}
-    bool empty();
+    bool empty() const;
     int   x,  y,  x2,  y2; // Draw coordinates, relative to the top-left corner of a full glyph. Added to xx and yy for draw.
     float tx, ty, tx2, ty2; // Texture coords: used to locate glyph on bound font texture
     float xs; // Spacing: used to increment xx
@@ -52,7 +52,7 @@ namespace enigma
    public:
      SpriteFont() : name(""), fontname(""), fontsize(0),
        bold(false), italic(false), height(0), yoffset(0), texture(-1),
-       twid(0), thgt(0) {}
+       twid(0), thgt(0), glyphIndexStart(0), version(0) {}
     // Trivia
     std::string name, fontname;
     int fontsize; 
@@ -66,8 +66,20 @@ namespace enigma
     int texture;
     int twid, thgt;
 
+    // Character lookup, rebuilt by indexGlyphs() whenever glyphRanges change.
+    // Each entry packs the range into the top 8 bits and the glyph's offset
+    // in that range below. Characters past the end of the table are searched
+    // for in glyphRanges instead.
+    std::vector<uint32_t> glyphIndex;
+    uint32_t glyphIndexStart;
+    // Changes whenever glyphs do, so cached layouts can tell they're stale.
+    unsigned version;
+
+    void indexGlyphs();
+
     void destroy() { 
       glyphRanges.clear();
+      glyphIndex.clear();
       if (texture >= 0) graphics_delete_texture(texture);
       texture = -1;
     }
@@ -89,7 +101,7 @@ namespace enigma
   extern int rawfontcount, rawfontmaxid;
   int font_new(uint32_t gs, uint32_t gc); // Creates a new font, allocating 'gc' glyphs
   int font_pack(SpriteFont *font, int spr, uint32_t gcount, bool prop, int sep);
-  fontglyph findGlyph(const SpriteFont& fnt, uint32_t character);
+  const fontglyph& findGlyph(const SpriteFont& fnt, uint32_t character);
 } //namespace enigma
 
 #endif //ENIGMA_FONTS_INTERNAL_H
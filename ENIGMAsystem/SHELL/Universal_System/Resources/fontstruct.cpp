@@ -25,6 +25,7 @@
 
 #include "Graphics_Systems/graphics_mandatory.h"
 
+#include <algorithm>
 #include <list>
 #include <string>
 #include <string.h>
@@ -38,10 +39,44 @@ namespace enigma
 {
   AssetArray<SpriteFont, -1> sprite_fonts;
 
-  bool fontglyph::empty() {
+  bool fontglyph::empty() const {
     return !(std::abs(x2-x) > 0 && std::abs(y2-y) > 0);
   }
 
+  namespace {
+    const uint32_t kNoGlyph = 0xFFFFFFFF;
+    // Covers every BMP script block most games use without making CJK fonts
+    // carry a table the size of the BMP; the rest is found by search.
+    const uint32_t kMaxGlyphIndex = 0x3000;
+    unsigned font_versions = 0;
+  }
+
+  void SpriteFont::indexGlyphs() {
+    version = ++font_versions;
+    glyphIndex.clear();
+    glyphIndexStart = 0;
+    if (glyphRanges.empty() || glyphRanges.size() > 0xFF) return;
+
+    uint32_t first = UINT32_MAX, last = 0;
+    for (const fontglyphrange& fgr : glyphRanges) {
+      if (fgr.glyphs.empty()) continue;
+      first = std::min(first, fgr.glyphstart);
+      last = std::max(last, uint32_t(fgr.glyphstart + fgr.glyphs.size()));
+    }
+    if (first >= last) return;
+
+    glyphIndexStart = first;
+    glyphIndex.assign(std::min(last - first, kMaxGlyphIndex), kNoGlyph);
+    // Walk the ranges backwards so the first range holding a character wins, as in a search
+    for (size_t r = glyphRanges.size(); r--; ) {
+      const fontglyphrange& fgr = glyphRanges[r];
+      for (size_t g = 0; g < fgr.glyphs.size(); g++) {
+        const uint32_t slot = fgr.glyphstart + g - first;
+        if (slot < glyphIndex.size()) glyphIndex[slot] = r << 24 | g;
+      }
+    }
+  }
+
   int font_new(uint32_t gs, uint32_t gc) // Creates a new font, allocating 'gc' glyphs
   {
     SpriteFont ret;
@@ -51,6 +86,7 @@ namespace enigma
 
     ret.glyphRanges.push_back(fgr);
     ret.height = 0;
+    ret.indexGlyphs();
 
     return sprite_fonts.add(std::move(ret));
   }
@@ -167,18 +203,25 @@ namespace enigma
       font->twid = w;
       font->thgt = h;
       font->yoffset = 0;
+      font->indexGlyphs();
 
       return true;
   }
 
-fontglyph findGlyph(const SpriteFont& fnt, uint32_t character) {
-  for (size_t i = 0; i < fnt.glyphRanges.size(); i++) {
-    fontglyphrange fgr = fnt.glyphRanges[i];
+const fontglyph& findGlyph(const SpriteFont& fnt, uint32_t character) {
+  static const fontglyph none;
+  const uint32_t slot = character - fnt.glyphIndexStart;
+  if (slot < fnt.glyphIndex.size()) {
+    const uint32_t entry = fnt.glyphIndex[slot];
+    if (entry == kNoGlyph) return none;
+    return fnt.glyphRanges[entry >> 24].glyphs[entry & 0xFFFFFF];
+  }
+  for (const fontglyphrange& fgr : fnt.glyphRanges) {
     if (character >= fgr.glyphstart && character < fgr.glyphstart + fgr.glyphs.size()) {
       return fgr.glyphs[character - fgr.glyphstart];
     }
   }
-  return fontglyph();
+  return none;
 }
 
 } // namespace enigma
@@ -244,6 +287,7 @@ bool font_replace(int ind, string name, int size, bool bold, bool italic, uint32
   fgr.glyphstart = first;
 
   fnt->glyphRanges.push_back(fgr);
+  fnt->indexGlyphs();
 
   return true;
 }
@@ -259,6 +303,7 @@ bool font_replace_sprite(int ind, int spr, uint32_t first, bool prop, int sep)
   enigma::fontglyphrange fgr;
   fgr.glyphstart = first;
   fnt->glyphRanges.push_back(fgr);
+  fnt->indexGlyphs();
 
   return enigma::font_pack(fnt, spr, gcount, prop, sep);
 }
@@ -275,42 +320,42 @@ int font_add_sprite(int spr, uint32_t first, bool prop, int sep)
 }
 
 float font_get_glyph_texture_left(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.tx;
 }
 
 float font_get_glyph_texture_top(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.ty;
 }
 
 float font_get_glyph_texture_right(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.tx2;
 }
 
 float font_get_glyph_texture_bottom(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.ty2;
 }
 
 float font_get_glyph_left(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.x;
 }
 
 float font_get_glyph_top(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.y;
 }
 
 float font_get_glyph_right(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.x2;
 }
 
 float font_get_glyph_bottom(int fnt, uint32_t character) {
-  const enigma::fontglyph glyph = enigma::findGlyph(sprite_fonts[fnt], character);
+  const enigma::fontglyph& glyph = enigma::findGlyph(sprite_fonts[fnt], character);
   return glyph.y2;
 }
 
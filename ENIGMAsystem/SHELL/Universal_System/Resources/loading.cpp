@@ -17,6 +17,7 @@
 **/
 
 #include "resinit.h"
+#include "resmodule.h"
 #include "sprites_internal.h"
 #include "backgrounds_internal.h"
 #include "Universal_System/roomsystem.h"
@@ -28,7 +29,6 @@
 #include "Audio_Systems/audio_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
 #include "Graphics_Systems/graphics_mandatory.h"
-#include "Platforms/General/fileio.h"
 
 #include <ctime>
 
@@ -71,47 +71,28 @@ namespace enigma
 
     // Open the exe for resource load
     do { // Allows break
-      FILE_t* resfile;
+      ResourceModule module;
       if (resource_file_path != std::string("$exe")) {
-        if (!(resfile = fopen_wrapper(resource_file_path,"rb"))) {
+        if (!module.open(resource_file_path)) {
           DEBUG_MESSAGE("Resource load fail: exe unopenable", MESSAGE_TYPE::M_ERROR);
           break;
         }
       } else {
         char exename[4097];
         windowsystem_write_exename(exename);
-        if (!(resfile = fopen_wrapper(exename,"rb"))) {
+        if (!module.open(exename)) {
           DEBUG_MESSAGE("No resource data in exe", MESSAGE_TYPE::M_ERROR);
           break;
         }
       }
-      int nullhere;
-      // Read the magic number so we know we're looking at our own data
-      fseek_wrapper(resfile,-8,SEEK_END);
-      char str_quad[4];
-      if (!fread_wrapper(str_quad,4,1,resfile) or str_quad[0] != 'r' or str_quad[1] != 'e' or str_quad[2] != 's' or str_quad[3] != '0') {
-        DEBUG_MESSAGE("No resource data in exe", MESSAGE_TYPE::M_ERROR);
-        break;
-      }
-
-      // Get where our resources are located in the module
-      int pos;
-      if (!fread_wrapper(&pos,4,1,resfile)) break;
 
-      // Go to the start of the resource data
-      fseek_wrapper(resfile,pos,SEEK_SET);
-      if (!fread_wrapper(&nullhere,4,1,resfile)) break;
-      if(nullhere) break;
-
-      enigma::exe_loadsprs(resfile);
-      enigma::exe_loadsounds(resfile);
-      enigma::exe_loadbackgrounds(resfile);
-      enigma::exe_loadfonts(resfile);
+      enigma::exe_loadsprs(module);
+      enigma::exe_loadsounds(module);
+      enigma::exe_loadbackgrounds(module);
+      enigma::exe_loadfonts(module);
       #ifdef PATH_EXT_SET
-      enigma::exe_loadpaths(resfile);
+      enigma::exe_loadpaths(module);
       #endif
-
-      fclose_wrapper(resfile);
     } while (false);
 
     //Load object struct
@@ -32,16 +32,16 @@
 #ifndef ENIGMA_RESINIT_H
 #define ENIGMA_RESINIT_H
 
-#include "Platforms/General/fileio.h"
-
 namespace enigma 
 {
 
-void exe_loadsprs(FILE_t* exe);
-void exe_loadsounds(FILE_t* exe);
-void exe_loadbackgrounds(FILE_t* exe);
-void exe_loadfonts(FILE_t* exe);
-void exe_loadpaths(FILE_t* exe);
+class ResourceModule;
+
+void exe_loadsprs(const ResourceModule& module);
+void exe_loadsounds(const ResourceModule& module);
+void exe_loadbackgrounds(const ResourceModule& module);
+void exe_loadfonts(const ResourceModule& module);
+void exe_loadpaths(const ResourceModule& module);
 
 } //namespace enigma
 
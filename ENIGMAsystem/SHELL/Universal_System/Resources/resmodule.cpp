@@ -0,0 +1,138 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "resmodule.h"
+#include "Universal_System/zlib.h"
+#include "lz4/lz4block.h"
+#include "Widget_Systems/widgets_mandatory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+using namespace enigma::resource_module;
+
+namespace enigma {
+
+bool ResourceModule::open(const char* fname) {
+  close();
+  if (!(file = fopen_wrapper(fname, "rb"))) return false;
+
+  // Read the magic number so we know we're looking at our own data
+  char trailer[sizeof(kTrailer)];
+  int32_t pos;
+  fseek_wrapper(file, -int64_t(sizeof(trailer) + sizeof(pos)), SEEK_END);
+  const int64_t trailer_pos = ftell_wrapper(file);
+  if (!fread_wrapper(trailer, sizeof(trailer), 1, file) or memcmp(trailer, kTrailer, sizeof(trailer))
+      or !fread_wrapper(&pos, sizeof(pos), 1, file) or pos < 0 or pos >= trailer_pos) {
+    close();
+    return false;
+  }
+  base = pos;
+
+  Header header;
+  fseek_wrapper(file, base, SEEK_SET);
+  if (!fread_wrapper(&header, sizeof(header), 1, file) or memcmp(header.magic, kMagic, sizeof(header.magic))) {
+    close();
+    return false;
+  }
+  if (header.version != kVersion) {
+    DEBUG_MESSAGE("Resource data is version " + std::to_string(header.version) + "; this game expects "
+                  + std::to_string(kVersion), MESSAGE_TYPE::M_ERROR);
+    close();
+    return false;
+  }
+  if (header.toc_offset + uint64_t(header.entry_count) * sizeof(TocEntry) > uint64_t(trailer_pos - base)) {
+    DEBUG_MESSAGE("Resource table of contents is truncated", MESSAGE_TYPE::M_ERROR);
+    close();
+    return false;
+  }
+
+  toc.resize(header.entry_count);
+  fseek_wrapper(file, base + header.toc_offset, SEEK_SET);
+  if (fread_wrapper(toc.data(), sizeof(TocEntry), toc.size(), file) != toc.size()) {
+    close();
+    return false;
+  }
+
+  // Map everything up to the TOC; failing that, payloads are read on demand
+  view_size = header.toc_offset;
+  if (view_size) view = static_cast<const unsigned char*>(fmap_wrapper(file, base, view_size));
+  return true;
+}
+
+void ResourceModule::close() {
+  if (view) funmap_wrapper(view, base, view_size);
+  if (file) fclose_wrapper(file);
+  view = nullptr;
+  file = nullptr;
+  view_size = 0;
+  toc.clear();
+}
+
+std::pair<const TocEntry*, const TocEntry*> ResourceModule::entries(uint32_t type) const {
+  auto first = std::lower_bound(toc.begin(), toc.end(), type,
+      [](const TocEntry& e, uint32_t t) { return e.type < t; });
+  auto last = std::upper_bound(first, toc.end(), type,
+      [](uint32_t t, const TocEntry& e) { return t < e.type; });
+  return {toc.data() + (first - toc.begin()), toc.data() + (last - toc.begin())};
+}
+
+const TocEntry* ResourceModule::find(uint32_t type, int id, uint32_t index) const {
+  TocEntry key = {};
+  key.type = type;
+  key.id = id;
+  key.index = index;
+  auto it = std::lower_bound(toc.begin(), toc.end(), key);
+  if (it == toc.end() or it->type != type or it->id != id or it->index != index) return nullptr;
+  return &*it;
+}
+
+const unsigned char* ResourceModule::payload(const TocEntry& entry, std::vector<unsigned char>& storage) const {
+  if (entry.offset + entry.size > view_size) return nullptr;
+  if (view) return view + entry.offset;
+
+  storage.resize(entry.size);
+  fseek_wrapper(file, base + entry.offset, SEEK_SET);
+  if (fread_wrapper(storage.data(), 1, entry.size, file) != entry.size) {
+    DEBUG_MESSAGE("Resource data is truncated before exe end", MESSAGE_TYPE::M_ERROR);
+    return nullptr;
+  }
+  return storage.data();
+}
+
+bool ResourceModule::decode(const TocEntry& entry, unsigned char* out) const {
+  std::vector<unsigned char> storage;
+  const unsigned char* data = payload(entry, storage);
+  if (!data) return false;
+
+  switch (entry.codec) {
+    case CODEC_NONE:
+      if (entry.size != entry.unpacked_size) return false;
+      memcpy(out, data, entry.size);
+      return true;
+    case CODEC_ZLIB:
+      return zlib_decompress(const_cast<unsigned char*>(data), entry.size, entry.unpacked_size, out)
+          == int(entry.unpacked_size);
+    case CODEC_LZ4:
+      return enigma::lz4::decompress(data, entry.size, out, entry.unpacked_size) == long(entry.unpacked_size);
+    default:
+      DEBUG_MESSAGE("Resource uses unknown codec " + std::to_string(entry.codec), MESSAGE_TYPE::M_ERROR);
+      return false;
+  }
+}
+
+} //namespace enigma
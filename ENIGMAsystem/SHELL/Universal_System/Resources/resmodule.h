@@ -0,0 +1,74 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#  error This file includes non-ENIGMA STL headers and should not be included from SHELLmain.
+#endif
+
+#ifndef ENIGMA_RESMODULE_H
+#define ENIGMA_RESMODULE_H
+
+#include "resource_module.h"
+#include "Platforms/General/fileio.h"
+
+#include <utility>
+#include <vector>
+
+namespace enigma {
+
+using resource_module::TocEntry;
+
+/// Read access to the resource block written by the compiler. The block is
+/// memory-mapped where the platform allows it, so payloads stored without
+/// compression are used in place; otherwise payloads are read on demand.
+class ResourceModule {
+ public:
+  ResourceModule() = default;
+  ResourceModule(const ResourceModule&) = delete;
+  ResourceModule& operator=(const ResourceModule&) = delete;
+  ~ResourceModule() { close(); }
+
+  /// Locates the block via the trailer at the end of the given file and
+  /// reads its table of contents. Returns false if there is no valid block.
+  bool open(const char* fname);
+  void close();
+
+  bool is_open() const { return file != nullptr; }
+  bool is_mapped() const { return view != nullptr; }
+
+  /// All entries of the given type, ordered by id and then index.
+  std::pair<const TocEntry*, const TocEntry*> entries(uint32_t type) const;
+  /// The entry with the given key, or NULL if the module has none.
+  const TocEntry* find(uint32_t type, int id, uint32_t index = 0) const;
+
+  /// Returns the stored bytes of an entry. Mapped modules return a pointer
+  /// into the mapping; otherwise the payload is read into `storage`, which
+  /// must outlive the returned pointer. Returns NULL if the read fails.
+  const unsigned char* payload(const TocEntry& entry, std::vector<unsigned char>& storage) const;
+  /// Decodes an entry into `out`, which must hold `entry.unpacked_size` bytes.
+  bool decode(const TocEntry& entry, unsigned char* out) const;
+
+ private:
+  FILE_t* file = nullptr;
+  int64_t base = 0;
+  const unsigned char* view = nullptr;
+  size_t view_size = 0;
+  std::vector<TocEntry> toc;
+};
+
+} //namespace enigma
+
+#endif //ENIGMA_RESMODULE_H
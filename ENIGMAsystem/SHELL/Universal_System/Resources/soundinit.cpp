@@ -20,10 +20,12 @@
 #include "Widget_Systems/widgets_mandatory.h"
 #include "libEGMstd.h"
 #include "resinit.h"
-#include "Universal_System/zlib.h"
-#include "Platforms/General/fileio.h"
+#include "resmodule.h"
 
 #include <cstring>
+#include <string>
+
+using namespace enigma::resource_module;
 
 namespace enigma_user {
   void sound_play(int sound);
@@ -36,36 +38,32 @@ namespace enigma
 
   }
 
-  void exe_loadsounds(FILE_t *exe)
+  void exe_loadsounds(const ResourceModule &module)
   {
-    int nullhere;
-
-    if (!fread_wrapper(&nullhere,4,1,exe)) return;
-    if (memcmp(&nullhere, "SND ", sizeof(int)) != 0)
-      return;
-
-    // Determine how many sprites we have
-    int sndcount;
-    if (!fread_wrapper(&sndcount,4,1,exe)) return;
+    auto range = module.entries(RES_SOUND);
 
-    // Fetch the highest ID we will be using
-    int snd_highid;
-    if (!fread_wrapper(&snd_highid,4,1,exe)) return;
-
-    for (int i = 0; i < sndcount; i++)
+    std::vector<unsigned char> storage;
+    for (const TocEntry *entry = range.first; entry != range.second; ++entry)
     {
-      int id;
-      if (!fread_wrapper(&id,1,4,exe)) return;
-
-      unsigned size;
-      if (!fread_wrapper(&size,1,4,exe)) return;
+      // Mapped modules hand the audio system the stored file in place
+      const unsigned char *fdata = module.payload(*entry, storage);
+      if (!fdata) {
+        DEBUG_MESSAGE("Failed to load sound " + std::to_string(entry->id) + ": data is truncated", MESSAGE_TYPE::M_ERROR);
+        continue;
+      }
 
-      char* fdata = new char[size];
-      if (!fread_wrapper(fdata,1,size,exe)) return;
+      // Sounds without an info entry are decoded on load
+      SoundInfo info = {};
+      std::vector<unsigned char> info_storage;
+      if (const TocEntry *info_entry = module.find(RES_SOUND_INFO, entry->id)) {
+        const unsigned char *info_data = module.payload(*info_entry, info_storage);
+        if (info_data and info_entry->size >= sizeof(info)) memcpy(&info, info_data, sizeof(info));
+      }
 
-      int e = sound_add_from_buffer(id,fdata,size);
-      if (e) DEBUG_MESSAGE("Failed to load sound " + std::to_string(i) + " error " + std::to_string(e), MESSAGE_TYPE::M_ERROR);
-      delete[] fdata;
+      void *buffer = const_cast<unsigned char*>(fdata);
+      int e = info.streamed ? sound_add_from_buffer_streamed(entry->id, buffer, entry->size)
+                            : sound_add_from_buffer(entry->id, buffer, entry->size);
+      if (e) DEBUG_MESSAGE("Failed to load sound " + std::to_string(entry->id) + " error " + std::to_string(e), MESSAGE_TYPE::M_ERROR);
     }
   }
 }
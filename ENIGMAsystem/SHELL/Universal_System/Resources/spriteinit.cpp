@@ -17,9 +17,8 @@
 
 #include "libEGMstd.h"
 #include "resinit.h"
+#include "resmodule.h"
 #include "sprites_internal.h"
-#include "Universal_System/zlib.h"
-#include "Platforms/General/fileio.h"
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
 #include "Widget_Systems/widgets_mandatory.h"
@@ -28,46 +27,31 @@
 #include <string>
 
 using enigma_user::toString;
+using namespace enigma::resource_module;
 
 namespace enigma
 {
-  void exe_loadsprs(FILE_t *exe)
+  void exe_loadsprs(const ResourceModule &module)
   {
-    int nullhere;
-    unsigned sprid, width, height, bbt, bbb, bbl, bbr, bbm, shape;
-    int xorig, yorig;
+    auto range = module.entries(RES_SPRITE);
+    if (range.first == range.second) return;
 
-    if (!fread_wrapper(&nullhere,4,1,exe)) return;
-    if (memcmp(&nullhere, "SPR ", sizeof(int)) != 0)
-      return;
+    // Entries are ordered by id, so the last holds the highest ID we will be using
+    sprites.resize((range.second - 1)->id + 1);
 
-    // Determine how many sprites we have
-    int sprcount;
-    if (!fread_wrapper(&sprcount,4,1,exe)) return;
-
-    // Fetch the highest ID we will be using
-    int spr_highid;
-    if (!fread_wrapper(&spr_highid,4,1,exe)) return;
-
-    if (sprcount == 0) return;
-    sprites.resize(spr_highid+1);
-
-    for (int i = 0; i < sprcount; i++)
+    std::vector<unsigned char> storage;
+    for (const TocEntry *entry = range.first; entry != range.second; ++entry)
     {
-      if (!fread_wrapper(&sprid, 4,1,exe)) return;
-      if (!fread_wrapper(&width, 4,1,exe)) return;
-      if (!fread_wrapper(&height,4,1,exe)) return;
-      if (!fread_wrapper(&xorig, 4,1,exe)) return;
-      if (!fread_wrapper(&yorig, 4,1,exe)) return;
-      if (!fread_wrapper(&bbt, 4,1,exe)) return;
-      if (!fread_wrapper(&bbb, 4,1,exe)) return;
-      if (!fread_wrapper(&bbl, 4,1,exe)) return;
-      if (!fread_wrapper(&bbr, 4,1,exe)) return;
-      if (!fread_wrapper(&bbm, 4,1,exe)) return;
-      if (!fread_wrapper(&shape, 4,1,exe)) return;
+      SpriteInfo info;
+      const unsigned char *data = module.payload(*entry, storage);
+      if (!data or entry->size < sizeof(info)) {
+        DEBUG_MESSAGE("Failed to load sprite " + toString(entry->id) + ": metrics are missing", MESSAGE_TYPE::M_ERROR);
+        continue;
+      }
+      memcpy(&info, data, sizeof(info));
 
       collision_type coll_type;
-      switch (shape)
+      switch (info.shape)
       {
         case ct_precise: coll_type = ct_precise; break;
         case ct_bbox: coll_type = ct_bbox; break;
@@ -78,37 +62,25 @@ namespace enigma
         default: coll_type = ct_bbox; break;
       };
 
-      int subimages;
-      if (!fread_wrapper(&subimages,4,1,exe)) return; //co//ut << "Subimages: " << subimages << endl;
+      Sprite spr(info.width, info.height, info.xorig, info.yorig);
+      spr.SetBBox(info.bbox_left, info.bbox_top, info.bbox_right-info.bbox_left, info.bbox_bottom-info.bbox_top);
 
-      Sprite spr(width, height, xorig, yorig);
-      spr.SetBBox(bbl, bbt, bbr-bbl, bbb-bbt);
-      
-      for (int ii=0;ii<subimages;ii++)
+      for (int ii = 0; ii < info.subimages; ii++)
       {
-        int unpacked;
-        if (!fread_wrapper(&unpacked,4,1,exe)) return;
-        unsigned int size;
-        if (!fread_wrapper(&size,4,1,exe)) return; //co//ut << "Alloc size: " << size << endl;
-        unsigned char* cpixels=new unsigned char[size+1];
-        if (!cpixels)
-        {  //FIXME: Uncomment these when tostring is available
-          DEBUG_MESSAGE("Failed to load sprite: Cannot allocate enough memory "+ toString(unpacked), MESSAGE_TYPE::M_ERROR);
-          break;
-        }
-        unsigned int sz2=fread_wrapper(cpixels,1,size,exe);
-        if (size!=sz2) {
-          DEBUG_MESSAGE("Failed to load sprite: Data is truncated before exe end. Read "+toString(sz2)+
-                                  " out of expected "+toString(size), MESSAGE_TYPE::M_ERROR);
-          return;
+        const TocEntry *image = module.find(RES_SPRITE_IMAGE, entry->id, ii);
+        const uint64_t unpacked = uint64_t(info.width) * info.height * 4;
+        if (!image or image->unpacked_size != unpacked)
+        {
+          DEBUG_MESSAGE("Sprite load error: Sprite does not match expected size", MESSAGE_TYPE::M_ERROR);
+          continue;
         }
         unsigned char* pixels=new unsigned char[unpacked+1];
-        if (zlib_decompress(cpixels,size,unpacked,pixels) != unpacked)
+        if (!module.decode(*image, pixels))
         {
-          DEBUG_MESSAGE("Sprite load error: Sprite does not match expected size", MESSAGE_TYPE::M_ERROR);
+          DEBUG_MESSAGE("Failed to load sprite: Subimage " + toString(ii) + " could not be decoded", MESSAGE_TYPE::M_ERROR);
+          delete[] pixels;
           continue;
         }
-        delete[] cpixels;
 
         unsigned char* collision_data = 0;
         switch (coll_type)
@@ -122,18 +94,10 @@ namespace enigma
           default: collision_data = 0; break;
         };
 
-        spr.AddSubimage(RawImage(pixels, width, height), coll_type, collision_data);
-        
-        if (!fread_wrapper(&nullhere,4,1,exe)) return;
-
-        if (nullhere)
-        {
-          DEBUG_MESSAGE("Sprite load error: Null terminator expected", MESSAGE_TYPE::M_ERROR);
-          break;
-        }
+        spr.AddSubimage(RawImage(pixels, info.width, info.height), coll_type, collision_data);
       }
-      
-      sprites.assign(sprid, std::move(spr));
+
+      sprites.assign(entry->id, std::move(spr));
     }
   }
 }
@@ -72,6 +72,13 @@ int buffer_base64_decode_ext(int buffer, std::string str, unsigned offset);
 std::string buffer_base64_encode(int buffer, unsigned offset, unsigned size);
 std::string buffer_md5(int buffer, unsigned offset, unsigned size);
 std::string buffer_sha1(int buffer, unsigned offset, unsigned size);
+// Not cryptographic, but far faster than md5 or sha1; a 16 digit hex string
+std::string buffer_xxhash64(int buffer, unsigned offset, unsigned size);
+double buffer_crc32(int buffer, unsigned offset, unsigned size);
+// zlib format; each returns a new grow buffer, or -1 on failure
+int buffer_compress(int buffer, unsigned offset, unsigned size);
+int buffer_decompress(int buffer);
+int buffer_decompress(int buffer, unsigned offset, unsigned size);
 
 void *buffer_get_address(int buffer);
 unsigned buffer_get_size(int buffer);
@@ -89,6 +96,9 @@ variant buffer_read(int buffer, int type);
 void buffer_fill(int buffer, unsigned offset, int type, variant value, unsigned size);
 void buffer_poke(int buffer, unsigned offset, int type, variant value);
 void buffer_write(int buffer, int type, variant value);
+// Write the first count elements of an array, or read count into a new one, in order
+void buffer_write_array(int buffer, int type, const var& values, unsigned count);
+var buffer_read_array(int buffer, int type, unsigned count);
 
 void game_save_buffer(int buffer);
 void game_load_buffer(int buffer);
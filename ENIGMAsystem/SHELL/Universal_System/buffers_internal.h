@@ -32,6 +32,9 @@ namespace enigma
     unsigned position;
     unsigned alignment;
     int type;
+    // Never shared with another buffer, unlike the id, which a new buffer
+    // takes once this one is deleted
+    unsigned long serial;
     
     BinaryBuffer(unsigned size);
     ~BinaryBuffer() = default;
@@ -40,6 +43,14 @@ namespace enigma
     void Seek(unsigned offset);  
     unsigned char ReadByte();
     void WriteByte(unsigned char byte);
+    // Copy size bytes from or to position and move past them. Where the bytes
+    // run past the end, they go a byte at a time, wrapping or growing as the
+    // buffer's type says; otherwise it's one memcpy.
+    void Read(void *dest, unsigned size);
+    void Write(const void *src, unsigned size);
+    // Write over what's at offset, leaving position alone: wrapping or growing
+    // as the buffer does, or cut off at the end of any other kind.
+    void WriteAt(unsigned offset, const void *src, unsigned size);
   };
   
   extern std::vector<BinaryBuffer*> buffers;
@@ -17,23 +17,31 @@
 
 #include "buffers.h"
 #include "buffers_internal.h"
+#include "hashing.h"
 #include "libEGMstd.h"
 
 #include "Resources/AssetArray.h" // TODO: start actually using for this resource
 #include "Graphics_Systems/graphics_mandatory.h"
 #include "Graphics_Systems/General/GSsurface.h"
+#include "Graphics_Systems/General/GSsurface_impl.h"
+#include "Graphics_Systems/General/GSprimitives.h"
 #include "Widget_Systems/widgets_mandatory.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <zlib.h>
 
 using std::string;
 
 namespace enigma {
 std::vector<BinaryBuffer*> buffers(0);
+static unsigned long next_serial = 1;  // 0 is for no buffer
 
 BinaryBuffer::BinaryBuffer(unsigned size) {
+  serial = next_serial++;
   data.resize(size, 0);
   position = 0;
   alignment = 1;
@@ -74,6 +82,40 @@ void BinaryBuffer::WriteByte(unsigned char byte) {
   Seek(position + 1);
 }
 
+void BinaryBuffer::Read(void *dest, unsigned size) {
+  if (!size) return;
+  // Up to the end, the byte-at-a-time seeks only matter after the last byte
+  if (position + size <= GetSize()) {
+    memcpy(dest, &data[position], size);
+    Seek(position + size);
+    return;
+  }
+  unsigned char *bytes = static_cast<unsigned char*>(dest);
+  for (unsigned i = 0; i < size; i++) bytes[i] = ReadByte();
+}
+
+void BinaryBuffer::Write(const void *src, unsigned size) {
+  // Grow as the writes a byte at a time would have, to one past the last byte
+  if (type == enigma_user::buffer_grow && position + size >= GetSize()) Resize(position + size + 1);
+  if (size && position + size <= GetSize()) {
+    memcpy(&data[position], src, size);
+    Seek(position + size);
+    return;
+  }
+  const unsigned char *bytes = static_cast<const unsigned char*>(src);
+  for (unsigned i = 0; i < size; i++) WriteByte(bytes[i]);
+}
+
+void BinaryBuffer::WriteAt(unsigned offset, const void *src, unsigned size) {
+  if (type != enigma_user::buffer_grow && type != enigma_user::buffer_wrap)
+    size = offset < GetSize() ? std::min(size, GetSize() - offset) : 0;
+  if (!size) return;
+  const unsigned start = position;
+  Seek(offset);
+  Write(src, size);
+  position = start;
+}
+
 int get_free_buffer() {
   for (unsigned i = 0; i < buffers.size(); i++) {
     if (!buffers[i]) {
@@ -83,12 +125,164 @@ int get_free_buffer() {
   return buffers.size();
 }
 
-std::vector<unsigned char> valToBytes(variant value, unsigned count) {
-  std::vector<unsigned char> result(0);
-  for (unsigned i = 0; i < count; i++) {
-    result.push_back(value >> ((i)*8));
+static float half_to_float(uint16_t h) {
+  const uint32_t sign = uint32_t(h & 0x8000) << 16;
+  int exponent = (h >> 10) & 0x1F;
+  uint32_t mantissa = h & 0x3FF, bits;
+  if (exponent == 0x1F) {  // Infinity or NaN
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  } else if (exponent) {
+    bits = sign | uint32_t(exponent + 112) << 23 | (mantissa << 13);
+  } else if (mantissa) {  // Subnormal; normalize it
+    exponent = 113;
+    while (!(mantissa & 0x400)) mantissa <<= 1, exponent--;
+    bits = sign | uint32_t(exponent) << 23 | ((mantissa & 0x3FF) << 13);
+  } else {
+    bits = sign;
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static uint16_t float_to_half(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  const uint16_t sign = (bits >> 16) & 0x8000;
+  const int exponent = int((bits >> 23) & 0xFF) - 112;
+  uint32_t mantissa = bits & 0x7FFFFF;
+  if (exponent >= 0x1F) {  // Too large, infinity, or NaN
+    return sign | 0x7C00 | ((bits & 0x7FFFFFFF) > 0x7F800000 ? 0x200 : 0);
+  }
+  if (exponent <= 0) {  // Subnormal, or too small
+    if (exponent < -10) return sign;
+    mantissa |= 0x800000;
+    const int shift = 14 - exponent;
+    uint32_t half = mantissa >> shift;
+    const uint32_t rest = mantissa & ((1u << shift) - 1), midway = 1u << (shift - 1);
+    if (rest > midway || (rest == midway && (half & 1))) half++;
+    return sign | half;
+  }
+  // Round to nearest even; a carry into the exponent is still correct
+  uint32_t half = uint32_t(exponent) << 10 | (mantissa >> 13);
+  const uint32_t rest = mantissa & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;
+  return sign | half;
+}
+
+template<typename T> static variant read_as(BinaryBuffer *binbuff) {
+  T value;
+  binbuff->Read(&value, sizeof(value));
+  return value;
+}
+
+template<typename T> static void write_as(BinaryBuffer *binbuff, T value) {
+  binbuff->Write(&value, sizeof(value));
+}
+
+// Integers are truncated toward zero, wrapping to the type's size as C does
+static inline int64_t to_integer(const variant &value) {
+  const double d = value;
+  return d >= 9223372036854775808.0 ? int64_t(uint64_t(d)) : int64_t(d);
+}
+
+// Values are stored little-endian, which is the byte order of every platform we build for
+variant read_value(BinaryBuffer *binbuff, int type) {
+  using namespace enigma_user;
+  switch (type) {
+    case buffer_u8:  return read_as<uint8_t>(binbuff);
+    case buffer_s8:  return read_as<int8_t>(binbuff);
+    case buffer_u16: return read_as<uint16_t>(binbuff);
+    case buffer_s16: return read_as<int16_t>(binbuff);
+    case buffer_u32: return read_as<uint32_t>(binbuff);
+    case buffer_s32: return read_as<int32_t>(binbuff);
+    case buffer_u64: return read_as<uint64_t>(binbuff);
+    case buffer_f32: return read_as<float>(binbuff);
+    case buffer_f64: return read_as<double>(binbuff);
+    case buffer_bool: {
+      uint8_t b;
+      binbuff->Read(&b, sizeof(b));
+      return bool(b);
+    }
+    case buffer_f16: {
+      uint16_t h;
+      binbuff->Read(&h, sizeof(h));
+      return half_to_float(h);
+    }
+    case buffer_string: case buffer_text: {
+      if (binbuff->position < binbuff->GetSize()) {
+        const unsigned char *start = &binbuff->data[binbuff->position];
+        const void *end = memchr(start, 0, binbuff->GetSize() - binbuff->position);
+        if (end) {
+          const size_t length = static_cast<const unsigned char*>(end) - start;
+          string str(reinterpret_cast<const char*>(start), length);
+          binbuff->Seek(binbuff->position + length + 1);
+          return str;
+        }
+      }
+      // Unterminated before the end; wrap or grow one byte at a time, but
+      // never past the end of a fixed buffer or more than once around a wrap
+      string str;
+      for (char byte; binbuff->position < binbuff->GetSize() && str.size() < binbuff->GetSize() &&
+                      (byte = binbuff->ReadByte()); )
+        str += byte;
+      return str;
+    }
+    default:
+      return 0;
+  }
+}
+
+void write_value(BinaryBuffer *binbuff, int type, const variant &value) {
+  using namespace enigma_user;
+  switch (type) {
+    case buffer_u8:  case buffer_s8:  write_as<uint8_t>(binbuff, to_integer(value)); break;
+    case buffer_u16: case buffer_s16: write_as<uint16_t>(binbuff, to_integer(value)); break;
+    case buffer_u32: case buffer_s32: write_as<uint32_t>(binbuff, to_integer(value)); break;
+    case buffer_u64: write_as<uint64_t>(binbuff, to_integer(value)); break;
+    case buffer_f16: write_as<uint16_t>(binbuff, float_to_half(float(double(value)))); break;
+    case buffer_f32: write_as<float>(binbuff, float(double(value))); break;
+    case buffer_f64: write_as<double>(binbuff, double(value)); break;
+    case buffer_bool: write_as<uint8_t>(binbuff, bool(value)); break;
+    case buffer_string: case buffer_text: {
+      const string str = value.to_string();
+      // Text is written without the terminating null
+      const unsigned size = str.length() + (type == buffer_string);
+      binbuff->Write(str.c_str(), size);
+      if (binbuff->alignment > size) {
+        for (unsigned i = 0; i < binbuff->alignment - size; i++) {
+          binbuff->WriteByte(0);
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// Calls f(bytes, count) for each contiguous run of the given range. A range
+// running off the end of a wrap buffer continues from the start; any other
+// buffer cuts it short.
+template<typename F> static void for_each_span(BinaryBuffer *binbuff, unsigned offset, unsigned size, F f) {
+  const unsigned total = binbuff->GetSize();
+  if (!total) return;
+  if (binbuff->type != enigma_user::buffer_wrap) {
+    if (offset < total) f(&binbuff->data[offset], std::min(size, total - offset));
+    return;
+  }
+  for (offset %= total; size; offset = 0) {
+    const unsigned count = std::min(size, total - offset);
+    f(&binbuff->data[offset], count);
+    size -= count;
   }
-  return result;
+}
+
+// Wraps bytes made by one of the functions below in a new grow buffer.
+static int new_buffer(std::vector<unsigned char> &&data) {
+  const int id = enigma_user::buffer_create(0, enigma_user::buffer_grow, 1);
+  buffers[id]->data.swap(data);
+  return id;
 }
 }  // namespace enigma
 
@@ -173,49 +367,39 @@ void buffer_save_ext(int buffer, string filename, unsigned offset, unsigned size
   myfile.close();
 }
 
+// Reads the whole file in one read
+static bool read_file(const string &filename, std::vector<unsigned char> &data) {
+  std::ifstream myfile(filename.c_str(), std::ios::binary | std::ios::ate);
+  if (!myfile.is_open()) {
+    DEBUG_MESSAGE("Unable to open file " + filename, MESSAGE_TYPE::M_ERROR);
+    return false;
+  }
+  data.resize(myfile.tellg());
+  myfile.seekg(0);
+  myfile.read(reinterpret_cast<char*>(data.data()), data.size());
+  data.resize(myfile.gcount());
+  return true;
+}
+
 int buffer_load(string filename) {
   enigma::BinaryBuffer* buffer = new enigma::BinaryBuffer(0);
+  if (!read_file(filename, buffer->data)) {
+    delete buffer;
+    return -1;
+  }
   buffer->type = buffer_grow;
   buffer->alignment = 1;
   int id = enigma::get_free_buffer();
   enigma::buffers.insert(enigma::buffers.begin() + id, buffer);
-
-  std::ifstream myfile(filename.c_str());
-  if (!myfile.is_open()) {
-    DEBUG_MESSAGE("Unable to open file " + filename, MESSAGE_TYPE::M_ERROR);
-    return -1;
-  }
-  myfile.read(reinterpret_cast<char*>(&buffer->data[0]), myfile.tellg());
-  myfile.close();
-
   return id;
 }
 
 void buffer_load_ext(int buffer, string filename, unsigned offset) {
   get_buffer(binbuff, buffer);
 
-  std::ifstream myfile(filename.c_str());
-  if (!myfile.is_open()) {
-    DEBUG_MESSAGE("Unable to open file " + filename, MESSAGE_TYPE::M_ERROR);
-    return;
-  }
-  std::vector<char> data;
-  myfile.read(reinterpret_cast<char*>(&data[0]), myfile.tellg());
-  unsigned over = data.size() - binbuff->GetSize();
-  switch (binbuff->type) {
-    case buffer_wrap:
-      binbuff->data.insert(binbuff->data.begin() + offset, data.begin(), data.end() - over);
-      binbuff->data.insert(binbuff->data.begin(), data.begin(), data.begin() + over);
-      break;
-    case buffer_grow:
-      binbuff->data.insert(binbuff->data.begin() + offset, data.begin(), data.end());
-      break;
-    default:
-      binbuff->data.insert(binbuff->data.begin() + offset, data.begin(), data.end() - over);
-      break;
-  }
-
-  myfile.close();
+  std::vector<unsigned char> data;
+  if (!read_file(filename, data)) return;
+  binbuff->WriteAt(offset, data.data(), data.size());
 }
 
 void buffer_fill(int buffer, unsigned offset, int type, variant value, unsigned size) {
@@ -263,17 +447,37 @@ int buffer_get_type(int buffer) {
 }
 
 void buffer_get_surface(int buffer, int surface, int mode, unsigned offset, int modulo) {
-  //get_buffer(binbuff, buffer);
-  //TODO: Write this function
-  DEBUG_MESSAGE("Function unimplemented: buffer_get_surface", MESSAGE_TYPE::M_WARNING);
+  get_buffer(binbuff, buffer);
+  if (!surface_exists(surface)) return;
+  draw_batch_flush(batch_flush_deferred);
+  const int wid = surface_get_width(surface), hgt = surface_get_height(surface);
+  unsigned char* pxdata = enigma::graphics_copy_texture_pixels(surface_get_texture(surface), 0, 0, wid, hgt);
+  if (!pxdata) return;
+
+  // Pixels come BGRA; grayscale and mask keep one byte of each
+  const unsigned bpp = mode == buffer_surface_copy ? 4 : 1;
+  std::vector<unsigned char> row(wid * bpp);
+  for (int y = 0; y < hgt; ++y) {
+    const unsigned char* src = pxdata + size_t(y) * wid * 4;
+    if (mode == buffer_surface_copy) {
+      std::copy(src, src + wid * 4, row.begin());
+    } else {
+      for (int x = 0; x < wid; ++x, src += 4)
+        row[x] = mode == buffer_surface_mask ? src[3] : (src[2] * 77 + src[1] * 151 + src[0] * 28) >> 8;
+    }
+    binbuff->WriteAt(offset, row.data(), row.size());
+    offset += row.size() + modulo;
+  }
+  delete[] pxdata;
 }
 
 void buffer_set_surface(int buffer, int surface, int mode, unsigned offset, int modulo) {
   int tex = surface_get_texture(surface);
   int wid = surface_get_width(surface);
   int hgt = surface_get_height(surface);
-  if (buffer_get_size(buffer) == buffer_sizeof(buffer_u64) * wid * hgt) {
+  if (buffer_get_size(buffer) == buffer_sizeof(buffer_u32) * wid * hgt) {
     enigma::graphics_push_texture_pixels(tex, wid, hgt, (unsigned char *)buffer_get_address(buffer));
+    enigma::surface_contents_changed(surface);
   } else { // execution can not continue safely with wrong buffer size
     DEBUG_MESSAGE("Buffer allocated with wrong length!", MESSAGE_TYPE::M_WARNING);
   }
@@ -323,24 +527,7 @@ int buffer_tell(int buffer) {
 variant buffer_peek(int buffer, unsigned offset, int type) {
   get_bufferr(binbuff, buffer, -1);
   binbuff->Seek(offset);
-  if (type != buffer_string) {
-    //unsigned dsize = buffer_sizeof(type) + binbuff->alignment - 1;
-    //NOTE: These buffers most likely need a little more code added to take care of endianess on different architectures.
-    //TODO: Fix floating point precision.
-    long res = 0;
-    for (unsigned i = 0; i < buffer_sizeof(type); i++) {
-      res += binbuff->ReadByte() << i * 8;
-    }
-    return res;
-  } else {
-    char byte = '1';
-    std::vector<char> data;
-    while (byte != 0x00) {
-      byte = binbuff->ReadByte();
-      data.push_back(byte);
-    }
-    return variant(&data[0]);
-  }
+  return enigma::read_value(binbuff, type);
 }
 
 variant buffer_read(int buffer, int type) {
@@ -351,27 +538,7 @@ variant buffer_read(int buffer, int type) {
 void buffer_poke(int buffer, unsigned offset, int type, variant value) {
   get_buffer(binbuff, buffer);
   binbuff->Seek(offset);
-  if (type != buffer_string) {
-    //TODO: Implement buffer alignment.
-    //unsigned dsize = buffer_sizeof(type); //+ binbuff->alignment - 1;
-    std::vector<unsigned char> data = enigma::valToBytes(value, buffer_sizeof(type));
-    for (unsigned i = 0; i < data.size(); i++) {
-      binbuff->WriteByte(data[i]);
-    }
-  } else {
-    char byte = '1';
-    unsigned pos = 0;
-    while (byte != 0x00) {
-      byte = value[pos];
-      pos += 1;
-      binbuff->WriteByte(byte);
-    }
-    if (binbuff->alignment > pos) {
-      for (unsigned i = 0; i < binbuff->alignment - pos; i++) {
-        binbuff->WriteByte(0);
-      }
-    }
-  }
+  enigma::write_value(binbuff, type, value);
 }
 
 void buffer_write(int buffer, int type, variant value) {
@@ -379,38 +546,165 @@ void buffer_write(int buffer, int type, variant value) {
   buffer_poke(buffer, binbuff->position, type, value);
 }
 
+void buffer_write_array(int buffer, int type, const var& values, unsigned count) {
+  get_buffer(binbuff, buffer);
+  binbuff->Seek(binbuff->position);
+  // Grow once up front rather than once per value
+  const unsigned size = buffer_sizeof(type) * count;
+  if (binbuff->type == buffer_grow && binbuff->position + size >= binbuff->GetSize()) {
+    binbuff->Resize(binbuff->position + size + 1);
+  }
+  for (unsigned i = 0; i < count; i++) {
+    enigma::write_value(binbuff, type, values[i]);
+  }
+}
+
+var buffer_read_array(int buffer, int type, unsigned count) {
+  var values(0, count);
+  get_bufferr(binbuff, buffer, values);
+  binbuff->Seek(binbuff->position);
+  for (unsigned i = 0; i < count; i++) {
+    values[i] = enigma::read_value(binbuff, type);
+  }
+  return values;
+}
+
 string buffer_md5(int buffer, unsigned offset, unsigned size) {
-  //get_bufferr(binbuff, buffer, 0);
-  //TODO: Write this function
-  return NULL;
+  get_bufferr(binbuff, buffer, "");
+  enigma::MD5 hash;
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    hash.update(bytes, count);
+  });
+  return hash.hex_digest();
 }
 
 string buffer_sha1(int buffer, unsigned offset, unsigned size) {
-  //get_bufferr(binbuff, buffer, 0);
-  //TODO: Write this function
-  return NULL;
+  get_bufferr(binbuff, buffer, "");
+  enigma::SHA1 hash;
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    hash.update(bytes, count);
+  });
+  return hash.hex_digest();
+}
+
+string buffer_xxhash64(int buffer, unsigned offset, unsigned size) {
+  get_bufferr(binbuff, buffer, "");
+  enigma::XXH64 hash;
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    hash.update(bytes, count);
+  });
+  char digest[17];
+  snprintf(digest, sizeof(digest), "%016llx", (unsigned long long) hash.digest());
+  return digest;
+}
+
+double buffer_crc32(int buffer, unsigned offset, unsigned size) {
+  get_bufferr(binbuff, buffer, 0);
+  uLong crc = crc32(0, Z_NULL, 0);
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    crc = crc32(crc, bytes, count);
+  });
+  return crc;
 }
 
 int buffer_base64_decode(string str) {
-  enigma::BinaryBuffer* buffer = new enigma::BinaryBuffer(0);
-  buffer->type = buffer_grow;
-  buffer->alignment = 1;
-  int id = enigma::get_free_buffer();
-  enigma::buffers.insert(enigma::buffers.begin() + id, buffer);
-  //TODO: Write this function
-  return id;
+  std::vector<unsigned char> data;
+  if (!enigma::base64_decode(str, data)) {
+    DEBUG_MESSAGE("buffer_base64_decode: the string is not valid base64", MESSAGE_TYPE::M_USER_ERROR);
+    return -1;
+  }
+  return enigma::new_buffer(std::move(data));
 }
 
 int buffer_base64_decode_ext(int buffer, string str, unsigned offset) {
-  //get_bufferr(binbuff, buffer, -1);
-  //TODO: Write this function
-  return 0;
+  get_bufferr(binbuff, buffer, -1);
+  std::vector<unsigned char> data;
+  if (!enigma::base64_decode(str, data)) {
+    DEBUG_MESSAGE("buffer_base64_decode_ext: the string is not valid base64", MESSAGE_TYPE::M_USER_ERROR);
+    return -1;
+  }
+  binbuff->Seek(offset);
+  if (!data.empty()) binbuff->Write(&data[0], data.size());
+  return data.size();
 }
 
 string buffer_base64_encode(int buffer, unsigned offset, unsigned size) {
-  //get_bufferr(binbuff, buffer, 0);
-  //TODO: Write this function
-  return NULL;
+  get_bufferr(binbuff, buffer, "");
+  enigma::Base64Encoder encoder;
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    encoder.update(bytes, count);
+  });
+  return encoder.finish();
+}
+
+int buffer_compress(int buffer, unsigned offset, unsigned size) {
+  get_bufferr(binbuff, buffer, -1);
+  z_stream stream = {};
+  if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    DEBUG_MESSAGE("buffer_compress: zlib failed to initialize", MESSAGE_TYPE::M_ERROR);
+    return -1;
+  }
+  // Sized for the worst case up front, so this should only ever deflate once per run
+  std::vector<unsigned char> out(deflateBound(&stream, size));
+  int status = Z_OK;
+  auto run = [&](const unsigned char *bytes, unsigned count, int flush) {
+    stream.next_in = const_cast<Bytef*>(bytes);
+    stream.avail_in = count;
+    do {
+      if (stream.total_out == out.size()) out.resize(out.size() * 2);
+      stream.next_out = &out[stream.total_out];
+      stream.avail_out = out.size() - stream.total_out;
+      status = deflate(&stream, flush);
+    } while (status == Z_OK && (stream.avail_in || flush == Z_FINISH));
+  };
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    run(bytes, count, Z_NO_FLUSH);
+  });
+  run(nullptr, 0, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    DEBUG_MESSAGE("buffer_compress: zlib failed to compress the buffer", MESSAGE_TYPE::M_ERROR);
+    return -1;
+  }
+  return enigma::new_buffer(std::move(out));
+}
+
+int buffer_decompress(int buffer) {
+  get_bufferr(binbuff, buffer, -1);
+  return buffer_decompress(buffer, 0, binbuff->GetSize());
+}
+
+int buffer_decompress(int buffer, unsigned offset, unsigned size) {
+  get_bufferr(binbuff, buffer, -1);
+  z_stream stream = {};
+  if (inflateInit(&stream) != Z_OK) {
+    DEBUG_MESSAGE("buffer_decompress: zlib failed to initialize", MESSAGE_TYPE::M_ERROR);
+    return -1;
+  }
+  // Doubling from a guess of 4:1 keeps the number of passes small
+  std::vector<unsigned char> out(std::max(size * 4, 256u));
+  int status = Z_OK;
+  enigma::for_each_span(binbuff, offset, size, [&](const unsigned char *bytes, unsigned count) {
+    stream.next_in = const_cast<Bytef*>(bytes);
+    stream.avail_in = count;
+    // Output may still be pending once the input is used up, if it filled `out`
+    while (status == Z_OK && (stream.avail_in || !stream.avail_out)) {
+      if (stream.total_out == out.size()) out.resize(out.size() * 2);
+      stream.next_out = &out[stream.total_out];
+      stream.avail_out = out.size() - stream.total_out;
+      status = inflate(&stream, Z_NO_FLUSH);
+    }
+    // Z_BUF_ERROR here just means this run of input is used up
+    if (status == Z_BUF_ERROR) status = Z_OK;
+  });
+  out.resize(stream.total_out);
+  inflateEnd(&stream);
+  if (status != Z_STREAM_END) {
+    DEBUG_MESSAGE("buffer_decompress: the buffer does not hold complete zlib data", MESSAGE_TYPE::M_USER_ERROR);
+    return -1;
+  }
+  return enigma::new_buffer(std::move(out));
 }
 
 void game_save_buffer(int buffer) {
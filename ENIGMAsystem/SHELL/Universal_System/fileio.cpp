@@ -19,8 +19,12 @@
 
 #include "Platforms/General/fileio.h"
 #include "Resources/AssetArray.h"
+#include "Universal_System/buffers.h"
+#include "Universal_System/buffers_internal.h"
+#include "Universal_System/estring.h"
 #include "Widget_Systems/widgets_mandatory.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -123,18 +127,28 @@ void file_text_writeln(int fileid, const std::string& str) {
 std::string file_text_read_string(int fileid) {
   std::string line;
   if (std::getline(enigma::files.get(fileid).fs, line)) {
-    enigma::files.get(fileid).fs.unget();
+    // Leave the newline for readln; a last line without one has nothing to put back
+    if (!enigma::files.get(fileid).fs.eof()) enigma::files.get(fileid).fs.unget();
     try_io_and_print(enigma::files.get(fileid))
   }
   return line;
 }
 
+// Reads the rest of the file, newlines and all, in one read.
 std::string file_text_read_all(int fileid) {
-  std::string all, line;
-  while(std::getline(enigma::files.get(fileid).fs, line)) {
-    try_io_and_print(enigma::files.get(fileid))
-    all += line;
-  }
+  std::fstream& fs = enigma::files.get(fileid).fs;
+  std::string all;
+  const std::streampos start = fs.tellg();
+  if (start == std::streampos(-1)) return all;
+  fs.seekg(0, std::ios::end);
+  const std::streamoff length = fs.tellg() - start;
+  fs.seekg(start);
+  all.resize(length);
+  // Text mode may turn line ends into fewer characters than the bytes counted
+  fs.read(&all[0], length);
+  all.resize(fs.gcount());
+  fs.peek();  // At the end now, so file_text_eof says so
+  try_io_and_print(enigma::files.get(fileid))
   return all;
 }
 
@@ -213,17 +227,59 @@ void file_bin_seek(int fileid, size_t pos) {
 
 // Writes a byte of data to the file with the given file id.
 void file_bin_write_byte(int fileid, unsigned char byte) {
-  enigma::files.get(fileid).fs << byte;
+  // Straight to the stream's buffer, flagging failure as << would
+  std::fstream& fs = enigma::files.get(fileid).fs;
+  if (!fs.good()) fs.setstate(std::ios::failbit);
+  else if (fs.rdbuf()->sputc(byte) == EOF) fs.setstate(std::ios::badbit);
   try_io_and_print(enigma::files.get(fileid))
 }
 
 // Reads a byte of data from the file and returns this
 int file_bin_read_byte(int fileid) {
-  unsigned char byte = 0;
-  enigma::files.get(fileid).fs >> std::noskipws >> byte;
-  bool good = enigma::files.get(fileid).fs.good();
+  // Straight from the stream's buffer, rather than through a sentry and
+  // formatted extraction for every byte; failure is flagged as >> would
+  std::fstream& fs = enigma::files.get(fileid).fs;
+  int byte = -1;
+  if (!fs.good()) fs.setstate(std::ios::failbit);
+  else if ((byte = fs.rdbuf()->sbumpc()) == EOF) {
+    byte = -1;
+    fs.setstate(std::ios::eofbit | std::ios::failbit);
+  }
+  try_io_and_print(enigma::files.get(fileid))
+  return byte;
+}
+
+// Reads up to size bytes from the file's position into the buffer at offset, in one
+// read, and returns how many it got. A grow buffer grows to fit them; other buffers
+// take what fits before their end.
+unsigned file_bin_read_buffer(int fileid, int buffer, unsigned offset, unsigned size) {
+  get_bufferr(binbuff, buffer, 0);
+  std::fstream& fs = enigma::files.get(fileid).fs;
+  const unsigned old_size = binbuff->GetSize();
+  if (binbuff->type == buffer_grow && offset + size > old_size) binbuff->Resize(offset + size);
+  size = offset < binbuff->GetSize() ? std::min(size, binbuff->GetSize() - offset) : 0;
+  if (!size) return 0;
+  fs.read(reinterpret_cast<char*>(&binbuff->data[offset]), size);
+  const unsigned read = fs.gcount();
+  if (binbuff->type == buffer_grow && offset + read < binbuff->GetSize())
+    binbuff->Resize(std::max(old_size, offset + read));
+  // Running out of file partway isn't a failure here; it just ends the read
+  if (read < size && fs.eof()) fs.clear(std::ios::eofbit);
+  try_io_and_print(enigma::files.get(fileid))
+  return read;
+}
+
+// Writes size bytes of the buffer from offset, or as many as it has, to the file in
+// one write, and returns how many it wrote.
+unsigned file_bin_write_buffer(int fileid, int buffer, unsigned offset, unsigned size) {
+  get_bufferr(binbuff, buffer, 0);
+  std::fstream& fs = enigma::files.get(fileid).fs;
+  size = offset < binbuff->GetSize() ? std::min(size, binbuff->GetSize() - offset) : 0;
+  if (!size) return 0;
+  fs.write(reinterpret_cast<const char*>(&binbuff->data[offset]), size);
+  const bool good = fs.good();
   try_io_and_print(enigma::files.get(fileid))
-  return (!good) ? -1 : static_cast<int>(byte);
+  return good ? size : 0;
 }
 
 } // NAMESPACE enigma_user
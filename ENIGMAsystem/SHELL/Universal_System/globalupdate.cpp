@@ -27,7 +27,11 @@
 
 #include "Audio_Systems/audio_mandatory.h"
 #include "Platforms/platforms_mandatory.h"
+#include "Instances/instance_index.h"
 
 namespace enigma {
-void update_globals() { audiosystem_update(); }
+void update_globals() {
+  audiosystem_update();
+  instance_index_generation++;  // Instances may have moved during the event
+}
 }  // namespace enigma
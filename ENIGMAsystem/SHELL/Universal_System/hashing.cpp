@@ -0,0 +1,282 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "hashing.h"
+
+#include <array>
+#include <cstring>
+
+namespace enigma {
+
+namespace {
+
+inline uint32_t rotl32(uint32_t x, int r) { return (x << r) | (x >> (32 - r)); }
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint32_t load_le32(const unsigned char *p) {
+  return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+inline uint64_t load_le64(const unsigned char *p) {
+  return uint64_t(load_le32(p)) | uint64_t(load_le32(p + 4)) << 32;
+}
+inline uint32_t load_be32(const unsigned char *p) {
+  return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | uint32_t(p[3]);
+}
+
+std::string hex(const unsigned char *bytes, size_t size) {
+  static const char digits[] = "0123456789abcdef";
+  std::string out(size * 2, '0');
+  for (size_t i = 0; i < size; ++i) {
+    out[i * 2] = digits[bytes[i] >> 4];
+    out[i * 2 + 1] = digits[bytes[i] & 15];
+  }
+  return out;
+}
+
+// Shared by MD5 and SHA1: both hash 64 byte blocks, holding back a partial one.
+template<typename B> void update_blocks(B block, unsigned char *pending, uint64_t &length,
+                                        const void *data, size_t size) {
+  const unsigned char *p = static_cast<const unsigned char*>(data);
+  size_t have = length % 64;
+  length += size;
+  if (have) {
+    const size_t take = size < 64 - have ? size : 64 - have;
+    memcpy(pending + have, p, take);
+    p += take, size -= take, have += take;
+    if (have < 64) return;
+    block(pending);
+  }
+  for (; size >= 64; p += 64, size -= 64) block(p);
+  memcpy(pending, p, size);
+}
+
+// Appends 0x80, zeros, and the bit length in the last 8 bytes of a block.
+template<typename B> void pad_blocks(B block, unsigned char *pending, uint64_t length, bool big_endian) {
+  size_t have = length % 64;
+  pending[have++] = 0x80;
+  if (have > 56) {
+    memset(pending + have, 0, 64 - have);
+    block(pending);
+    have = 0;
+  }
+  memset(pending + have, 0, 56 - have);
+  const uint64_t bits = length * 8;
+  for (int i = 0; i < 8; ++i)
+    pending[56 + i] = uint8_t(bits >> (big_endian ? 56 - i * 8 : i * 8));
+  block(pending);
+}
+
+const uint64_t kPrime64[5] = {
+  11400714785074694791ULL, 14029467366897019727ULL, 1609587929392839161ULL,
+  9650029242287828579ULL, 2870177450012600261ULL
+};
+
+inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+  return rotl64(acc + input * kPrime64[1], 31) * kPrime64[0];
+}
+inline uint64_t xxh64_merge(uint64_t hash, uint64_t acc) {
+  return (hash ^ xxh64_round(0, acc)) * kPrime64[0] + kPrime64[3];
+}
+
+const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+} // namespace
+
+MD5::MD5(): state_{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476}, length_(0) {}
+
+void MD5::block(const unsigned char *p) {
+  static const uint32_t k[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+  };
+  static const int shift[4][4] = {{7, 12, 17, 22}, {5, 9, 14, 20}, {4, 11, 16, 23}, {6, 10, 15, 21}};
+
+  uint32_t m[16];
+  for (int i = 0; i < 16; ++i) m[i] = load_le32(p + i * 4);
+  uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+  for (int i = 0; i < 64; ++i) {
+    uint32_t f;
+    int g;
+    switch (i / 16) {
+      case 0:  f = (b & c) | (~b & d); g = i;               break;
+      case 1:  f = (d & b) | (~d & c); g = (5 * i + 1) % 16; break;
+      case 2:  f = b ^ c ^ d;          g = (3 * i + 5) % 16; break;
+      default: f = c ^ (b | ~d);       g = (7 * i) % 16;     break;
+    }
+    const uint32_t next = d;
+    d = c, c = b;
+    b += rotl32(a + f + k[i] + m[g], shift[i / 16][i % 4]);
+    a = next;
+  }
+  state_[0] += a, state_[1] += b, state_[2] += c, state_[3] += d;
+}
+
+void MD5::update(const void *data, size_t size) {
+  update_blocks([this](const unsigned char *p) { block(p); }, pending_, length_, data, size);
+}
+
+std::string MD5::hex_digest() {
+  pad_blocks([this](const unsigned char *p) { block(p); }, pending_, length_, false);
+  unsigned char out[16];
+  for (int i = 0; i < 16; ++i) out[i] = uint8_t(state_[i / 4] >> (i % 4 * 8));
+  return hex(out, sizeof(out));
+}
+
+SHA1::SHA1(): state_{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0}, length_(0) {}
+
+void SHA1::block(const unsigned char *p) {
+  uint32_t w[80];
+  for (int i = 0; i < 16; ++i) w[i] = load_be32(p + i * 4);
+  for (int i = 16; i < 80; ++i) w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+  uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3], e = state_[4];
+  for (int i = 0; i < 80; ++i) {
+    uint32_t f, k;
+    switch (i / 20) {
+      case 0:  f = (b & c) | (~b & d);          k = 0x5a827999; break;
+      case 1:  f = b ^ c ^ d;                   k = 0x6ed9eba1; break;
+      case 2:  f = (b & c) | (b & d) | (c & d); k = 0x8f1bbcdc; break;
+      default: f = b ^ c ^ d;                   k = 0xca62c1d6; break;
+    }
+    const uint32_t t = rotl32(a, 5) + f + e + k + w[i];
+    e = d, d = c, c = rotl32(b, 30), b = a, a = t;
+  }
+  state_[0] += a, state_[1] += b, state_[2] += c, state_[3] += d, state_[4] += e;
+}
+
+void SHA1::update(const void *data, size_t size) {
+  update_blocks([this](const unsigned char *p) { block(p); }, pending_, length_, data, size);
+}
+
+std::string SHA1::hex_digest() {
+  pad_blocks([this](const unsigned char *p) { block(p); }, pending_, length_, true);
+  unsigned char out[20];
+  for (int i = 0; i < 20; ++i) out[i] = uint8_t(state_[i / 4] >> (24 - i % 4 * 8));
+  return hex(out, sizeof(out));
+}
+
+XXH64::XXH64(uint64_t seed):
+    acc_{seed + kPrime64[0] + kPrime64[1], seed + kPrime64[1], seed, seed - kPrime64[0]},
+    seed_(seed), length_(0) {}
+
+void XXH64::update(const void *data, size_t size) {
+  const unsigned char *p = static_cast<const unsigned char*>(data);
+  size_t have = length_ % 32;
+  length_ += size;
+  if (have) {
+    const size_t take = size < 32 - have ? size : 32 - have;
+    memcpy(pending_ + have, p, take);
+    p += take, size -= take, have += take;
+    if (have < 32) return;
+    for (int i = 0; i < 4; ++i) acc_[i] = xxh64_round(acc_[i], load_le64(pending_ + i * 8));
+  }
+  for (; size >= 32; p += 32, size -= 32) {
+    for (int i = 0; i < 4; ++i) acc_[i] = xxh64_round(acc_[i], load_le64(p + i * 8));
+  }
+  memcpy(pending_, p, size);
+}
+
+uint64_t XXH64::digest() const {
+  uint64_t h;
+  if (length_ >= 32) {
+    h = rotl64(acc_[0], 1) + rotl64(acc_[1], 7) + rotl64(acc_[2], 12) + rotl64(acc_[3], 18);
+    for (int i = 0; i < 4; ++i) h = xxh64_merge(h, acc_[i]);
+  } else {
+    h = seed_ + kPrime64[4];
+  }
+  h += length_;
+
+  const unsigned char *p = pending_, *end = pending_ + length_ % 32;
+  for (; p + 8 <= end; p += 8) h = rotl64(h ^ xxh64_round(0, load_le64(p)), 27) * kPrime64[0] + kPrime64[3];
+  if (p + 4 <= end) {
+    h = rotl64(h ^ (load_le32(p) * kPrime64[0]), 23) * kPrime64[1] + kPrime64[2];
+    p += 4;
+  }
+  for (; p < end; ++p) h = rotl64(h ^ (*p * kPrime64[4]), 11) * kPrime64[0];
+
+  h ^= h >> 33, h *= kPrime64[1];
+  h ^= h >> 29, h *= kPrime64[2];
+  return h ^ (h >> 32);
+}
+
+void Base64Encoder::update(const void *data, size_t size) {
+  const unsigned char *p = static_cast<const unsigned char*>(data);
+  out_.reserve(out_.size() + (pending_size_ + size) / 3 * 4);
+  if (pending_size_) {
+    while (pending_size_ < 3 && size) pending_[pending_size_++] = *p++, --size;
+    if (pending_size_ < 3) return;
+    encode_group(pending_);
+  }
+  for (; size >= 3; p += 3, size -= 3) encode_group(p);
+  memcpy(pending_, p, size);
+  pending_size_ = size;
+}
+
+void Base64Encoder::encode_group(const unsigned char *p) {
+  const uint32_t bits = uint32_t(p[0]) << 16 | uint32_t(p[1]) << 8 | p[2];
+  const char chars[4] = {kBase64[bits >> 18], kBase64[bits >> 12 & 63], kBase64[bits >> 6 & 63], kBase64[bits & 63]};
+  out_.append(chars, 4);
+}
+
+std::string Base64Encoder::finish() {
+  if (pending_size_) {
+    const uint32_t bits = uint32_t(pending_[0]) << 16 | (pending_size_ > 1 ? uint32_t(pending_[1]) << 8 : 0);
+    out_ += kBase64[bits >> 18];
+    out_ += kBase64[bits >> 12 & 63];
+    out_ += pending_size_ > 1 ? kBase64[bits >> 6 & 63] : '=';
+    out_ += '=';
+    pending_size_ = 0;
+  }
+  return std::move(out_);
+}
+
+bool base64_decode(const std::string &text, std::vector<unsigned char> &out) {
+  static const std::array<signed char, 256> value = [] {
+    std::array<signed char, 256> table;
+    table.fill(-1);
+    for (int i = 0; i < 64; ++i) table[uint8_t(kBase64[i])] = i;
+    return table;
+  }();
+
+  out.reserve(out.size() + text.size() / 4 * 3);
+  uint32_t bits = 0;
+  int count = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    const unsigned char c = text[i];
+    if (c == '=') break;
+    if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+    if (value[c] < 0) return false;
+    bits = bits << 6 | value[c];
+    if (++count == 4) {
+      out.push_back(uint8_t(bits >> 16));
+      out.push_back(uint8_t(bits >> 8));
+      out.push_back(uint8_t(bits));
+      bits = 0, count = 0;
+    }
+  }
+  // A trailing 2 or 3 characters carry 1 or 2 more bytes; a lone one is malformed
+  if (count == 1) return false;
+  if (count >= 2) out.push_back(uint8_t(bits >> (count == 2 ? 4 : 10)));
+  if (count == 3) out.push_back(uint8_t(bits >> 2));
+  return true;
+}
+
+} //namespace enigma
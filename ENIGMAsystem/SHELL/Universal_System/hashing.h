@@ -0,0 +1,93 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_HASHING_H
+#define ENIGMA_HASHING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Incremental hashes and base64. Each takes its input through update() in as
+// many pieces as is convenient (say, the two halves of a wrapped buffer range),
+// so nothing has to be copied into one contiguous block first.
+
+namespace enigma {
+
+class MD5 {
+ public:
+  MD5();
+  void update(const void *data, size_t size);
+  /// Finishes the hash; the object must not be updated afterward.
+  std::string hex_digest();
+
+ private:
+  void block(const unsigned char *p);
+  uint32_t state_[4];
+  uint64_t length_;
+  unsigned char pending_[64];
+};
+
+class SHA1 {
+ public:
+  SHA1();
+  void update(const void *data, size_t size);
+  /// Finishes the hash; the object must not be updated afterward.
+  std::string hex_digest();
+
+ private:
+  void block(const unsigned char *p);
+  uint32_t state_[5];
+  uint64_t length_;
+  unsigned char pending_[64];
+};
+
+/// XXH64: not cryptographic, but several times faster than either of the
+/// above, for integrity checks where nobody is forging the data.
+class XXH64 {
+ public:
+  explicit XXH64(uint64_t seed = 0);
+  void update(const void *data, size_t size);
+  /// May be called at any point; more input can follow.
+  uint64_t digest() const;
+
+ private:
+  uint64_t acc_[4];
+  uint64_t seed_, length_;
+  unsigned char pending_[32];
+};
+
+class Base64Encoder {
+ public:
+  void update(const void *data, size_t size);
+  /// Pads out the last group and returns the text.
+  std::string finish();
+
+ private:
+  void encode_group(const unsigned char *p);
+  std::string out_;
+  unsigned char pending_[3];
+  unsigned pending_size_ = 0;
+};
+
+/// Decodes base64 text, with or without padding, ignoring whitespace.
+/// Returns false, leaving `out` partly filled, on any other character.
+bool base64_decode(const std::string &text, std::vector<unsigned char> &out);
+
+} //namespace enigma
+
+#endif //ENIGMA_HASHING_H
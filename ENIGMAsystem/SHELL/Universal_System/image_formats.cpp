@@ -246,7 +246,7 @@ unsigned long *bgra_to_argb(unsigned char *bgra_data, unsigned pngwidth, unsigne
   return result;
 }
 
-unsigned char* mono_to_rgba(unsigned char* pxdata, unsigned width, unsigned height) {
+unsigned char* mono_to_rgba(const unsigned char* pxdata, unsigned width, unsigned height) {
   unsigned char* rgba = new unsigned char[width * height * 4];
   for (unsigned i = 0; i < width * height; ++i) {
     unsigned index_out = i * 4;
@@ -0,0 +1 @@
+#include "../../../shared/lz4/lz4block.cpp"
@@ -0,0 +1,176 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+typedef std::chrono::steady_clock profiler_clock;
+
+const int phase_count = enigma_user::profiler_swap + 1;
+const char* const phase_names[phase_count] = { "other", "step", "collision", "draw", "swap" };
+
+bool enabled = false;
+int current_phase = enigma_user::profiler_other;
+profiler_clock::time_point phase_start;
+double phase_times[phase_count];      // Milliseconds so far this frame
+double last_phase_times[phase_count]; // And for the frame before
+enigma::FrameCounts last_counts;
+double gpu_time = -1;
+
+// The Chrome trace array format doesn't need its closing bracket, so a trace
+// cut short by a crash still opens.
+struct trace_file {
+  std::ofstream out;
+  profiler_clock::time_point start;
+
+  ~trace_file() { close(); }
+
+  void close() {
+    if (!out.is_open()) return;
+    out << "\n]\n";
+    out.close();
+  }
+
+  long long microseconds(profiler_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - start).count();
+  }
+
+  void write(const char* event) {
+    out << ",\n" << event;
+  }
+} trace;
+
+// Adds the time since the phase started to it, and to the trace.
+void charge_phase(profiler_clock::time_point now) {
+  phase_times[current_phase] += std::chrono::duration<double, std::milli>(now - phase_start).count();
+  if (trace.out.is_open() && now > phase_start) {
+    char event[160];
+    snprintf(event, sizeof(event), "{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":1}",
+             phase_names[current_phase], trace.microseconds(phase_start), trace.microseconds(now) - trace.microseconds(phase_start));
+    trace.write(event);
+  }
+  phase_start = now;
+}
+
+// Starts timing from scratch, so that time from before isn't charged to anything.
+void start_timing() {
+  phase_start = profiler_clock::now();
+  for (int i = 0; i < phase_count; ++i) phase_times[i] = last_phase_times[i] = 0;
+}
+
+} // namespace anonymous
+
+namespace enigma {
+
+FrameCounts frame_counts;
+
+bool profiler_timing() {
+  return enabled || trace.out.is_open();
+}
+
+void profiler_gpu_time(double ms) {
+  gpu_time = ms;
+  if (trace.out.is_open()) {
+    char event[128];
+    snprintf(event, sizeof(event), "{\"name\":\"gpu\",\"ph\":\"C\",\"ts\":%lld,\"pid\":1,\"args\":{\"ms\":%.3f}}",
+             trace.microseconds(profiler_clock::now()), ms);
+    trace.write(event);
+  }
+}
+
+void profiler_phase(int phase) {
+  if (phase == current_phase) return;
+  if (profiler_timing()) charge_phase(profiler_clock::now());
+  current_phase = phase;
+}
+
+profiler_scope::profiler_scope(int phase): previous(current_phase) {
+  profiler_phase(phase);
+}
+
+profiler_scope::~profiler_scope() {
+  profiler_phase(previous);
+}
+
+void profiler_end_frame() {
+  last_counts = frame_counts;
+  frame_counts = FrameCounts();
+  if (!profiler_timing()) return;
+
+  const profiler_clock::time_point now = profiler_clock::now();
+  charge_phase(now);
+  for (int i = 0; i < phase_count; ++i) {
+    last_phase_times[i] = phase_times[i];
+    phase_times[i] = 0;
+  }
+  if (trace.out.is_open()) {
+    char event[320];
+    snprintf(event, sizeof(event), "{\"name\":\"frame\",\"ph\":\"C\",\"ts\":%lld,\"pid\":1,\"args\":{"
+             "\"batches\":%u,\"draw_calls\":%u,\"vertices\":%u,\"texture_switches\":%u,\"state_flushes\":%u}}",
+             trace.microseconds(now), last_counts.batches, last_counts.draw_calls, last_counts.vertices,
+             last_counts.texture_switches, last_counts.state_flushes);
+    trace.write(event);
+  }
+}
+
+} // namespace enigma
+
+namespace enigma_user {
+
+void profiler_set_enabled(bool enable) {
+  if (enable && !enigma::profiler_timing()) start_timing();
+  enabled = enable;
+}
+
+bool profiler_get_enabled() { return enabled; }
+
+int profiler_get_vertex_count() { return last_counts.vertices; }
+int profiler_get_drawcall_count() { return last_counts.draw_calls; }
+int profiler_get_batch_count() { return last_counts.batches; }
+int profiler_get_texture_switch_count() { return last_counts.texture_switches; }
+int profiler_get_state_flush_count() { return last_counts.state_flushes; }
+
+double profiler_get_cpu_time(int phase) {
+  if (!enigma::profiler_timing() || phase < 0 || phase >= phase_count) return -1;
+  return last_phase_times[phase];
+}
+
+double profiler_get_gpu_time() { return gpu_time; }
+
+bool profiler_trace_start(std::string filename) {
+  profiler_trace_stop();
+  // The trace starts where the current phase does
+  if (enigma::profiler_timing()) charge_phase(profiler_clock::now());
+  else start_timing();
+  trace.out.open(filename.c_str(), std::ios::out | std::ios::trunc);
+  if (!trace.out.is_open()) return false;
+  trace.start = phase_start;
+  trace.out << "[{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Game\"}}";
+  return true;
+}
+
+void profiler_trace_stop() {
+  if (!trace.out.is_open()) return;
+  charge_phase(profiler_clock::now());
+  trace.close();
+}
+
+} // namespace enigma_user
@@ -0,0 +1,90 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_PROFILER_H
+#define ENIGMA_PROFILER_H
+
+#include <string>
+
+namespace enigma {
+
+// What the renderer did so far this frame; the graphics systems count into it.
+struct FrameCounts {
+  unsigned batches, draw_calls, vertices, texture_switches, state_flushes;
+};
+extern FrameCounts frame_counts;
+
+// Backends call this for each draw they send, with the vertices (or indices) drawn.
+inline void profiler_draw_call(unsigned vertices) {
+  ++frame_counts.draw_calls;
+  frame_counts.vertices += vertices;
+}
+
+// Whether time is being measured, so that backends can skip timer queries otherwise
+bool profiler_timing();
+// For backends to report how long the GPU took over a frame, in milliseconds;
+// this is usually known a few frames after the fact.
+void profiler_gpu_time(double ms);
+// Charges the time from now on to the given phase, until the next call.
+void profiler_phase(int phase);
+// Charges the time until it goes out of scope to a phase, then goes back to
+// whichever phase was current before.
+struct profiler_scope {
+  int previous;
+  profiler_scope(int phase);
+  ~profiler_scope();
+};
+// Called once a frame, at the end of ENIGMA_events.
+void profiler_end_frame();
+
+} // namespace enigma
+
+namespace enigma_user {
+
+// The parts of a frame that CPU time is charged to
+enum {
+  profiler_other,     // Room changes, instance cleanup, and waiting for the next frame
+  profiler_step,      // Step, alarm, input and every other event
+  profiler_collision, // Collision events, including the checks for them
+  profiler_draw,      // Draw events and building up the frame
+  profiler_swap       // Presenting the frame, including any wait for vsync
+};
+
+// Counting is always on; timing and GPU queries only once enabled.
+void profiler_set_enabled(bool enable);
+bool profiler_get_enabled();
+
+// Each of these is for the last frame finished.
+int profiler_get_vertex_count();
+int profiler_get_drawcall_count();
+int profiler_get_batch_count();
+int profiler_get_texture_switch_count();
+int profiler_get_state_flush_count();
+// Milliseconds, or -1 when not timing or for an unknown phase
+double profiler_get_cpu_time(int phase);
+// Milliseconds the GPU took over the latest frame it has reported on, or -1
+// if the graphics system can't tell.
+double profiler_get_gpu_time();
+
+// Writes a trace of each frame's phases and counts to the file, in the Chrome
+// trace event format (chrome://tracing or Perfetto can open it), until stopped.
+// This times frames whether or not the profiler is enabled.
+bool profiler_trace_start(std::string filename);
+void profiler_trace_stop();
+
+} // namespace enigma_user
+
+#endif // ENIGMA_PROFILER_H
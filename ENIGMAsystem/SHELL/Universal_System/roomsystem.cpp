@@ -31,6 +31,7 @@
 #include "libEGMstd.h"
 #include "Instances/instance_system.h"
 #include "Instances/instance.h"
+#include "Instances/instance_index.h"
 #include "Object_Tiers/planar_object.h"
 #include "Resources/backgrounds.h"
 
@@ -194,6 +195,7 @@ namespace enigma
 
     //We may still be holding on to deactivated instances; they can interact badly with existing instances in certain cases.
     instance_deactivated_list.clear();
+    instance_index_generation++;
 
     // Initialize background variants so they do not throw uninitialized variable access errors.
     for (unsigned i=0;i<8;i++) {
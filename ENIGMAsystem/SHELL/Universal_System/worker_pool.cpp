@@ -0,0 +1,102 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "worker_pool.h"
+
+namespace enigma {
+
+void worker_pool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& thread : threads) thread.join();
+  threads.clear();
+  stopping = false;
+}
+
+// Claims and runs jobs of the current loop until none are left.
+void worker_pool::work() {
+  for (size_t i; (i = next_job++) < job_count; ) (*job)(i);
+}
+
+// `seen` is the loop current when the thread was started, which isn't its business.
+void worker_pool::worker(unsigned long seen) {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    wake.wait(lock, [&] { return stopping || batch != seen || !tasks.empty(); });
+    if (stopping) return;
+    if (batch != seen) {
+      seen = batch;
+      lock.unlock();
+      work();
+      lock.lock();
+      if (--busy == 0) done.notify_one();
+      continue;
+    }
+    std::function<void()> task = std::move(tasks.front());
+    tasks.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+void worker_pool::resize(size_t workers) {
+  if (threads.size() == workers) return;
+  stop();
+  std::lock_guard<std::mutex> lock(mutex);
+  for (size_t i = 0; i < workers; i++) {
+    threads.emplace_back([this, seen = batch] { worker(seen); });
+  }
+}
+
+void worker_pool::run(size_t count, const std::function<void(size_t)>& f) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &f;
+    job_count = count;
+    next_job = 0;
+    busy = threads.size();
+    batch++;
+  }
+  wake.notify_all();
+  work();
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return busy == 0; });
+  job = nullptr;
+}
+
+void worker_pool::parallel_for(int threads, size_t count, const std::function<void(size_t)>& job) {
+  const size_t total = threads > 0 ? threads : std::thread::hardware_concurrency();
+  if (total <= 1 || count <= 1) {
+    for (size_t i = 0; i < count; i++) job(i);
+    return;
+  }
+  resize(total - 1);
+  run(count, job);
+}
+
+void worker_pool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+  wake.notify_one();
+}
+
+}  //namespace enigma
@@ -0,0 +1,79 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifdef INCLUDED_FROM_SHELLMAIN
+#  error This file includes non-ENIGMA STL headers and should not be included from SHELLmain.
+#endif
+
+#ifndef ENIGMA_WORKER_POOL_H
+#define ENIGMA_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace enigma {
+
+// Threads that systems and extensions hand work to, either as a loop the
+// caller waits on or as tasks queued to run in the background. Threads are
+// started on first use and kept until the pool is resized or destroyed; each
+// system keeps its own pool, so that one's tasks never hold up another's loop.
+class worker_pool {
+ public:
+  ~worker_pool() { stop(); }
+
+  // Starts or stops threads so that exactly this many are running. Queued
+  // tasks are kept for the new threads.
+  void resize(size_t workers);
+  size_t size() const { return threads.size(); }
+
+  // Calls job(i) for every i in [0;count), spread over the workers and the
+  // calling thread, and returns once every call is done. Jobs may run in any
+  // order and must not depend on each other. A loop waits for workers busy
+  // with a task to finish it.
+  void run(size_t count, const std::function<void(size_t)>& job);
+  // The same on `threads` threads in all, counting the caller; 0 means one per
+  // hardware thread. With one thread, or one job, it all runs on the caller.
+  void parallel_for(int threads, size_t count, const std::function<void(size_t)>& job);
+
+  // Queues task to run on one of the workers, and returns at once.
+  void submit(std::function<void()> task);
+
+ private:
+  void stop();
+  void work();
+  void worker(unsigned long seen);
+
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable wake, done;
+  std::deque<std::function<void()> > tasks;
+  const std::function<void(size_t)>* job = nullptr;
+  size_t job_count = 0;
+  std::atomic<size_t> next_job{0};
+  size_t busy = 0;  // Workers yet to finish the current loop
+  unsigned long batch = 0;
+  bool stopping = false;
+};
+
+}  //namespace enigma
+
+#endif  //ENIGMA_WORKER_POOL_H
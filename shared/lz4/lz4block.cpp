@@ -0,0 +1,162 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#include "lz4block.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace enigma {
+
+namespace lz4 {
+
+// Limits from the block format: matches are at least four bytes, the last
+// five bytes are always literals, and no match may start in the last twelve.
+static const size_t kMinMatch = 4;
+static const size_t kLastLiterals = 5;
+static const size_t kMatchFindLimit = 12;
+static const size_t kMaxOffset = 65535;
+static const int kHashBits = 16;
+
+static inline uint32_t read32(const unsigned char* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - kHashBits);
+}
+
+static inline unsigned char* write_length(unsigned char* op, size_t len) {
+  for (; len >= 255; len -= 255) *op++ = 255;
+  *op++ = (unsigned char) len;
+  return op;
+}
+
+static unsigned char* write_sequence(unsigned char* op, const unsigned char* literals, size_t literal_count,
+                                     size_t offset, size_t match_length) {
+  unsigned char* token = op++;
+  *token = (literal_count >= 15 ? 15 : literal_count) << 4;
+  if (literal_count >= 15) op = write_length(op, literal_count - 15);
+  memcpy(op, literals, literal_count);
+  op += literal_count;
+  if (!match_length) return op;  // The final sequence carries literals only
+
+  *op++ = offset & 0xFF;
+  *op++ = offset >> 8;
+  match_length -= kMinMatch;
+  *token |= match_length >= 15 ? 15 : match_length;
+  if (match_length >= 15) op = write_length(op, match_length - 15);
+  return op;
+}
+
+size_t compress(const unsigned char* src, size_t size, unsigned char* dst) {
+  unsigned char* op = dst;
+  size_t anchor = 0;
+
+  if (size > kMatchFindLimit) {
+    // Positions are stored plus one so that zero marks an empty slot
+    std::vector<uint32_t> table(size_t(1) << kHashBits, 0);
+    const size_t match_start_limit = size - kMatchFindLimit;
+    const size_t match_end_limit = size - kLastLiterals;
+
+    size_t ip = 0, misses = 0;
+    while (ip < match_start_limit) {
+      const uint32_t sequence = read32(src + ip);
+      uint32_t &slot = table[hash(sequence)];
+      const size_t candidate = slot;
+      slot = ip + 1;
+
+      if (!candidate or ip - (candidate - 1) > kMaxOffset or read32(src + candidate - 1) != sequence) {
+        // Skip faster through data that isn't compressing
+        ip += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+
+      size_t ref = candidate - 1;
+      while (ip > anchor and ref > 0 and src[ip - 1] == src[ref - 1]) --ip, --ref;
+      size_t len = kMinMatch;
+      while (ip + len < match_end_limit and src[ip + len] == src[ref + len]) ++len;
+
+      op = write_sequence(op, src + anchor, ip - anchor, ip - ref, len);
+      ip += len;
+      anchor = ip;
+      if (ip - 2 < match_start_limit) table[hash(read32(src + ip - 2))] = ip - 2 + 1;
+    }
+  }
+
+  op = write_sequence(op, src + anchor, size - anchor, 0, 0);
+  return op - dst;
+}
+
+long decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity) {
+  const unsigned char* ip = src;
+  const unsigned char* const iend = src + size;
+  unsigned char* op = dst;
+  unsigned char* const oend = dst + capacity;
+
+  while (ip < iend) {
+    const unsigned token = *ip++;
+
+    size_t literal_count = token >> 4;
+    if (literal_count == 15) {
+      unsigned char b;
+      do {
+        if (ip >= iend) return -1;
+        literal_count += b = *ip++;
+      } while (b == 255);
+    }
+    if (size_t(iend - ip) < literal_count or size_t(oend - op) < literal_count) return -1;
+    memcpy(op, ip, literal_count);
+    ip += literal_count;
+    op += literal_count;
+    if (ip == iend) break;  // Last sequence has no match
+
+    if (iend - ip < 2) return -1;
+    const size_t offset = ip[0] | ip[1] << 8;
+    ip += 2;
+    if (!offset or offset > size_t(op - dst)) return -1;
+
+    size_t match_length = token & 15;
+    if (match_length == 15) {
+      unsigned char b;
+      do {
+        if (ip >= iend) return -1;
+        match_length += b = *ip++;
+      } while (b == 255);
+    }
+    match_length += kMinMatch;
+    if (size_t(oend - op) < match_length) return -1;
+
+    const unsigned char* match = op - offset;
+    if (offset >= match_length) {
+      memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      // Overlapping copy; this is how runs are encoded
+      while (match_length--) *op++ = *match++;
+    }
+  }
+
+  return op - dst;
+}
+
+} //namespace lz4
+
+} //namespace enigma
@@ -0,0 +1,45 @@
+/**
+*** This file is a part of the ENIGMA Development Environment.
+***
+*** ENIGMA is free software: you can redistribute it and/or modify it under the
+*** terms of the GNU General Public License as published by the Free Software
+*** Foundation, version 3 of the license or any later version.
+***
+*** This application and its source code is distributed AS-IS, WITHOUT ANY
+*** WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*** FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+*** details.
+***
+*** You should have received a copy of the GNU General Public License along
+*** with this code. If not, see <http://www.gnu.org/licenses/>
+**/
+
+#ifndef ENIGMA_LZ4BLOCK_H
+#define ENIGMA_LZ4BLOCK_H
+
+#include <cstddef>
+
+// A small implementation of the LZ4 block format, used for resources that
+// should load quickly rather than pack tightly. Output is compatible with the
+// reference liblz4 block API, so either side may be swapped for it.
+
+namespace enigma {
+
+namespace lz4 {
+
+/// Largest size compress() can produce for an input of the given size.
+inline size_t compress_bound(size_t size) { return size + size / 255 + 16; }
+
+/// Compresses `size` bytes of `src` into `dst`, which must hold at least
+/// compress_bound(size) bytes. Returns the compressed size.
+size_t compress(const unsigned char* src, size_t size, unsigned char* dst);
+
+/// Decompresses a block into `dst`, which holds `capacity` bytes. Returns the
+/// decompressed size, or -1 if the block is malformed or would overflow dst.
+long decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity);
+
+} //namespace lz4
+
+} //namespace enigma
+
+#endif //ENIGMA_LZ4BLOCK_H
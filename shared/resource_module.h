@@ -0,0 +1,120 @@
+#ifndef ENIGMA_RESOURCE_MODULE_H
+#define ENIGMA_RESOURCE_MODULE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the resource block the compiler appends to (or writes beside) a
+// game, shared by the compiler's writer and the engine's loader.
+//
+//   Header                        magic, version, location of the TOC
+//   payloads...                   one per TOC entry, kPayloadAlignment aligned
+//   TocEntry[entry_count]         sorted by (type, id, index)
+//   "\0\0\0\0res1" int32 start    trailer, found by seeking from the end
+//
+// Offsets are relative to the start of the block and all values are stored
+// little-endian. Because every payload is reachable from the TOC, the loader
+// can map the block and use uncompressed payloads in place, or hand separate
+// compressed payloads to separate decoders.
+
+namespace enigma {
+namespace resource_module {
+
+constexpr uint32_t fourcc(char a, char b, char c, char d) {
+  return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 |
+         uint32_t(uint8_t(c)) << 16 | uint32_t(uint8_t(d)) << 24;
+}
+
+constexpr uint32_t kVersion = 1;
+constexpr size_t kPayloadAlignment = 8;
+static const char kMagic[4] = {'E', 'R', 'E', 'S'};
+static const char kTrailer[8] = {'\0', '\0', '\0', '\0', 'r', 'e', 's', '1'};
+
+enum ResourceType : uint32_t {
+  RES_SPRITE           = fourcc('S', 'P', 'R', ' '),  // SpriteInfo
+  RES_SPRITE_IMAGE     = fourcc('S', 'P', 'R', 'I'),  // RGBA pixels, index = subimage
+  RES_SOUND            = fourcc('S', 'N', 'D', ' '),  // the sound file, as imported
+  RES_SOUND_INFO       = fourcc('S', 'N', 'D', 'I'),  // SoundInfo
+  RES_BACKGROUND       = fourcc('B', 'K', 'G', ' '),  // BackgroundInfo
+  RES_BACKGROUND_IMAGE = fourcc('B', 'K', 'G', 'I'),  // RGBA pixels
+  RES_FONT             = fourcc('F', 'N', 'T', ' '),  // FontInfo, then ranges
+  RES_FONT_IMAGE       = fourcc('F', 'N', 'T', 'I'),  // 8-bit glyph atlas
+  RES_PATH             = fourcc('P', 'T', 'H', ' '),  // PathInfo, then points
+};
+
+// Values double as the indices of the resource codec options in settings.ey.
+enum Codec : uint32_t {
+  CODEC_NONE = 0,
+  CODEC_ZLIB = 1,  // Smaller; the historical default
+  CODEC_LZ4  = 2,  // Larger, but decodes several times faster
+};
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+  uint64_t toc_offset;
+};
+
+struct TocEntry {
+  uint32_t type;
+  int32_t id;
+  uint32_t index;
+  uint32_t codec;
+  uint64_t offset;
+  uint64_t size;           // bytes stored in the module
+  uint64_t unpacked_size;  // bytes after decoding; equals size for CODEC_NONE
+};
+
+static_assert(sizeof(Header) == 24, "resource module header must be packed");
+static_assert(sizeof(TocEntry) == 40, "resource module TOC entry must be packed");
+
+inline bool operator<(const TocEntry &a, const TocEntry &b) {
+  if (a.type != b.type) return a.type < b.type;
+  if (a.id != b.id) return a.id < b.id;
+  return a.index < b.index;
+}
+
+struct SpriteInfo {
+  int32_t width, height, xorig, yorig;
+  int32_t bbox_top, bbox_bottom, bbox_left, bbox_right, bbox_mode;
+  int32_t shape, subimages;
+};
+
+struct SoundInfo {
+  int32_t kind;      // Sound::Kind from the resource
+  int32_t streamed;  // Keep the file encoded and decode it while it plays
+};
+
+struct BackgroundInfo {
+  int32_t width, height, transparent, smooth_edges, preload;
+  int32_t use_as_tileset, tile_width, tile_height;
+  int32_t h_offset, v_offset, h_sep, v_sep;
+};
+
+// Followed by range_count GlyphRangeInfo, each followed by its glyphs.
+struct FontInfo {
+  int32_t texture_width, texture_height, range_count;
+};
+struct GlyphRangeInfo {
+  int32_t start, count;
+};
+struct GlyphInfo {
+  float advance, baseline, origin;
+  int32_t width, height;
+  float tx, ty, tx2, ty2;
+};
+
+// Followed by point_count PathPointInfo.
+struct PathInfo {
+  int32_t smooth, closed, precision, point_count;
+};
+struct PathPointInfo {
+  int32_t x, y, speed;
+};
+
+}  // namespace resource_module
+}  // namespace enigma
+
+#endif  // ENIGMA_RESOURCE_MODULE_H